@@ -247,19 +247,12 @@ public:
         return remaining_bits;
     }
 
-private:
-    ErrorOr<void> refill_buffer_from_stream(size_t requested_bit_count)
+    /// Tries to buffer at least `requested_bit_count` bits, and returns how many bits are buffered.
+    /// Unlike peek_bits(), running out of data is not an error, so this can be used to find out whether a fast path
+    /// can peek a fixed number of bits without checking every single read.
+    ALWAYS_INLINE ErrorOr<size_t> fill_buffer(size_t requested_bit_count)
     {
-        while (requested_bit_count > m_bit_count) [[likely]] {
-            if (m_stream->is_eof()) [[unlikely]] {
-                if (m_unsatisfiable_read_behavior == UnsatisfiableReadBehavior::FillWithZero) {
-                    m_bit_count = requested_bit_count;
-                    return {};
-                }
-
-                return Error::from_string_literal("Reached end-of-stream without collecting the required number of bits");
-            }
-
+        while (requested_bit_count > m_bit_count && !m_stream->is_eof()) {
             size_t bits_to_read = bit_buffer_size - m_bit_count;
             size_t bytes_to_read = bits_to_read / bits_per_byte;
 
@@ -270,6 +263,23 @@ private:
             m_bit_count += bytes.size() * bits_per_byte;
         }
 
+        return m_bit_count;
+    }
+
+private:
+    ErrorOr<void> refill_buffer_from_stream(size_t requested_bit_count)
+    {
+        TRY(fill_buffer(requested_bit_count));
+
+        if (requested_bit_count > m_bit_count) [[unlikely]] {
+            if (m_unsatisfiable_read_behavior == UnsatisfiableReadBehavior::FillWithZero) {
+                m_bit_count = requested_bit_count;
+                return {};
+            }
+
+            return Error::from_string_literal("Reached end-of-stream without collecting the required number of bits");
+        }
+
         return {};
     }
 
@@ -25,6 +25,16 @@ static CPUIDResult cpuid(u32 leaf, u32 subleaf)
         : "0"(leaf), "2"(subleaf));
     return result;
 }
+
+static u64 xgetbv(u32 index)
+{
+    u32 eax;
+    u32 edx;
+    asm("xgetbv"
+        : "=a"(eax), "=d"(edx)
+        : "c"(index));
+    return (static_cast<u64>(edx) << 32) | eax;
+}
 #    endif
 
 CPUFeatures Detail::detect_cpu_features_uncached()
@@ -48,6 +58,16 @@ CPUFeatures Detail::detect_cpu_features_uncached()
     if (cpuid1.ecx >> 25 & 1)
         result |= CPUFeatures::X86_AES;
 #        endif
+#        if AK_CAN_CODEGEN_FOR_X86_PCLMUL
+    if (cpuid1.ecx >> 1 & 1)
+        result |= CPUFeatures::X86_PCLMUL;
+#        endif
+#        if AK_CAN_CODEGEN_FOR_X86_AVX2
+    // The OS also has to save the upper halves of the YMM registers on context switches.
+    bool os_saves_ymm_registers = (cpuid1.ecx >> 27 & 1) && (xgetbv(0) & 0b110) == 0b110;
+    if (os_saves_ymm_registers && (cpuid7.ebx >> 5 & 1))
+        result |= CPUFeatures::X86_AVX2;
+#        endif
 #    endif
 
     return result;
@@ -22,6 +22,10 @@ enum class CPUFeatures : u64 {
     X86_SHA = 1ULL << 1,
 #    define AK_CAN_CODEGEN_FOR_X86_AES 1
     X86_AES = 1ULL << 2,
+#    define AK_CAN_CODEGEN_FOR_X86_PCLMUL 1
+    X86_PCLMUL = 1ULL << 3,
+#    define AK_CAN_CODEGEN_FOR_X86_AVX2 1
+    X86_AVX2 = 1ULL << 4,
 #else
 #    define AK_CAN_CODEGEN_FOR_X86_SSE42 0
     X86_SSE42 = Invalid,
@@ -29,6 +33,10 @@ enum class CPUFeatures : u64 {
     X86_SHA = Invalid,
 #    define AK_CAN_CODEGEN_FOR_X86_AES 0
     X86_AES = Invalid,
+#    define AK_CAN_CODEGEN_FOR_X86_PCLMUL 0
+    X86_PCLMUL = Invalid,
+#    define AK_CAN_CODEGEN_FOR_X86_AVX2 0
+    X86_AVX2 = Invalid,
 #endif
 };
 
@@ -40,6 +40,9 @@ public:
 
     bool is_null() const { return m_ptr == nullptr; }
 
+    // Used by JIT compilers to check the pointer directly.
+    static size_t ptr_offset() { return __builtin_offsetof(WeakLink, m_ptr); }
+
     void revoke() { m_ptr = nullptr; }
 
 private:
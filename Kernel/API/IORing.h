@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// An I/O ring is a pair of queues in memory shared between a process and the kernel, which is mapped by mmap()ing the
+// file descriptor returned by io_ring_create(). The process adds submissions at the submission queue's tail and tells
+// the kernel about them with io_ring_enter(). The kernel adds a completion for every submission it has consumed once
+// the operation has finished, which the process then removes at the completion queue's head.
+//
+// Both queues are rings whose sizes are powers of two, so their head and tail are free-running counters that are
+// masked to index into the entry arrays. Whoever adds entries owns a queue's tail, and whoever removes them its head.
+
+#define IO_RING_MAX_ENTRIES 4096
+
+// Passed as the offset of a read or write to use (and advance) the file description's offset.
+#define IO_RING_CURRENT_OFFSET (~0ull)
+
+enum class IORingOpcode : u8 {
+    Nop,
+    Read,
+    Write,
+    Accept,
+    Send,
+    Receive,
+    Fsync,
+};
+
+struct IORingSubmission {
+    IORingOpcode opcode;
+    u8 reserved[3];
+    i32 fd;
+    // SOCK_NONBLOCK and SOCK_CLOEXEC for accepts, and MSG_* flags for sends and receives.
+    u32 flags;
+    u32 length;
+    u64 offset;
+    u64 buffer;
+    // Passed through to the completion, so the process can tell which submission it belongs to.
+    u64 user_data;
+};
+static_assert(sizeof(IORingSubmission) == 40);
+
+struct IORingCompletion {
+    u64 user_data;
+    // The syscall-style result of the operation: A byte count or file descriptor, or a negated errno value.
+    i64 result;
+};
+static_assert(sizeof(IORingCompletion) == 16);
+
+struct IORingHeader {
+    u32 submission_head;
+    u32 submission_tail;
+    u32 completion_head;
+    u32 completion_tail;
+
+    // These are set up by the kernel and don't change afterwards.
+    u32 submission_entries;
+    u32 completion_entries;
+    u32 submissions_offset;
+    u32 completions_offset;
+    u32 mapping_size;
+};
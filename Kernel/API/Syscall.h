@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/EnumBits.h>
 #include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <AK/Userspace.h>
@@ -18,6 +19,7 @@
 
 extern "C" {
 struct pollfd;
+struct epoll_event;
 struct timeval;
 struct timespec;
 struct sockaddr;
@@ -69,6 +71,9 @@ enum class NeedsBigProcessLock {
     S(disown, NeedsBigProcessLock::No)                     \
     S(dump_backtrace, NeedsBigProcessLock::No)             \
     S(dup2, NeedsBigProcessLock::No)                       \
+    S(epoll_create, NeedsBigProcessLock::No)               \
+    S(epoll_ctl, NeedsBigProcessLock::No)                  \
+    S(epoll_pwait, NeedsBigProcessLock::No)                \
     S(execve, NeedsBigProcessLock::Yes)                    \
     S(exit, NeedsBigProcessLock::Yes)                      \
     S(exit_thread, NeedsBigProcessLock::Yes)               \
@@ -112,6 +117,8 @@ enum class NeedsBigProcessLock {
     S(getuid, NeedsBigProcessLock::No)                     \
     S(inode_watcher_add_watch, NeedsBigProcessLock::No)    \
     S(inode_watcher_remove_watch, NeedsBigProcessLock::No) \
+    S(io_ring_create, NeedsBigProcessLock::No)             \
+    S(io_ring_enter, NeedsBigProcessLock::No)              \
     S(ioctl, NeedsBigProcessLock::No)                      \
     S(join_thread, NeedsBigProcessLock::No)                \
     S(kill, NeedsBigProcessLock::No)                       \
@@ -265,6 +272,28 @@ struct SC_poll_params {
     u32 const* sigmask;
 };
 
+struct SC_epoll_ctl_params {
+    int epoll_fd;
+    int operation;
+    int fd;
+    struct epoll_event const* event;
+};
+
+struct SC_epoll_pwait_params {
+    int epoll_fd;
+    struct epoll_event* events;
+    int max_events;
+    const struct timespec* timeout;
+    u32 const* sigmask;
+};
+
+struct SC_io_ring_enter_params {
+    int fd;
+    u32 to_submit;
+    u32 min_complete;
+    const struct timespec* timeout;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
@@ -555,10 +584,21 @@ enum class SchedulerParametersMode : bool {
     Thread,
 };
 
+enum class SchedulerParametersFields : u8 {
+    None = 0,
+    Priority = 1 << 0,
+    CPUAffinity = 1 << 1,
+};
+
+AK_ENUM_BITWISE_OPERATORS(SchedulerParametersFields);
+
 struct SC_scheduler_parameters_params {
     pid_t pid_or_tid;
     SchedulerParametersMode mode;
+    // The fields that scheduler_set_parameters should change, ignored by scheduler_get_parameters.
+    SchedulerParametersFields fields;
     struct sched_param parameters;
+    u32 cpu_affinity;
 };
 
 struct SC_faccessat_params {
@@ -10,11 +10,18 @@
 
 namespace Kernel {
 #if ARCH(X86_64)
+u8 msi_destination_id(u32 processor_id);
 u64 msi_address_register(u8 destination_id, bool redirection_hint, bool destination_mode);
 u32 msi_data_register(u8 vector, bool level_trigger, bool assert);
 u32 msix_vector_control_register(u32 vector_control, bool mask);
 void msi_signal_eoi();
 #elif ARCH(AARCH64) || ARCH(RISCV64)
+[[maybe_unused]] static u8 msi_destination_id([[maybe_unused]] u32 processor_id)
+{
+    TODO_AARCH64();
+    return 0;
+}
+
 [[maybe_unused]] static u64 msi_address_register([[maybe_unused]] u8 destination_id, [[maybe_unused]] bool redirection_hint, [[maybe_unused]] bool destination_mode)
 {
     TODO_AARCH64();
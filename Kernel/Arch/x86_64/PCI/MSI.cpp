@@ -12,6 +12,11 @@
 #include <Kernel/Interrupts/InterruptDisabler.h>
 
 namespace Kernel {
+u8 msi_destination_id(u32 processor_id)
+{
+    return Processor::by_id(processor_id).info().apic_id();
+}
+
 u64 msi_address_register(u8 destination_id, bool redirection_hint, bool destination_mode)
 {
     u64 flags = 0;
@@ -20,7 +25,7 @@ u64 msi_address_register(u8 destination_id, bool redirection_hint, bool destinat
         if (destination_mode)
             flags |= msi_destination_mode_logical;
     }
-    return (msi_address_base | (Processor::by_id(destination_id).info().apic_id() << msi_destination_shift) | flags);
+    return (msi_address_base | (static_cast<u64>(destination_id) << msi_destination_shift) | flags);
 }
 
 u32 msi_data_register(u8 vector, bool level_trigger, bool assert)
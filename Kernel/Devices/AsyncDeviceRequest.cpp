@@ -21,6 +21,7 @@ AsyncDeviceRequest::~AsyncDeviceRequest()
         SpinlockLocker lock(m_lock);
         VERIFY(is_completed_result(m_result));
         VERIFY(m_sub_requests_pending.is_empty());
+        VERIFY(m_merged_requests.is_empty());
     }
 
     // We should not need any locking here anymore. The destructor should
@@ -44,20 +45,31 @@ void AsyncDeviceRequest::request_finished()
     if (m_parent_request)
         m_parent_request->sub_request_finished(*this);
 
-    // Trigger processing the next request
-    m_device.process_next_queued_request({}, *this);
+    // Trigger processing the next request, unless we never got a place in the queue of our own.
+    if (!m_is_merged)
+        m_device.process_next_queued_request({}, *this);
+
+    while (!m_merged_requests.is_empty()) {
+        auto merged_request = m_merged_requests.take_first();
+        merged_request->request_finished();
+    }
 
     // Wake anyone who may be waiting
     m_queue.wake_all();
 }
 
 auto AsyncDeviceRequest::wait(Duration* timeout) -> RequestWaitResult
+{
+    return wait(Thread::BlockTimeout(false, timeout));
+}
+
+auto AsyncDeviceRequest::wait(Thread::BlockTimeout const& timeout) -> RequestWaitResult
 {
     VERIFY(!m_parent_request);
     auto request_result = get_request_result();
     if (is_completed_result(request_result))
         return { request_result, Thread::BlockResult::NotBlocked };
-    auto wait_result = m_queue.wait_on(Thread::BlockTimeout(false, timeout), name());
+    auto wait_result = m_queue.wait_on(timeout, name());
     return { get_request_result(), wait_result };
 }
 
@@ -78,7 +90,24 @@ void AsyncDeviceRequest::add_sub_request(NonnullLockRefPtr<AsyncDeviceRequest> s
     VERIFY(!is_completed_result(m_result));
     m_sub_requests_pending.append(sub_request);
     if (m_result == Started)
-        sub_request->do_start(move(lock));
+        sub_request->do_start(lock);
+}
+
+bool AsyncDeviceRequest::try_merge(AsyncDeviceRequest& request)
+{
+    VERIFY(&m_device == &request.m_device);
+    VERIFY(&request != this);
+    if (m_result != Pending || !can_merge(request))
+        return false;
+
+    SpinlockLocker lock(request.m_lock);
+    if (request.m_result != Pending || !request.m_sub_requests_pending.is_empty())
+        return false;
+    request.m_result = Started;
+    request.m_is_merged = true;
+    m_merged_requests.append(request);
+    did_merge(request);
+    return true;
 }
 
 void AsyncDeviceRequest::sub_request_finished(AsyncDeviceRequest& sub_request)
@@ -135,6 +164,11 @@ void AsyncDeviceRequest::complete(RequestResult result)
         VERIFY(m_result == Started);
         m_result = result;
     }
+    for (auto& merged_request : m_merged_requests) {
+        SpinlockLocker lock(merged_request.m_lock);
+        VERIFY(merged_request.m_result == Started);
+        merged_request.m_result = result;
+    }
     if (Processor::current_in_irq()) {
         ref(); // Make sure we don't get freed
         Processor::deferred_call_queue([this]() {
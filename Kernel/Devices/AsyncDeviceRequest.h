@@ -61,10 +61,13 @@ public:
     void add_sub_request(NonnullLockRefPtr<AsyncDeviceRequest>);
 
     [[nodiscard]] RequestWaitResult wait(Duration* = nullptr);
+    [[nodiscard]] RequestWaitResult wait(Thread::BlockTimeout const&);
+    [[nodiscard]] bool is_completed() const { return is_completed_result(get_request_result()); }
 
-    void do_start(SpinlockLocker<Spinlock<LockRank::None>>&& requests_lock)
+    // Starts the request if nobody else has, in which case the lock is released before calling start().
+    void do_start(SpinlockLocker<Spinlock<LockRank::None>>& requests_lock)
     {
-        if (is_completed_result(m_result))
+        if (m_result != Pending)
             return;
         m_result = Started;
         requests_lock.unlock();
@@ -72,6 +75,18 @@ public:
         start();
     }
 
+    // Called by the device for a request that is queued right behind this one before this one is started.
+    // If it returns true, this request has taken over the work of the other one, which is then completed
+    // together with this request.
+    bool try_merge(AsyncDeviceRequest&);
+
+    template<typename Callback>
+    void for_each_merged_request(Callback callback)
+    {
+        for (auto& request : m_merged_requests)
+            callback(request);
+    }
+
     void complete(RequestResult result);
 
     void set_private(void* priv)
@@ -134,6 +149,11 @@ protected:
 
     RequestResult get_request_result() const;
 
+    // Whether this request can do the work of the given request as well, which comes right after it in the queue
+    // of the same device.
+    virtual bool can_merge(AsyncDeviceRequest const&) const { return false; }
+    virtual void did_merge(AsyncDeviceRequest&) { }
+
 private:
     void sub_request_finished(AsyncDeviceRequest&);
     void request_finished();
@@ -155,11 +175,15 @@ private:
     AsyncDeviceRequest* m_parent_request { nullptr };
     RequestResult m_result { Pending };
     IntrusiveListNode<AsyncDeviceRequest, LockRefPtr<AsyncDeviceRequest>> m_list_node;
+    IntrusiveListNode<AsyncDeviceRequest, LockRefPtr<AsyncDeviceRequest>> m_merged_list_node;
 
     using AsyncDeviceSubRequestList = IntrusiveList<&AsyncDeviceRequest::m_list_node>;
+    using AsyncDeviceMergedRequestList = IntrusiveList<&AsyncDeviceRequest::m_merged_list_node>;
 
     AsyncDeviceSubRequestList m_sub_requests_pending;
     AsyncDeviceSubRequestList m_sub_requests_complete;
+    AsyncDeviceMergedRequestList m_merged_requests;
+    bool m_is_merged { false };
     DeprecatedWaitQueue m_queue;
     LockWeakPtr<Process> const m_process;
     void* m_private { nullptr };
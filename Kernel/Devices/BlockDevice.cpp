@@ -15,6 +15,7 @@ AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestTy
     , m_request_type(request_type)
     , m_block_index(block_index)
     , m_block_count(block_count)
+    , m_total_block_count(block_count)
     , m_buffer(buffer)
     , m_buffer_size(buffer_size)
 {
@@ -25,6 +26,27 @@ void AsyncBlockDeviceRequest::start()
     m_block_device.start_request(*this);
 }
 
+bool AsyncBlockDeviceRequest::can_merge(AsyncDeviceRequest const& other) const
+{
+    auto max_block_count = m_block_device.max_merged_request_block_count();
+    if (max_block_count == 0)
+        return false;
+
+    // Only requests on the same device end up in the same queue, so this is a block device request as well.
+    auto const& request = static_cast<AsyncBlockDeviceRequest const&>(other);
+    if (request.m_request_type != m_request_type || request.m_block_index != m_block_index + m_total_block_count)
+        return false;
+    if (m_total_block_count + request.m_block_count > max_block_count)
+        return false;
+    // The data of the merged requests is laid out back to back, so they have to cover their blocks exactly.
+    return m_buffer_size == m_block_count * block_size() && request.m_buffer_size == request.m_block_count * block_size();
+}
+
+void AsyncBlockDeviceRequest::did_merge(AsyncDeviceRequest& other)
+{
+    m_total_block_count += static_cast<AsyncBlockDeviceRequest&>(other).m_block_count;
+}
+
 BlockDevice::BlockDevice(MajorAllocation::BlockDeviceFamily block_device_family, MinorNumber minor, size_t block_size)
     : Device(MajorAllocation::block_device_family_to_major_number(block_device_family), minor)
     , m_block_size(block_size)
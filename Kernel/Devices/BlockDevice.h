@@ -28,6 +28,18 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) = 0;
 
+    // Requests are only checked against the size of the device by read() and write(), so they may only be started
+    // directly by others if the device knows how many blocks it has.
+    virtual Optional<u64> addressable_block_count() const { return {}; }
+
+    // How many blocks a request may cover once the requests queued right behind it have been merged into it.
+    // Devices have to opt into this, as their start_request() then has to take care of the merged requests too.
+    virtual u32 max_merged_request_block_count() const { return 0; }
+
+    // How many blocks read(), write() and others that make their own requests put into a single request.
+    // Not all controllers can transfer more than a page at a time, but the ones that take merged requests can.
+    u32 max_request_block_count() const { return max<u32>(PAGE_SIZE >> m_block_size_log, max_merged_request_block_count()); }
+
 protected:
     BlockDevice(MajorAllocation::BlockDeviceFamily, MinorNumber minor, size_t block_size = PAGE_SIZE);
 
@@ -58,11 +70,31 @@ public:
     RequestType request_type() const { return m_request_type; }
     u64 block_index() const { return m_block_index; }
     u32 block_count() const { return m_block_count; }
+    // Includes the blocks of all requests that were merged into this one.
+    u32 total_block_count() const { return m_total_block_count; }
     size_t block_size() const { return m_block_device.block_size(); }
     UserOrKernelBuffer& buffer() { return m_buffer; }
     UserOrKernelBuffer const& buffer() const { return m_buffer; }
     size_t buffer_size() const { return m_buffer_size; }
 
+    // Calls the callback for this request and each request that was merged into it, along with the offset
+    // of its data within the whole transfer.
+    template<typename Callback>
+    ErrorOr<void> for_each_request_in_transfer(Callback callback)
+    {
+        TRY(callback(*this, 0));
+        size_t offset = m_buffer_size;
+        ErrorOr<void> result;
+        for_each_merged_request([&](AsyncDeviceRequest& request) {
+            if (result.is_error())
+                return;
+            auto& block_request = static_cast<AsyncBlockDeviceRequest&>(request);
+            result = callback(block_request, offset);
+            offset += block_request.buffer_size();
+        });
+        return result;
+    }
+
     virtual void start() override;
     virtual StringView name() const override
     {
@@ -77,10 +109,14 @@ public:
     }
 
 private:
+    virtual bool can_merge(AsyncDeviceRequest const&) const override;
+    virtual void did_merge(AsyncDeviceRequest&) override;
+
     BlockDevice& m_block_device;
     RequestType const m_request_type;
     u64 const m_block_index;
     u32 const m_block_count;
+    u32 m_total_block_count { 0 };
     UserOrKernelBuffer m_buffer;
     size_t const m_buffer_size;
 };
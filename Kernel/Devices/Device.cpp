@@ -120,17 +120,45 @@ ErrorOr<NonnullRefPtr<OpenFileDescription>> Device::open(int options)
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceRequest const& completed_request)
 {
     SpinlockLocker lock(m_requests_lock);
-    VERIFY(!m_requests.is_empty());
-    VERIFY(m_requests.first().ptr() == &completed_request);
-    m_requests.remove(m_requests.begin());
-    if (!m_requests.is_empty()) {
-        auto* next_request = m_requests.first().ptr();
-        next_request->do_start(move(lock));
-    }
+    VERIFY(m_requests_in_flight > 0);
+
+    // With more than one request in flight, they may complete in any order.
+    auto it = m_requests.begin();
+    for (size_t index = 0; it->ptr() != &completed_request; ++index, ++it)
+        VERIFY(index + 1 < m_requests_in_flight);
+    m_requests.remove(it);
+    --m_requests_in_flight;
+    start_queued_requests(lock);
+    lock.unlock();
 
     evaluate_block_conditions();
 }
 
+void Device::start_queued_requests(SpinlockLocker<Spinlock<LockRank::None>>& lock)
+{
+    VERIFY(lock.have_lock());
+    while (m_requests_in_flight < max_requests_in_flight()) {
+        auto it = m_requests.begin();
+        for (size_t index = 0; index < m_requests_in_flight; ++index)
+            ++it;
+        if (it.is_end())
+            return;
+
+        // Give the request a chance to take over the work of the ones queued right behind it.
+        NonnullLockRefPtr<AsyncDeviceRequest> request = *it->ptr();
+        for (auto next = it; !(++next).is_end() && request->try_merge(**next);) {
+            m_requests.remove(next);
+            next = it;
+            ++m_merged_request_count;
+        }
+
+        ++m_requests_in_flight;
+        request->do_start(lock);
+        if (!lock.have_lock())
+            lock.lock();
+    }
+}
+
 void Device::after_inserting_device(Badge<Device>, Device& device)
 {
     if (device.is_block_device()) {
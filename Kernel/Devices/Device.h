@@ -14,6 +14,7 @@
 // There are two main subclasses:
 //   - BlockDevice (random access)
 //   - CharacterDevice (sequential)
+#include <AK/Atomic.h>
 #include <AK/CircularQueue.h>
 #include <AK/DoublyLinkedList.h>
 #include <AK/Error.h>
@@ -54,15 +55,20 @@ public:
     virtual bool is_openable_by_jailed_processes() const { return false; }
     void process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceRequest const&);
 
+    // How many queued requests may be started before the first of them has completed.
+    // Requests are always started in the order they were made in.
+    virtual size_t max_requests_in_flight() const { return 1; }
+
+    // How many queued requests have been merged into the request in front of them so far.
+    u64 merged_request_count() const { return m_merged_request_count.load(); }
+
     template<typename AsyncRequestType, typename... Args>
     ErrorOr<NonnullLockRefPtr<AsyncRequestType>> try_make_request(Args&&... args)
     {
         auto request = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) AsyncRequestType(*this, forward<Args>(args)...)));
         SpinlockLocker lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
         TRY(m_requests.try_append(request));
-        if (was_empty)
-            request->do_start(move(lock));
+        start_queued_requests(lock);
         return request;
     }
 
@@ -97,6 +103,8 @@ protected:
     virtual void before_will_be_destroyed_remove_from_device_identifier_directory() = 0;
 
 private:
+    void start_queued_requests(SpinlockLocker<Spinlock<LockRank::None>>&);
+
     template<typename T>
     static inline void add_device_to_map(HashMap<u64, T*>& map, Device& device)
     {
@@ -119,7 +127,10 @@ private:
     State m_state { State::Normal };
 
     Spinlock<LockRank::None> m_requests_lock {};
+    // The first m_requests_in_flight requests have been started, the rest are still waiting for their turn.
     DoublyLinkedList<LockRefPtr<AsyncDeviceRequest>> m_requests;
+    size_t m_requests_in_flight { 0 };
+    Atomic<u64, AK::MemoryOrder::memory_order_relaxed> m_merged_request_count { 0 };
 
 protected:
     // FIXME: This pointer will be eventually removed after all nodes in /sys/dev/block/ and
@@ -37,7 +37,7 @@ UNMAP_AFTER_INIT NVMeController::NVMeController(const PCI::DeviceIdentifier& dev
 
 UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
 {
-    // Nr of queues = one queue per core
+    // Nr of queues = one queue per core, unless the controller can't provide that many
     auto nr_of_queues = Processor::count();
     auto queue_type = is_queue_polled ? QueueType::Polled : QueueType::IRQ;
 
@@ -67,6 +67,9 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
     dbgln_if(NVME_DEBUG, "NVMe: IO queue depth is: {}", IO_QUEUE_SIZE);
 
     TRY(identify_and_init_controller());
+    nr_of_queues = request_io_queues(nr_of_queues);
+    dbgln_if(NVME_DEBUG, "NVMe: Using {} IO queues", nr_of_queues);
+
     // Create an IO queue per core
     for (u32 cpuid = 0; cpuid < nr_of_queues; ++cpuid) {
         // qid is zero is used for admin queue
@@ -211,7 +214,7 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::identify_and_init_namespaces()
 
             dbgln_if(NVME_DEBUG, "NVMe: Block count is {} and Block size is {}", block_counts, block_size);
 
-            m_namespaces.append(TRY(NVMeNameSpace::create(*this, m_queues, nsid, block_counts, block_size)));
+            m_namespaces.append(TRY(NVMeNameSpace::create(*this, m_queues, nsid, block_counts, block_size, m_max_transfer_pages * PAGE_SIZE)));
             m_device_count++;
             dbgln_if(NVME_DEBUG, "NVMe: Initialized namespace with NSID: {}", nsid);
         }
@@ -248,6 +251,14 @@ ErrorOr<void> NVMeController::identify_and_init_controller()
         }
     }
 
+    // MDTS is in units of the minimum memory page size, and 0 means that there is no limit.
+    m_max_transfer_pages = IO_COMMAND_MAX_PAGES;
+    if (ctrl.mdts != 0 && ctrl.mdts < 32) {
+        auto max_transfer_size = CAP_MPSMIN_SIZE(m_controller_regs->cap) << ctrl.mdts;
+        m_max_transfer_pages = clamp<u64>(max_transfer_size / PAGE_SIZE, 1, IO_COMMAND_MAX_PAGES);
+    }
+    dbgln_if(NVME_DEBUG, "NVMe: Transferring at most {} pages per command", m_max_transfer_pages);
+
     if (ctrl.oacs & ID_CTRL_SHADOW_DBBUF_MASK) {
         OwnPtr<Memory::Region> dbbuf_dma_region;
         OwnPtr<Memory::Region> eventidx_dma_region;
@@ -281,6 +292,23 @@ ErrorOr<void> NVMeController::identify_and_init_controller()
     return {};
 }
 
+UNMAP_AFTER_INIT u32 NVMeController::request_io_queues(u32 nr_of_queues)
+{
+    NVMeSubmission sub {};
+    u32 result = 0;
+    sub.op = OP_ADMIN_SET_FEATURES;
+    sub.generic.cdw10 = FEATURE_NUMBER_OF_QUEUES;
+    sub.generic.cdw11 = NUMBER_OF_QUEUES(nr_of_queues, nr_of_queues);
+    if (auto status = submit_admin_command(sub, true, &result); status) {
+        dmesgln_pci(*this, "Failed to set the number of IO queues: status {:#x}", status);
+        return nr_of_queues;
+    }
+
+    // The controller may allocate more queues than requested, but never fewer than one of each kind.
+    u32 allocated_queues = min(NUMBER_OF_SUBMISSION_QUEUES(result), NUMBER_OF_COMPLETION_QUEUES(result));
+    return min(nr_of_queues, allocated_queues);
+}
+
 UNMAP_AFTER_INIT NVMeController::NSFeatures NVMeController::get_ns_features(IdentifyNamespace& identify_data_struct)
 {
     auto flbas = identify_data_struct.flbas & FLBA_SIZE_MASK;
@@ -441,9 +469,10 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_io_queue(u8 qid, QueueType
         .dbbuf_eventidx = move(eventidx_doorbell_regs),
     };
 
-    auto irq = TRY(allocate_irq(qid));
+    // Deliver the completions of each queue to the processor that mostly submits to it.
+    auto irq = TRY(allocate_irq(qid, qid - 1));
 
-    m_queues.append(TRY(NVMeQueue::try_create(*this, qid, irq, IO_QUEUE_SIZE, move(cq_dma_region), move(sq_dma_region), move(doorbell), queue_type)));
+    m_queues.append(TRY(NVMeQueue::try_create(*this, qid, irq, IO_QUEUE_SIZE, move(cq_dma_region), move(sq_dma_region), move(doorbell), queue_type, m_max_transfer_pages)));
     dbgln_if(NVME_DEBUG, "NVMe: Created IO Queue with QID{}", m_queues.size());
     return {};
 }
@@ -38,11 +38,11 @@ public:
     ErrorOr<void> reset_controller();
     ErrorOr<void> start_controller();
 
-    u16 submit_admin_command(NVMeSubmission& sub, bool sync = false)
+    u16 submit_admin_command(NVMeSubmission& sub, bool sync = false, u32* result = nullptr)
     {
         // First queue is always the admin queue
         if (sync) {
-            return m_admin_queue->submit_sync_sqe(sub);
+            return m_admin_queue->submit_sync_sqe(sub, result);
         }
         m_admin_queue->submit_sqe(sub);
         return 0;
@@ -62,6 +62,7 @@ private:
     void set_admin_q_depth();
     ErrorOr<void> identify_and_init_namespaces();
     ErrorOr<void> identify_and_init_controller();
+    u32 request_io_queues(u32 nr_of_queues);
     NSFeatures get_ns_features(IdentifyNamespace& identify_data_struct);
     ErrorOr<void> create_admin_queue(QueueType queue_type);
     ErrorOr<void> create_io_queue(u8 qid, QueueType queue_type);
@@ -83,6 +84,7 @@ private:
     AK::Duration m_ready_timeout;
     PhysicalAddress m_bar { 0 };
     u8 m_dbl_stride { 0 };
+    size_t m_max_transfer_pages { 1 };
     Optional<PCI::InterruptType> m_irq_type;
     QueueType m_queue_type { QueueType::IRQ };
     static Atomic<u8> s_controller_id;
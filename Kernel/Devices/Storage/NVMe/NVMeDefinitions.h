@@ -34,13 +34,15 @@ struct IdentifyNamespace {
     u64 rsvd3[488];
 };
 
-// FIXME: For now only one value is used. Once we start using
+// FIXME: For now only a few values are used. Once we start using
 // more values from id_ctrl command, use separate member variables
 // instead of using rsd array.
 struct IdentifyController {
-    u8 rsdv1[256];
+    u8 rsdv1[77];
+    u8 mdts;
+    u8 rsdv2[178];
     u16 oacs;
-    u8 rsdv2[3838];
+    u8 rsdv3[3838];
 };
 
 // DOORBELL
@@ -64,6 +66,14 @@ static constexpr u32 CAP_TO(u64 cap)
     return (cap & CAP_TO_MASK) >> CAP_TO_SHIFT;
 }
 
+static constexpr u8 CAP_MPSMIN_SHIFT = 48;
+static constexpr u64 CAP_MPSMIN_MASK = 0xfull << CAP_MPSMIN_SHIFT;
+// The smallest memory page size the controller supports, which is also the unit of MDTS.
+static constexpr u64 CAP_MPSMIN_SIZE(u64 cap)
+{
+    return 1ull << (12 + ((cap & CAP_MPSMIN_MASK) >> CAP_MPSMIN_SHIFT));
+}
+
 // CC – Controller Configuration
 static constexpr u8 CC_EN_BIT = 0x0;
 static constexpr u8 CSTS_RDY_BIT = 0x0;
@@ -100,6 +110,10 @@ static constexpr u16 CQ_STATUS_FIELD(u16 x)
 
 static constexpr u16 ADMIN_QUEUE_SIZE = 2;
 static constexpr u16 IO_QUEUE_SIZE = 64; // TODO:Need to be configurable
+// How many IO commands may be in flight on each IO queue, each of which has its own DMA buffer.
+static constexpr u16 IO_QUEUE_COMMAND_SLOTS = 8;
+// The largest transfer a single IO command does, which allows merging adjacent requests of up to 64 KiB.
+static constexpr u32 IO_COMMAND_MAX_PAGES = 16;
 
 // IDENTIFY
 static constexpr u16 NVMe_IDENTIFY_SIZE = 4096;
@@ -117,9 +131,26 @@ enum AdminCommandOpCode {
     OP_ADMIN_CREATE_COMPLETION_QUEUE = 0x5,
     OP_ADMIN_CREATE_SUBMISSION_QUEUE = 0x1,
     OP_ADMIN_IDENTIFY = 0x6,
+    OP_ADMIN_SET_FEATURES = 0x9,
     OP_ADMIN_DBBUF_CONFIG = 0x7C,
 };
 
+// FEATURES
+static constexpr u8 FEATURE_NUMBER_OF_QUEUES = 0x7;
+// Both the requested and the allocated numbers of queues are 0 based.
+static constexpr u32 NUMBER_OF_QUEUES(u16 submission_queues, u16 completion_queues)
+{
+    return static_cast<u32>(submission_queues - 1) | (static_cast<u32>(completion_queues - 1) << 16);
+}
+static constexpr u16 NUMBER_OF_SUBMISSION_QUEUES(u32 result)
+{
+    return (result & 0xffff) + 1;
+}
+static constexpr u16 NUMBER_OF_COMPLETION_QUEUES(u32 result)
+{
+    return (result >> 16) + 1;
+}
+
 // IO opcodes
 enum IOCommandOpcode {
     OP_NVME_WRITE = 0x1,
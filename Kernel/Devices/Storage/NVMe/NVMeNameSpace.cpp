@@ -12,31 +12,32 @@
 
 namespace Kernel {
 
-UNMAP_AFTER_INIT ErrorOr<NonnullRefPtr<NVMeNameSpace>> NVMeNameSpace::create(NVMeController const& controller, Vector<NonnullLockRefPtr<NVMeQueue>> queues, u16 nsid, size_t storage_size, size_t lba_size)
+UNMAP_AFTER_INIT ErrorOr<NonnullRefPtr<NVMeNameSpace>> NVMeNameSpace::create(NVMeController const& controller, Vector<NonnullLockRefPtr<NVMeQueue>> queues, u16 nsid, size_t storage_size, size_t lba_size, size_t max_transfer_size)
 {
-    auto device = TRY(Device::try_create_device<NVMeNameSpace>(StorageDevice::LUNAddress { controller.controller_id(), nsid, 0 }, controller.hardware_relative_controller_id(), move(queues), storage_size, lba_size, nsid));
+    auto device = TRY(Device::try_create_device<NVMeNameSpace>(StorageDevice::LUNAddress { controller.controller_id(), nsid, 0 }, controller.hardware_relative_controller_id(), move(queues), storage_size, lba_size, nsid, max_transfer_size));
     return device;
 }
 
-UNMAP_AFTER_INIT NVMeNameSpace::NVMeNameSpace(LUNAddress logical_unit_number_address, u32 hardware_relative_controller_id, Vector<NonnullLockRefPtr<NVMeQueue>> queues, size_t max_addresable_block, size_t lba_size, u16 nsid)
+UNMAP_AFTER_INIT NVMeNameSpace::NVMeNameSpace(LUNAddress logical_unit_number_address, u32 hardware_relative_controller_id, Vector<NonnullLockRefPtr<NVMeQueue>> queues, size_t max_addresable_block, size_t lba_size, u16 nsid, size_t max_transfer_size)
     : StorageDevice(logical_unit_number_address, hardware_relative_controller_id, lba_size, max_addresable_block)
     , m_nsid(nsid)
+    , m_max_transfer_size(max_transfer_size)
     , m_queues(move(queues))
 {
 }
 
 void NVMeNameSpace::start_request(AsyncBlockDeviceRequest& request)
 {
-    auto index = Processor::current_id();
-    auto& queue = m_queues.at(index);
-    // TODO: For now we support only IO transfers of size PAGE_SIZE (Going along with the current constraint in the block layer)
-    // Eventually remove this constraint by using the PRP2 field in the submission struct and remove block layer constraint for NVMe driver.
-    VERIFY(request.block_count() <= (PAGE_SIZE / block_size()));
+    // The block layer never hands us more than a single command can transfer, even after merging requests.
+    VERIFY(request.total_block_count() <= max_merged_request_block_count());
 
-    if (request.request_type() == AsyncBlockDeviceRequest::Read) {
-        queue->read(request, m_nsid, request.block_index(), request.block_count());
-    } else {
-        queue->write(request, m_nsid, request.block_index(), request.block_count());
+    // Prefer the queue of the current processor, so the completion is handled by it as well, but rather use
+    // another queue than waiting for one of its commands to complete.
+    auto preferred_queue_index = Processor::current_id() % m_queues.size();
+    for (size_t i = 0; i < m_queues.size(); ++i) {
+        if (m_queues[(preferred_queue_index + i) % m_queues.size()]->try_submit_request(request, m_nsid))
+            return;
     }
+    m_queues[preferred_queue_index]->submit_request(request, m_nsid);
 }
 }
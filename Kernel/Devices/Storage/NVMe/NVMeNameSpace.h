@@ -23,15 +23,19 @@ class NVMeNameSpace : public StorageDevice {
     friend class Device;
 
 public:
-    static ErrorOr<NonnullRefPtr<NVMeNameSpace>> create(NVMeController const&, Vector<NonnullLockRefPtr<NVMeQueue>> queues, u16 nsid, size_t storage_size, size_t lba_size);
+    static ErrorOr<NonnullRefPtr<NVMeNameSpace>> create(NVMeController const&, Vector<NonnullLockRefPtr<NVMeQueue>> queues, u16 nsid, size_t storage_size, size_t lba_size, size_t max_transfer_size);
 
     CommandSet command_set() const override { return CommandSet::NVMe; }
     void start_request(AsyncBlockDeviceRequest& request) override;
 
+    virtual size_t max_requests_in_flight() const override { return m_queues.size() * IO_QUEUE_COMMAND_SLOTS; }
+    virtual u32 max_merged_request_block_count() const override { return m_max_transfer_size / block_size(); }
+
 private:
-    NVMeNameSpace(LUNAddress, u32 hardware_relative_controller_id, Vector<NonnullLockRefPtr<NVMeQueue>> queues, size_t storage_size, size_t lba_size, u16 nsid);
+    NVMeNameSpace(LUNAddress, u32 hardware_relative_controller_id, Vector<NonnullLockRefPtr<NVMeQueue>> queues, size_t storage_size, size_t lba_size, u16 nsid, size_t max_transfer_size);
 
     u16 m_nsid;
+    size_t m_max_transfer_size { 0 };
     Vector<NonnullLockRefPtr<NVMeQueue>> m_queues;
 };
 
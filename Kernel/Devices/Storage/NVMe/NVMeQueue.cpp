@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <Kernel/Arch/Delay.h>
 #include <Kernel/Arch/MemoryFences.h>
 #include <Kernel/Devices/Storage/NVMe/NVMeController.h>
@@ -11,37 +12,30 @@
 #include <Kernel/Devices/Storage/NVMe/NVMePollQueue.h>
 #include <Kernel/Devices/Storage/NVMe/NVMeQueue.h>
 #include <Kernel/Library/StdLib.h>
+#include <Kernel/Tasks/WorkQueue.h>
 
 namespace Kernel {
-ErrorOr<NonnullLockRefPtr<NVMeQueue>> NVMeQueue::try_create(NVMeController& device, u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs, QueueType queue_type)
+ErrorOr<NonnullLockRefPtr<NVMeQueue>> NVMeQueue::try_create(NVMeController& device, u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs, QueueType queue_type, size_t max_transfer_pages)
 {
-    // Note: Allocate DMA region for RW operation. For now the requests don't exceed more than 4096 bytes (Storage device takes care of it)
-    RefPtr<Memory::PhysicalRAMPage> rw_dma_page;
-    // FIXME: Synchronize DMA buffer accesses correctly and set the MemoryType to NonCacheable.
-    auto rw_dma_region = TRY(MM.allocate_dma_buffer_page("NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_page, Memory::MemoryType::IO));
-
-    if (rw_dma_page.is_null())
-        return ENOMEM;
-
-    if (queue_type == QueueType::Polled) {
-        auto queue = NVMePollQueue::try_create(move(rw_dma_region), rw_dma_page.release_nonnull(), qid, q_depth, move(cq_dma_region), move(sq_dma_region), move(db_regs));
-        return queue;
-    }
-
-    auto queue = NVMeInterruptQueue::try_create(device, move(rw_dma_region), rw_dma_page.release_nonnull(), qid, irq.release_value(), q_depth, move(cq_dma_region), move(sq_dma_region), move(db_regs));
-    return queue;
+    LockRefPtr<NVMeQueue> queue;
+    if (queue_type == QueueType::Polled)
+        queue = TRY(NVMePollQueue::try_create(qid, q_depth, move(cq_dma_region), move(sq_dma_region), move(db_regs)));
+    else
+        queue = TRY(NVMeInterruptQueue::try_create(device, qid, irq.release_value(), q_depth, move(cq_dma_region), move(sq_dma_region), move(db_regs)));
+
+    // The admin queue only ever transfers data through buffers that are passed along with its commands.
+    if (qid != 0)
+        TRY(queue->create_io_slots(max_transfer_pages));
+    return queue.release_nonnull();
 }
 
-UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalRAMPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs)
-    : m_rw_dma_region(move(rw_dma_region))
-    , m_qid(qid)
+UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs)
+    : m_qid(qid)
     , m_admin_queue(qid == 0)
     , m_qdepth(q_depth)
     , m_cq_dma_region(move(cq_dma_region))
     , m_sq_dma_region(move(sq_dma_region))
     , m_db_regs(move(db_regs))
-    , m_rw_dma_page(rw_dma_page)
-
 {
     m_requests.with([q_depth](auto& requests) {
         requests.try_ensure_capacity(q_depth).release_value_but_fixme_should_propagate_errors();
@@ -50,6 +44,39 @@ UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_regio
     m_cqe_array = { reinterpret_cast<NVMeCompletion*>(m_cq_dma_region->vaddr().as_ptr()), m_qdepth };
 }
 
+UNMAP_AFTER_INIT ErrorOr<void> NVMeQueue::create_io_slots(size_t pages_per_slot)
+{
+    static_assert(IO_QUEUE_COMMAND_SLOTS < sizeof(IOSlotState::free_slots) * 8);
+    static_assert(IO_QUEUE_COMMAND_SLOTS < IO_QUEUE_SIZE);
+    static_assert(IO_QUEUE_COMMAND_SLOTS * IO_COMMAND_MAX_PAGES * sizeof(u64) <= PAGE_SIZE);
+    VERIFY(pages_per_slot > 0 && pages_per_slot <= IO_COMMAND_MAX_PAGES);
+
+    RefPtr<Memory::PhysicalRAMPage> prp_list_page;
+    // FIXME: Synchronize DMA buffer accesses correctly and set the MemoryType to NonCacheable.
+    m_prp_list_region = TRY(MM.allocate_dma_buffer_page("NVMe Queue PRP lists"sv, Memory::Region::Access::ReadWrite, prp_list_page, Memory::MemoryType::IO));
+    auto* prp_lists = reinterpret_cast<LittleEndian<u64>*>(m_prp_list_region->vaddr().as_ptr());
+
+    TRY(m_io_slots.try_ensure_capacity(IO_QUEUE_COMMAND_SLOTS));
+    for (size_t slot = 0; slot < IO_QUEUE_COMMAND_SLOTS; ++slot) {
+        // The controller is told about every page separately, so the buffer doesn't have to be physically contiguous.
+        Vector<NonnullRefPtr<Memory::PhysicalRAMPage>> pages;
+        TRY(pages.try_ensure_capacity(pages_per_slot));
+        for (size_t page = 0; page < pages_per_slot; ++page)
+            pages.unchecked_append(TRY(MM.allocate_physical_page()));
+        auto buffer = TRY(Memory::ScatterGatherList::try_create(pages.span(), "NVMe Queue Read/Write DMA"sv));
+
+        auto prp_list_offset = slot * IO_COMMAND_MAX_PAGES;
+        for (size_t page = 1; page < pages_per_slot; ++page)
+            prp_lists[prp_list_offset + page - 1] = pages[page]->paddr().get();
+        m_io_slots.unchecked_append({ move(buffer), prp_list_page->paddr().offset(prp_list_offset * sizeof(u64)) });
+    }
+
+    m_io_slot_state.with([](auto& state) {
+        state.free_slots = (1u << IO_QUEUE_COMMAND_SLOTS) - 1;
+    });
+    return {};
+}
+
 bool NVMeQueue::cqe_available()
 {
     return PHASE_TAG(m_cqe_array[m_cq_head].status) == m_cq_valid_phase;
@@ -74,16 +101,18 @@ u32 NVMeQueue::process_cq()
         while (cqe_available()) {
             u16 status;
             u16 cmdid;
+            u32 result;
             ++nr_of_processed_cqes;
             status = CQ_STATUS_FIELD(m_cqe_array[m_cq_head].status);
             cmdid = m_cqe_array[m_cq_head].command_id;
+            result = m_cqe_array[m_cq_head].cmd_spec;
             dbgln_if(NVME_DEBUG, "NVMe: Completion with status {:x} and command identifier {}. CQ_HEAD: {}", status, cmdid, m_cq_head);
 
             if (!requests.contains(cmdid)) {
                 dmesgln("Bogus cmd id: {}", cmdid);
                 VERIFY_NOT_REACHED();
             }
-            complete_current_request_impl(cmdid, status, requests);
+            complete_current_request_impl(cmdid, status, result, requests);
             update_cqe_head();
         }
     });
@@ -110,17 +139,20 @@ void NVMeQueue::submit_sqe(NVMeSubmission& sub)
     update_sq_doorbell();
 }
 
-void NVMeQueue::complete_current_request_impl(u16 cmdid, u16 status, HashMap<u16, NVMeIO>& requests)
+void NVMeQueue::complete_current_request_impl(u16 cmdid, u16 status, u32 result, HashMap<u16, NVMeIO>& requests)
 {
     auto& request_pdu = requests.get(cmdid).release_value();
     auto current_request = request_pdu.request;
     AsyncDeviceRequest::RequestResult req_result = AsyncDeviceRequest::Success;
 
-    ScopeGuard guard = [&req_result, status, &request_pdu] {
-        if (request_pdu.request)
+    ScopeGuard guard = [this, cmdid, &req_result, status, result, &request_pdu] {
+        if (request_pdu.request) {
+            // The data has been copied out of the slot already, so the next request may use it right away.
+            release_io_slot(cmdid);
             request_pdu.request->complete(req_result);
+        }
         if (request_pdu.end_io_handler)
-            request_pdu.end_io_handler(status);
+            request_pdu.end_io_handler(status, result);
         request_pdu.clear();
     };
 
@@ -135,29 +167,31 @@ void NVMeQueue::complete_current_request_impl(u16 cmdid, u16 status, HashMap<u16
     }
 
     if (current_request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
-        if (auto result = current_request->write_to_buffer(current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), current_request->buffer_size()); result.is_error()) {
+        auto* data = m_io_slots[cmdid].buffer->dma_region().as_ptr();
+        auto copy_result = current_request->for_each_request_in_transfer([data](AsyncBlockDeviceRequest& request, size_t offset) {
+            return request.write_to_buffer(request.buffer(), data + offset, request.buffer_size());
+        });
+        if (copy_result.is_error()) {
             req_result = AsyncBlockDeviceRequest::MemoryFault;
             return;
         }
     }
 }
 
-void NVMeQueue::complete_current_request(u16 cmdid, u16 status)
-{
-    m_requests.with([this, cmdid, status](auto& requests) {
-        complete_current_request_impl(cmdid, status, requests);
-    });
-}
-
-u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
+u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub, u32* result)
 {
     // For now let's use sq tail as a unique command id.
     u16 cmd_status;
     u16 cid = get_request_cid();
     sub.cmdid = cid;
 
-    m_requests.with([this, &sub, &cmd_status](auto& requests) {
-        requests.set(sub.cmdid, { nullptr, [this, &cmd_status](u16 status) mutable { cmd_status = status; m_sync_wait_queue.wake_all(); } });
+    m_requests.with([this, &sub, &cmd_status, result](auto& requests) {
+        requests.set(sub.cmdid, { nullptr, [this, &cmd_status, result](u16 status, u32 command_result) mutable {
+                                     cmd_status = status;
+                                     if (result)
+                                         *result = command_result;
+                                     m_sync_wait_queue.wake_all();
+                                 } });
     });
     submit_sqe(sub);
 
@@ -167,46 +201,123 @@ u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
     return cmd_status;
 }
 
-void NVMeQueue::read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+Optional<u16> NVMeQueue::take_free_io_slot(IOSlotState& state)
 {
-    NVMeSubmission sub {};
-    sub.op = OP_NVME_READ;
-    sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
-    // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
-    sub.cmdid = get_request_cid();
+    if (state.free_slots == 0)
+        return {};
+    u16 slot = bit_scan_forward(state.free_slots) - 1;
+    state.free_slots &= ~(1u << slot);
+    return slot;
+}
 
-    m_requests.with([&sub, &request](auto& requests) {
-        requests.set(sub.cmdid, { request, nullptr });
+void NVMeQueue::release_io_slot(u16 slot)
+{
+    bool should_submit_waiting_requests = m_io_slot_state.with([slot](auto& state) {
+        VERIFY(!(state.free_slots & (1u << slot)));
+        state.free_slots |= 1u << slot;
+        if (state.waiting_requests.is_empty() || state.is_submitting_waiting_requests)
+            return false;
+        state.is_submitting_waiting_requests = true;
+        return true;
     });
+    if (!should_submit_waiting_requests)
+        return;
 
-    full_memory_fence();
-    submit_sqe(sub);
+    // We are usually called from the interrupt handler, with the lock of our requests held.
+    auto result = g_io_work->try_queue([this] {
+        submit_waiting_requests();
+    });
+    if (result.is_error()) {
+        // The next command that completes will try again.
+        dmesgln("NVMe: Unable to submit requests waiting for queue {}: {}", m_qid, result.error());
+        m_io_slot_state.with([](auto& state) {
+            state.is_submitting_waiting_requests = false;
+        });
+    }
 }
 
-void NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+void NVMeQueue::submit_waiting_requests()
 {
-    NVMeSubmission sub {};
+    for (;;) {
+        Optional<WaitingRequest> waiting_request;
+        auto slot = m_io_slot_state.with([&waiting_request](auto& state) -> Optional<u16> {
+            if (state.waiting_requests.is_empty() || state.free_slots == 0) {
+                state.is_submitting_waiting_requests = false;
+                return {};
+            }
+            waiting_request = state.waiting_requests.take_first();
+            return take_free_io_slot(state);
+        });
+        if (!slot.has_value())
+            return;
+        submit_request_in_slot(*waiting_request->request, waiting_request->nsid, slot.value());
+    }
+}
 
-    sub.op = OP_NVME_WRITE;
+bool NVMeQueue::try_submit_request(AsyncBlockDeviceRequest& request, u16 nsid)
+{
+    auto slot = m_io_slot_state.with([](auto& state) {
+        return take_free_io_slot(state);
+    });
+    if (!slot.has_value())
+        return false;
+    submit_request_in_slot(request, nsid, slot.value());
+    return true;
+}
+
+void NVMeQueue::submit_request(AsyncBlockDeviceRequest& request, u16 nsid)
+{
+    auto slot = m_io_slot_state.with([&request, nsid](auto& state) -> ErrorOr<Optional<u16>> {
+        if (auto slot = take_free_io_slot(state); slot.has_value())
+            return slot;
+        TRY(state.waiting_requests.try_append({ request, nsid }));
+        return Optional<u16> {};
+    });
+    if (slot.is_error()) {
+        request.complete(AsyncDeviceRequest::Failure);
+        return;
+    }
+    if (slot.value().has_value())
+        submit_request_in_slot(request, nsid, slot.value().value());
+}
+
+void NVMeQueue::submit_request_in_slot(AsyncBlockDeviceRequest& request, u16 nsid, u16 slot)
+{
+    auto& io_slot = m_io_slots[slot];
+    size_t transfer_size = request.total_block_count() * request.block_size();
+    size_t page_count = ceil_div(transfer_size, static_cast<size_t>(PAGE_SIZE));
+    VERIFY(page_count <= io_slot.buffer->scatters_count());
+
+    if (request.request_type() == AsyncBlockDeviceRequest::Write) {
+        auto* data = io_slot.buffer->dma_region().as_ptr();
+        auto copy_result = request.for_each_request_in_transfer([data](AsyncBlockDeviceRequest& request, size_t offset) {
+            return request.read_from_buffer(request.buffer(), data + offset, request.buffer_size());
+        });
+        if (copy_result.is_error()) {
+            release_io_slot(slot);
+            request.complete(AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+    }
+
+    NVMeSubmission sub {};
+    sub.op = request.request_type() == AsyncBlockDeviceRequest::Read ? OP_NVME_READ : OP_NVME_WRITE;
     sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
+    sub.rw.slba = AK::convert_between_host_and_little_endian(request.block_index());
     // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
-    sub.cmdid = get_request_cid();
+    sub.rw.length = AK::convert_between_host_and_little_endian((request.total_block_count() - 1) & 0xFFFF);
+    auto pages = io_slot.buffer->vmobject().physical_pages();
+    sub.rw.data_ptr.prp1 = pages[0]->paddr().get();
+    if (page_count == 2)
+        sub.rw.data_ptr.prp2 = pages[1]->paddr().get();
+    else if (page_count > 2)
+        sub.rw.data_ptr.prp2 = io_slot.prp_list.get();
+    sub.cmdid = slot;
 
     m_requests.with([&sub, &request](auto& requests) {
         requests.set(sub.cmdid, { request, nullptr });
     });
 
-    if (auto result = request.read_from_buffer(request.buffer(), m_rw_dma_region->vaddr().as_ptr(), request.buffer_size()); result.is_error()) {
-        complete_current_request(sub.cmdid, AsyncDeviceRequest::MemoryFault);
-        return;
-    }
-
     full_memory_fence();
     submit_sqe(sub);
 }
@@ -17,7 +17,9 @@
 #include <Kernel/Library/LockRefPtr.h>
 #include <Kernel/Library/NonnullLockRefPtr.h>
 #include <Kernel/Locking/Spinlock.h>
+#include <Kernel/Locking/SpinlockProtected.h>
 #include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Memory/ScatterGatherList.h>
 #include <Kernel/Memory/TypedMapping.h>
 #include <Kernel/Tasks/DeprecatedWaitQueue.h>
 
@@ -48,17 +50,26 @@ struct NVMeIO {
         end_io_handler = nullptr;
     }
     RefPtr<AsyncBlockDeviceRequest> request;
-    Function<void(u16 status)> end_io_handler;
+    Function<void(u16 status, u32 result)> end_io_handler;
+};
+
+// Every IO command in flight owns one of these, which holds the data of the command's transfer.
+struct NVMeIOSlot {
+    NonnullLockRefPtr<Memory::ScatterGatherList> buffer;
+    // Lists all pages of the buffer after the first one, for transfers that don't fit into PRP1 and PRP2.
+    PhysicalAddress prp_list;
 };
 
 class NVMeController;
 class NVMeQueue : public AtomicRefCounted<NVMeQueue> {
 public:
-    static ErrorOr<NonnullLockRefPtr<NVMeQueue>> try_create(NVMeController& device, u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs, QueueType queue_type);
+    static ErrorOr<NonnullLockRefPtr<NVMeQueue>> try_create(NVMeController& device, u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs, QueueType queue_type, size_t max_transfer_pages = 0);
     bool is_admin_queue() { return m_admin_queue; }
-    u16 submit_sync_sqe(NVMeSubmission&);
-    void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
-    void write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
+    u16 submit_sync_sqe(NVMeSubmission&, u32* result = nullptr);
+    // Returns false without submitting anything if all command slots of this queue are in use.
+    bool try_submit_request(AsyncBlockDeviceRequest& request, u16 nsid);
+    // Waits for a free command slot if all of them are in use.
+    void submit_request(AsyncBlockDeviceRequest& request, u16 nsid);
     virtual void submit_sqe(NVMeSubmission&);
     virtual ~NVMeQueue();
 
@@ -85,7 +96,7 @@ protected:
             m_db_regs.mmio_reg->sq_tail = m_sq_tail;
     }
 
-    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalRAMPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs);
+    NVMeQueue(u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, OwnPtr<Memory::Region> sq_dma_region, Doorbell db_regs);
 
     [[nodiscard]] u32 get_request_cid()
     {
@@ -100,10 +111,25 @@ protected:
         }
     }
 
-    virtual void complete_current_request(u16 cmdid, u16 status);
-
 private:
-    void complete_current_request_impl(u16 cmdid, u16 status, HashMap<u16, NVMeIO>& requests);
+    struct WaitingRequest {
+        NonnullRefPtr<AsyncBlockDeviceRequest> request;
+        u16 nsid;
+    };
+
+    struct IOSlotState {
+        u32 free_slots { 0 };
+        Vector<WaitingRequest> waiting_requests;
+        bool is_submitting_waiting_requests { false };
+    };
+
+    ErrorOr<void> create_io_slots(size_t pages_per_slot);
+    static Optional<u16> take_free_io_slot(IOSlotState&);
+    void release_io_slot(u16 slot);
+    void submit_request_in_slot(AsyncBlockDeviceRequest&, u16 nsid, u16 slot);
+    void submit_waiting_requests();
+
+    void complete_current_request_impl(u16 cmdid, u16 status, u32 result, HashMap<u16, NVMeIO>& requests);
     bool cqe_available();
     void update_cqe_head();
     void update_cq_doorbell()
@@ -116,7 +142,6 @@ private:
 
 protected:
     SpinlockProtected<HashMap<u16, NVMeIO>, LockRank::None> m_requests;
-    NonnullOwnPtr<Memory::Region> m_rw_dma_region;
 
 private:
     u16 m_qid {};
@@ -133,6 +158,10 @@ private:
     Span<NVMeCompletion> m_cqe_array;
     DeprecatedWaitQueue m_sync_wait_queue;
     Doorbell m_db_regs;
-    NonnullRefPtr<Memory::PhysicalRAMPage const> const m_rw_dma_page;
+
+    // IO commands use their slot as the command identifier, so only the admin queue allocates them with get_request_cid().
+    Vector<NVMeIOSlot> m_io_slots;
+    OwnPtr<Memory::Region> m_prp_list_region;
+    SpinlockProtected<IOSlotState, LockRank::None> m_io_slot_state {};
 };
 }
@@ -24,7 +24,6 @@ StorageDevice::StorageDevice(LUNAddress logical_unit_number_address, u32 hardwar
     , m_logical_unit_number_address(logical_unit_number_address)
     , m_hardware_relative_controller_id(hardware_relative_controller_id)
     , m_max_addressable_block(max_addressable_block)
-    , m_blocks_per_page(PAGE_SIZE / block_size())
 {
 }
 
@@ -88,8 +87,9 @@ ErrorOr<size_t> StorageDevice::read(OpenFileDescription&, u64 offset, UserOrKern
 
     // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
     // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= m_blocks_per_page) {
-        whole_blocks = m_blocks_per_page;
+    // Devices that take merged requests can take requests of that size to begin with though.
+    if (whole_blocks >= max_request_block_count()) {
+        whole_blocks = max_request_block_count();
         remaining = 0;
     }
 
@@ -153,8 +153,9 @@ ErrorOr<size_t> StorageDevice::write(OpenFileDescription&, u64 offset, UserOrKer
 
     // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
     // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= m_blocks_per_page) {
-        whole_blocks = m_blocks_per_page;
+    // Devices that take merged requests can take requests of that size to begin with though.
+    if (whole_blocks >= max_request_block_count()) {
+        whole_blocks = max_request_block_count();
         remaining = 0;
     }
 
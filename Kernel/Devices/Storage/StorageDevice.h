@@ -65,6 +65,7 @@ public:
     virtual bool can_read(OpenFileDescription const&, u64) const override { return true; }
     virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override;
     virtual bool can_write(OpenFileDescription const&, u64) const override { return true; }
+    virtual Optional<u64> addressable_block_count() const override { return max_mathematical_addressable_block(); }
     virtual void prepare_for_unplug() { m_partitions.clear(); }
 
     Vector<NonnullRefPtr<StorageDevicePartition>> const& partitions() const { return m_partitions; }
@@ -107,7 +108,6 @@ private:
     u32 const m_hardware_relative_controller_id { 0 };
 
     u64 const m_max_addressable_block { 0 };
-    size_t const m_blocks_per_page { 0 };
 };
 
 }
@@ -32,6 +32,7 @@ public:
     // we can return true here too.
     virtual bool can_read(OpenFileDescription const&, u64) const override { return true; }
     virtual bool can_write(OpenFileDescription const&, u64) const override { return true; }
+    virtual Optional<u64> addressable_block_count() const override { return m_metadata.end_block() - m_metadata.start_block() + 1; }
 
     Partition::DiskPartitionMetadata const& metadata() const;
 
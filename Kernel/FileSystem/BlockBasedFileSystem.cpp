@@ -4,113 +4,262 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Tasks/Process.h>
+#include <Kernel/Tasks/WorkQueue.h>
 
 namespace Kernel {
 
+// Consecutive dirty blocks are written back to the device in runs of at most this size.
+static constexpr size_t max_write_back_run_size = 64 * KiB;
+
+// Read-ahead reads consecutive blocks from the device in runs of at most this size.
+static constexpr size_t max_read_ahead_run_size = 128 * KiB;
+
 struct CacheEntry {
-    IntrusiveListNode<CacheEntry> list_node;
     BlockBasedFileSystem::BlockIndex block_index { 0 };
     u8* data { nullptr };
+    bool is_in_use { false };
     bool has_data { false };
+    bool is_dirty { false };
+    // Set whenever the entry is accessed, and cleared by the clock hand passing by.
+    // Only entries that haven't been accessed since the clock hand last passed them are evicted.
+    bool was_referenced { false };
 };
 
-class DiskCache {
+static bool has_plenty_of_free_memory()
+{
+    auto memory_info = MM.get_system_memory_info();
+    return memory_info.physical_pages_uncommitted > memory_info.physical_pages / 4;
+}
+
+static bool is_low_on_free_memory()
+{
+    auto memory_info = MM.get_system_memory_info();
+    return memory_info.physical_pages_uncommitted < memory_info.physical_pages / 8;
+}
+
+// The cache is split into shards, each of which holds the blocks whose index maps to it, and has its own lock.
+// A shard starts out with a single chunk of entries and grows by another chunk whenever it runs full, as long as
+// the cache is below its capacity and the system has plenty of free memory. Otherwise, entries are evicted using
+// the CLOCK algorithm.
+class DiskCacheShard {
+    AK_MAKE_NONCOPYABLE(DiskCacheShard);
+    AK_MAKE_NONMOVABLE(DiskCacheShard);
+
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
+    static constexpr size_t ChunkSize = 256 * KiB;
+
+    DiskCacheShard() = default;
+
+    ErrorOr<void> initialize(size_t block_size, size_t max_entry_count)
     {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * fs.logical_block_size();
-            m_clean_list.append(entries()[i]);
-        }
+        VERIFY(block_size <= ChunkSize);
+        m_block_size = block_size;
+        m_max_entry_count = max(max_entry_count, entries_per_chunk());
+        return grow();
     }
 
-    ~DiskCache() = default;
+    Mutex& lock() const { return m_lock; }
 
-    bool is_dirty() const { return !m_dirty_list.is_empty(); }
-    bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
+    bool is_dirty() const { return m_dirty_entry_count > 0; }
 
-    void mark_all_clean()
+    CacheEntry* find(BlockBasedFileSystem::BlockIndex block_index)
     {
-        while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
+        VERIFY(m_lock.is_exclusively_locked_by_current_thread());
+        auto it = m_hash.find(block_index);
+        if (it == m_hash.end())
+            return nullptr;
+        auto& entry = m_entries[it->value];
+        VERIFY(entry.block_index == block_index);
+        return &entry;
+    }
+
+    CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index)
+    {
+        auto* entry = find(block_index);
+        if (entry)
+            entry->was_referenced = true;
+        return entry;
+    }
+
+    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index, BlockBasedFileSystem& fs)
+    {
+        if (auto* entry = get(block_index))
+            return entry;
+
+        auto& new_entry = m_entries[TRY(take_entry(fs))];
+        TRY(m_hash.try_set(block_index, &new_entry - m_entries.data()));
+
+        new_entry.block_index = block_index;
+        new_entry.is_in_use = true;
+        ++m_in_use_entry_count;
+        new_entry.has_data = false;
+        new_entry.was_referenced = true;
+        return &new_entry;
     }
 
     void mark_dirty(CacheEntry& entry)
     {
-        m_dirty_list.prepend(entry);
+        if (!entry.is_dirty)
+            ++m_dirty_entry_count;
+        entry.is_dirty = true;
     }
 
     void mark_clean(CacheEntry& entry)
     {
-        m_clean_list.prepend(entry);
+        if (entry.is_dirty)
+            --m_dirty_entry_count;
+        entry.is_dirty = false;
     }
 
-    CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index) const
+    // Appends all dirty entries to the given list. They stay dirty until they have actually been written back.
+    ErrorOr<void> append_dirty_entries(Vector<CacheEntry*>& entries)
     {
-        auto it = m_hash.find(block_index);
-        if (it == m_hash.end())
-            return nullptr;
-        auto& entry = const_cast<CacheEntry&>(*it->value);
-        VERIFY(entry.block_index == block_index);
-        if (!entry_is_dirty(entry) && (m_clean_list.first() != &entry)) {
-            // Cache hit! Promote the entry to the front of the list.
-            m_clean_list.prepend(entry);
+        VERIFY(m_lock.is_exclusively_locked_by_current_thread());
+        if (!is_dirty())
+            return {};
+        TRY(entries.try_ensure_capacity(entries.size() + m_dirty_entry_count));
+        for_each_dirty_entry([&](CacheEntry& entry) { entries.unchecked_append(&entry); });
+        return {};
+    }
+
+    template<typename Callback>
+    void for_each_dirty_entry(Callback callback)
+    {
+        for (auto& entry : m_entries) {
+            if (entry.is_dirty)
+                callback(entry);
         }
-        return &entry;
     }
 
-    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index, BlockBasedFileSystem& fs) const
+    // Gives the last chunk of entries back to the system, unless it is the only one left.
+    void shrink(BlockBasedFileSystem& fs)
     {
-        if (auto* entry = get(block_index))
-            return entry;
+        VERIFY(m_lock.is_exclusively_locked_by_current_thread());
+        if (m_chunks.size() <= 1)
+            return;
+
+        (void)fs.write_back_dirty_entries(*this);
 
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            fs.flush_writes_impl();
-            return ensure(block_index, fs);
+        // Blocks that couldn't be written back must not be lost, so keep the chunk around until they have been.
+        auto first_removed_index = m_entries.size() - entries_per_chunk();
+        for (size_t i = first_removed_index; i < m_entries.size(); ++i) {
+            if (m_entries[i].is_dirty)
+                return;
         }
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+        for (size_t i = first_removed_index; i < m_entries.size(); ++i) {
+            auto& entry = m_entries[i];
+            if (entry.is_in_use) {
+                m_hash.remove(entry.block_index);
+                --m_in_use_entry_count;
+            }
+        }
+        m_entries.shrink(first_removed_index);
+        (void)m_chunks.take_last();
+        m_clock_hand %= m_entries.size();
+    }
 
-        m_hash.remove(new_entry.block_index);
-        TRY(m_hash.try_set(block_index, &new_entry));
+private:
+    size_t entries_per_chunk() const { return ChunkSize / m_block_size; }
 
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
+    ErrorOr<void> grow()
+    {
+        if (m_entries.size() + entries_per_chunk() > m_max_entry_count)
+            return ENOMEM;
+
+        auto chunk = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, ChunkSize, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow));
+        TRY(m_entries.try_ensure_capacity(m_entries.size() + entries_per_chunk()));
+        TRY(m_chunks.try_append(move(chunk)));
+
+        // Hand out the new entries first.
+        m_clock_hand = m_entries.size();
+        auto* data = m_chunks.last()->data();
+        for (size_t i = 0; i < entries_per_chunk(); ++i)
+            m_entries.unchecked_append({ .data = data + i * m_block_size });
+        return {};
+    }
 
-        return &new_entry;
+    ErrorOr<size_t> take_entry(BlockBasedFileSystem& fs)
+    {
+        VERIFY(m_lock.is_exclusively_locked_by_current_thread());
+        // Rather than evicting anything, grow while the system can spare the memory.
+        // If we can't grow, we'll just have to evict something instead.
+        if (m_in_use_entry_count == m_entries.size() && has_plenty_of_free_memory())
+            (void)grow();
+
+        // Every entry is visited at most twice: The first visit clears its referenced bit, the second one evicts it.
+        for (size_t i = 0; i < 2 * m_entries.size(); ++i) {
+            auto index = m_clock_hand;
+            m_clock_hand = (m_clock_hand + 1) % m_entries.size();
+
+            auto& entry = m_entries[index];
+            if (!entry.is_in_use)
+                return index;
+            if (entry.is_dirty)
+                continue;
+            if (entry.was_referenced) {
+                entry.was_referenced = false;
+                continue;
+            }
+            m_hash.remove(entry.block_index);
+            entry.is_in_use = false;
+            --m_in_use_entry_count;
+            return index;
+        }
+
+        // Not a single clean entry! Write back this shard's dirty entries and try again.
+        // NOTE: Other shards are left alone, as locking them here could deadlock with a concurrent flush.
+        if (fs.write_back_dirty_entries(*this) == 0)
+            return EIO;
+        return take_entry(fs);
     }
 
-    CacheEntry const* entries() const { return (CacheEntry const*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
+    mutable Mutex m_lock { "DiskCacheShard"sv };
+    size_t m_block_size { 0 };
+    size_t m_max_entry_count { 0 };
+    size_t m_in_use_entry_count { 0 };
+    size_t m_dirty_entry_count { 0 };
+    size_t m_clock_hand { 0 };
+    Vector<NonnullOwnPtr<KBuffer>> m_chunks;
+    Vector<CacheEntry> m_entries;
+    HashMap<BlockBasedFileSystem::BlockIndex, size_t> m_hash;
+};
+
+class DiskCache {
+public:
+    static constexpr size_t ShardCount = 16;
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(size_t block_size)
+    {
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache));
+
+        // Much like a page cache, each file system may use a good part of physical memory to cache its blocks.
+        // Shards only grow as they are needed, and stop growing when the system is running short on free memory.
+        auto capacity = MM.get_system_memory_info().physical_pages * PAGE_SIZE / 8;
+        auto max_entry_count_per_shard = capacity / block_size / ShardCount;
+        for (auto& shard : cache->m_shards)
+            TRY(shard.initialize(block_size, max_entry_count_per_shard));
+        return cache;
+    }
+
+    DiskCacheShard& shard_for(BlockBasedFileSystem::BlockIndex block_index) { return m_shards[block_index.value() % ShardCount]; }
 
     template<typename Callback>
-    void for_each_dirty_entry(Callback callback)
+    void for_each_shard(Callback callback)
     {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
+        for (auto& shard : m_shards)
+            callback(shard);
     }
 
 private:
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-
-    // NOTE: m_entries must be declared before m_dirty_list and m_clean_list because their entries are allocated from it.
-    // We need to ensure that the destructors of m_dirty_list and m_clean_list are called before m_entries is destroyed.
-    NonnullOwnPtr<KBuffer> m_entries;
-    mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
-    mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
+    DiskCache() = default;
+
+    Array<DiskCacheShard, ShardCount> m_shards;
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -126,13 +275,33 @@ ErrorOr<void> BlockBasedFileSystem::initialize_while_locked()
     VERIFY(m_lock.is_locked());
     VERIFY(!is_initialized_while_locked());
     VERIFY(logical_block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, DiskCache::EntryCount * logical_block_size(), Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow));
-    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, DiskCache::EntryCount * sizeof(CacheEntry), Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
+    m_cache = TRY(DiskCache::try_create(logical_block_size()));
+    return {};
+}
 
-    m_cache.with_exclusive([&](auto& cache) {
-        cache = move(disk_cache);
-    });
+ErrorOr<void> BlockBasedFileSystem::read_from_device(u64 offset, UserOrKernelBuffer& buffer, size_t count) const
+{
+    // NOTE: Devices may transfer less than we asked for, so keep going until we have everything.
+    size_t nread = 0;
+    while (nread < count) {
+        auto buffer_offset = buffer.offset(nread);
+        auto result = TRY(file_description().read(buffer_offset, offset + nread, count - nread));
+        if (result == 0)
+            return EIO;
+        nread += result;
+    }
+    return {};
+}
+
+ErrorOr<void> BlockBasedFileSystem::write_to_device(u64 offset, UserOrKernelBuffer const& buffer, size_t count)
+{
+    size_t nwritten = 0;
+    while (nwritten < count) {
+        auto result = TRY(file_description().write(offset + nwritten, buffer.offset(nwritten), count - nwritten));
+        if (result == 0)
+            return EIO;
+        nwritten += result;
+    }
     return {};
 }
 
@@ -149,26 +318,26 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, UserOrKernelBu
 
     TRY(data.read(buffered_data.bytes()));
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
-        if (!allow_cache) {
-            flush_specific_block_if_needed(index);
-            u64 base_offset = index.value() * logical_block_size() + offset;
-            auto nwritten = TRY(file_description().write(base_offset, data, count));
-            VERIFY(nwritten == count);
-            return {};
-        }
+    auto& shard = m_cache->shard_for(index);
+    MutexLocker locker(shard.lock());
+    if (!allow_cache) {
+        TRY(flush_specific_block_if_needed(shard, index));
+        u64 base_offset = index.value() * logical_block_size() + offset;
+        auto nwritten = TRY(file_description().write(base_offset, data, count));
+        VERIFY(nwritten == count);
+        return {};
+    }
 
-        auto entry = TRY(cache->ensure(index, *this));
-        if (count < logical_block_size()) {
-            // Fill the cache first.
-            TRY(read_block(index, nullptr, logical_block_size()));
-        }
-        memcpy(entry->data + offset, buffered_data.data(), count);
+    auto entry = TRY(shard.ensure(index, *this));
+    if (count < logical_block_size()) {
+        // Fill the cache first.
+        TRY(read_block(index, nullptr, logical_block_size()));
+    }
+    memcpy(entry->data + offset, buffered_data.data(), count);
 
-        cache->mark_dirty(*entry);
-        entry->has_data = true;
-        return {};
-    });
+    shard.mark_dirty(*entry);
+    entry->has_data = true;
+    return {};
 }
 
 ErrorOr<void> BlockBasedFileSystem::raw_read(BlockIndex index, UserOrKernelBuffer& buffer)
@@ -223,27 +392,27 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     VERIFY(offset + count <= logical_block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
-        if (!allow_cache) {
-            const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
-            u64 base_offset = index.value() * logical_block_size() + offset;
-            auto nread = TRY(file_description().read(*buffer, base_offset, count));
-            VERIFY(nread == count);
-            return {};
-        }
-
-        auto* entry = TRY(cache->ensure(index, const_cast<BlockBasedFileSystem&>(*this)));
-        if (!entry->has_data) {
-            auto base_offset = index.value() * logical_block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-            auto nread = TRY(file_description().read(entry_data_buffer, base_offset, logical_block_size()));
-            VERIFY(nread == logical_block_size());
-            entry->has_data = true;
-        }
-        if (buffer)
-            TRY(buffer->write(entry->data + offset, count));
+    auto& shard = m_cache->shard_for(index);
+    MutexLocker locker(shard.lock());
+    if (!allow_cache) {
+        TRY(const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(shard, index));
+        u64 base_offset = index.value() * logical_block_size() + offset;
+        auto nread = TRY(file_description().read(*buffer, base_offset, count));
+        VERIFY(nread == count);
         return {};
-    });
+    }
+
+    auto* entry = TRY(shard.ensure(index, const_cast<BlockBasedFileSystem&>(*this)));
+    if (!entry->has_data) {
+        auto base_offset = index.value() * logical_block_size();
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
+        auto nread = TRY(file_description().read(entry_data_buffer, base_offset, logical_block_size()));
+        VERIFY(nread == logical_block_size());
+        entry->has_data = true;
+    }
+    if (buffer)
+        TRY(buffer->write(entry->data + offset, count));
+    return {};
 }
 
 ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
@@ -262,37 +431,195 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
     return {};
 }
 
-void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
+struct ReadAheadWork {
+    NonnullRefPtr<BlockBasedFileSystem> fs;
+    Vector<BlockBasedFileSystem::BlockIndex> blocks;
+};
+
+void BlockBasedFileSystem::read_ahead_blocks(Vector<BlockIndex>&& blocks) const
 {
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        auto* entry = cache->get(index);
-        if (!entry)
-            return;
-        if (!cache->entry_is_dirty(*entry))
+    if (blocks.is_empty())
+        return;
+
+    auto* work = new (nothrow) ReadAheadWork { const_cast<BlockBasedFileSystem&>(*this), move(blocks) };
+    if (!work)
+        return;
+
+    // Read-ahead is merely a hint, so if we can't queue it, we simply don't read ahead.
+    auto result = g_read_ahead_work->try_queue(
+        [](void* data) {
+            auto& work = *static_cast<ReadAheadWork*>(data);
+            work.fs->read_ahead_blocks_impl(work.blocks);
+        },
+        work,
+        [](void* data) { delete static_cast<ReadAheadWork*>(data); });
+    if (result.is_error())
+        delete work;
+}
+
+void BlockBasedFileSystem::read_ahead_blocks_impl(Vector<BlockIndex>& blocks)
+{
+    // Claim entries for all blocks that aren't cached yet, so nobody else starts reading them in the meantime.
+    // They aren't marked as referenced until they have data, so they don't displace anything that is actually used.
+    Vector<BlockIndex> missing_blocks;
+    for (auto index : blocks) {
+        auto& shard = m_cache->shard_for(index);
+        MutexLocker locker(shard.lock());
+        if (shard.find(index))
+            continue;
+        auto entry_or_error = shard.ensure(index, *this);
+        if (entry_or_error.is_error())
+            break;
+        entry_or_error.value()->was_referenced = false;
+        if (missing_blocks.try_append(index).is_error())
+            break;
+    }
+    if (missing_blocks.is_empty())
+        return;
+
+    quick_sort(missing_blocks);
+
+    auto max_run_block_count = max_read_ahead_run_size / logical_block_size();
+    auto buffer_or_error = ByteBuffer::create_uninitialized(max_run_block_count * logical_block_size());
+    if (buffer_or_error.is_error())
+        return;
+    auto buffer = buffer_or_error.release_value();
+
+    for (size_t run_start = 0; run_start < missing_blocks.size();) {
+        size_t run_length = 1;
+        while (run_start + run_length < missing_blocks.size()
+            && run_length < max_run_block_count
+            && missing_blocks[run_start + run_length].value() == missing_blocks[run_start].value() + run_length)
+            ++run_length;
+
+        auto run_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer.data());
+        auto result = read_from_device(missing_blocks[run_start].value() * logical_block_size(), run_buffer, run_length * logical_block_size());
+
+        // The entries may have been evicted or filled by a regular read while we were waiting for the device.
+        for (size_t i = 0; i < run_length; ++i) {
+            auto index = missing_blocks[run_start + i];
+            auto& shard = m_cache->shard_for(index);
+            MutexLocker locker(shard.lock());
+            auto* entry = shard.find(index);
+            if (!entry || entry->has_data || result.is_error())
+                continue;
+            memcpy(entry->data, buffer.data() + i * logical_block_size(), logical_block_size());
+            entry->has_data = true;
+        }
+        run_start += run_length;
+    }
+}
+
+ErrorOr<void> BlockBasedFileSystem::flush_specific_block_if_needed(DiskCacheShard& shard, BlockIndex index)
+{
+    VERIFY(shard.lock().is_exclusively_locked_by_current_thread());
+    if (!shard.is_dirty())
+        return {};
+    auto* entry = shard.find(index);
+    if (!entry || !entry->is_dirty)
+        return {};
+    size_t base_offset = entry->block_index.value() * logical_block_size();
+    auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
+    TRY(write_to_device(base_offset, entry_data_buffer, logical_block_size()));
+    shard.mark_clean(*entry);
+    return {};
+}
+
+size_t BlockBasedFileSystem::write_back(Span<CacheEntry*> entries)
+{
+    quick_sort(entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+    size_t written_count = 0;
+
+    // Coalesce consecutive blocks into larger writes, so the device sees a few large sequential requests
+    // instead of lots of scattered single-block ones. If we can't get a buffer for that, write blocks one by one.
+    auto max_run_block_count = max(max_write_back_run_size / logical_block_size(), static_cast<size_t>(1));
+    auto buffer_or_error = ByteBuffer::create_uninitialized(max_run_block_count * logical_block_size());
+    if (buffer_or_error.is_error())
+        max_run_block_count = 1;
+
+    for (size_t run_start = 0; run_start < entries.size();) {
+        size_t run_length = 1;
+        while (run_start + run_length < entries.size()
+            && run_length < max_run_block_count
+            && entries[run_start + run_length]->block_index.value() == entries[run_start]->block_index.value() + run_length)
+            ++run_length;
+
+        auto base_offset = entries[run_start]->block_index.value() * logical_block_size();
+        ErrorOr<void> result {};
+        if (run_length == 1) {
+            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entries[run_start]->data);
+            result = write_to_device(base_offset, entry_data_buffer, logical_block_size());
+        } else {
+            auto& buffer = buffer_or_error.value();
+            for (size_t i = 0; i < run_length; ++i)
+                memcpy(buffer.data() + i * logical_block_size(), entries[run_start + i]->data, logical_block_size());
+            auto run_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer.data());
+            result = write_to_device(base_offset, run_buffer, run_length * logical_block_size());
+        }
+
+        // Blocks that couldn't be written stay dirty, so the next flush tries again.
+        if (result.is_error()) {
+            dbgln("{}: Failed to write back {} blocks starting at block {}: {}", class_name(), run_length, entries[run_start]->block_index, result.error());
+        } else {
+            // NOTE: The caller has locked the shards of all these entries.
+            for (size_t i = 0; i < run_length; ++i)
+                m_cache->shard_for(entries[run_start + i]->block_index).mark_clean(*entries[run_start + i]);
+            written_count += run_length;
+        }
+        run_start += run_length;
+    }
+    return written_count;
+}
+
+size_t BlockBasedFileSystem::write_back_dirty_entries(DiskCacheShard& shard)
+{
+    VERIFY(shard.lock().is_exclusively_locked_by_current_thread());
+    Vector<CacheEntry*> entries;
+    if (!shard.append_dirty_entries(entries).is_error())
+        return write_back(entries.span());
+
+    // We couldn't even allocate the list of dirty entries, so write them back one by one.
+    size_t written_count = 0;
+    shard.for_each_dirty_entry([&](CacheEntry& entry) {
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        if (auto result = write_to_device(entry.block_index.value() * logical_block_size(), entry_data_buffer, logical_block_size()); result.is_error()) {
+            dbgln("{}: Failed to write back block {}: {}", class_name(), entry.block_index, result.error());
             return;
-        size_t base_offset = entry->block_index.value() * logical_block_size();
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-        (void)file_description().write(base_offset, entry_data_buffer, logical_block_size());
+        }
+        shard.mark_clean(entry);
+        ++written_count;
     });
+    return written_count;
 }
 
 void BlockBasedFileSystem::flush_writes_impl()
 {
-    size_t count = 0;
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * logical_block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, logical_block_size());
-            ++count;
-        });
-        cache->mark_all_clean();
-        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+    if (!m_cache)
+        return;
+
+    // Lock all shards, so that dirty blocks from all of them can be sorted into one list and coalesced.
+    // NOTE: Shards are always locked in the same order, and nobody else ever holds more than one shard lock.
+    m_cache->for_each_shard([](auto& shard) { shard.lock().lock(); });
+
+    Vector<CacheEntry*> entries;
+    m_cache->for_each_shard([&](auto& shard) {
+        if (shard.append_dirty_entries(entries).is_error())
+            (void)write_back_dirty_entries(shard);
     });
+    if (!entries.is_empty()) {
+        auto count = write_back(entries.span());
+        dbgln("{}: Flushed {} of {} blocks to disk", class_name(), count, entries.size());
+    }
+
+    m_cache->for_each_shard([](auto& shard) { shard.lock().unlock(); });
+
+    // While the system is running short on free memory, give back some of the memory used for caching blocks.
+    if (is_low_on_free_memory()) {
+        m_cache->for_each_shard([&](auto& shard) {
+            MutexLocker locker(shard.lock());
+            shard.shrink(*this);
+        });
+    }
 }
 
 ErrorOr<void> BlockBasedFileSystem::flush_writes()
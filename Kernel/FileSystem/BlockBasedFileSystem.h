@@ -7,11 +7,12 @@
 #pragma once
 
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
-#include <Kernel/Locking/MutexProtected.h>
 
 namespace Kernel {
 
 class BlockBasedFileSystem : public FileBackedFileSystem {
+    friend class DiskCacheShard;
+
 public:
     AK_TYPEDEF_DISTINCT_ORDERED_ID(u64, BlockIndex);
 
@@ -30,6 +31,9 @@ protected:
     ErrorOr<void> read_block(BlockIndex, UserOrKernelBuffer*, size_t count, u64 offset = 0, bool allow_cache = true) const;
     ErrorOr<void> read_blocks(BlockIndex, unsigned count, UserOrKernelBuffer&, bool allow_cache = true) const;
 
+    // Asynchronously reads the given blocks into the cache, unless they are cached already.
+    void read_ahead_blocks(Vector<BlockIndex>&&) const;
+
     ErrorOr<void> raw_read(BlockIndex, UserOrKernelBuffer&);
     ErrorOr<void> raw_write(BlockIndex, UserOrKernelBuffer const&);
 
@@ -42,9 +46,17 @@ protected:
     u64 m_device_block_size { 512 };
 
 private:
-    void flush_specific_block_if_needed(BlockIndex index);
+    ErrorOr<void> read_from_device(u64 offset, UserOrKernelBuffer&, size_t count) const;
+    ErrorOr<void> write_to_device(u64 offset, UserOrKernelBuffer const&, size_t count);
+
+    void read_ahead_blocks_impl(Vector<BlockIndex>&);
+
+    ErrorOr<void> flush_specific_block_if_needed(DiskCacheShard&, BlockIndex index);
+    // Both return how many blocks were written back. Blocks that couldn't be written stay dirty.
+    size_t write_back_dirty_entries(DiskCacheShard&);
+    size_t write_back(Span<CacheEntry*>);
 
-    mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
+    mutable OwnPtr<DiskCache> m_cache;
 };
 
 }
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Library/KString.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    BlockFlags block_flags = BlockFlags::None;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    if (events & EPOLLWRBAND)
+        block_flags |= BlockFlags::WritePriority;
+    if (events & EPOLLRDHUP)
+        block_flags |= BlockFlags::ReadHangUp;
+    return block_flags;
+}
+
+static u32 events_for_block_flags(BlockFlags block_flags)
+{
+    u32 events = 0;
+    if (has_flag(block_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(block_flags, BlockFlags::Write) && !has_flag(block_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLOUT;
+    if (has_flag(block_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (has_flag(block_flags, BlockFlags::WritePriority))
+        events |= EPOLLWRBAND;
+    if (has_flag(block_flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    if (has_flag(block_flags, BlockFlags::WriteError))
+        events |= EPOLLERR;
+    if (has_flag(block_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    return events;
+}
+
+static u32 ready_events(OpenFileDescription const& description, u32 events)
+{
+    auto block_flags = block_flags_for_events(events);
+    if (block_flags == BlockFlags::None)
+        return 0;
+
+    // Like with poll(), errors and hang-ups are always reported.
+    block_flags |= BlockFlags::WriteError | BlockFlags::WriteHangUp;
+    return events_for_block_flags(description.should_unblock(block_flags));
+}
+
+EventPollWatch::EventPollWatch(EventPoll& event_poll, OpenFileDescription& description, int fd, u32 events, epoll_data_t data)
+    : event_poll(event_poll)
+    , description(description)
+    , file(description.file())
+    , blocker_set(description.blocker_set())
+    , fd(fd)
+    , events(events)
+    , data(data)
+{
+}
+
+ErrorOr<NonnullRefPtr<EventPoll>> EventPoll::try_create()
+{
+    return adopt_nonnull_ref_or_enomem(new (nothrow) EventPoll);
+}
+
+EventPoll::~EventPoll()
+{
+    (void)close();
+}
+
+ErrorOr<void> EventPoll::close()
+{
+    HashMap<WatchKey, NonnullRefPtr<EventPollWatch>, WatchKeyTraits> watches;
+    {
+        SpinlockLocker lock(m_lock);
+        for (auto& it : m_watches) {
+            it.value->is_registered = false;
+            if (it.value->ready_list_node.is_in_list())
+                m_ready_list.remove(*it.value);
+        }
+        watches = move(m_watches);
+        update_has_ready_watches();
+    }
+
+    // The watched files can't reach a watch that isn't registered anymore, but they can still see it until it's removed
+    // from their blocker set, so this has to happen before we go away.
+    for (auto& it : watches) {
+        SpinlockLocker blocker_set_lock(it.value->blocker_set.m_lock);
+        remove_from_blocker_set(*it.value);
+    }
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EventPoll::pseudo_path(OpenFileDescription const&) const
+{
+    SpinlockLocker lock(m_lock);
+    return KString::formatted("EventPoll:({})", m_watches.size());
+}
+
+ErrorOr<void> EventPoll::add_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    // Watched files notify their EventPolls while holding their blocker set's lock, and EventPolls notify the threads
+    // waiting on them while holding that lock too, so EventPolls can't watch each other.
+    if (description.is_event_poll())
+        return EINVAL;
+
+    auto watch = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) EventPollWatch(*this, description, fd, event.events, event.data)));
+    auto& blocker_set = watch->blocker_set;
+    {
+        SpinlockLocker blocker_set_lock(blocker_set.m_lock);
+        SpinlockLocker lock(m_lock);
+
+        WatchKey key { fd, &description };
+        if (m_watches.contains(key))
+            return EEXIST;
+
+        TRY(blocker_set.m_event_poll_watches.try_append(watch.ptr()));
+        if (auto result = m_watches.try_set(key, watch); result.is_error()) {
+            blocker_set.m_event_poll_watches.take_last();
+            return result.release_error();
+        }
+        blocker_set.m_event_poll_watch_count++;
+
+        // The file may well be ready already, in which case it won't tell us about it until its state changes again.
+        queue_if_interested(*watch);
+    }
+
+    evaluate_block_conditions();
+    return {};
+}
+
+ErrorOr<void> EventPoll::modify_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    {
+        SpinlockLocker lock(m_lock);
+
+        auto it = m_watches.find({ fd, &description });
+        if (it == m_watches.end())
+            return ENOENT;
+
+        auto& watch = *it->value;
+        watch.events = event.events;
+        watch.data = event.data;
+        queue_if_interested(watch);
+    }
+
+    evaluate_block_conditions();
+    return {};
+}
+
+ErrorOr<void> EventPoll::remove_watch(int fd, OpenFileDescription& description)
+{
+    SpinlockLocker blocker_set_lock(description.blocker_set().m_lock);
+    SpinlockLocker lock(m_lock);
+
+    auto it = m_watches.find({ fd, &description });
+    if (it == m_watches.end())
+        return ENOENT;
+
+    NonnullRefPtr watch = *it->value;
+    unregister_watch(watch);
+    remove_from_blocker_set(watch);
+    return {};
+}
+
+size_t EventPoll::collect_ready_events(Span<epoll_event> events)
+{
+    size_t count = 0;
+    EventPollWatch* first_requeued_watch = nullptr;
+    while (count < events.size()) {
+        RefPtr<EventPollWatch> watch;
+        RefPtr<OpenFileDescription> description;
+        u32 watched_events = 0;
+        {
+            SpinlockLocker lock(m_lock);
+            if (m_ready_list.is_empty() || m_ready_list.first() == first_requeued_watch)
+                break;
+
+            watch = m_ready_list.first();
+            m_ready_list.remove(*watch);
+
+            // The description is only about to be destroyed if this fails, which removes the watch anyway.
+            if (!watch->description.try_ref())
+                continue;
+            description = adopt_ref(watch->description);
+            watched_events = watch->events;
+        }
+
+        // Asking the file whether it's ready can take a while, so this must not happen while holding a spinlock.
+        auto ready = ready_events(*description, watched_events);
+        if (ready == 0)
+            continue;
+
+        SpinlockLocker lock(m_lock);
+        // The watch may have been removed or modified while we weren't looking.
+        if (!watch->is_registered || watch->events != watched_events)
+            continue;
+
+        events[count++] = { ready, watch->data };
+
+        if (watch->events & EPOLLONESHOT) {
+            // Disable the watch until it is re-armed.
+            watch->events &= EPOLLET | EPOLLONESHOT;
+            continue;
+        }
+
+        // Edge-triggered watches are queued again the next time the file's state changes.
+        if (watch->events & EPOLLET)
+            continue;
+
+        // Level-triggered watches stay queued until we find that they're not ready anymore. Requeueing them at the end
+        // makes sure that a few busy files can't starve the others if more are ready than fit into one batch.
+        if (!watch->ready_list_node.is_in_list())
+            m_ready_list.append(*watch);
+        if (!first_requeued_watch)
+            first_requeued_watch = watch.ptr();
+    }
+
+    SpinlockLocker lock(m_lock);
+    update_has_ready_watches();
+    return count;
+}
+
+void EventPoll::notify_watches(Badge<FileBlockerSet>, FileBlockerSet& blocker_set)
+{
+    SpinlockLocker blocker_set_lock(blocker_set.m_lock);
+    for (auto* watch : blocker_set.m_event_poll_watches) {
+        // The watch is still in the blocker set, so its EventPoll can't have finished closing yet.
+        auto& event_poll = watch->event_poll;
+        bool did_queue = false;
+        {
+            SpinlockLocker lock(event_poll.m_lock);
+            did_queue = watch->is_registered && event_poll.queue_if_interested(*watch);
+        }
+        if (did_queue)
+            event_poll.evaluate_block_conditions();
+    }
+}
+
+void EventPoll::description_will_be_destroyed(Badge<OpenFileDescription>, OpenFileDescription& description)
+{
+    auto& blocker_set = description.blocker_set();
+    if (blocker_set.m_event_poll_watch_count.load() == 0)
+        return;
+
+    // Like on other systems, closing the last file descriptor of a file description removes it from all EventPolls.
+    SpinlockLocker blocker_set_lock(blocker_set.m_lock);
+    for (size_t i = 0; i < blocker_set.m_event_poll_watches.size();) {
+        NonnullRefPtr watch = *blocker_set.m_event_poll_watches[i];
+        if (&watch->description != &description) {
+            ++i;
+            continue;
+        }
+
+        auto& event_poll = watch->event_poll;
+        {
+            SpinlockLocker lock(event_poll.m_lock);
+            if (watch->is_registered)
+                event_poll.unregister_watch(watch);
+        }
+        remove_from_blocker_set(watch);
+    }
+}
+
+bool EventPoll::queue_if_interested(EventPollWatch& watch)
+{
+    VERIFY(m_lock.is_locked());
+
+    // Whether the file is actually ready is only checked when the events are collected.
+    if (watch.ready_list_node.is_in_list() || block_flags_for_events(watch.events) == BlockFlags::None)
+        return false;
+
+    m_ready_list.append(watch);
+    update_has_ready_watches();
+    return true;
+}
+
+void EventPoll::unregister_watch(EventPollWatch& watch)
+{
+    VERIFY(m_lock.is_locked());
+
+    watch.is_registered = false;
+    if (watch.ready_list_node.is_in_list())
+        m_ready_list.remove(watch);
+    m_watches.remove({ watch.fd, &watch.description });
+    update_has_ready_watches();
+}
+
+void EventPoll::remove_from_blocker_set(EventPollWatch& watch)
+{
+    VERIFY(watch.blocker_set.m_lock.is_locked());
+
+    if (watch.blocker_set.m_event_poll_watches.remove_first_matching([&](auto* other) { return other == &watch; }))
+        watch.blocker_set.m_event_poll_watch_count--;
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+class EventPoll;
+
+// The interest of an EventPoll in one open file description, registered under the file descriptor it was added with.
+// A watch is listed both by its EventPoll and by the blocker set of the watched file, each under its own lock.
+struct EventPollWatch final : public AtomicRefCounted<EventPollWatch> {
+    EventPollWatch(EventPoll& event_poll, OpenFileDescription& description, int fd, u32 events, epoll_data_t data);
+
+    EventPoll& event_poll;
+    OpenFileDescription& description;
+    // Keeps the blocker set alive while the watch is, so it can be locked to unregister the watch.
+    NonnullRefPtr<File> file;
+    FileBlockerSet& blocker_set;
+    int fd { -1 };
+
+    // NOTE: These are protected by the lock of the EventPoll.
+    u32 events { 0 };
+    epoll_data_t data {};
+    bool is_registered { true };
+    IntrusiveListNode<EventPollWatch> ready_list_node;
+
+    using ReadyList = IntrusiveList<&EventPollWatch::ready_list_node>;
+};
+
+// EventPoll keeps a persistent list of file descriptions a process is interested in, so that waiting for any of them
+// to become ready doesn't require passing (and the kernel scanning) all of them again every time, like poll() does.
+// Watched files tell their EventPolls about state changes from the same place they unblock threads waiting on them,
+// which puts the watch on a ready list. Waiting only has to look at the watches on this list, and it is only then
+// that a watched file is asked whether it is actually ready, without holding any spinlock.
+//
+// Locks are always taken in this order: the blocker set of a watched file, then the EventPoll.
+class EventPoll final : public File {
+public:
+    static ErrorOr<NonnullRefPtr<EventPoll>> try_create();
+    virtual ~EventPoll() override;
+
+    // NOTE: This may be true even though none of the queued watches turns out to be ready.
+    virtual bool can_read(OpenFileDescription const&, u64) const override { return m_has_ready_watches.load(AK::MemoryOrder::memory_order_relaxed); }
+    // Events can only be retrieved with epoll_wait().
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return true; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+    virtual ErrorOr<void> close() override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual StringView class_name() const override { return "EventPoll"sv; }
+    virtual bool is_event_poll() const override { return true; }
+
+    ErrorOr<void> add_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> modify_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> remove_watch(int fd, OpenFileDescription&);
+
+    // Fills in events for the watches that are ready and returns how many there were.
+    size_t collect_ready_events(Span<epoll_event>);
+
+    static void notify_watches(Badge<FileBlockerSet>, FileBlockerSet&);
+    static void description_will_be_destroyed(Badge<OpenFileDescription>, OpenFileDescription&);
+
+private:
+    EventPoll() = default;
+
+    struct WatchKey {
+        int fd { -1 };
+        OpenFileDescription const* description { nullptr };
+
+        bool operator==(WatchKey const&) const = default;
+    };
+    struct WatchKeyTraits : public DefaultTraits<WatchKey> {
+        static unsigned hash(WatchKey const& key) { return pair_int_hash(int_hash(key.fd), ptr_hash(key.description)); }
+    };
+
+    bool queue_if_interested(EventPollWatch&);
+    void unregister_watch(EventPollWatch&);
+    static void remove_from_blocker_set(EventPollWatch&);
+    void update_has_ready_watches() { m_has_ready_watches.store(!m_ready_list.is_empty(), AK::MemoryOrder::memory_order_relaxed); }
+
+    mutable Spinlock<LockRank::None> m_lock {};
+
+    // NOTE: These are protected by m_lock.
+    HashMap<WatchKey, NonnullRefPtr<EventPollWatch>, WatchKeyTraits> m_watches;
+    EventPollWatch::ReadyList m_ready_list;
+
+    // This is checked by threads blocking on this EventPoll, which can't take m_lock to look at the ready list.
+    Atomic<bool> m_has_ready_watches { false };
+};
+
+}
@@ -534,6 +534,33 @@ ErrorOr<size_t> Ext2FSInode::read_bytes_locked(off_t offset, size_t count, UserO
     return nread;
 }
 
+void Ext2FSInode::read_ahead_locked(off_t offset, size_t count) const
+{
+    VERIFY(m_inode_lock.is_locked());
+    VERIFY(offset >= 0);
+    if (static_cast<u64>(offset) >= size() || is_symlink())
+        return;
+
+    auto const block_size = fs().logical_block_size();
+    auto first_block_logical_index = offset / block_size;
+    auto last_block_logical_index = (min(static_cast<u64>(offset) + count, size()) - 1) / block_size;
+
+    Vector<BlockBasedFileSystem::BlockIndex> blocks;
+    if (blocks.try_ensure_capacity(last_block_logical_index - first_block_logical_index + 1).is_error())
+        return;
+    for (auto logical_index = first_block_logical_index; logical_index <= last_block_logical_index; ++logical_index) {
+        auto block_index_or_error = m_block_view.get_block(logical_index);
+        if (block_index_or_error.is_error())
+            break;
+        // Holes read as zeroes, so there is nothing to read ahead.
+        if (auto block_index = block_index_or_error.release_value(); block_index.value() != 0)
+            blocks.unchecked_append(block_index);
+    }
+
+    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::read_ahead(): Reading ahead {} blocks, {} bytes into inode", identifier(), blocks.size(), offset);
+    fs().read_ahead_blocks(move(blocks));
+}
+
 ErrorOr<void> Ext2FSInode::resize(u64 new_size)
 {
     VERIFY(m_inode_lock.is_locked());
@@ -6,12 +6,18 @@
 
 #include <AK/StringView.h>
 #include <AK/Userspace.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Tasks/Process.h>
 
 namespace Kernel {
 
+void FileBlockerSet::notify_event_poll_watches()
+{
+    EventPoll::notify_watches({}, *this);
+}
+
 File::File() = default;
 File::~File() = default;
 
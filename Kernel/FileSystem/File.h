@@ -20,8 +20,11 @@
 namespace Kernel {
 
 class File;
+struct EventPollWatch;
 
 class FileBlockerSet final : public Thread::BlockerSet {
+    friend class EventPoll;
+
 public:
     FileBlockerSet() { }
 
@@ -34,13 +37,25 @@ public:
 
     void unblock_all_blockers_whose_conditions_are_met()
     {
-        SpinlockLocker lock(m_lock);
-        BlockerSet::unblock_all_blockers_whose_conditions_are_met_locked([&](auto& b, void* data, bool&) {
-            VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
-            auto& blocker = static_cast<Thread::FileBlocker&>(b);
-            return blocker.unblock_if_conditions_are_met(false, data);
-        });
+        {
+            SpinlockLocker lock(m_lock);
+            BlockerSet::unblock_all_blockers_whose_conditions_are_met_locked([&](auto& b, void* data, bool&) {
+                VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
+                auto& blocker = static_cast<Thread::FileBlocker&>(b);
+                return blocker.unblock_if_conditions_are_met(false, data);
+            });
+        }
+
+        if (m_event_poll_watch_count.load() != 0)
+            notify_event_poll_watches();
     }
+
+private:
+    void notify_event_poll_watches();
+
+    // NOTE: This is protected by m_lock, see EventPoll.
+    Vector<EventPollWatch*> m_event_poll_watches;
+    Atomic<size_t> m_event_poll_watch_count { 0 };
 };
 
 // File is the base class for anything that can be referenced by a OpenFileDescription.
@@ -119,6 +134,8 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_event_poll() const { return false; }
+    virtual bool is_io_ring() const { return false; }
     virtual bool is_mount_file() const { return false; }
     virtual bool is_loop_device() const { return false; }
 
@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/IntegralMath.h>
+#include <Kernel/API/POSIX/sys/socket.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Library/KString.h>
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Tasks/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_opcode(IORingOpcode opcode)
+{
+    switch (opcode) {
+    case IORingOpcode::Read:
+    case IORingOpcode::Receive:
+        return BlockFlags::Read;
+    case IORingOpcode::Write:
+    case IORingOpcode::Send:
+        return BlockFlags::Write;
+    case IORingOpcode::Accept:
+        return BlockFlags::Accept;
+    default:
+        return BlockFlags::None;
+    }
+}
+
+static ErrorOr<FlatPtr> accept(Process& process, IORingSubmission const& submission, Socket& socket)
+{
+    if (submission.flags & ~(SOCK_NONBLOCK | SOCK_CLOEXEC))
+        return EINVAL;
+
+    auto fd_allocation = TRY(process.allocate_fd());
+
+    auto accepted_socket = socket.accept();
+    if (!accepted_socket)
+        return EAGAIN;
+
+    auto accepted_socket_description = TRY(OpenFileDescription::try_create(*accepted_socket));
+    accepted_socket_description->set_readable(true);
+    accepted_socket_description->set_writable(true);
+    if (submission.flags & SOCK_NONBLOCK)
+        accepted_socket_description->set_blocking(false);
+    int fd_flags = 0;
+    if (submission.flags & SOCK_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    process.fds().with_exclusive([&](auto& fds) {
+        fds[fd_allocation.fd].set(move(accepted_socket_description), fd_flags);
+    });
+
+    // NOTE: Moving this state to Completed is what causes connect() to unblock on the client side.
+    accepted_socket->set_setup_state(Socket::SetupState::Completed);
+    return fd_allocation.fd;
+}
+
+static ErrorOr<FlatPtr> perform(Process& process, IORingSubmission const& submission, OpenFileDescription& description)
+{
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+    case IORingOpcode::Receive: {
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(Userspace<u8*>(submission.buffer), submission.length));
+        // Never block in the socket, we'll be back once more data has arrived.
+        if (auto* socket = description.socket()) {
+            if (socket->is_shut_down_for_reading())
+                return 0;
+            UnixDateTime timestamp {};
+            int flags = submission.opcode == IORingOpcode::Receive ? static_cast<int>(submission.flags) : 0;
+            return TRY(socket->recvfrom(description, buffer, submission.length, flags, {}, {}, timestamp, false));
+        }
+        if (submission.offset == IO_RING_CURRENT_OFFSET)
+            return TRY(description.read(buffer, submission.length));
+        if (submission.offset > static_cast<u64>(NumericLimits<off_t>::max()) || !description.file().is_seekable())
+            return EINVAL;
+        return TRY(description.read(buffer, submission.offset, submission.length));
+    }
+    case IORingOpcode::Write:
+    case IORingOpcode::Send: {
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(Userspace<u8*>(submission.buffer), submission.length));
+        ErrorOr<size_t> result { 0 };
+        if (submission.opcode == IORingOpcode::Send) {
+            result = description.socket()->sendto(description, buffer, submission.length, submission.flags, {}, 0);
+        } else if (submission.offset == IO_RING_CURRENT_OFFSET) {
+            if (description.should_append() && description.file().is_seekable())
+                TRY(description.seek(0, SEEK_END));
+            result = description.write(buffer, submission.length);
+        } else {
+            if (submission.offset > static_cast<u64>(NumericLimits<off_t>::max()) || !description.file().is_seekable())
+                return EINVAL;
+            result = description.write(submission.offset, buffer, submission.length);
+        }
+        if (result.is_error() && result.error().code() == EPIPE && !(submission.opcode == IORingOpcode::Send && (submission.flags & MSG_NOSIGNAL)))
+            Thread::current()->send_signal(SIGPIPE, &process);
+        return TRY(result);
+    }
+    case IORingOpcode::Accept:
+        return accept(process, submission, *description.socket());
+    case IORingOpcode::Fsync:
+        TRY(description.sync());
+        return 0;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ErrorOr<NonnullRefPtr<IORing>> IORing::try_create(Process& process, u32 entries)
+{
+    if (entries == 0 || entries > IO_RING_MAX_ENTRIES)
+        return EINVAL;
+
+    u32 submission_entries = 1u << AK::ceil_log2(entries);
+    u32 completion_entries = submission_entries * 2;
+
+    // Submissions are consumed as soon as they have been started, so leave room for completions to pile up.
+    size_t submissions_offset = align_up_to(sizeof(IORingHeader), 64);
+    size_t completions_offset = align_up_to(submissions_offset + submission_entries * sizeof(IORingSubmission), 64);
+    size_t size = TRY(Memory::page_round_up(completions_offset + completion_entries * sizeof(IORingCompletion)));
+
+    auto vmobject = TRY(Memory::AnonymousVMObject::try_create_with_size(size, AllocationStrategy::AllocateNow));
+    auto region_name = TRY(KString::formatted("IORing: {}", process.pid()));
+    auto region = TRY(MM.allocate_kernel_region_with_vmobject(*vmobject, size, region_name->view(), Memory::Region::Access::ReadWrite));
+
+    auto& header = *reinterpret_cast<IORingHeader*>(region->vaddr().as_ptr());
+    header.submission_entries = submission_entries;
+    header.completion_entries = completion_entries;
+    header.submissions_offset = submissions_offset;
+    header.completions_offset = completions_offset;
+    header.mapping_size = size;
+
+    return adopt_nonnull_ref_or_enomem(new (nothrow) IORing(process.pid(), submission_entries, move(vmobject), move(region), submissions_offset, completions_offset));
+}
+
+IORing::IORing(ProcessID owner, u32 submission_entries, NonnullLockRefPtr<Memory::AnonymousVMObject> vmobject, NonnullOwnPtr<Memory::Region> region, size_t submissions_offset, size_t completions_offset)
+    : m_owner(owner)
+    , m_submission_entries(submission_entries)
+    , m_completion_entries(submission_entries * 2)
+    , m_vmobject(move(vmobject))
+    , m_region(move(region))
+    , m_submissions(reinterpret_cast<IORingSubmission const*>(m_region->vaddr().offset(submissions_offset).as_ptr()))
+    , m_completions(reinterpret_cast<IORingCompletion*>(m_region->vaddr().offset(completions_offset).as_ptr()))
+{
+}
+
+IORing::~IORing() = default;
+
+bool IORing::can_read(OpenFileDescription const&, u64) const
+{
+    // This is called while the scheduler lock is held, so we can't take our lock to look at the queue here.
+    return AK::atomic_load(&header().completion_head, AK::memory_order_relaxed) != AK::atomic_load(&header().completion_tail, AK::memory_order_relaxed);
+}
+
+ErrorOr<File::VMObjectAndMemoryType> IORing::vmobject_and_memory_type_for_mmap(Process&, Memory::VirtualRange const&, u64& offset, bool shared)
+{
+    // A private mapping would stop seeing the kernel's changes as soon as it is written to.
+    if (offset != 0 || !shared)
+        return EINVAL;
+
+    return VMObjectAndMemoryType {
+        .vmobject = m_vmobject,
+        .memory_type = Memory::MemoryType::Normal,
+    };
+}
+
+ErrorOr<NonnullOwnPtr<KString>> IORing::pseudo_path(OpenFileDescription const&) const
+{
+    return KString::formatted("IORing:({})", m_submission_entries);
+}
+
+ErrorOr<size_t> IORing::enter(Process& process, u32 to_submit, u32 min_complete, Thread::BlockTimeout const& timeout)
+{
+    // Submissions refer to the memory and file descriptors of the process that created the ring, so it's the only
+    // one that can submit them. This is also the only way operations make progress, which is why it has to wait too.
+    if (process.pid() != m_owner)
+        return EPERM;
+    if (min_complete > m_completion_entries)
+        return EINVAL;
+
+    size_t submitted = 0;
+    {
+        MutexLocker locker(m_lock);
+        submitted = submit(process, to_submit);
+    }
+
+    for (;;) {
+        Thread::SelectBlocker::FDVector fds;
+        LockRefPtr<AsyncBlockDeviceRequest> request;
+        {
+            MutexLocker locker(m_lock);
+            complete_finished_device_operations();
+            complete_ready_operations(process);
+            evaluate_block_conditions();
+
+            if (unreaped_completion_count() >= min_complete || operations_in_flight() == 0)
+                return submitted;
+
+            // Block devices will finish their transfers soon enough, so wait for those before waiting for files
+            // whose readiness might well depend on someone else.
+            if (!m_device_operations.is_empty()) {
+                request = m_device_operations.first().request;
+            } else {
+                TRY(fds.try_ensure_capacity(m_pending_operations.size()));
+                for (auto& operation : m_pending_operations)
+                    fds.unchecked_append({ operation.description, block_flags_for_opcode(operation.submission.opcode) });
+            }
+        }
+
+        auto block_result = request
+            ? request->wait(timeout).wait_result()
+            : Thread::current()->block<Thread::SelectBlocker>(timeout, fds);
+        if (block_result.was_interrupted()) {
+            if (submitted != 0)
+                return submitted;
+            return EINTR;
+        }
+        if (block_result == Thread::BlockResult::InterruptedByTimeout)
+            return submitted;
+    }
+}
+
+size_t IORing::submit(Process& process, u32 to_submit)
+{
+    VERIFY(m_lock.is_locked());
+
+    u32 tail = AK::atomic_load(&header().submission_tail, AK::memory_order_acquire);
+    u32 available = min(tail - m_submission_head, m_submission_entries);
+
+    size_t submitted = 0;
+    while (submitted < min(to_submit, available)) {
+        // Make sure that every operation we start has a place to put its completion.
+        if (unreaped_completion_count() + operations_in_flight() >= m_completion_entries)
+            break;
+
+        // The process can change the submission while we look at it, so make a copy first.
+        IORingSubmission submission;
+        memcpy(&submission, &m_submissions[m_submission_head & (m_submission_entries - 1)], sizeof(submission));
+        ++m_submission_head;
+        ++submitted;
+
+        if (auto result = start_operation(process, submission); result.is_error())
+            post_completion(submission.user_data, result.release_error());
+    }
+
+    AK::atomic_store(&header().submission_head, m_submission_head, AK::memory_order_release);
+    return submitted;
+}
+
+ErrorOr<void> IORing::start_operation(Process& process, IORingSubmission const& submission)
+{
+    if (submission.opcode == IORingOpcode::Nop) {
+        post_completion(submission.user_data, 0);
+        return {};
+    }
+
+    auto description = TRY(process.open_file_description(submission.fd));
+    switch (submission.opcode) {
+    case IORingOpcode::Read:
+        if (!description->is_readable())
+            return EBADF;
+        if (description->is_directory())
+            return EISDIR;
+        break;
+    case IORingOpcode::Write:
+        if (!description->is_writable())
+            return EBADF;
+        break;
+    case IORingOpcode::Accept:
+        TRY(process.require_promise(Pledge::accept));
+        [[fallthrough]];
+    case IORingOpcode::Send:
+    case IORingOpcode::Receive:
+        if (!description->is_socket())
+            return ENOTSOCK;
+        break;
+    case IORingOpcode::Fsync:
+        break;
+    default:
+        return EINVAL;
+    }
+
+    if (TRY(try_start_device_operation(submission, *description)))
+        return {};
+
+    PendingOperation operation { submission, move(description) };
+    if (auto result = try_perform(process, operation); result.has_value()) {
+        post_completion(submission.user_data, result.release_value());
+        return {};
+    }
+    TRY(m_pending_operations.try_append(move(operation)));
+    return {};
+}
+
+ErrorOr<bool> IORing::try_start_device_operation(IORingSubmission const& submission, OpenFileDescription& description)
+{
+    if (submission.opcode != IORingOpcode::Read && submission.opcode != IORingOpcode::Write)
+        return false;
+    if (!description.file().is_block_device() || submission.offset == IO_RING_CURRENT_OFFSET)
+        return false;
+
+    auto& device = static_cast<BlockDevice&>(description.file());
+    auto block_count = device.addressable_block_count();
+    if (!block_count.has_value())
+        return false;
+
+    // Anything that doesn't map to whole blocks on the device is left to read() and write().
+    u64 block_mask = device.block_size() - 1;
+    if (submission.length == 0 || (submission.offset & block_mask) != 0 || (submission.length & block_mask) != 0)
+        return false;
+    u64 index = submission.offset >> device.block_size_log();
+    if (index >= block_count.value())
+        return false;
+
+    // Like read() and write(), only transfer as much per request as the controller can take.
+    u64 blocks = min<u64>(submission.length >> device.block_size_log(), device.max_request_block_count());
+    blocks = min(blocks, block_count.value() - index);
+    size_t length = blocks << device.block_size_log();
+
+    auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(Userspace<u8*>(submission.buffer), length));
+    TRY(m_device_operations.try_ensure_capacity(m_device_operations.size() + 1));
+    auto type = submission.opcode == IORingOpcode::Read ? AsyncBlockDeviceRequest::Read : AsyncBlockDeviceRequest::Write;
+    auto request = TRY(device.try_make_request<AsyncBlockDeviceRequest>(type, index, static_cast<u32>(blocks), buffer, length));
+    m_device_operations.unchecked_append({ submission.user_data, length, move(request) });
+    return true;
+}
+
+Optional<ErrorOr<FlatPtr>> IORing::try_perform(Process& process, PendingOperation& operation)
+{
+    auto block_flags = block_flags_for_opcode(operation.submission.opcode);
+    if (block_flags != BlockFlags::None && operation.description->should_unblock(block_flags) == BlockFlags::None)
+        return {};
+
+    auto result = perform(process, operation.submission, *operation.description);
+
+    // Someone else might have taken what made the file ready, in which case we wait for it to be ready again.
+    if (result.is_error() && result.error().code() == EAGAIN && block_flags != BlockFlags::None)
+        return {};
+    return result;
+}
+
+void IORing::complete_ready_operations(Process& process)
+{
+    VERIFY(m_lock.is_locked());
+
+    for (size_t i = 0; i < m_pending_operations.size();) {
+        auto result = try_perform(process, m_pending_operations[i]);
+        if (!result.has_value()) {
+            ++i;
+            continue;
+        }
+        post_completion(m_pending_operations[i].submission.user_data, result.release_value());
+        m_pending_operations.remove(i);
+    }
+}
+
+void IORing::complete_finished_device_operations()
+{
+    VERIFY(m_lock.is_locked());
+
+    for (size_t i = 0; i < m_device_operations.size();) {
+        if (!m_device_operations[i].request->is_completed()) {
+            ++i;
+            continue;
+        }
+        complete_device_operation(m_device_operations[i]);
+        m_device_operations.remove(i);
+    }
+}
+
+void IORing::complete_device_operation(DeviceOperation& operation)
+{
+    auto result = operation.request->wait().request_result();
+    switch (result) {
+    case AsyncDeviceRequest::Success:
+        post_completion(operation.user_data, operation.length);
+        break;
+    case AsyncDeviceRequest::MemoryFault:
+        post_completion(operation.user_data, EFAULT);
+        break;
+    case AsyncDeviceRequest::OutOfMemory:
+        post_completion(operation.user_data, ENOMEM);
+        break;
+    default:
+        post_completion(operation.user_data, EIO);
+        break;
+    }
+}
+
+size_t IORing::unreaped_completion_count() const
+{
+    // The process could have moved the head anywhere, so don't trust it to be behind our tail.
+    u32 head = AK::atomic_load(&header().completion_head, AK::memory_order_acquire);
+    return min(m_completion_tail - head, m_completion_entries);
+}
+
+void IORing::post_completion(u64 user_data, ErrorOr<FlatPtr> result)
+{
+    VERIFY(m_lock.is_locked());
+
+    auto& completion = m_completions[m_completion_tail & (m_completion_entries - 1)];
+    completion.user_data = user_data;
+    completion.result = result.is_error() ? -static_cast<i64>(result.error().code()) : static_cast<i64>(result.value());
+
+    ++m_completion_tail;
+    AK::atomic_store(&header().completion_tail, m_completion_tail, AK::memory_order_release);
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/API/IORing.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Memory/AnonymousVMObject.h>
+#include <Kernel/Memory/Region.h>
+
+namespace Kernel {
+
+// IORing services the submissions of a process in the context of its io_ring_enter() calls, so they can refer to its
+// memory and file descriptors. Operations that would block on a file are kept around until the file becomes ready,
+// while block device transfers are started right away and complete asynchronously, so many operations can be in
+// flight at once.
+class IORing final : public File {
+public:
+    static ErrorOr<NonnullRefPtr<IORing>> try_create(Process&, u32 entries);
+    virtual ~IORing() override;
+
+    virtual bool can_read(OpenFileDescription const&, u64) const override;
+    // The queues can only be accessed by mmap()ing the ring.
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return true; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+    virtual ErrorOr<VMObjectAndMemoryType> vmobject_and_memory_type_for_mmap(Process&, Memory::VirtualRange const&, u64& offset, bool shared) override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual StringView class_name() const override { return "IORing"sv; }
+    virtual bool is_io_ring() const override { return true; }
+
+    // Consumes up to `to_submit` submissions and waits until at least `min_complete` completions are available.
+    // Returns the number of submissions that were consumed.
+    ErrorOr<size_t> enter(Process&, u32 to_submit, u32 min_complete, Thread::BlockTimeout const&);
+
+private:
+    struct PendingOperation {
+        IORingSubmission submission;
+        NonnullRefPtr<OpenFileDescription> description;
+    };
+
+    struct DeviceOperation {
+        u64 user_data { 0 };
+        size_t length { 0 };
+        NonnullLockRefPtr<AsyncBlockDeviceRequest> request;
+    };
+
+    IORing(ProcessID owner, u32 submission_entries, NonnullLockRefPtr<Memory::AnonymousVMObject>, NonnullOwnPtr<Memory::Region>, size_t submissions_offset, size_t completions_offset);
+
+    IORingHeader& header() const { return *reinterpret_cast<IORingHeader*>(m_region->vaddr().as_ptr()); }
+
+    size_t submit(Process&, u32 to_submit);
+    ErrorOr<void> start_operation(Process&, IORingSubmission const&);
+    ErrorOr<bool> try_start_device_operation(IORingSubmission const&, OpenFileDescription&);
+    Optional<ErrorOr<FlatPtr>> try_perform(Process&, PendingOperation&);
+    void complete_ready_operations(Process&);
+    void complete_finished_device_operations();
+    void complete_device_operation(DeviceOperation&);
+
+    size_t unreaped_completion_count() const;
+    size_t operations_in_flight() const { return m_pending_operations.size() + m_device_operations.size(); }
+    void post_completion(u64 user_data, ErrorOr<FlatPtr>);
+
+    ProcessID const m_owner;
+    u32 const m_submission_entries { 0 };
+    u32 const m_completion_entries { 0 };
+
+    NonnullLockRefPtr<Memory::AnonymousVMObject> const m_vmobject;
+    NonnullOwnPtr<Memory::Region> const m_region;
+    IORingSubmission const* const m_submissions { nullptr };
+    IORingCompletion* const m_completions { nullptr };
+
+    // NOTE: This serializes everything that touches the queues or the operations in flight, but is not held while
+    //       io_ring_enter() waits for them to finish.
+    mutable Mutex m_lock { "IORing"sv };
+
+    // Our own copies of the indices we own, as the ones in shared memory could be changed by the process at any time.
+    u32 m_submission_head { 0 };
+    u32 m_completion_tail { 0 };
+
+    Vector<PendingOperation> m_pending_operations;
+    Vector<DeviceOperation> m_device_operations;
+};
+
+}
@@ -114,6 +114,12 @@ ErrorOr<size_t> Inode::read_bytes(off_t offset, size_t length, UserOrKernelBuffe
     return read_bytes_locked(offset, length, buffer, open_description);
 }
 
+void Inode::read_ahead(off_t offset, size_t length) const
+{
+    MutexLocker locker(m_inode_lock, Mutex::Mode::Shared);
+    read_ahead_locked(offset, length);
+}
+
 ErrorOr<size_t> Inode::read_until_filled_or_end(off_t offset, size_t length, UserOrKernelBuffer buffer, OpenFileDescription* open_description) const
 {
     auto remaining_length = length;
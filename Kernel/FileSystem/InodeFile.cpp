@@ -32,12 +32,49 @@ ErrorOr<size_t> InodeFile::read(OpenFileDescription& description, u64 offset, Us
 
     auto nread = TRY(m_inode->read_bytes(offset, count, buffer, &description));
     if (nread > 0) {
+        if (!description.is_direct())
+            did_read(description, offset, nread);
         Thread::current()->did_file_read(nread);
         evaluate_block_conditions();
     }
     return nread;
 }
 
+void InodeFile::did_read(OpenFileDescription& description, u64 offset, size_t count)
+{
+    static constexpr size_t min_read_ahead_window_size = 16 * KiB;
+    static constexpr size_t max_read_ahead_window_size = 128 * KiB;
+
+    Optional<u64> read_ahead_offset;
+    size_t read_ahead_size = 0;
+    // NOTE: Each open file description is read ahead of on its own, so readers of the same file don't disturb each other.
+    description.with_read_ahead_state([&](auto& state) {
+        // NOTE: The first read of a file counts as sequential if it starts at the beginning, as most reads do.
+        bool is_sequential = offset == state.next_offset;
+        state.next_offset = offset + count;
+        if (!is_sequential) {
+            // Stop reading ahead until the reader becomes sequential again.
+            state.window_size = 0;
+            state.read_ahead_end = state.next_offset;
+            return;
+        }
+
+        // Every sequential read doubles the window, up to the maximum.
+        state.window_size = state.window_size == 0 ? min_read_ahead_window_size : min(state.window_size * 2, max_read_ahead_window_size);
+
+        // Once the reader gets within half a window of what has been read ahead so far, read the next window.
+        if (state.next_offset + state.window_size / 2 < state.read_ahead_end)
+            return;
+        auto start = max(state.read_ahead_end, state.next_offset);
+        read_ahead_offset = start;
+        read_ahead_size = state.window_size;
+        state.read_ahead_end = start + state.window_size;
+    });
+
+    if (read_ahead_offset.has_value())
+        m_inode->read_ahead(*read_ahead_offset, read_ahead_size);
+}
+
 ErrorOr<size_t> InodeFile::write(OpenFileDescription& description, u64 offset, UserOrKernelBuffer const& data, size_t count)
 {
     if (Checked<off_t>::addition_would_overflow(offset, count))
@@ -52,6 +52,9 @@ private:
     virtual bool is_regular_file() const override;
 
     explicit InodeFile(NonnullRefPtr<Inode>);
+
+    void did_read(OpenFileDescription&, u64 offset, size_t count);
+
     NonnullRefPtr<Inode> const m_inode;
 };
 
@@ -11,6 +11,7 @@
 #include <Kernel/Devices/TTY/MasterPTY.h>
 #include <Kernel/Devices/TTY/TTY.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
@@ -53,6 +54,7 @@ OpenFileDescription::OpenFileDescription(File& file)
 
 OpenFileDescription::~OpenFileDescription()
 {
+    EventPoll::description_will_be_destroyed({}, *this);
     m_file->detach(*this);
     // FIXME: Should this error path be observed somehow?
     (void)m_file->close();
@@ -313,6 +315,25 @@ InodeWatcher* OpenFileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool OpenFileDescription::is_event_poll() const
+{
+    return m_file->is_event_poll();
+}
+
+EventPoll const* OpenFileDescription::event_poll() const
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll const*>(m_file.ptr());
+}
+
+EventPoll* OpenFileDescription::event_poll()
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll*>(m_file.ptr());
+}
+
 bool OpenFileDescription::is_mount_file() const
 {
     return m_file->is_mount_file();
@@ -80,6 +80,10 @@ public:
     InodeWatcher const* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_event_poll() const;
+    EventPoll const* event_poll() const;
+    EventPoll* event_poll();
+
     bool is_mount_file() const;
     MountFile const* mount_file() const;
     MountFile* mount_file();
@@ -132,6 +136,19 @@ public:
     ErrorOr<void> apply_flock(Process const&, Userspace<flock const*>, ShouldBlock);
     ErrorOr<void> get_flock(Userspace<flock*>) const;
 
+    // Tracks sequential reads through this description, so that upcoming data can be read ahead of the reader.
+    struct ReadAheadState {
+        u64 next_offset { 0 };
+        u64 read_ahead_end { 0 };
+        size_t window_size { 0 };
+    };
+
+    template<typename Callback>
+    void with_read_ahead_state(Callback callback)
+    {
+        m_state.with([&](auto& state) { callback(state.read_ahead); });
+    }
+
 private:
     explicit OpenFileDescription(File&);
 
@@ -149,6 +166,7 @@ private:
         OwnPtr<OpenFileDescriptionData> data;
         RefPtr<Custody> custody;
         off_t current_offset { 0 };
+        ReadAheadState read_ahead;
         u32 file_flags { 0 };
         bool readable : 1 { false };
         bool writable : 1 { false };
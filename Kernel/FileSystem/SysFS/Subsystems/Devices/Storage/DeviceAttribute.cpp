@@ -19,6 +19,8 @@ StringView StorageDeviceAttributeSysFSComponent::name() const
         return "sector_size"sv;
     case Type::CommandSet:
         return "command_set"sv;
+    case Type::MergedRequests:
+        return "merged_requests"sv;
     default:
         VERIFY_NOT_REACHED();
     }
@@ -61,6 +63,9 @@ ErrorOr<NonnullOwnPtr<KBuffer>> StorageDeviceAttributeSysFSComponent::try_to_gen
     case Type::CommandSet:
         value = TRY(KString::formatted("{}", m_device->command_set_to_string_view()));
         break;
+    case Type::MergedRequests:
+        value = TRY(KString::formatted("{}", m_device->merged_request_count()));
+        break;
     default:
         VERIFY_NOT_REACHED();
     }
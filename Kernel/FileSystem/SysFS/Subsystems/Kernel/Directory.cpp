@@ -25,6 +25,7 @@
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Processes.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Profile.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/RequestPanic.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/SchedulerStatistics.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/SystemStatistics.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Uptime.h>
 
@@ -37,6 +38,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<SysFSGlobalKernelStatsDirectory> SysFSGlobalKerne
         list.append(SysFSDiskUsage::must_create(*global_kernel_stats_directory));
         list.append(SysFSMemoryStatus::must_create(*global_kernel_stats_directory));
         list.append(SysFSSystemStatistics::must_create(*global_kernel_stats_directory));
+        list.append(SysFSSchedulerStatistics::must_create(*global_kernel_stats_directory));
         list.append(SysFSOverallProcesses::must_create(*global_kernel_stats_directory));
         list.append(SysFSCPUInformation::must_create(*global_kernel_stats_directory));
         list.append(SysFSKernelLog::must_create(*global_kernel_stats_directory));
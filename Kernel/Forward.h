@@ -23,7 +23,9 @@ class DeprecatedWaitQueue;
 class Device;
 class DeviceControlDevice;
 class DiskCache;
+class DiskCacheShard;
 class DoubleBuffer;
+class EventPoll;
 class File;
 class FATInode;
 class OpenFileDescription;
@@ -95,6 +97,7 @@ class Spinlock;
 template<typename LockType>
 class SpinlockLocker;
 
+struct CacheEntry;
 struct InodeMetadata;
 struct TrapFrame;
 
@@ -17,6 +17,14 @@ ErrorOr<LockRefPtr<ScatterGatherList>> ScatterGatherList::try_create(AsyncBlockD
     return adopt_lock_ref_if_nonnull(new (nothrow) ScatterGatherList(vm_object, move(region)));
 }
 
+ErrorOr<NonnullLockRefPtr<ScatterGatherList>> ScatterGatherList::try_create(Span<NonnullRefPtr<PhysicalRAMPage>> allocated_pages, StringView region_name)
+{
+    auto vm_object = TRY(AnonymousVMObject::try_create_with_physical_pages(allocated_pages));
+    auto region = TRY(MM.allocate_kernel_region_with_vmobject(vm_object, allocated_pages.size() * PAGE_SIZE, region_name, Region::Access::Read | Region::Access::Write, MemoryType::Normal));
+
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) ScatterGatherList(vm_object, move(region)));
+}
+
 ScatterGatherList::ScatterGatherList(NonnullLockRefPtr<AnonymousVMObject> vm_object, NonnullOwnPtr<Region> dma_region)
     : m_vm_object(move(vm_object))
     , m_dma_region(move(dma_region))
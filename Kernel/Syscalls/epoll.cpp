@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Tasks/Process.h>
+
+namespace Kernel {
+
+ErrorOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto event_poll = TRY(EventPoll::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(event_poll)));
+
+    description->set_readable(true);
+
+    u32 fd_flags = 0;
+    if (flags & EPOLL_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto new_fd = TRY(fds.allocate());
+        fds[new_fd.fd].set(move(description), fd_flags);
+        return new_fd.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(Userspace<Syscall::SC_epoll_ctl_params const*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    auto event_poll_description = TRY(open_file_description(params.epoll_fd));
+    auto* event_poll = event_poll_description->event_poll();
+    if (!event_poll)
+        return EINVAL;
+
+    auto description = TRY(open_file_description(params.fd));
+
+    epoll_event event {};
+    if (params.operation != EPOLL_CTL_DEL)
+        TRY(copy_from_user(&event, params.event));
+
+    switch (params.operation) {
+    case EPOLL_CTL_ADD:
+        TRY(event_poll->add_watch(params.fd, *description, event));
+        return 0;
+    case EPOLL_CTL_MOD:
+        TRY(event_poll->modify_watch(params.fd, *description, event));
+        return 0;
+    case EPOLL_CTL_DEL:
+        TRY(event_poll->remove_watch(params.fd, *description));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_pwait(Userspace<Syscall::SC_epoll_pwait_params const*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto description = TRY(open_file_description(params.epoll_fd));
+    auto* event_poll = description->event_poll();
+    if (!event_poll)
+        return EINVAL;
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask)
+        TRY(copy_from_user(&sigmask, params.sigmask));
+
+    // Unlike poll(), the size of this buffer only depends on how many events userspace wants per call, and not on how
+    // many file descriptions are being watched.
+    Vector<epoll_event, 16> events;
+    TRY(events.try_resize(min(static_cast<size_t>(params.max_events), OpenFileDescriptions::max_open())));
+
+    auto* current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    bool did_time_out = false;
+    for (;;) {
+        auto count = event_poll->collect_ready_events(events.span());
+        if (count != 0 || did_time_out) {
+            if (count != 0)
+                TRY(copy_n_to_user(params.events, events.data(), count));
+            return count;
+        }
+
+        dbgln_if(POLL_SELECT_DEBUG, "epoll_pwait: Blocking on fd {}, timeout={}", params.epoll_fd, params.timeout);
+
+        // The EventPoll becomes readable once any of its watches is put on its ready list. We may still find nothing
+        // to report when looking at the list, for example if a level-triggered file was drained in the meantime.
+        Thread::FileBlocker::BlockFlags unblocked_flags {};
+        auto block_result = current_thread->block<Thread::ReadBlocker>(timeout, *description, unblocked_flags);
+        if (block_result.was_interrupted())
+            return EINTR;
+        did_time_out = block_result == Thread::BlockResult::InterruptedByTimeout;
+    }
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Tasks/Process.h>
+
+namespace Kernel {
+
+ErrorOr<FlatPtr> Process::sys$io_ring_create(u32 entries, int options)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (options & ~O_CLOEXEC)
+        return EINVAL;
+
+    auto ring = TRY(IORing::try_create(*this, entries));
+    auto description = TRY(OpenFileDescription::try_create(move(ring)));
+
+    // Both are needed to map the queues for sharing.
+    description->set_readable(true);
+    description->set_writable(true);
+
+    u32 fd_flags = 0;
+    if (options & O_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto new_fd = TRY(fds.allocate());
+        fds[new_fd.fd].set(move(description), fd_flags);
+        return new_fd.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$io_ring_enter(Userspace<Syscall::SC_io_ring_enter_params const*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    auto description = TRY(open_file_description(params.fd));
+    if (!description->file().is_io_ring())
+        return EINVAL;
+    auto& ring = static_cast<IORing&>(description->file());
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    return TRY(ring.enter(*this, params.to_submit, params.min_complete, timeout));
+}
+
+}
@@ -64,26 +64,48 @@ ErrorOr<FlatPtr> Process::sys$scheduler_set_parameters(Userspace<Syscall::SC_sch
     TRY(require_promise(Pledge::proc));
     auto parameters = TRY(copy_typed_from_user(user_param));
 
-    if (parameters.parameters.sched_priority < THREAD_PRIORITY_MIN || parameters.parameters.sched_priority > THREAD_PRIORITY_MAX)
+    auto fields = parameters.fields;
+    if ((fields & ~(Syscall::SchedulerParametersFields::Priority | Syscall::SchedulerParametersFields::CPUAffinity)) != Syscall::SchedulerParametersFields::None)
         return EINVAL;
 
-    SpinlockLocker lock(g_scheduler_lock);
-    auto peer = TRY(get_thread_from_pid_or_tid(parameters.pid_or_tid, parameters.mode));
+    bool set_priority = has_flag(fields, Syscall::SchedulerParametersFields::Priority);
+    if (set_priority && (parameters.parameters.sched_priority < THREAD_PRIORITY_MIN || parameters.parameters.sched_priority > THREAD_PRIORITY_MAX))
+        return EINVAL;
+
+    bool set_cpu_affinity = has_flag(fields, Syscall::SchedulerParametersFields::CPUAffinity);
+    bool should_yield = false;
+    {
+        SpinlockLocker lock(g_scheduler_lock);
+        // Don't let threads end up without any processor to run on.
+        if (set_cpu_affinity && !(parameters.cpu_affinity & Scheduler::online_processors()))
+            return EINVAL;
 
-    auto credentials = this->credentials();
-    auto peer_credentials = peer->process().credentials();
-    if (!credentials->is_superuser() && credentials->euid() != peer_credentials->uid() && credentials->uid() != peer_credentials->uid())
-        return EPERM;
+        auto peer = TRY(get_thread_from_pid_or_tid(parameters.pid_or_tid, parameters.mode));
 
-    peer->set_priority((u32)parameters.parameters.sched_priority);
-    // POSIX says that process scheduling parameters have precedence over thread scheduling parameters.
-    // We don't track them separately, so overwrite the thread scheduling settings manually for now.
-    if (parameters.mode == Syscall::SchedulerParametersMode::Process) {
-        peer->process().for_each_thread([&](auto& thread) {
-            thread.set_priority((u32)parameters.parameters.sched_priority);
-        });
+        auto credentials = this->credentials();
+        auto peer_credentials = peer->process().credentials();
+        if (!credentials->is_superuser() && credentials->euid() != peer_credentials->uid() && credentials->uid() != peer_credentials->uid())
+            return EPERM;
+
+        auto apply_parameters = [&](Thread& thread) {
+            if (set_priority)
+                thread.set_priority((u32)parameters.parameters.sched_priority);
+            if (set_cpu_affinity)
+                Scheduler::set_thread_affinity(thread, parameters.cpu_affinity);
+        };
+
+        apply_parameters(*peer);
+        // POSIX says that process scheduling parameters have precedence over thread scheduling parameters.
+        // We don't track them separately, so overwrite the thread scheduling settings manually for now.
+        if (parameters.mode == Syscall::SchedulerParametersMode::Process)
+            peer->process().for_each_thread(apply_parameters);
+
+        // If we may no longer run on this processor, move elsewhere right away.
+        should_yield = set_cpu_affinity && !(Thread::current()->affinity() & (1u << Processor::current_id()));
     }
 
+    if (should_yield)
+        Thread::current()->yield_without_releasing_big_lock();
     return 0;
 }
 
@@ -96,6 +118,7 @@ ErrorOr<FlatPtr> Process::sys$scheduler_get_parameters(Userspace<Syscall::SC_sch
     TRY(copy_from_user(&parameters, user_param));
 
     int priority;
+    u32 cpu_affinity;
     {
         SpinlockLocker lock(g_scheduler_lock);
         auto peer = TRY(get_thread_from_pid_or_tid(parameters.pid_or_tid, parameters.mode));
@@ -106,9 +129,11 @@ ErrorOr<FlatPtr> Process::sys$scheduler_get_parameters(Userspace<Syscall::SC_sch
             return EPERM;
 
         priority = (int)peer->priority();
+        cpu_affinity = peer->affinity() & Scheduler::online_processors();
     }
 
     parameters.parameters.sched_priority = priority;
+    parameters.cpu_affinity = cpu_affinity;
 
     TRY(copy_to_user(user_param, &parameters));
     return 0;
@@ -399,6 +399,9 @@ public:
     ErrorOr<FlatPtr> sys$msync(Userspace<void*>, size_t, int flags);
     ErrorOr<FlatPtr> sys$purge(int mode);
     ErrorOr<FlatPtr> sys$poll(Userspace<Syscall::SC_poll_params const*>);
+    ErrorOr<FlatPtr> sys$epoll_create(int flags);
+    ErrorOr<FlatPtr> sys$epoll_ctl(Userspace<Syscall::SC_epoll_ctl_params const*>);
+    ErrorOr<FlatPtr> sys$epoll_pwait(Userspace<Syscall::SC_epoll_pwait_params const*>);
     ErrorOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
     ErrorOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     ErrorOr<FlatPtr> sys$chdir(Userspace<char const*>, size_t);
@@ -436,6 +439,8 @@ public:
     ErrorOr<FlatPtr> sys$alarm(unsigned seconds);
     ErrorOr<FlatPtr> sys$faccessat(Userspace<Syscall::SC_faccessat_params const*>);
     ErrorOr<FlatPtr> sys$fcntl(int fd, int cmd, uintptr_t extra_arg);
+    ErrorOr<FlatPtr> sys$io_ring_create(u32 entries, int options);
+    ErrorOr<FlatPtr> sys$io_ring_enter(Userspace<Syscall::SC_io_ring_enter_params const*>);
     ErrorOr<FlatPtr> sys$ioctl(int fd, unsigned request, FlatPtr arg);
     ErrorOr<FlatPtr> sys$mkdir(int dirfd, Userspace<char const*> pathname, size_t path_length, mode_t mode);
     ErrorOr<FlatPtr> sys$times(Userspace<tms*>);
@@ -5,9 +5,11 @@
  */
 
 #include <AK/BuiltinWrappers.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
 #include <AK/ScopeGuard.h>
-#include <AK/Singleton.h>
 #include <AK/Time.h>
+#include <AK/Vector.h>
 #include <Kernel/Arch/TrapFrame.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Interrupts/InterruptDisabler.h>
@@ -32,6 +34,9 @@ static u32 time_slice_for(Thread const& thread)
     return 2;
 }
 
+// One load balancing period == 256ms (assuming 250 ticks/second)
+static constexpr u32 load_balance_interval = 64;
+
 READONLY_AFTER_INIT Thread* g_finalizer;
 READONLY_AFTER_INIT WaitQueue* g_finalizer_wait_queue;
 SpinlockProtected<bool, LockRank::None> g_finalizer_has_work;
@@ -45,9 +50,129 @@ struct ThreadReadyQueues {
     u32 mask {};
     static constexpr size_t count = sizeof(mask) * 8;
     Array<ThreadReadyQueue, count> queues;
+
+    Thread* first_runnable_thread_for(u32 cpu)
+    {
+        auto affinity_mask = 1u << cpu;
+        auto priority_mask = mask;
+        while (priority_mask != 0) {
+            auto priority = bit_scan_forward(priority_mask);
+            VERIFY(priority > 0);
+            auto& ready_queue = queues[--priority];
+            for (auto& thread : ready_queue.thread_list) {
+                VERIFY(thread.m_runnable_priority == (int)priority);
+                if (thread.is_active())
+                    continue;
+                if (!(thread.affinity() & affinity_mask))
+                    continue;
+                return &thread;
+            }
+            priority_mask &= ~(1u << priority);
+        }
+        return nullptr;
+    }
+
+    void append(Thread& thread, u32 cpu, u32 priority)
+    {
+        VERIFY(thread.m_runnable_priority < 0);
+        thread.m_runnable_priority = (int)priority;
+        AK::atomic_store(&thread.m_runnable_cpu, cpu, AK::MemoryOrder::memory_order_relaxed);
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        auto& ready_queue = queues[priority];
+        bool was_empty = ready_queue.thread_list.is_empty();
+        ready_queue.thread_list.append(thread);
+        if (was_empty)
+            mask |= (1u << priority);
+    }
+
+    void remove(Thread& thread)
+    {
+        auto priority = thread.m_runnable_priority;
+        VERIFY(mask & (1u << priority));
+        auto& ready_queue = queues[priority];
+        thread.m_runnable_priority = -1;
+        ready_queue.thread_list.remove(thread);
+        if (ready_queue.thread_list.is_empty())
+            mask &= ~(1u << priority);
+    }
 };
 
-static Singleton<RecursiveSpinlockProtected<ThreadReadyQueues, LockRank::None>> g_ready_queues;
+// Every processor picks threads from its own ready queues. Threads are queued on the processor
+// they last ran on unless another processor they may run on is less busy, idle processors steal
+// threads from busy ones, and every processor periodically pulls over threads from the busiest one.
+// NOTE: A thread's place in the ready queues (m_runnable_cpu and m_runnable_priority) only changes
+//       while the ready queues it is put on or taken from are locked. Picking the next thread and
+//       changing thread states still happen with g_scheduler_lock held, as it also protects the
+//       states themselves and is held across context switches.
+struct SchedulerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Scheduler; }
+
+    // The number of threads that are waiting for, or running on, this processor.
+    u32 load() const
+    {
+        return ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed) + (is_idle.load(AK::MemoryOrder::memory_order_relaxed) ? 0 : 1);
+    }
+
+    Thread* peek_runnable_thread_for(u32 cpu)
+    {
+        return ready_queues.with([&](auto& queues) {
+            return queues.first_runnable_thread_for(cpu);
+        });
+    }
+
+    Thread* take_runnable_thread_for(u32 cpu)
+    {
+        return ready_queues.with([&](auto& queues) -> Thread* {
+            auto* thread = queues.first_runnable_thread_for(cpu);
+            if (!thread)
+                return nullptr;
+            queues.remove(*thread);
+            ready_thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+            return thread;
+        });
+    }
+
+    void append(Thread& thread, u32 cpu, u32 priority)
+    {
+        ready_queues.with([&](auto& queues) {
+            queues.append(thread, cpu, priority);
+            ready_thread_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        });
+    }
+
+    enum class RemoveResult {
+        Removed,
+        NotQueued,
+        QueuedElsewhere,
+    };
+
+    // The thread may be moved to another processor's ready queues until we hold the lock for ours,
+    // so we can only tell whether it is still queued here once we have it.
+    RemoveResult remove_if_queued_on(Thread& thread, u32 cpu)
+    {
+        return ready_queues.with([&](auto& queues) {
+            if (thread.m_runnable_cpu != cpu)
+                return RemoveResult::QueuedElsewhere;
+            if (thread.m_runnable_priority < 0) {
+                VERIFY(!thread.m_ready_queue_node.is_in_list());
+                return RemoveResult::NotQueued;
+            }
+            queues.remove(thread);
+            ready_thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+            return RemoveResult::Removed;
+        });
+    }
+
+    RecursiveSpinlockProtected<ThreadReadyQueues, LockRank::None> ready_queues {};
+    Atomic<u32> ready_thread_count { 0 };
+    Atomic<bool> is_idle { true };
+    Atomic<u64> migrations { 0 };
+    Atomic<u64> steals { 0 };
+    u32 ticks_until_load_balance { load_balance_interval };
+};
+
+// Set for every processor once its SchedulerProcessorData has been created.
+static Atomic<u32> s_online_processors { 0 };
 
 static RecursiveSpinlockProtected<TotalTimeScheduled, LockRank::None> g_total_time_scheduled {};
 
@@ -56,7 +181,7 @@ static void dump_thread_list(bool = false);
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into ThreadReadyQueues::queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -65,74 +190,187 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static SchedulerProcessorData& processor_data_for(u32 cpu)
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    if (cpu == Processor::current_id())
+        return ProcessorSpecific<SchedulerProcessorData>::get();
+    VERIFY(s_online_processors.load(AK::MemoryOrder::memory_order_acquire) & (1u << cpu));
+    return *Processor::by_id(cpu).get_specific<SchedulerProcessorData>();
+}
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                thread.m_runnable_priority = -1;
-                ready_queue.thread_list.remove(thread);
-                if (ready_queue.thread_list.is_empty())
-                    ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
-            }
-            priority_mask &= ~(1u << priority);
+template<typename Callback>
+static void for_each_online_processor(u32 processor_mask, Callback callback)
+{
+    processor_mask &= s_online_processors.load(AK::MemoryOrder::memory_order_acquire);
+    while (processor_mask != 0) {
+        auto cpu = bit_scan_forward(processor_mask) - 1;
+        processor_mask &= ~(1u << cpu);
+        callback(cpu, processor_data_for(cpu));
+    }
+}
+
+static void initialize_processor_data()
+{
+    auto cpu = Processor::current_id();
+    if (s_online_processors.load(AK::MemoryOrder::memory_order_acquire) & (1u << cpu))
+        return;
+    ProcessorSpecific<SchedulerProcessorData>::initialize();
+    s_online_processors.fetch_or(1u << cpu, AK::MemoryOrder::memory_order_acq_rel);
+}
+
+static u32 select_processor_for(Thread const& thread)
+{
+    auto current_cpu = Processor::current_id();
+    auto candidates = thread.affinity() & s_online_processors.load(AK::MemoryOrder::memory_order_acquire);
+    if (candidates == 0) {
+        // None of the processors this thread may run on have entered the scheduler yet.
+        // Keep it on our queue until one of them comes up and steals it.
+        return current_cpu;
+    }
+
+    // Stay on the previous processor to keep its caches warm, unless another one is less busy.
+    Optional<u32> best_cpu;
+    u32 best_load = NumericLimits<u32>::max();
+    auto previous_cpu = thread.cpu();
+    if (candidates & (1u << previous_cpu)) {
+        best_cpu = previous_cpu;
+        best_load = processor_data_for(previous_cpu).load();
+    }
+    for_each_online_processor(candidates, [&](u32 cpu, SchedulerProcessorData& processor_data) {
+        auto load = processor_data.load();
+        if (load < best_load) {
+            best_cpu = cpu;
+            best_load = load;
         }
+    });
+    return best_cpu.value();
+}
 
-        auto* idle_thread = Processor::idle_thread();
-        idle_thread->set_active(true);
-        return *idle_thread;
+// Moves a thread that may run on `to_cpu` over from the ready queues of `from_cpu`.
+// Both ready queues are locked at once (in a fixed order, so that processors moving threads in
+// opposite directions can't deadlock), which means that the thread never appears to be unqueued.
+static Thread* migrate_runnable_thread(u32 from_cpu, u32 to_cpu)
+{
+    auto& from_processor_data = processor_data_for(from_cpu);
+    auto& to_processor_data = processor_data_for(to_cpu);
+
+    auto migrate = [&](ThreadReadyQueues& from_queues, ThreadReadyQueues& to_queues) -> Thread* {
+        auto* thread = from_queues.first_runnable_thread_for(to_cpu);
+        if (!thread)
+            return nullptr;
+        from_queues.remove(*thread);
+        from_processor_data.ready_thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+        to_queues.append(*thread, to_cpu, thread_priority_to_priority_index(thread->priority()));
+        to_processor_data.ready_thread_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return thread;
+    };
+
+    if (from_cpu < to_cpu) {
+        return from_processor_data.ready_queues.with([&](auto& from_queues) {
+            return to_processor_data.ready_queues.with([&](auto& to_queues) { return migrate(from_queues, to_queues); });
+        });
+    }
+    return to_processor_data.ready_queues.with([&](auto& to_queues) {
+        return from_processor_data.ready_queues.with([&](auto& from_queues) { return migrate(from_queues, to_queues); });
     });
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+static Thread* steal_runnable_thread(u32 cpu)
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    // NOTE: The stolen thread is in no ready queue until we have switched to it. This is fine, as
+    //       nobody can change its state in the meantime: We are called with g_scheduler_lock held.
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                return &thread;
+    // Try the processors with the most waiting threads first.
+    auto victims = ~(1u << cpu);
+    for (;;) {
+        Optional<u32> busiest_cpu;
+        u32 busiest_count = 0;
+        for_each_online_processor(victims, [&](u32 victim_cpu, SchedulerProcessorData& processor_data) {
+            auto count = processor_data.ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+            if (count > busiest_count) {
+                busiest_cpu = victim_cpu;
+                busiest_count = count;
             }
-            priority_mask &= ~(1u << priority);
+        });
+        if (!busiest_cpu.has_value())
+            return nullptr;
+        if (auto* thread = processor_data_for(*busiest_cpu).take_runnable_thread_for(cpu)) {
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", cpu, *thread, *busiest_cpu);
+            return thread;
         }
+        victims &= ~(1u << *busiest_cpu);
+    }
+}
 
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
-        return nullptr;
+static void balance_load()
+{
+    // This only needs the locks of the ready queues involved, so it doesn't hold up other processors
+    // that are picking their next thread or changing thread states.
+    auto cpu = Processor::current_id();
+    auto& processor_data = ProcessorSpecific<SchedulerProcessorData>::get();
+
+    Optional<u32> busiest_cpu;
+    u32 busiest_load = 0;
+    for_each_online_processor(~(1u << cpu), [&](u32 other_cpu, SchedulerProcessorData& other_processor_data) {
+        auto load = other_processor_data.load();
+        if (load > busiest_load) {
+            busiest_cpu = other_cpu;
+            busiest_load = load;
+        }
     });
+    if (!busiest_cpu.has_value())
+        return;
+
+    // Pull threads over until we are at most one thread apart.
+    auto load = processor_data.load();
+    while (busiest_load > load + 1) {
+        auto* thread = migrate_runnable_thread(*busiest_cpu, cpu);
+        if (!thread)
+            break;
+        processor_data.migrations.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Pulled {} over from processor {}", cpu, *thread, *busiest_cpu);
+        --busiest_load;
+        ++load;
+    }
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto cpu = Processor::current_id();
+    auto& processor_data = ProcessorSpecific<SchedulerProcessorData>::get();
+
+    auto* thread = processor_data.take_runnable_thread_for(cpu);
+    if (!thread) {
+        thread = steal_runnable_thread(cpu);
+        if (thread)
+            processor_data.steals.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    }
+    if (!thread)
+        thread = Processor::idle_thread();
+    processor_data.is_idle.store(thread->is_idle_thread(), AK::MemoryOrder::memory_order_relaxed);
+
+    // Mark it as active because we are using this thread. This is similar
+    // to comparing it with Processor::current_thread, but when there are
+    // multiple processors there's no easy way to check whether the thread
+    // is actually still needed. This prevents accidental finalization when
+    // a thread is no longer in Running state, but running on another core.
+
+    // We need to mark it active here so that this thread won't be
+    // scheduled on another core if it were to be queued before actually
+    // switching to it.
+    // FIXME: Figure out a better way maybe?
+    thread->set_active(true);
+    return *thread;
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread, or to steal from other processors. We just want to see
+    // if we have any other thread ready to be scheduled.
+    auto cpu = Processor::current_id();
+    return ProcessorSpecific<SchedulerProcessorData>::get().peek_runnable_thread_for(cpu);
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
@@ -140,43 +378,68 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
-            VERIFY(!thread.m_ready_queue_node.is_in_list());
-            return false;
-        }
-
-        if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
-            return false;
+    if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
+        return false;
 
-        VERIFY(ready_queues.mask & (1u << priority));
-        auto& ready_queue = ready_queues.queues[priority];
-        thread.m_runnable_priority = -1;
-        ready_queue.thread_list.remove(thread);
-        if (ready_queue.thread_list.is_empty())
-            ready_queues.mask &= ~(1u << priority);
-        return true;
-    });
+    // NOTE: Load balancing may be moving the thread between ready queues without g_scheduler_lock,
+    //       so whether it's queued at all can only be checked with the right queues locked.
+    for (;;) {
+        auto cpu = AK::atomic_load(&thread.m_runnable_cpu, AK::MemoryOrder::memory_order_relaxed);
+        auto result = processor_data_for(cpu).remove_if_queued_on(thread, cpu);
+        if (result != SchedulerProcessorData::RemoveResult::QueuedElsewhere)
+            return result == SchedulerProcessorData::RemoveResult::Removed;
+    }
 }
 
 void Scheduler::enqueue_runnable_thread(Thread& thread)
 {
-    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
 
-    g_ready_queues->with([&](auto& ready_queues) {
-        VERIFY(thread.m_runnable_priority < 0);
-        thread.m_runnable_priority = (int)priority;
-        VERIFY(!thread.m_ready_queue_node.is_in_list());
-        auto& ready_queue = ready_queues.queues[priority];
-        bool was_empty = ready_queue.thread_list.is_empty();
-        ready_queue.thread_list.append(thread);
-        if (was_empty)
-            ready_queues.mask |= (1u << priority);
-    });
+    auto cpu = select_processor_for(thread);
+    auto& processor_data = processor_data_for(cpu);
+    if (cpu != thread.cpu() && thread.times_scheduled() > 0)
+        processor_data.migrations.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    processor_data.append(thread, cpu, priority);
+}
+
+void Scheduler::set_thread_affinity(Thread& thread, u32 affinity)
+{
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
+    thread.set_affinity(affinity);
+
+    // Move the thread over if it's waiting on a processor it may no longer run on.
+    auto runnable_cpu = AK::atomic_load(&thread.m_runnable_cpu, AK::MemoryOrder::memory_order_relaxed);
+    if (!(affinity & (1u << runnable_cpu)) && dequeue_runnable_thread(thread))
+        enqueue_runnable_thread(thread);
+}
+
+u32 Scheduler::online_processors()
+{
+    return s_online_processors.load(AK::MemoryOrder::memory_order_acquire);
+}
+
+ErrorOr<void> Scheduler::for_each_processor_statistics(Function<ErrorOr<void>(ProcessorSchedulingStatistics const&)> callback)
+{
+    Vector<ProcessorSchedulingStatistics, 32> statistics;
+    {
+        // Holding the scheduler lock gives us a consistent snapshot, and keeps us on this processor
+        // while we look at its data. The callback may block, so we only call it after letting go.
+        SpinlockLocker lock(g_scheduler_lock);
+        for_each_online_processor(NumericLimits<u32>::max(), [&](u32 cpu, SchedulerProcessorData& processor_data) {
+            statistics.unchecked_append({
+                .cpu = cpu,
+                .ready_threads = processor_data.ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed),
+                .idle = processor_data.is_idle.load(AK::MemoryOrder::memory_order_relaxed),
+                .migrations = processor_data.migrations.load(AK::MemoryOrder::memory_order_relaxed),
+                .steals = processor_data.steals.load(AK::MemoryOrder::memory_order_relaxed),
+            });
+        });
+    }
+    for (auto const& processor_statistics : statistics)
+        TRY(callback(processor_statistics));
+    return {};
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -377,6 +640,9 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
     VERIFY(Processor::is_initialized()); // sanity check
     VERIFY(TimeManagement::is_initialized());
 
+    // The colonel's thread is queued as soon as it's created, so our ready queues have to exist by then.
+    initialize_processor_data();
+
     g_finalizer_wait_queue = new WaitQueue;
 
     g_finalizer_has_work.with([](auto& has_work) {
@@ -392,6 +658,7 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
 UNMAP_AFTER_INIT void Scheduler::set_idle_thread(Thread* idle_thread)
 {
+    initialize_processor_data();
     idle_thread->set_idle_thread();
     Processor::current().set_idle_thread(*idle_thread);
     Processor::set_current_thread(*idle_thread);
@@ -445,10 +712,17 @@ void Scheduler::timer_tick()
         return;
     }
 
+    auto& processor_data = ProcessorSpecific<SchedulerProcessorData>::get();
+    if (--processor_data.ticks_until_load_balance == 0) {
+        processor_data.ticks_until_load_balance = load_balance_interval;
+        balance_load();
+    }
+
     if (current_thread->tick())
         return;
 
-    if (!current_thread->is_idle_thread() && !peek_next_runnable_thread()) {
+    bool may_keep_running = current_thread->affinity() & (1u << Processor::current_id());
+    if (!current_thread->is_idle_thread() && may_keep_running && !peek_next_runnable_thread()) {
         // If no other thread is ready to be scheduled we don't need to
         // switch to the idle thread. Just give the current thread another
         // time slice and let it run!
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Assertions.h>
+#include <AK/Error.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Types.h>
@@ -30,6 +31,14 @@ struct TotalTimeScheduled {
     u64 total_kernel { 0 };
 };
 
+struct ProcessorSchedulingStatistics {
+    u32 cpu { 0 };
+    u32 ready_threads { 0 };
+    bool idle { false };
+    u64 migrations { 0 };
+    u64 steals { 0 };
+};
+
 enum class [[nodiscard]] ShouldYield {
     Yes,
     No,
@@ -57,6 +66,9 @@ public:
     static Thread* peek_next_runnable_thread();
     static bool dequeue_runnable_thread(Thread&, bool = false);
     static void enqueue_runnable_thread(Thread&);
+    static void set_thread_affinity(Thread&, u32 affinity);
+    static u32 online_processors();
+    static ErrorOr<void> for_each_processor_statistics(Function<ErrorOr<void>(ProcessorSchedulingStatistics const&)>);
     static void dump_scheduler_state(bool = false);
     static bool is_initialized();
     static TotalTimeScheduled get_total_time_scheduled();
@@ -63,7 +63,9 @@ class Thread
     friend class Mutex;
     friend class Process;
     friend class Scheduler;
+    friend struct SchedulerProcessorData;
     friend struct ThreadReadyQueue;
+    friend struct ThreadReadyQueues;
 
 public:
     static Thread* current()
@@ -1096,6 +1098,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    u32 m_runnable_cpu { 0 };
 
     friend class DeprecatedWaitQueue;
 
@@ -14,11 +14,13 @@ namespace Kernel {
 
 WorkQueue* g_io_work;
 WorkQueue* g_ata_work;
+WorkQueue* g_read_ahead_work;
 
 UNMAP_AFTER_INIT void WorkQueue::initialize()
 {
     g_io_work = new WorkQueue("IO WorkQueue Task"sv);
     g_ata_work = new WorkQueue("ATA WorkQueue Task"sv);
+    g_read_ahead_work = new WorkQueue("Read-ahead WorkQueue Task"sv);
 }
 
 UNMAP_AFTER_INIT WorkQueue::WorkQueue(StringView name)
@@ -0,0 +1,59 @@
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+# Runs `wasm --benchmark` on every module of the WebAssembly spec testsuite, which runs each exported function on both
+# the interpreter and the JIT, and sums up the timings of the two tiers across the whole corpus.
+#
+# The modules are generated into Tests/Fixtures/SpecTests of the Lagom build directory when configuring Lagom with
+# -DINCLUDE_WASM_SPEC_TESTS=ON.
+
+if [ $# -lt 1 ] || [ $# -gt 2 ]; then
+    echo "Usage: $0 <spec test module directory> [wasm binary]"
+    exit 1
+fi
+
+MODULE_PATH="$1"
+WASM="${2:-wasm}"
+
+# How many times each exported function is run on each tier.
+: "${RUNS:=100}"
+# Modules that take longer than this (for example because a function loops forever without arguments) are skipped.
+: "${TIMEOUT_SECONDS:=10}"
+
+total_interpreter_us=0
+total_jit_us=0
+benchmarked_modules=0
+skipped_modules=0
+mismatching_modules=()
+
+for module in "$MODULE_PATH"/*.wasm; do
+    status=0
+    output=$(timeout "$TIMEOUT_SECONDS" "$WASM" --export-noop --benchmark "$RUNS" "$module" 2>&1) || status=$?
+
+    if grep -q "results of the interpreter and the jit differ" <<< "$output"; then
+        mismatching_modules+=("$(basename "$module")")
+    elif [ "$status" -ne 0 ]; then
+        # Modules that don't instantiate on their own (e.g. because they import memories or globals) can't be run.
+        skipped_modules=$((skipped_modules + 1))
+        continue
+    fi
+
+    timings=$(sed -nE 's/.*: interpreter ([0-9]+)us, jit ([0-9]+)us, speedup .*/\1 \2/p' <<< "$output" |\
+        awk '{ I += $1; J += $2 } END { print I + 0, J + 0 }')
+    read -r interpreter_us jit_us <<< "$timings"
+    total_interpreter_us=$((total_interpreter_us + interpreter_us))
+    total_jit_us=$((total_jit_us + jit_us))
+    benchmarked_modules=$((benchmarked_modules + 1))
+done
+
+echo "Benchmarked modules: ${benchmarked_modules} (${skipped_modules} skipped)"
+echo "Interpreter: ${total_interpreter_us}us"
+echo "JIT: ${total_jit_us}us"
+awk -v i="$total_interpreter_us" -v j="$total_jit_us" 'BEGIN { printf "Speedup: %.2fx\n", i / (j > 0 ? j : 1) }'
+
+if (( ${#mismatching_modules[@]} )); then
+    echo "Modules with results that differ between the interpreter and the JIT:"
+    printf '    %s\n' "${mismatching_modules[@]}"
+    exit 1
+fi
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Time.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+struct Pipe {
+    Pipe()
+    {
+        VERIFY(pipe(fds) == 0);
+    }
+
+    ~Pipe()
+    {
+        if (fds[0] >= 0)
+            close(fds[0]);
+        if (fds[1] >= 0)
+            close(fds[1]);
+    }
+
+    int read_fd() const { return fds[0]; }
+    int write_fd() const { return fds[1]; }
+
+    void write_byte() const { EXPECT_EQ(write(write_fd(), "x", 1), 1); }
+    void read_byte() const
+    {
+        char byte;
+        EXPECT_EQ(read(read_fd(), &byte, 1), 1);
+    }
+
+    int fds[2] { -1, -1 };
+};
+
+static int create_event_poll()
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    VERIFY(epoll_fd >= 0);
+    return epoll_fd;
+}
+
+static void add_watch(int epoll_fd, int fd, u32 events, u64 data)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.u64 = data;
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event), 0);
+}
+
+// Returns the number of events, which are expected to be for the given data and to include the given events.
+static int wait_for_events(int epoll_fd, int timeout, u32 expected_events = 0, u64 expected_data = 0)
+{
+    Array<epoll_event, 4> events {};
+    int count = epoll_wait(epoll_fd, events.data(), events.size(), timeout);
+    EXPECT(count >= 0);
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(events[i].events & expected_events, expected_events);
+        EXPECT_EQ(events[i].data.u64, expected_data);
+    }
+    return count;
+}
+
+TEST_CASE(level_triggered_watch_is_reported_until_drained)
+{
+    Pipe pipe;
+    int epoll_fd = create_event_poll();
+    add_watch(epoll_fd, pipe.read_fd(), EPOLLIN, 1);
+
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    pipe.write_byte();
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 1), 1);
+    // The pipe is still readable, so it is reported again.
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 1), 1);
+
+    pipe.read_byte();
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    close(epoll_fd);
+}
+
+TEST_CASE(edge_triggered_watch_is_reported_once_per_change)
+{
+    Pipe pipe;
+    int epoll_fd = create_event_poll();
+    add_watch(epoll_fd, pipe.read_fd(), EPOLLIN | EPOLLET, 2);
+
+    pipe.write_byte();
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 2), 1);
+    // The pipe is still readable, but nothing has changed since the last report.
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    // More data arriving re-arms the watch, even though the earlier data was never read.
+    pipe.write_byte();
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 2), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    close(epoll_fd);
+}
+
+TEST_CASE(one_shot_watch_is_rearmed_by_modify)
+{
+    Pipe pipe;
+    int epoll_fd = create_event_poll();
+    add_watch(epoll_fd, pipe.read_fd(), EPOLLIN | EPOLLONESHOT, 3);
+
+    pipe.write_byte();
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 3), 1);
+
+    // The watch stays disabled, no matter what happens to the pipe.
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+    pipe.write_byte();
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = 4;
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pipe.read_fd(), &event), 0);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 4), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    close(epoll_fd);
+}
+
+TEST_CASE(modify_and_delete_require_an_existing_watch)
+{
+    Pipe pipe;
+    int epoll_fd = create_event_poll();
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pipe.read_fd(), &event), -1);
+    EXPECT_EQ(errno, ENOENT);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe.read_fd(), nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    add_watch(epoll_fd, pipe.read_fd(), EPOLLIN, 5);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe.read_fd(), &event), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    pipe.write_byte();
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe.read_fd(), nullptr), 0);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    close(epoll_fd);
+}
+
+TEST_CASE(zero_timeout_does_not_block)
+{
+    Pipe pipe;
+    int epoll_fd = create_event_poll();
+    add_watch(epoll_fd, pipe.read_fd(), EPOLLIN, 6);
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    EXPECT((Duration::from_timespec(end) - Duration::from_timespec(start)).to_milliseconds() < 100);
+
+    // A positive timeout expires without any events.
+    EXPECT_EQ(wait_for_events(epoll_fd, 10), 0);
+
+    // Watches that are already ready when they are added are reported right away.
+    add_watch(epoll_fd, pipe.write_fd(), EPOLLOUT, 7);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLOUT, 7), 1);
+
+    close(epoll_fd);
+}
+
+TEST_CASE(closing_the_last_fd_removes_the_watch)
+{
+    Pipe pipe;
+    int epoll_fd = create_event_poll();
+
+    pipe.write_byte();
+    add_watch(epoll_fd, pipe.read_fd(), EPOLLIN, 8);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 8), 1);
+
+    // The file description is still open through the duplicate, so the watch stays.
+    int duplicate_fd = dup(pipe.read_fd());
+    EXPECT(duplicate_fd >= 0);
+    close(pipe.fds[0]);
+    pipe.fds[0] = -1;
+    EXPECT_EQ(wait_for_events(epoll_fd, 0, EPOLLIN, 8), 1);
+
+    // Closing the last fd destroys the file description, which removes the watch even though it's still ready.
+    close(duplicate_fd);
+    EXPECT_EQ(wait_for_events(epoll_fd, 0), 0);
+
+    close(epoll_fd);
+}
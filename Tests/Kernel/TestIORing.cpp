@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/IORing.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <serenity.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static Vector<IORingCompletion> reap_completions(Core::IORing& ring)
+{
+    Vector<IORingCompletion> completions;
+    ring.for_each_completion([&](auto& completion) { completions.append(completion); });
+    return completions;
+}
+
+TEST_CASE(nop)
+{
+    auto ring = MUST(Core::IORing::create(8));
+    MUST(ring->queue_nop(1));
+    MUST(ring->queue_nop(2));
+    EXPECT_EQ(MUST(ring->submit(2)), 2u);
+
+    auto completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 2u);
+    EXPECT_EQ(completions[0].user_data, 1u);
+    EXPECT_EQ(completions[0].result, 0);
+    EXPECT_EQ(completions[1].user_data, 2u);
+    EXPECT_EQ(completions[1].result, 0);
+}
+
+TEST_CASE(write_and_read_pipe)
+{
+    auto ring = MUST(Core::IORing::create(8));
+    auto pipe = MUST(Core::System::pipe2(0));
+
+    auto message = "Well hello friends!"sv;
+    char buffer[64] {};
+    MUST(ring->queue_write(pipe[1], message.bytes(), IO_RING_CURRENT_OFFSET, 1));
+    MUST(ring->queue_read(pipe[0], { buffer, sizeof(buffer) }, IO_RING_CURRENT_OFFSET, 2));
+    EXPECT_EQ(MUST(ring->submit(2)), 2u);
+
+    auto completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 2u);
+    EXPECT_EQ(completions[0].user_data, 1u);
+    EXPECT_EQ(completions[0].result, static_cast<i64>(message.length()));
+    EXPECT_EQ(completions[1].user_data, 2u);
+    EXPECT_EQ(completions[1].result, static_cast<i64>(message.length()));
+    EXPECT_EQ(StringView(buffer, message.length()), message);
+
+    MUST(Core::System::close(pipe[0]));
+    MUST(Core::System::close(pipe[1]));
+}
+
+TEST_CASE(pending_read_completes_when_data_arrives)
+{
+    auto ring = MUST(Core::IORing::create(8));
+    auto pipe = MUST(Core::System::pipe2(0));
+
+    char buffer[16] {};
+    MUST(ring->queue_read(pipe[0], { buffer, sizeof(buffer) }, IO_RING_CURRENT_OFFSET, 1));
+    EXPECT_EQ(MUST(ring->submit()), 1u);
+    // The pipe is empty, so the read has been consumed, but is still waiting for data.
+    EXPECT_EQ(ring->available_completion_count(), 0u);
+
+    auto pid = MUST(Core::System::fork());
+    if (pid == 0) {
+        usleep(100'000);
+        auto result = Core::System::write(pipe[1], "abc"sv.bytes());
+        _exit(result.is_error() ? 1 : 0);
+    }
+
+    // This has to wait for the child to write to the pipe.
+    EXPECT_EQ(MUST(ring->submit(1)), 0u);
+    auto completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 1u);
+    EXPECT_EQ(completions[0].user_data, 1u);
+    EXPECT_EQ(completions[0].result, 3);
+    EXPECT_EQ(StringView(buffer, 3), "abc"sv);
+
+    auto status = MUST(Core::System::waitpid(pid));
+    EXPECT(WIFEXITED(status.status));
+    EXPECT_EQ(WEXITSTATUS(status.status), 0);
+
+    MUST(Core::System::close(pipe[0]));
+    MUST(Core::System::close(pipe[1]));
+}
+
+TEST_CASE(bad_file_descriptors_complete_with_ebadf)
+{
+    auto ring = MUST(Core::IORing::create(8));
+    auto pipe = MUST(Core::System::pipe2(0));
+
+    char buffer[16] {};
+    MUST(ring->queue_read(-1, { buffer, sizeof(buffer) }, IO_RING_CURRENT_OFFSET, 1));
+    // The read end of a pipe can't be written to.
+    MUST(ring->queue_write(pipe[0], "abc"sv.bytes(), IO_RING_CURRENT_OFFSET, 2));
+    // Errors don't stop the submissions that follow.
+    MUST(ring->queue_nop(3));
+    EXPECT_EQ(MUST(ring->submit(3)), 3u);
+
+    auto completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 3u);
+    EXPECT_EQ(completions[0].user_data, 1u);
+    EXPECT_EQ(completions[0].result, -EBADF);
+    EXPECT_EQ(completions[1].user_data, 2u);
+    EXPECT_EQ(completions[1].result, -EBADF);
+    EXPECT_EQ(completions[2].user_data, 3u);
+    EXPECT_EQ(completions[2].result, 0);
+
+    MUST(Core::System::close(pipe[0]));
+    MUST(Core::System::close(pipe[1]));
+}
+
+TEST_CASE(min_complete_waits_until_timeout)
+{
+    auto ring = MUST(Core::IORing::create(8));
+    auto pipe = MUST(Core::System::pipe2(0));
+
+    char buffer[16] {};
+    MUST(ring->queue_read(pipe[0], { buffer, sizeof(buffer) }, IO_RING_CURRENT_OFFSET, 1));
+    MUST(ring->queue_nop(2));
+
+    // Only the nop can complete, so waiting for two completions has to time out.
+    auto timer = Core::ElapsedTimer::start_new();
+    EXPECT_EQ(MUST(ring->submit(2, Duration::from_milliseconds(100))), 2u);
+    EXPECT(timer.elapsed_time() >= Duration::from_milliseconds(90));
+
+    auto completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 1u);
+    EXPECT_EQ(completions[0].user_data, 2u);
+
+    // Waiting for a single completion returns as soon as it is there.
+    MUST(Core::System::write(pipe[1], "x"sv.bytes()));
+    timer = Core::ElapsedTimer::start_new();
+    EXPECT_EQ(MUST(ring->submit(1, Duration::from_seconds(10))), 0u);
+    EXPECT(timer.elapsed_time() < Duration::from_seconds(5));
+
+    completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 1u);
+    EXPECT_EQ(completions[0].user_data, 1u);
+    EXPECT_EQ(completions[0].result, 1);
+
+    MUST(Core::System::close(pipe[0]));
+    MUST(Core::System::close(pipe[1]));
+}
+
+TEST_CASE(only_the_creator_can_enter)
+{
+    auto ring = MUST(Core::IORing::create(8));
+    MUST(ring->queue_nop(1));
+
+    auto pid = MUST(Core::System::fork());
+    if (pid == 0) {
+        // The child has inherited the ring, but the submissions would refer to its parent's memory and fds.
+        auto result = Core::System::io_ring_enter(ring->fd(), 1, 0, nullptr);
+        _exit(result.is_error() && result.error().code() == EPERM ? 0 : 1);
+    }
+
+    auto status = MUST(Core::System::waitpid(pid));
+    EXPECT(WIFEXITED(status.status));
+    EXPECT_EQ(WEXITSTATUS(status.status), 0);
+
+    // The parent can still use it, and the child didn't consume the submission.
+    EXPECT_EQ(MUST(ring->submit(1)), 1u);
+    auto completions = reap_completions(*ring);
+    EXPECT_EQ(completions.size(), 1u);
+    EXPECT_EQ(completions[0].user_data, 1u);
+}
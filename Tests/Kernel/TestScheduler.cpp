@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <LibCore/File.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sched.h>
+
+static cpu_set_t current_affinity()
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    EXPECT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    return mask;
+}
+
+TEST_CASE(affinity_can_be_narrowed_to_each_processor)
+{
+    auto original_mask = current_affinity();
+    EXPECT(CPU_COUNT(&original_mask) > 0);
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &original_mask))
+            continue;
+
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        EXPECT_EQ(sched_setaffinity(0, sizeof(mask), &mask), 0);
+
+        // Give the scheduler a chance to move us over to the processor.
+        sched_yield();
+
+        auto new_mask = current_affinity();
+        EXPECT_EQ(CPU_COUNT(&new_mask), 1);
+        EXPECT(CPU_ISSET(cpu, &new_mask));
+    }
+
+    EXPECT_EQ(sched_setaffinity(0, sizeof(original_mask), &original_mask), 0);
+    auto restored_mask = current_affinity();
+    EXPECT_EQ(CPU_COUNT(&restored_mask), CPU_COUNT(&original_mask));
+}
+
+TEST_CASE(invalid_affinity_is_rejected)
+{
+    auto original_mask = current_affinity();
+
+    cpu_set_t empty_mask;
+    CPU_ZERO(&empty_mask);
+    errno = 0;
+    EXPECT_EQ(sched_setaffinity(0, sizeof(empty_mask), &empty_mask), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    errno = 0;
+    EXPECT_EQ(sched_setaffinity(0, sizeof(original_mask) - 1, &original_mask), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    cpu_set_t mask;
+    errno = 0;
+    EXPECT_EQ(sched_getaffinity(0, sizeof(mask) - 1, &mask), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // Failed calls must leave the affinity untouched.
+    auto mask_after = current_affinity();
+    EXPECT_EQ(CPU_COUNT(&mask_after), CPU_COUNT(&original_mask));
+}
+
+TEST_CASE(scheduler_statistics_cover_every_processor)
+{
+    auto file = MUST(Core::File::open("/sys/kernel/scheduler"sv, Core::File::OpenMode::Read));
+    auto file_contents = MUST(file->read_until_eof());
+    auto json = MUST(JsonValue::from_string(file_contents));
+    EXPECT(json.is_array());
+
+    auto online_mask = current_affinity();
+    auto& processors = json.as_array();
+    EXPECT(processors.size() > 0);
+    EXPECT(processors.size() >= static_cast<size_t>(CPU_COUNT(&online_mask)));
+
+    processors.for_each([](JsonValue const& value) {
+        EXPECT(value.is_object());
+        auto const& processor = value.as_object();
+        for (auto key : { "cpu"sv, "ready_threads"sv, "idle"sv, "migrations"sv, "steals"sv })
+            EXPECT(processor.has(key));
+    });
+}
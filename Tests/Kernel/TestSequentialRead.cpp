@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <AK/Vector.h>
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// NOTE: /tmp is a RAMFS, so this has to live on the (Ext2) root file system to go through the block cache and read-ahead.
+static constexpr auto TEST_FILE_PATH = "/home/anon/.sequential_read_test";
+static constexpr size_t file_size = 8 * MiB;
+
+static u8 pattern_byte(size_t offset)
+{
+    // Mix in the block number, so that blocks that end up in the wrong place are noticed.
+    return static_cast<u8>((offset * 7) ^ (offset >> 12));
+}
+
+static void write_pattern(int fd)
+{
+    Vector<u8> buffer;
+    buffer.resize(64 * KiB);
+    for (size_t offset = 0; offset < file_size; offset += buffer.size()) {
+        for (size_t i = 0; i < buffer.size(); ++i)
+            buffer[i] = pattern_byte(offset + i);
+        VERIFY(write(fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size()));
+    }
+    EXPECT_EQ(fsync(fd), 0);
+    sync();
+}
+
+static void read_and_verify(int fd, size_t chunk_size)
+{
+    VERIFY(lseek(fd, 0, SEEK_SET) == 0);
+
+    Vector<u8> buffer;
+    buffer.resize(chunk_size);
+    size_t offset = 0;
+    while (offset < file_size) {
+        auto nread = read(fd, buffer.data(), buffer.size());
+        VERIFY(nread > 0);
+        for (ssize_t i = 0; i < nread; ++i) {
+            if (buffer[i] != pattern_byte(offset + i)) {
+                FAIL(ByteString::formatted("Mismatch at offset {} when reading in chunks of {} bytes", offset + i, chunk_size));
+                return;
+            }
+        }
+        offset += nread;
+    }
+    EXPECT_EQ(offset, file_size);
+    EXPECT_EQ(read(fd, buffer.data(), buffer.size()), 0);
+}
+
+TEST_CASE(sequential_reads_return_the_written_data)
+{
+    auto fd = open(TEST_FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    VERIFY(fd != -1);
+    auto cleanup_guard = ScopeGuard([&] {
+        close(fd);
+        unlink(TEST_FILE_PATH);
+    });
+
+    write_pattern(fd);
+
+    // Chunk sizes that are smaller than, equal to, larger than and not aligned to the read-ahead window.
+    for (size_t chunk_size : { 512uz, 4 * KiB, 16 * KiB, 100'000uz, 1 * MiB })
+        read_and_verify(fd, chunk_size);
+}
+
+TEST_CASE(interleaved_sequential_readers_return_the_written_data)
+{
+    auto fd = open(TEST_FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    VERIFY(fd != -1);
+    auto cleanup_guard = ScopeGuard([&] {
+        close(fd);
+        unlink(TEST_FILE_PATH);
+    });
+
+    write_pattern(fd);
+
+    // Each description keeps its own read-ahead state, so two readers at different offsets must not disturb each other.
+    auto first_fd = open(TEST_FILE_PATH, O_RDONLY);
+    VERIFY(first_fd != -1);
+    auto second_fd = open(TEST_FILE_PATH, O_RDONLY);
+    VERIFY(second_fd != -1);
+    auto readers_guard = ScopeGuard([&] {
+        close(first_fd);
+        close(second_fd);
+    });
+
+    static constexpr size_t chunk_size = 32 * KiB;
+    VERIFY(lseek(second_fd, file_size / 2, SEEK_SET) == static_cast<off_t>(file_size / 2));
+
+    Vector<u8> buffer;
+    buffer.resize(chunk_size);
+    auto read_chunk_and_verify = [&](int reader_fd, size_t offset) {
+        VERIFY(read(reader_fd, buffer.data(), chunk_size) == static_cast<ssize_t>(chunk_size));
+        for (size_t i = 0; i < chunk_size; ++i) {
+            if (buffer[i] != pattern_byte(offset + i)) {
+                FAIL(ByteString::formatted("Mismatch at offset {}", offset + i));
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (size_t offset = 0; offset < file_size / 2; offset += chunk_size) {
+        if (!read_chunk_and_verify(first_fd, offset))
+            return;
+        if (!read_chunk_and_verify(second_fd, file_size / 2 + offset))
+            return;
+    }
+}
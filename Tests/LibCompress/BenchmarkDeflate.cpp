@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/Format.h>
+#include <AK/Time.h>
+#include <LibCompress/Deflate.h>
+
+// A deterministic corpus that looks roughly like the data we inflate the most: text with a limited vocabulary
+// (HTML, JS, CSS), tables of small numbers (PNG scanlines, fonts), and some data that doesn't compress at all.
+static ByteBuffer make_corpus(size_t corpus_size)
+{
+    static constexpr Array words {
+        "the "sv, "of "sv, "and "sv, "<div class=\""sv, "\">"sv, "</div>\n"sv, "function "sv, "return "sv,
+        "const "sv, "this."sv, "length"sv, " = "sv, "; "sv, "{\n    "sv, "}\n"sv, "margin: 0;\n"sv
+    };
+
+    auto corpus = MUST(ByteBuffer::create_uninitialized(corpus_size));
+    u32 state = 0x2545f491;
+    auto next_random = [&] {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    size_t offset = 0;
+    while (offset < corpus_size) {
+        auto section_size = min<size_t>(64 * KiB + next_random() % (256 * KiB), corpus_size - offset);
+        auto section = corpus.bytes().slice(offset, section_size);
+        offset += section_size;
+
+        switch (next_random() % 4) {
+        case 0:
+        case 1:
+            for (size_t i = 0; i < section.size();) {
+                auto word = words[next_random() % words.size()];
+                auto length = min(word.length(), section.size() - i);
+                word.bytes().trim(length).copy_to(section.slice(i));
+                i += length;
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < section.size(); ++i)
+                section[i] = (i % 97) + (next_random() % 4);
+            break;
+        default:
+            for (auto& byte : section)
+                byte = next_random();
+            break;
+        }
+    }
+
+    return corpus;
+}
+
+static void benchmark_deflate(Compress::DeflateCompressor::CompressionLevel compression_level)
+{
+    // The slowest levels only compress a few MB per second, so this uses a smaller corpus than inflating.
+    static auto const corpus = make_corpus(4 * MiB);
+
+    auto start = MonotonicTime::now();
+    auto compressed = MUST(Compress::DeflateCompressor::compress_all(corpus, compression_level));
+    auto elapsed = MonotonicTime::now() - start;
+
+    auto decompressed = MUST(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(decompressed == corpus);
+
+    auto elapsed_microseconds = max<i64>(elapsed.to_microseconds(), 1);
+    outln("Deflated {} MiB to {} KiB (ratio {:.3}) in {} ms: {} MB/s", corpus.size() / MiB, compressed.size() / KiB,
+        static_cast<double>(compressed.size()) / corpus.size(), elapsed.to_milliseconds(), corpus.size() / elapsed_microseconds);
+}
+
+BENCHMARK_CASE(deflate_fastest)
+{
+    benchmark_deflate(Compress::DeflateCompressor::CompressionLevel::FASTEST);
+}
+
+BENCHMARK_CASE(deflate_fast)
+{
+    benchmark_deflate(Compress::DeflateCompressor::CompressionLevel::FAST);
+}
+
+BENCHMARK_CASE(deflate_good)
+{
+    benchmark_deflate(Compress::DeflateCompressor::CompressionLevel::GOOD);
+}
+
+BENCHMARK_CASE(deflate_great)
+{
+    benchmark_deflate(Compress::DeflateCompressor::CompressionLevel::GREAT);
+}
+
+BENCHMARK_CASE(deflate_optimal)
+{
+    benchmark_deflate(Compress::DeflateCompressor::CompressionLevel::OPTIMAL);
+}
+
+static void benchmark_inflate(Compress::DeflateCompressor::CompressionLevel compression_level)
+{
+    static auto const corpus = make_corpus(32 * MiB);
+    auto compressed = MUST(Compress::DeflateCompressor::compress_all(corpus, compression_level));
+
+    auto start = MonotonicTime::now();
+    auto decompressed = MUST(Compress::DeflateDecompressor::decompress_all(compressed));
+    auto elapsed = MonotonicTime::now() - start;
+
+    EXPECT(decompressed == corpus);
+
+    auto elapsed_microseconds = max<i64>(elapsed.to_microseconds(), 1);
+    outln("Inflated {} MiB (from {} MiB) in {} ms: {} MB/s", corpus.size() / MiB, compressed.size() / MiB,
+        elapsed.to_milliseconds(), corpus.size() / elapsed_microseconds);
+}
+
+BENCHMARK_CASE(inflate_fast)
+{
+    benchmark_inflate(Compress::DeflateCompressor::CompressionLevel::FAST);
+}
+
+BENCHMARK_CASE(inflate_good)
+{
+    benchmark_inflate(Compress::DeflateCompressor::CompressionLevel::GOOD);
+}
+
+BENCHMARK_CASE(inflate_store)
+{
+    benchmark_inflate(Compress::DeflateCompressor::CompressionLevel::STORE);
+}
@@ -10,6 +10,7 @@
 #include <AK/BitStream.h>
 #include <AK/MemoryStream.h>
 #include <AK/Random.h>
+#include <AK/StringBuilder.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/File.h>
 #include <cstring>
@@ -126,6 +127,19 @@ TEST_CASE(deflate_decompress_zeroes)
     EXPECT(uncompressed == decompressed.bytes());
 }
 
+TEST_CASE(deflate_decompress_code_at_end_of_stream)
+{
+    // A fixed Huffman block with six 9-bit literals, whose 7-bit end-of-block code ends right at the last bit of the stream.
+    Array<u8, 8> const compressed {
+        0xfb, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01
+    };
+
+    Array<u8, 6> const uncompressed { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+    auto const decompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == decompressed.bytes());
+}
+
 TEST_CASE(deflate_round_trip_store)
 {
     auto original = ByteBuffer::create_uninitialized(1024).release_value();
@@ -156,6 +170,63 @@ TEST_CASE(deflate_round_trip_compress_large)
     EXPECT(uncompressed == original);
 }
 
+TEST_CASE(deflate_round_trip_overlapping_back_references)
+{
+    // Runs of short patterns make for back references whose source overlaps their destination, and the output is
+    // larger than the decompressor's output window, so the window has to move along while decoding.
+    auto original = TRY_OR_FAIL(ByteBuffer::create_uninitialized(512 * KiB));
+    Array<u8, 16> pattern;
+    size_t offset = 0;
+    while (offset < original.size()) {
+        fill_with_random(pattern);
+        auto pattern_length = 1 + pattern[0] % pattern.size();
+        auto run_length = min<size_t>(pattern[1] * 8, original.size() - offset);
+        for (size_t i = 0; i < run_length; ++i)
+            original[offset + i] = pattern[i % pattern_length];
+        offset += run_length;
+    }
+
+    auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST));
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == original);
+
+    // Reading a few bytes at a time must not make a difference.
+    FixedMemoryStream memory_stream { compressed.bytes() };
+    LittleEndianInputBitStream bit_stream { MaybeOwned<Stream>(memory_stream) };
+    auto deflate_stream = TRY_OR_FAIL(Compress::DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(bit_stream)));
+    ByteBuffer uncompressed_in_pieces;
+    Array<u8, 7> buffer;
+    while (!deflate_stream->is_eof())
+        TRY_OR_FAIL(uncompressed_in_pieces.try_append(TRY_OR_FAIL(deflate_stream->read_some(buffer))));
+    EXPECT(uncompressed_in_pieces == original);
+}
+
+TEST_CASE(deflate_round_trip_all_levels)
+{
+    // Text with a small vocabulary, so that there are plenty of matches for every parser to choose from.
+    Array words { "deflate "sv, "inflate "sv, "stream "sv, "block "sv, "huffman "sv, "literal "sv, "length "sv, "distance "sv };
+    Array<u8, 4096> choices;
+    fill_with_random(choices);
+    StringBuilder builder;
+    for (size_t i = 0; i < 64 * KiB; ++i)
+        builder.append(words[choices[i % choices.size()] % words.size()]);
+    auto original = TRY_OR_FAIL(builder.to_byte_buffer());
+
+    Optional<size_t> fastest_size;
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::FASTEST, Compress::DeflateCompressor::CompressionLevel::FAST,
+             Compress::DeflateCompressor::CompressionLevel::GOOD, Compress::DeflateCompressor::CompressionLevel::GREAT,
+             Compress::DeflateCompressor::CompressionLevel::OPTIMAL }) {
+        auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original, level));
+        auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+        EXPECT(uncompressed == original);
+
+        if (!fastest_size.has_value())
+            fastest_size = compressed.size();
+        else
+            EXPECT(compressed.size() <= fastest_size.value());
+    }
+}
+
 TEST_CASE(deflate_compress_literals)
 {
     // This byte array is known to not produce any back references with our lz77 implementation even at the highest compression settings
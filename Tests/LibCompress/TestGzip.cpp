@@ -7,6 +7,7 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/Array.h>
+#include <AK/MemoryStream.h>
 #include <AK/Random.h>
 #include <LibCompress/Gzip.h>
 
@@ -105,3 +106,45 @@ TEST_CASE(gzip_truncated_uncompressed_block)
     auto const decompressed_or_error = Compress::GzipDecompressor::decompress_all(compressed);
     EXPECT(decompressed_or_error.is_error());
 }
+
+TEST_CASE(gzip_parallel_round_trip)
+{
+    auto chunk_size = Compress::ParallelGzipCompressor::chunk_size;
+    Array<size_t, 5> const sizes { 0, 1, 1000, chunk_size, 5 * chunk_size + 123 };
+    Array<size_t, 2> const thread_counts { 1, 4 };
+
+    // Repeat a short random pattern, so that there are back references across the chunk boundaries.
+    Array<u8, 4096> pattern;
+    fill_with_random(pattern.span());
+
+    for (auto size : sizes) {
+        auto original = TRY_OR_FAIL(ByteBuffer::create_uninitialized(size));
+        for (size_t i = 0; i < size; ++i)
+            original[i] = pattern[i % pattern.size()] ^ (i % 7919 == 0 ? 0xff : 0);
+
+        for (auto thread_count : thread_counts) {
+            auto compressed = TRY_OR_FAIL(Compress::ParallelGzipCompressor::compress_all(original, thread_count));
+            auto uncompressed = TRY_OR_FAIL(Compress::GzipDecompressor::decompress_all(compressed));
+            EXPECT(uncompressed == original);
+
+            // Everything is written as a single member, so its trailer has to cover all of the input.
+            FixedMemoryStream trailer { compressed.span().slice_from_end(8) };
+            EXPECT_EQ(TRY_OR_FAIL(trailer.read_value<LittleEndian<u32>>()), Crypto::Checksum::CRC32 { original }.digest());
+            EXPECT_EQ(TRY_OR_FAIL(trailer.read_value<LittleEndian<u32>>()), size);
+        }
+    }
+}
+
+TEST_CASE(gzip_parallel_write_error)
+{
+    // The output only has room for the header, so writing the first batch fails.
+    Array<u8, 16> output_buffer;
+    FixedMemoryStream output_stream { output_buffer.span() };
+    auto compressor = TRY_OR_FAIL(Compress::ParallelGzipCompressor::create(MaybeOwned<Stream>(output_stream), 2));
+
+    auto input = TRY_OR_FAIL(ByteBuffer::create_uninitialized(2 * Compress::ParallelGzipCompressor::chunk_size));
+    fill_with_random(input.span());
+    EXPECT(compressor->write_until_depleted(input).is_error());
+
+    // The compressor is given up on without calling finish(), which must not crash.
+}
@@ -465,3 +465,44 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_GCM_128bit_encrypt_with_unaligned_aad)
+{
+    // Test case 4 from "The Galois/Counter Mode of Operation (GCM)".
+    Crypto::Cipher::AESCipher::GCMMode cipher("\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08"_b, 128, Crypto::Cipher::Intent::Encryption);
+    u8 result_tag[] { 0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47 };
+    u8 result_ct[] { 0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c, 0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e, 0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c, 0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05, 0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91 };
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto out = ByteBuffer::create_uninitialized(60).release_value();
+    auto out_bytes = out.bytes();
+    cipher.encrypt(
+        "\xd9\x31\x32\x25\xf8\x84\x06\xe5\xa5\x59\x09\xc5\xaf\xf5\x26\x9a\x86\xa7\xa9\x53\x15\x34\xf7\xda\x2e\x4c\x30\x3d\x8a\x31\x8a\x72\x1c\x3c\x0c\x95\x95\x68\x09\x53\x2f\xcf\x0e\x24\x49\xa6\xb5\x25\xb1\x6a\xed\xf5\xaa\x0d\xe6\x57\xba\x63\x7b\x39"_b,
+        out_bytes,
+        "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88\x00\x00\x00\x00"_b,
+        "\xfe\xed\xfa\xce\xde\xad\xbe\xef\xfe\xed\xfa\xce\xde\xad\xbe\xef\xab\xad\xda\xd2"_b,
+        tag);
+    EXPECT(memcmp(result_ct, out.data(), out.size()) == 0);
+    EXPECT(memcmp(result_tag, tag.data(), tag.size()) == 0);
+}
+
+TEST_CASE(test_AES_GCM_round_trip_many_blocks)
+{
+    // Long enough to go through the multi-block paths of AES and GHASH, and to end in a partial block.
+    auto plaintext = ByteBuffer::create_uninitialized(4 * KiB + 13).release_value();
+    for (size_t i = 0; i < plaintext.size(); ++i)
+        plaintext[i] = i * 7;
+    auto iv = "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88\xff\xff\xff\xf0"_b;
+    auto aad = "\xde\xad\xbe\xef\xfa\xaf\x11\xcc"_b;
+
+    Crypto::Cipher::AESCipher::GCMMode cipher("\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto ciphertext = ByteBuffer::create_uninitialized(plaintext.size()).release_value();
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    cipher.encrypt(plaintext, ciphertext.bytes(), iv, aad, tag);
+
+    auto decrypted = ByteBuffer::create_uninitialized(plaintext.size()).release_value();
+    EXPECT_EQ(cipher.decrypt(ciphertext, decrypted.bytes(), iv, aad, tag), Crypto::VerificationConsistency::Consistent);
+    EXPECT_EQ(decrypted, plaintext);
+
+    ciphertext[3000] ^= 1;
+    EXPECT_EQ(cipher.decrypt(ciphertext, decrypted.bytes(), iv, aad, tag), Crypto::VerificationConsistency::Inconsistent);
+}
@@ -335,6 +335,64 @@ TEST_CASE(test_bigint_modular_power_extra_tests)
     }
 }
 
+TEST_CASE(test_bigint_large_multiplication)
+{
+    // Large enough to go through Karatsuba, checked with the identities F(2n) = F(n) * (2 * F(n + 1) - F(n)) and F(2n + 1) = F(n)^2 + F(n + 1)^2.
+    auto fibonacci_n = bigint_fibonacci(4000);
+    auto fibonacci_n_plus_1 = bigint_fibonacci(4001);
+
+    auto fibonacci_2n = fibonacci_n.multiplied_by(fibonacci_n_plus_1.shift_left(1).minus(fibonacci_n));
+    EXPECT_EQ(fibonacci_2n, bigint_fibonacci(8000));
+
+    auto fibonacci_2n_plus_1 = fibonacci_n.multiplied_by(fibonacci_n).plus(fibonacci_n_plus_1.multiplied_by(fibonacci_n_plus_1));
+    EXPECT_EQ(fibonacci_2n_plus_1, bigint_fibonacci(8001));
+
+    // Operands of very different lengths.
+    auto fibonacci_small = bigint_fibonacci(1500);
+    auto product = fibonacci_2n.multiplied_by(fibonacci_small);
+    EXPECT_EQ(product.divided_by(fibonacci_small).quotient, fibonacci_2n);
+    EXPECT(product.divided_by(fibonacci_small).remainder.is_zero());
+}
+
+TEST_CASE(test_bigint_large_modular_power)
+{
+    // 2^2203 - 1 is a Mersenne prime, so by Fermat's little theorem 3^(p - 1) = 1 (mod p).
+    Crypto::UnsignedBigInteger one { 1 };
+    auto prime = one.shift_left(2203).minus(one);
+    auto result = Crypto::NumberTheory::ModularPower(3, prime.minus(one), prime);
+    EXPECT_EQ(result, one);
+
+    // And 3^p = 3 (mod p).
+    result = Crypto::NumberTheory::ModularPower(3, prime, prime);
+    EXPECT_EQ(result, 3);
+}
+
+static void benchmark_modular_power(size_t fibonacci_index)
+{
+    // Full-size exponents, like the ones used in RSA signing and Diffie-Hellman.
+    auto modulo = bigint_fibonacci(fibonacci_index);
+    modulo.set_bit_inplace(0);
+    auto exponent = bigint_fibonacci(fibonacci_index - 1);
+    auto base = bigint_fibonacci(fibonacci_index - 100);
+
+    for (size_t i = 0; i < 10; ++i) {
+        auto result = Crypto::NumberTheory::ModularPower(base, exponent, modulo);
+        AK::taint_for_optimizer(result);
+    }
+}
+
+BENCHMARK_CASE(modular_power_2048_bits)
+{
+    // F(2951) is 2048 bits long.
+    benchmark_modular_power(2951);
+}
+
+BENCHMARK_CASE(modular_power_4096_bits)
+{
+    // F(5901) is 4096 bits long.
+    benchmark_modular_power(5901);
+}
+
 TEST_CASE(test_bigint_primality_test)
 {
     struct {
@@ -66,6 +66,42 @@ TEST_CASE(test_crc32)
     do_test("various CRC algorithms input data"sv.bytes(), 0x9BD366AE);
 }
 
+TEST_CASE(test_checksums_of_all_lengths_and_alignments)
+{
+    // The vectorized implementations only handle whole blocks, so compare them against byte-at-a-time updates for
+    // every length and alignment around the block sizes, with and without a preceding update.
+    Array<u8, 1024> data;
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (i * 251) ^ (i >> 3);
+
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t length = 0; length < data.size() - offset; length += 7) {
+            auto input = data.span().slice(offset, length);
+
+            Crypto::Checksum::CRC32 crc32_bytewise;
+            Crypto::Checksum::Adler32 adler32_bytewise;
+            for (size_t i = 0; i < input.size(); ++i) {
+                crc32_bytewise.update(input.slice(i, 1));
+                adler32_bytewise.update(input.slice(i, 1));
+            }
+
+            EXPECT_EQ(Crypto::Checksum::CRC32(input).digest(), crc32_bytewise.digest());
+            EXPECT_EQ(Crypto::Checksum::Adler32(input).digest(), adler32_bytewise.digest());
+
+            Crypto::Checksum::CRC32 crc32_split(input.trim(offset));
+            crc32_split.update(input.slice(min(offset, input.size())));
+            EXPECT_EQ(crc32_split.digest(), crc32_bytewise.digest());
+        }
+    }
+}
+
+TEST_CASE(test_adler32_does_not_overflow)
+{
+    Array<u8, 65536> data;
+    data.fill(0xff);
+    EXPECT_EQ(Crypto::Checksum::Adler32(data).digest(), 0x77970ef2u);
+}
+
 TEST_CASE(test_ipv4header)
 {
     auto do_test = [](ReadonlyBytes input, u16 expected_result) {
@@ -225,6 +225,43 @@ TEST_CASE(test_secp256r1)
     EXPECT_EQ(expected_public_key, generated_public);
 }
 
+TEST_CASE(test_secp256r1_verify)
+{
+    // clang-format off
+    u8 hash_data[32] {
+        0xd5, 0xae, 0x47, 0xce, 0x75, 0x90, 0x1a, 0xc5, 0x26, 0xd3, 0xf8, 0x70, 0xfc, 0xe9, 0x7c, 0xf5,
+        0x52, 0x69, 0x6a, 0x58, 0x74, 0xcc, 0x70, 0xc0, 0x03, 0x8a, 0x4f, 0xaf, 0x18, 0x53, 0x19, 0xc2,
+    };
+
+    u8 public_key_data[65] {
+        0x04,
+        0xd4, 0x8e, 0x1a, 0xa0, 0x96, 0x1a, 0x84, 0x68, 0x2e, 0x48, 0x72, 0x63, 0xab, 0x83, 0x0a, 0x98,
+        0xd8, 0x7e, 0xbb, 0x69, 0x12, 0x2f, 0xa2, 0x98, 0x49, 0xf2, 0x8c, 0xba, 0xde, 0xba, 0xb9, 0xa8,
+        0x2f, 0x47, 0x66, 0xb3, 0x11, 0xed, 0x1e, 0xce, 0x3e, 0xb5, 0x7b, 0xcf, 0xd4, 0x5e, 0x9a, 0x78,
+        0x08, 0x0b, 0xac, 0x5a, 0x89, 0x5a, 0xb5, 0xa1, 0x74, 0x8a, 0x72, 0x74, 0x6d, 0xd2, 0x4a, 0xc3,
+    };
+
+    u8 signature_data[70] {
+        0x30, 0x44,
+        0x02, 0x20,
+        0x42, 0x55, 0x34, 0xcd, 0xf3, 0x07, 0x1f, 0xa6, 0x79, 0xea, 0x32, 0xd0, 0xa9, 0xfc, 0x55, 0x59,
+        0x0b, 0x49, 0xf1, 0xcc, 0xc7, 0x85, 0x0c, 0x22, 0x11, 0x2d, 0xf6, 0x1c, 0xc1, 0xa5, 0x25, 0x58,
+        0x02, 0x20,
+        0x5a, 0x56, 0xe9, 0x0b, 0x29, 0x4f, 0xf8, 0xd9, 0x7f, 0x3a, 0xd9, 0xf7, 0x72, 0x84, 0xf0, 0x96,
+        0xf7, 0xb9, 0x42, 0xbb, 0xfa, 0xa3, 0x8d, 0x74, 0x4e, 0xa8, 0x04, 0x23, 0xa9, 0x84, 0xdd, 0xd8,
+    };
+    // clang-format on
+
+    ReadonlyBytes public_key { public_key_data, 65 };
+    ReadonlyBytes signature { signature_data, 70 };
+
+    Crypto::Curves::SECP256r1 curve;
+    EXPECT_EQ(MUST(curve.verify({ hash_data, 32 }, public_key, signature)), true);
+
+    hash_data[0] ^= 1;
+    EXPECT_EQ(MUST(curve.verify({ hash_data, 32 }, public_key, signature)), false);
+}
+
 TEST_CASE(test_secp384r1)
 {
     // clang-format off
@@ -306,3 +343,45 @@ TEST_CASE(test_secp384r1)
     auto generated_public = MUST(curve.generate_public_key(private_key));
     EXPECT_EQ(expected_public_key.span(), generated_public);
 }
+
+TEST_CASE(test_secp384r1_verify)
+{
+    // clang-format off
+    u8 hash_data[48] {
+        0x9b, 0x1d, 0x31, 0x7e, 0x3d, 0xe3, 0xf3, 0x8e, 0x62, 0x48, 0x90, 0xec, 0x7d, 0xb8, 0xd3, 0x70,
+        0x29, 0xc7, 0xc9, 0xe7, 0x21, 0xdc, 0x43, 0x31, 0x8d, 0xee, 0xa1, 0xc6, 0x6d, 0xe1, 0xdd, 0xd2,
+        0xea, 0x2a, 0xb1, 0x93, 0xf5, 0xd5, 0x26, 0xf3, 0x81, 0x68, 0x40, 0x2c, 0xc4, 0x03, 0xbb, 0x56,
+    };
+
+    u8 public_key_data[97] {
+        0x04,
+        0x7f, 0x55, 0x3a, 0x40, 0xeb, 0x7f, 0x3f, 0xc0, 0x22, 0x59, 0x9f, 0xe2, 0x67, 0xea, 0x5d, 0xb6,
+        0x63, 0x04, 0x59, 0x27, 0x05, 0x6a, 0x1d, 0x15, 0x4a, 0x45, 0xd2, 0xbe, 0x9c, 0xbf, 0x04, 0xd0,
+        0x5d, 0xe4, 0xa3, 0xd0, 0x41, 0xc3, 0xd5, 0x02, 0x65, 0xe5, 0x4d, 0xbb, 0xc6, 0x32, 0xf3, 0x74,
+        0xf4, 0xa6, 0x96, 0xf9, 0x78, 0xb0, 0xda, 0xde, 0x37, 0x8d, 0x29, 0x4e, 0xae, 0x68, 0xcd, 0x37,
+        0xe8, 0x01, 0x05, 0xfe, 0x9d, 0x8f, 0xf1, 0xf3, 0xaa, 0x37, 0x33, 0xe3, 0x17, 0x14, 0x3f, 0x3a,
+        0xe1, 0xbb, 0xed, 0x18, 0xc5, 0xad, 0xdb, 0x9d, 0x86, 0x1a, 0x37, 0x6d, 0xea, 0xe7, 0xe9, 0x68,
+    };
+
+    u8 signature_data[102] {
+        0x30, 0x64,
+        0x02, 0x30,
+        0x12, 0xa7, 0x2e, 0xb0, 0xf8, 0x0f, 0x30, 0x66, 0x9d, 0xb9, 0xf5, 0x35, 0x3a, 0xa3, 0x71, 0x0c,
+        0xb6, 0x8a, 0x56, 0x02, 0x73, 0xad, 0xcb, 0x48, 0x4f, 0x64, 0x34, 0xb8, 0xfe, 0xc8, 0xf1, 0xf9,
+        0x44, 0x0c, 0x2c, 0x05, 0x59, 0x2d, 0x75, 0xb7, 0x04, 0xf5, 0x61, 0x2b, 0x49, 0x67, 0xf1, 0x72,
+        0x02, 0x30,
+        0x3f, 0x4a, 0x07, 0xb3, 0x09, 0xf2, 0x82, 0x13, 0x05, 0x31, 0x54, 0xe8, 0x12, 0x84, 0x16, 0x81,
+        0xeb, 0x30, 0xed, 0x32, 0x17, 0x1a, 0xe3, 0x21, 0x88, 0x49, 0x56, 0xc1, 0xc8, 0xa0, 0x67, 0xf7,
+        0xaf, 0x2b, 0x2d, 0xf9, 0x87, 0x74, 0x1b, 0x03, 0xa6, 0x03, 0x9c, 0xe8, 0x5e, 0x67, 0x7a, 0x48,
+    };
+    // clang-format on
+
+    ReadonlyBytes public_key { public_key_data, 97 };
+    ReadonlyBytes signature { signature_data, 102 };
+
+    Crypto::Curves::SECP384r1 curve;
+    EXPECT_EQ(MUST(curve.verify({ hash_data, 48 }, public_key, signature)), true);
+
+    hash_data[0] ^= 1;
+    EXPECT_EQ(MUST(curve.verify({ hash_data, 48 }, public_key, signature)), false);
+}
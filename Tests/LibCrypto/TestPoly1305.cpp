@@ -303,3 +303,34 @@ TEST_CASE(test_vector_11)
     auto expected = ReadonlyBytes { expected_result, 16 };
     EXPECT_EQ(result, expected);
 }
+
+TEST_CASE(empty_updates)
+{
+    u8 key[32] {
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    u8 message[48] {
+        0xE3, 0x35, 0x94, 0xD7, 0x50, 0x5E, 0x43, 0xB9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x33, 0x94, 0xD7, 0x50, 0x5E, 0x43, 0x79, 0xCD, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    u8 expected_result[16] {
+        0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    // Empty updates (which don't point anywhere) must not change the result, with or without a partial block.
+    Crypto::Authentication::Poly1305 mac(ReadonlyBytes { key, 32 });
+    mac.update({});
+    mac.update(ReadonlyBytes { message, 5 });
+    mac.update({});
+    mac.update(ReadonlyBytes { message + 5, 27 });
+    mac.update({});
+    mac.update(ReadonlyBytes { message + 32, 16 });
+    mac.update({});
+    auto result = MUST(mac.digest());
+    auto expected = ReadonlyBytes { expected_result, 16 };
+    EXPECT_EQ(result, expected);
+}
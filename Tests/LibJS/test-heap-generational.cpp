@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/WeakPtr.h>
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Heap/HeapBlock.h>
+#include <LibJS/Heap/MarkedVector.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Runtime/ValueInlines.h>
+#include <LibTest/TestCase.h>
+
+static bool is_young(JS::Cell const& cell)
+{
+    return JS::HeapBlock::from_cell(&cell)->is_nursery();
+}
+
+// Allocates enough objects to fill many blocks, and returns one that was promoted to the old generation along with them.
+static JS::Object& allocate_old_object(JS::Realm& realm, JS::MarkedVector<JS::Value>& objects)
+{
+    for (size_t i = 0; i < 10'000; ++i)
+        objects.append(JS::Object::create(realm, nullptr));
+    realm.heap().collect_garbage(JS::Heap::CollectionType::CollectYoungGeneration);
+    return objects[objects.size() / 2].as_object();
+}
+
+// NOTE: This is not inlined, so that the young array is only reachable through the old object once it returns.
+//       Arrays are allocated from their own blocks, so the young array doesn't end up in a block about to be promoted.
+static NEVER_INLINE WeakPtr<JS::Array> store_young_array(JS::Realm& realm, JS::Object& old_object)
+{
+    auto young_array = MUST(JS::Array::create(realm, 0));
+    old_object.define_direct_property(JS::PropertyKey("young"), young_array, JS::default_attributes);
+    return young_array->make_weak_ptr<JS::Array>();
+}
+
+static JS::Object* stored_young_array(JS::Object const& old_object)
+{
+    return &old_object.get_without_side_effects(JS::PropertyKey("young")).as_object();
+}
+
+TEST_CASE(young_objects_are_promoted)
+{
+    auto vm = MUST(JS::VM::create());
+    vm->heap().set_generational_collection_enabled(true);
+    auto execution_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& realm = *execution_context->realm;
+
+    JS::MarkedVector<JS::Value> objects(vm->heap());
+    auto& old_object = allocate_old_object(realm, objects);
+    EXPECT(!is_young(old_object));
+
+    // Newly allocated objects always start out young.
+    auto young_object = JS::Object::create(realm, nullptr);
+    EXPECT(is_young(*young_object));
+}
+
+TEST_CASE(old_to_young_references_survive_a_young_collection)
+{
+    auto vm = MUST(JS::VM::create());
+    auto& heap = vm->heap();
+    heap.set_generational_collection_enabled(true);
+    auto execution_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& realm = *execution_context->realm;
+
+    JS::MarkedVector<JS::Value> objects(heap);
+    auto& old_object = allocate_old_object(realm, objects);
+
+    // A full collection forgets every remembered cell, so it's up to the write barrier to remember the old object.
+    heap.collect_garbage(JS::Heap::CollectionType::CollectGarbage);
+    EXPECT(!is_young(old_object));
+    EXPECT(!old_object.is_remembered());
+
+    auto young_array = store_young_array(realm, old_object);
+    EXPECT(old_object.is_remembered());
+
+    for (size_t i = 0; i < 3; ++i) {
+        heap.collect_garbage(JS::Heap::CollectionType::CollectYoungGeneration);
+        EXPECT(young_array);
+        EXPECT(is_young(*young_array));
+        EXPECT(old_object.is_remembered());
+        EXPECT_EQ(stored_young_array(old_object), young_array.ptr());
+    }
+}
+
+TEST_CASE(old_to_young_references_are_found_again_after_a_full_collection)
+{
+    auto vm = MUST(JS::VM::create());
+    auto& heap = vm->heap();
+    heap.set_generational_collection_enabled(true);
+    auto execution_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& realm = *execution_context->realm;
+
+    JS::MarkedVector<JS::Value> objects(heap);
+    auto& old_object = allocate_old_object(realm, objects);
+    auto young_array = store_young_array(realm, old_object);
+
+    heap.collect_garbage(JS::Heap::CollectionType::CollectGarbage);
+    EXPECT(!old_object.is_remembered());
+    EXPECT_EQ(heap.remembered_cell_count(), 0u);
+
+    heap.collect_garbage(JS::Heap::CollectionType::CollectYoungGeneration);
+    EXPECT(young_array);
+    EXPECT(is_young(*young_array));
+    EXPECT(old_object.is_remembered());
+    EXPECT_EQ(stored_young_array(old_object), young_array.ptr());
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/WeakPtr.h>
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Heap/MarkedVector.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Runtime/ValueInlines.h>
+#include <LibTest/TestCase.h>
+
+static constexpr size_t object_count = 10'000;
+
+// NOTE: This is not inlined, so that the garbage objects are not reachable from the stack once it returns.
+static NEVER_INLINE Vector<WeakPtr<JS::Object>> allocate_garbage(JS::Realm& realm)
+{
+    Vector<WeakPtr<JS::Object>> garbage;
+    for (size_t i = 0; i < object_count; ++i)
+        garbage.append(JS::Object::create(realm, nullptr)->make_weak_ptr<JS::Object>());
+    return garbage;
+}
+
+static void allocate_live_objects(JS::Realm& realm, JS::MarkedVector<JS::Value>& objects)
+{
+    for (size_t i = 0; i < object_count; ++i) {
+        auto object = JS::Object::create(realm, nullptr);
+        object->define_direct_property(JS::PropertyKey("index"), JS::Value(i), JS::default_attributes);
+        objects.append(object);
+    }
+}
+
+TEST_CASE(dead_cells_are_swept_after_the_collection)
+{
+    auto vm = MUST(JS::VM::create());
+    auto& heap = vm->heap();
+    heap.set_incremental_sweeping_enabled(true);
+    auto execution_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& realm = *execution_context->realm;
+
+    auto garbage = allocate_garbage(realm);
+    heap.collect_garbage();
+
+    // Weak pointers to dead cells are revoked by the collection, even though the cells haven't been swept yet.
+    size_t revoked_count = 0;
+    for (auto& object : garbage) {
+        if (!object)
+            ++revoked_count;
+    }
+    EXPECT(revoked_count > object_count / 2);
+
+    EXPECT(!heap.sweep_pending_blocks(Duration::from_seconds(10)));
+    EXPECT(!heap.sweep_pending_blocks(Duration::from_seconds(10)));
+}
+
+TEST_CASE(live_cells_survive_incremental_sweeping)
+{
+    auto vm = MUST(JS::VM::create());
+    auto& heap = vm->heap();
+    heap.set_incremental_sweeping_enabled(true);
+    auto execution_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& realm = *execution_context->realm;
+
+    JS::MarkedVector<JS::Value> live_objects(heap);
+    allocate_garbage(realm);
+    allocate_live_objects(realm, live_objects);
+    allocate_garbage(realm);
+    heap.collect_garbage();
+
+    // Allocating sweeps pending blocks as it goes, and may reuse the cells of dead objects.
+    JS::MarkedVector<JS::Value> more_live_objects(heap);
+    allocate_live_objects(realm, more_live_objects);
+    heap.finish_sweeping();
+
+    for (size_t i = 0; i < object_count; ++i) {
+        EXPECT_EQ(live_objects[i].as_object().get_without_side_effects(JS::PropertyKey("index")), JS::Value(i));
+        EXPECT_EQ(more_live_objects[i].as_object().get_without_side_effects(JS::PropertyKey("index")), JS::Value(i));
+    }
+}
+
+TEST_CASE(dying_cells_are_not_visited_as_live_cells)
+{
+    auto vm = MUST(JS::VM::create());
+    auto& heap = vm->heap();
+    heap.set_incremental_sweeping_enabled(true);
+    auto execution_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& realm = *execution_context->realm;
+
+    allocate_garbage(realm);
+    heap.collect_garbage();
+
+    size_t visited_cell_count = 0;
+    heap.for_each_live_cell_of_type<JS::Object>([&](JS::Object& object) {
+        EXPECT(object.state() == JS::Cell::State::Live);
+        ++visited_cell_count;
+    });
+    EXPECT(visited_cell_count > 0);
+    EXPECT(!heap.sweep_pending_blocks(Duration::from_seconds(10)));
+}
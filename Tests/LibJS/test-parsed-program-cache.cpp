@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/ParsedProgramCache.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Runtime/ValueInlines.h>
+#include <LibJS/Script.h>
+#include <LibTest/TestCase.h>
+
+// Reads a global `let` binding, both at the top level and from inside a function, so that the bytecode for both ends up
+// with populated global variable caches.
+static constexpr auto shared_source = "function read_value() { return value; } read_value() + value;"sv;
+
+static JS::Value run(JS::VM& vm, JS::Realm& realm, StringView source)
+{
+    auto script = JS::Script::parse(source, realm, "shared.js"sv);
+    VERIFY(!script.is_error());
+    return MUST(vm.bytecode_interpreter().run(script.value()));
+}
+
+TEST_CASE(programs_are_shared_between_realms)
+{
+    auto vm = MUST(JS::VM::create());
+    vm->parsed_program_cache().set_source_size_budget(1 * MiB);
+
+    auto first_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto second_context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    auto& first_realm = *first_context->realm;
+    auto& second_realm = *second_context->realm;
+
+    run(*vm, first_realm, "let value = 1;"sv);
+    run(*vm, second_realm, "let value = 20;"sv);
+
+    // Run the shared script twice in the first realm, so its caches are warm and the second parse is a cache hit.
+    EXPECT_EQ(run(*vm, first_realm, shared_source).as_double(), 2);
+    EXPECT_EQ(run(*vm, first_realm, shared_source).as_double(), 2);
+    auto hit_count = vm->parsed_program_cache().hit_count();
+    EXPECT(hit_count > 0);
+
+    // The second realm reuses the Program, but has its own `value`, which it must see instead of the first realm's.
+    EXPECT_EQ(run(*vm, second_realm, shared_source).as_double(), 40);
+    EXPECT_EQ(run(*vm, second_realm, shared_source).as_double(), 40);
+    EXPECT_EQ(vm->parsed_program_cache().hit_count(), hit_count + 2);
+
+    EXPECT_EQ(run(*vm, first_realm, shared_source).as_double(), 2);
+}
+
+TEST_CASE(programs_outlive_their_realm)
+{
+    auto vm = MUST(JS::VM::create());
+    vm->parsed_program_cache().set_source_size_budget(1 * MiB);
+
+    {
+        auto context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+        run(*vm, *context->realm, "let value = 1;"sv);
+        EXPECT_EQ(run(*vm, *context->realm, shared_source).as_double(), 2);
+    }
+    vm->heap().collect_garbage();
+
+    // A new realm loading the same source, like a page being reloaded, gets the cached Program.
+    auto context = JS::create_simple_execution_context<JS::GlobalObject>(*vm);
+    run(*vm, *context->realm, "let value = 300;"sv);
+    auto hit_count = vm->parsed_program_cache().hit_count();
+    EXPECT_EQ(run(*vm, *context->realm, shared_source).as_double(), 600);
+    EXPECT_EQ(vm->parsed_program_cache().hit_count(), hit_count + 1);
+}
@@ -1218,3 +1218,141 @@ TEST_CASE(mismatching_brackets)
         EXPECT_EQ(re.parser_result.error, regex::Error::MismatchingBracket);
     }
 }
+
+TEST_CASE(lazy_dfa_eligibility)
+{
+    {
+        Regex<ECMA262> re("(a|b)*c\\b"sv);
+        EXPECT(re.parser_result.optimization_data.lazy_dfa);
+    }
+    {
+        // Backreferences can't be expressed as a finite automaton.
+        Regex<ECMA262> re("(a)\\1"sv);
+        EXPECT(!re.parser_result.optimization_data.lazy_dfa);
+    }
+    {
+        Regex<ECMA262> re("a(?=b)"sv);
+        EXPECT(!re.parser_result.optimization_data.lazy_dfa);
+    }
+}
+
+TEST_CASE(lazy_dfa_catastrophic_backtracking)
+{
+    // Without the DFA, the VM tries every way of splitting the input between the loops before giving up.
+    auto input = ByteString::repeated('a', 10'000);
+    Array patterns {
+        "(a*)*b"sv,
+        "(a|aa)*c"sv,
+        "(?:a+)+$b"sv,
+    };
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern, ECMAScriptFlags::Global);
+        EXPECT_EQ(re.match(input).success, false);
+
+        Regex<ECMA262> anchored_re(pattern);
+        EXPECT_EQ(anchored_re.match(input).success, false);
+    }
+}
+
+TEST_CASE(lazy_dfa_search)
+{
+    {
+        Regex<ECMA262> re("\\bfoo\\d+"sv, ECMAScriptFlags::Global);
+        auto result = re.match("foo1 xfoo2 foo33 foo"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.size(), 2u);
+        EXPECT_EQ(result.matches[0].view.to_byte_string(), "foo1"sv);
+        EXPECT_EQ(result.matches[0].column, 0u);
+        EXPECT_EQ(result.matches[1].view.to_byte_string(), "foo33"sv);
+        EXPECT_EQ(result.matches[1].global_offset, 11u);
+    }
+    {
+        Regex<ECMA262> re("(ab|c)+d$"sv, ECMAScriptFlags::Global);
+        auto result = re.match("abcd ababcd"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.size(), 1u);
+        EXPECT_EQ(result.matches[0].view.to_byte_string(), "ababcd"sv);
+        EXPECT_EQ(result.capture_group_matches[0][0].view.to_byte_string(), "c"sv);
+    }
+    {
+        // String compares are skipped by the DFA when matching case-insensitively.
+        Regex<ECMA262> re("hello"sv, ECMAScriptFlags::Global | ECMAScriptFlags::Insensitive);
+        auto result = re.match("Hello hELLO"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.size(), 2u);
+    }
+}
+
+TEST_CASE(lazy_dfa_states_follow_match_options)
+{
+    // The states built for one set of options must not be reused for another.
+    Regex<ECMA262> re("^ab+c"sv, ECMAScriptFlags::Global);
+    for (size_t i = 0; i < 2; ++i) {
+        auto result = re.match("abc\nabbc"sv);
+        EXPECT_EQ(result.matches.size(), 1u);
+
+        auto multiline_result = re.match("abc\nabbc"sv, ECMAScriptFlags::Multiline);
+        EXPECT_EQ(multiline_result.matches.size(), 2u);
+    }
+}
+
+TEST_CASE(optimizer_prefilter_literals)
+{
+    {
+        Regex<ECMA262> re("foo(bar|qux)\\d+"sv);
+        auto const& data = re.parser_result.optimization_data;
+        EXPECT_EQ(data.literal_prefix.value_or({}), "foo"sv);
+        EXPECT(!data.required_literal.has_value());
+    }
+    {
+        Regex<ECMA262> re("\\d+ ERROR: (\\w+)"sv);
+        auto const& data = re.parser_result.optimization_data;
+        EXPECT(!data.literal_prefix.has_value());
+        EXPECT_EQ(data.required_literal.value_or({}), " ERROR: "sv);
+        EXPECT(data.leading_characters.has_value());
+        EXPECT(data.leading_characters->at('7'));
+        EXPECT(!data.leading_characters->at('a'));
+    }
+    {
+        Regex<ECMA262> re("[a-c]x|Dy"sv);
+        auto const& data = re.parser_result.optimization_data;
+        EXPECT(!data.required_literal.has_value());
+        EXPECT(data.leading_characters.has_value());
+        EXPECT(data.leading_characters->at('b'));
+        EXPECT(data.leading_characters->at('d'));
+        EXPECT(!data.leading_characters->at('x'));
+    }
+    {
+        // Could match the empty string, so any position could start a match.
+        Regex<ECMA262> re("a*"sv);
+        EXPECT(!re.parser_result.optimization_data.leading_characters.has_value());
+    }
+}
+
+TEST_CASE(prefilter_search)
+{
+    auto haystack = ByteString::formatted("{}12 ERROR: disk\n{}7 ERROR: net", ByteString::repeated('.', 100'000), ByteString::repeated('x', 1000));
+    {
+        Regex<ECMA262> re("\\d+ ERROR: (\\w+)"sv, ECMAScriptFlags::Global);
+        auto result = re.match(haystack);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.size(), 2u);
+        EXPECT_EQ(result.matches[0].view.to_byte_string(), "12 ERROR: disk"sv);
+        EXPECT_EQ(result.matches[0].global_offset, 100'000u);
+        EXPECT_EQ(result.capture_group_matches[1][0].view.to_byte_string(), "net"sv);
+    }
+    {
+        Regex<ECMA262> re("error: \\w+"sv, ECMAScriptFlags::Global | ECMAScriptFlags::Insensitive);
+        auto result = re.match(haystack);
+        EXPECT_EQ(result.matches.size(), 2u);
+    }
+    {
+        Regex<ECMA262> re("WARNING"sv, ECMAScriptFlags::Global);
+        EXPECT_EQ(re.match(haystack).success, false);
+    }
+    {
+        // Without the global flag, only the first position may start a match.
+        Regex<ECMA262> re("ERROR"sv);
+        EXPECT_EQ(re.match(haystack).success, false);
+    }
+}
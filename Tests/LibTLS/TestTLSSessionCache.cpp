@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Socket.h>
+#include <LibCore/TCPServer.h>
+#include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibTLS/SessionCache.h>
+#include <LibTLS/TLSv12.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Thread.h>
+
+static TLS::Session make_session(u8 id, Duration lifetime = Duration::from_seconds(60))
+{
+    TLS::Session session;
+    session.session_id = MUST(ByteBuffer::copy(Array<u8, 1> { id }.span()));
+    session.master_key = MUST(ByteBuffer::create_zeroed(48));
+    session.cipher = TLS::CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256;
+    session.expiry = UnixDateTime::now() + lifetime;
+    return session;
+}
+
+TEST_CASE(session_cache_find_and_replace)
+{
+    auto cache = TLS::SessionCache::create();
+    EXPECT(!cache->find("example.com"sv, 443).has_value());
+
+    cache->store("example.com"sv, 443, make_session(1));
+    auto session = cache->find("example.com"sv, 443);
+    EXPECT(session.has_value());
+    EXPECT_EQ(session->session_id[0], 1);
+    EXPECT_EQ(session->cipher, TLS::CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256);
+
+    cache->store("example.com"sv, 443, make_session(2));
+    EXPECT_EQ(cache->find("example.com"sv, 443)->session_id[0], 2);
+
+    cache->remove("example.com"sv, 443);
+    EXPECT(!cache->find("example.com"sv, 443).has_value());
+}
+
+TEST_CASE(session_cache_is_keyed_by_host_and_port)
+{
+    auto cache = TLS::SessionCache::create();
+    cache->store("example.com"sv, 443, make_session(1));
+    cache->store("example.com"sv, 8443, make_session(2));
+
+    EXPECT_EQ(cache->find("example.com"sv, 443)->session_id[0], 1);
+    EXPECT_EQ(cache->find("example.com"sv, 8443)->session_id[0], 2);
+    EXPECT(!cache->find("example.com"sv, 993).has_value());
+
+    cache->remove("example.com"sv, 8443);
+    EXPECT(cache->find("example.com"sv, 443).has_value());
+    EXPECT(!cache->find("example.com"sv, 8443).has_value());
+}
+
+TEST_CASE(session_cache_evicts_least_recently_used)
+{
+    auto cache = TLS::SessionCache::create(2);
+    cache->store("a.example"sv, 443, make_session(1));
+    cache->store("b.example"sv, 443, make_session(2));
+
+    // Looking up "a.example" makes "b.example" the least recently used host.
+    EXPECT(cache->find("a.example"sv, 443).has_value());
+    cache->store("c.example"sv, 443, make_session(3));
+
+    EXPECT(cache->find("a.example"sv, 443).has_value());
+    EXPECT(!cache->find("b.example"sv, 443).has_value());
+    EXPECT(cache->find("c.example"sv, 443).has_value());
+}
+
+TEST_CASE(session_cache_drops_expired_sessions)
+{
+    auto cache = TLS::SessionCache::create();
+    cache->store("example.com"sv, 443, make_session(1, Duration::from_seconds(-1)));
+    EXPECT(!cache->find("example.com"sv, 443).has_value());
+}
+
+TEST_CASE(certificate_chain_cache)
+{
+    auto cache = TLS::CertificateChainCache::create(1);
+
+    Vector<TLS::Certificate> chain;
+    chain.append({});
+    chain[0].original_asn1 = MUST(ByteBuffer::copy("certificate"sv.bytes()));
+    auto fingerprint = MUST(TLS::CertificateChainCache::fingerprint(chain));
+    EXPECT_EQ(fingerprint.size(), 32u);
+    EXPECT(!cache->contains(fingerprint));
+
+    cache->add(fingerprint, UnixDateTime::now() + Duration::from_seconds(60));
+    EXPECT(cache->contains(fingerprint));
+
+    chain[0].original_asn1 = MUST(ByteBuffer::copy("other certificate"sv.bytes()));
+    auto other_fingerprint = MUST(TLS::CertificateChainCache::fingerprint(chain));
+    EXPECT(!cache->contains(other_fingerprint));
+
+    cache->add(other_fingerprint, UnixDateTime::now() - Duration::from_seconds(1));
+    EXPECT(!cache->contains(fingerprint));
+    EXPECT(!cache->contains(other_fingerprint));
+}
+
+// The rest of this file runs the client through an abbreviated handshake against a scripted server. The server knows the
+// master secret of the cached session, so it can write a correctly encrypted Finished message with whatever contents it wants.
+
+static constexpr u8 resumed_session_id = 42;
+
+static TLS::Session make_resumable_session()
+{
+    auto session = make_session(resumed_session_id);
+    for (size_t i = 0; i < session.master_key.size(); ++i)
+        session.master_key[i] = static_cast<u8>(i * 7);
+    return session;
+}
+
+// RFC 5246 section 5: PRF(secret, label, seed) = P_SHA256(secret, label + seed)
+static ByteBuffer prf(ReadonlyBytes secret, StringView label, ReadonlyBytes seed, ReadonlyBytes seed_b, size_t length)
+{
+    using HMAC = Crypto::Authentication::HMAC<Crypto::Hash::SHA256>;
+    auto output = MUST(ByteBuffer::create_uninitialized(length));
+
+    auto label_and_seed = MUST(ByteBuffer::copy(label.bytes()));
+    label_and_seed.append(seed);
+    label_and_seed.append(seed_b);
+
+    // A(1) = HMAC(secret, label + seed), A(i) = HMAC(secret, A(i - 1))
+    HMAC hmac(secret);
+    auto a = hmac.process(label_and_seed.bytes());
+    for (size_t offset = 0; offset < length; offset += hmac.digest_size()) {
+        hmac.update(a.bytes());
+        hmac.update(label_and_seed.bytes());
+        auto block = hmac.digest();
+        output.overwrite(offset, block.immutable_data(), min(hmac.digest_size(), length - offset));
+        a = hmac.process(a.bytes());
+    }
+    return output;
+}
+
+static ErrorOr<ByteBuffer> read_record(Core::TCPSocket& socket, TLS::ContentType expected_type)
+{
+    u8 header[5];
+    TRY(socket.read_until_filled({ header, sizeof(header) }));
+    if (header[0] != to_underlying(expected_type))
+        return Error::from_string_literal("Unexpected record type");
+    auto payload = TRY(ByteBuffer::create_uninitialized(header[3] * 0x100 + header[4]));
+    TRY(socket.read_until_filled(payload));
+    return payload;
+}
+
+static ErrorOr<void> write_record(Core::TCPSocket& socket, TLS::ContentType type, ReadonlyBytes payload)
+{
+    u8 header[5] { to_underlying(type), 3, 3, static_cast<u8>(payload.size() >> 8), static_cast<u8>(payload.size()) };
+    TRY(socket.write_until_depleted({ header, sizeof(header) }));
+    TRY(socket.write_until_depleted(payload));
+    return {};
+}
+
+static ByteBuffer handshake_message(TLS::HandshakeType type, ReadonlyBytes body)
+{
+    ByteBuffer message;
+    message.append(to_underlying(type));
+    message.append(static_cast<u8>(body.size() >> 16));
+    message.append(static_cast<u8>(body.size() >> 8));
+    message.append(static_cast<u8>(body.size()));
+    message.append(body);
+    return message;
+}
+
+// AES-128-GCM records as in RFC 5288 section 3, with the sequence number as the explicit part of the nonce.
+static ByteBuffer gcm_iv(ReadonlyBytes implicit_iv, ReadonlyBytes explicit_nonce)
+{
+    auto iv = MUST(ByteBuffer::create_zeroed(16));
+    iv.overwrite(0, implicit_iv.data(), 4);
+    iv.overwrite(4, explicit_nonce.data(), 8);
+    return iv;
+}
+
+static ByteBuffer gcm_aad(u8 type, size_t length)
+{
+    auto aad = MUST(ByteBuffer::create_zeroed(13));
+    aad[8] = type;
+    aad[9] = 3;
+    aad[10] = 3;
+    aad[11] = static_cast<u8>(length >> 8);
+    aad[12] = static_cast<u8>(length);
+    return aad;
+}
+
+static ByteBuffer encrypt_record(ReadonlyBytes key, ReadonlyBytes implicit_iv, TLS::ContentType type, ReadonlyBytes plaintext)
+{
+    Crypto::Cipher::AESCipher::GCMMode gcm(key, key.size() * 8, Crypto::Cipher::Intent::Encryption);
+    auto record = MUST(ByteBuffer::create_zeroed(8 + plaintext.size() + 16));
+    auto iv = gcm_iv(implicit_iv, record.bytes().slice(0, 8));
+    gcm.encrypt(plaintext, record.bytes().slice(8, plaintext.size()), iv, gcm_aad(to_underlying(type), plaintext.size()), record.bytes().slice(8 + plaintext.size()));
+    return record;
+}
+
+static ErrorOr<ByteBuffer> decrypt_record(ReadonlyBytes key, ReadonlyBytes implicit_iv, TLS::ContentType type, ReadonlyBytes record)
+{
+    if (record.size() < 8 + 16)
+        return Error::from_string_literal("Record too short");
+    Crypto::Cipher::AESCipher::GCMMode gcm(key, key.size() * 8, Crypto::Cipher::Intent::Decryption);
+    auto plaintext = TRY(ByteBuffer::create_uninitialized(record.size() - 8 - 16));
+    auto iv = gcm_iv(implicit_iv, record.slice(0, 8));
+    auto ciphertext = record.slice(8, plaintext.size());
+    if (gcm.decrypt(ciphertext, plaintext, iv, gcm_aad(to_underlying(type), plaintext.size()), record.slice(8 + plaintext.size())) != Crypto::VerificationConsistency::Consistent)
+        return Error::from_string_literal("Record doesn't decrypt");
+    return plaintext;
+}
+
+enum class ServerFinished {
+    Valid,
+    Tampered,
+};
+
+// Accepts the session that the client offers, sends a ChangeCipherSpec and a Finished message, and then checks what the
+// client answers with: its own ChangeCipherSpec and Finished messages if it accepted ours, or an alert otherwise.
+static ErrorOr<void> run_resuming_server(Core::TCPServer& server, TLS::Session const& session, ServerFinished server_finished)
+{
+    auto socket = TRY(server.accept());
+    TRY(socket->set_blocking(true));
+    Crypto::Hash::SHA256 transcript;
+
+    auto client_hello = TRY(read_record(*socket, TLS::ContentType::HANDSHAKE));
+    transcript.update(client_hello);
+    // type (1), length (3), version (2), random (32), session_id (1 + n)
+    if (client_hello.size() < 39 || client_hello[0] != to_underlying(TLS::HandshakeType::CLIENT_HELLO))
+        return Error::from_string_literal("Expected a ClientHello");
+    auto client_random = client_hello.bytes().slice(6, 32);
+    if (client_hello[38] != session.session_id.size() || client_hello.bytes().slice(39, client_hello[38]) != session.session_id.bytes())
+        return Error::from_string_literal("Client didn't offer the cached session");
+
+    u8 server_random[32];
+    for (size_t i = 0; i < sizeof(server_random); ++i)
+        server_random[i] = static_cast<u8>(0xa0 + i);
+
+    ByteBuffer server_hello_body;
+    server_hello_body.append(3);
+    server_hello_body.append(3);
+    server_hello_body.append(ReadonlyBytes { server_random, sizeof(server_random) });
+    server_hello_body.append(static_cast<u8>(session.session_id.size()));
+    server_hello_body.append(session.session_id);
+    server_hello_body.append(static_cast<u8>(to_underlying(session.cipher) >> 8));
+    server_hello_body.append(static_cast<u8>(to_underlying(session.cipher)));
+    server_hello_body.append(0); // no compression
+    auto server_hello = handshake_message(TLS::HandshakeType::SERVER_HELLO, server_hello_body);
+    transcript.update(server_hello);
+    TRY(write_record(*socket, TLS::ContentType::HANDSHAKE, server_hello));
+
+    // client_write_key (16), server_write_key (16), client_write_IV (4), server_write_IV (4)
+    auto key_block = prf(session.master_key, "key expansion"sv, { server_random, sizeof(server_random) }, client_random, 40);
+    auto client_key = key_block.bytes().slice(0, 16);
+    auto server_key = key_block.bytes().slice(16, 16);
+    auto client_iv = key_block.bytes().slice(32, 4);
+    auto server_iv = key_block.bytes().slice(36, 4);
+
+    u8 change_cipher_spec = 1;
+    TRY(write_record(*socket, TLS::ContentType::CHANGE_CIPHER_SPEC, { &change_cipher_spec, 1 }));
+
+    auto server_verify_data = prf(session.master_key, "server finished"sv, transcript.peek().bytes(), {}, 12);
+    if (server_finished == ServerFinished::Tampered)
+        server_verify_data[0] ^= 1;
+    auto finished = handshake_message(TLS::HandshakeType::FINISHED, server_verify_data);
+    transcript.update(finished);
+    TRY(write_record(*socket, TLS::ContentType::HANDSHAKE, encrypt_record(server_key, server_iv, TLS::ContentType::HANDSHAKE, finished)));
+
+    if (server_finished == ServerFinished::Tampered) {
+        // The client has to reject our Finished message with an alert or by hanging up, instead of answering with its own.
+        auto alert = read_record(*socket, TLS::ContentType::ALERT);
+        if (!alert.is_error() || socket->is_eof())
+            return {};
+        return alert.release_error();
+    }
+
+    TRY(read_record(*socket, TLS::ContentType::CHANGE_CIPHER_SPEC));
+    auto client_finished = TRY(decrypt_record(client_key, client_iv, TLS::ContentType::HANDSHAKE, TRY(read_record(*socket, TLS::ContentType::HANDSHAKE))));
+    auto client_verify_data = prf(session.master_key, "client finished"sv, transcript.peek().bytes(), {}, 12);
+    if (client_finished != handshake_message(TLS::HandshakeType::FINISHED, client_verify_data))
+        return Error::from_string_literal("Client's Finished doesn't cover our Finished message");
+    return {};
+}
+
+static ErrorOr<NonnullOwnPtr<TLS::TLSv12>> connect_to_resuming_server(ServerFinished server_finished)
+{
+    Core::EventLoop loop;
+    auto server = TRY(Core::TCPServer::try_create());
+    TRY(server->listen({ 127, 0, 0, 1 }, 0));
+    TRY(server->set_blocking(true));
+    auto port = server->local_port().value();
+
+    auto session = make_resumable_session();
+    auto cache = TLS::SessionCache::create();
+    cache->store("localhost"sv, port, session);
+
+    Optional<Error> server_error;
+    auto server_thread = Threading::Thread::construct([&]() -> intptr_t {
+        if (auto result = run_resuming_server(*server, session, server_finished); result.is_error())
+            server_error = result.release_error();
+        return 0;
+    });
+    server_thread->start();
+
+    TLS::Options options;
+    options.set_session_cache(cache);
+    auto client = TLS::TLSv12::connect("localhost", port, move(options));
+
+    // Our last messages might still be waiting to be flushed by the event loop.
+    while (!server_thread->has_exited())
+        loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    (void)server_thread->join();
+    if (server_error.has_value())
+        FAIL(ByteString::formatted("Scripted server failed: {}", *server_error));
+    return client;
+}
+
+TEST_CASE(resumed_handshake)
+{
+    auto client = TRY_OR_FAIL(connect_to_resuming_server(ServerFinished::Valid));
+    EXPECT(client->is_established());
+    EXPECT(client->is_resumed_session());
+}
+
+TEST_CASE(resumed_handshake_with_tampered_finished)
+{
+    auto client = connect_to_resuming_server(ServerFinished::Tampered);
+    EXPECT(client.is_error());
+}
@@ -12,6 +12,9 @@
 
 TEST_ROOT("Userland/Libraries/LibWasm/Tests");
 
+TESTJS_PROGRAM_FLAG(use_stack_interpreter, "Run all functions on the stack machine instead of lowering them to register bytecode", "stack-interpreter", 0);
+TESTJS_PROGRAM_FLAG(use_jit, "Compile the register bytecode of all functions to native code", "jit", 0);
+
 TESTJS_GLOBAL_FUNCTION(read_binary_wasm_file, readBinaryWasmFile)
 {
     auto& realm = *vm.current_realm();
@@ -47,6 +50,10 @@ public:
         : JS::Object(ConstructWithPrototypeTag::Tag, prototype)
     {
         m_machine.enable_instruction_count_limit();
+        if (use_stack_interpreter)
+            m_machine.disable_register_bytecode();
+        else if (use_jit)
+            m_machine.enable_jit();
     }
 
     static Wasm::AbstractMachine& machine() { return m_machine; }
@@ -514,7 +514,9 @@ int pthread_getschedparam(pthread_t thread, [[maybe_unused]] int* policy, struct
     Syscall::SC_scheduler_parameters_params parameters {
         .pid_or_tid = thread,
         .mode = Syscall::SchedulerParametersMode::Thread,
+        .fields = Syscall::SchedulerParametersFields::None,
         .parameters = *param,
+        .cpu_affinity = 0,
     };
     int rc = syscall(Syscall::SC_scheduler_get_parameters, &parameters);
     if (rc == 0)
@@ -529,7 +531,9 @@ int pthread_setschedparam(pthread_t thread, [[maybe_unused]] int policy, struct
     Syscall::SC_scheduler_parameters_params parameters {
         .pid_or_tid = thread,
         .mode = Syscall::SchedulerParametersMode::Thread,
+        .fields = Syscall::SchedulerParametersFields::Priority,
         .parameters = *param,
+        .cpu_affinity = 0,
     };
     int rc = syscall(Syscall::SC_scheduler_set_parameters, &parameters);
     __RETURN_PTHREAD_ERROR(rc);
@@ -35,7 +35,9 @@ int sched_setparam(pid_t pid, const struct sched_param* param)
     Syscall::SC_scheduler_parameters_params parameters {
         .pid_or_tid = pid,
         .mode = Syscall::SchedulerParametersMode::Process,
+        .fields = Syscall::SchedulerParametersFields::Priority,
         .parameters = *param,
+        .cpu_affinity = 0,
     };
     int rc = syscall(SC_scheduler_set_parameters, &parameters);
     __RETURN_WITH_ERRNO(rc, rc, -1);
@@ -47,11 +49,53 @@ int sched_getparam(pid_t pid, struct sched_param* param)
     Syscall::SC_scheduler_parameters_params parameters {
         .pid_or_tid = pid,
         .mode = Syscall::SchedulerParametersMode::Process,
+        .fields = Syscall::SchedulerParametersFields::None,
         .parameters = {},
+        .cpu_affinity = 0,
     };
     int rc = syscall(SC_scheduler_get_parameters, &parameters);
     if (rc == 0)
         *param = parameters.parameters;
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
+
+// https://man7.org/linux/man-pages/man2/sched_setaffinity.2.html
+int sched_setaffinity(pid_t pid, size_t cpusetsize, cpu_set_t const* mask)
+{
+    if (cpusetsize < sizeof(cpu_set_t)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    Syscall::SC_scheduler_parameters_params parameters {
+        .pid_or_tid = pid,
+        .mode = Syscall::SchedulerParametersMode::Process,
+        .fields = Syscall::SchedulerParametersFields::CPUAffinity,
+        .parameters = {},
+        .cpu_affinity = mask->__bits,
+    };
+    int rc = syscall(SC_scheduler_set_parameters, &parameters);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+// https://man7.org/linux/man-pages/man2/sched_getaffinity.2.html
+int sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask)
+{
+    if (cpusetsize < sizeof(cpu_set_t)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    Syscall::SC_scheduler_parameters_params parameters {
+        .pid_or_tid = pid,
+        .mode = Syscall::SchedulerParametersMode::Process,
+        .fields = Syscall::SchedulerParametersFields::None,
+        .parameters = {},
+        .cpu_affinity = 0,
+    };
+    int rc = syscall(SC_scheduler_get_parameters, &parameters);
+    if (rc == 0)
+        mask->__bits = parameters.cpu_affinity;
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
 }
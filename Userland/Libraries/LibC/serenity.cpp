@@ -101,6 +101,19 @@ int anon_create(size_t size, int options)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int io_ring_create(unsigned entries, int options)
+{
+    int rc = syscall(SC_io_ring_create, entries, options);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+int io_ring_enter(int fd, unsigned to_submit, unsigned min_complete, const struct timespec* timeout)
+{
+    Syscall::SC_io_ring_enter_params params { fd, to_submit, min_complete, timeout };
+    int rc = syscall(SC_io_ring_enter, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 int serenity_readlink(char const* path, size_t path_length, char* buffer, size_t buffer_size)
 {
     Syscall::SC_readlink_params small_params {
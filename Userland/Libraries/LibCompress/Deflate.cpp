@@ -8,6 +8,7 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/BinarySearch.h>
+#include <AK/Math.h>
 #include <AK/MemoryStream.h>
 #include <LibCompress/Deflate.h>
 #include <LibCompress/Huffman.h>
@@ -157,9 +158,11 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
 
 ErrorOr<u32> CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) const
 {
-    auto prefix = TRY(stream.peek_bits<size_t>(m_max_prefixed_code_length));
+    // The code at the very end of a stream can be shorter than the prefix, so don't insist on reading all of it.
+    auto available_bits = TRY(stream.fill_buffer(m_max_prefixed_code_length));
+    auto prefix = TRY(stream.peek_bits<size_t>(min(available_bits, m_max_prefixed_code_length)));
 
-    if (auto [symbol_value, code_length] = m_prefix_table[prefix]; code_length != 0) {
+    if (auto [symbol_value, code_length] = m_prefix_table[prefix]; code_length != 0 && code_length <= available_bits) {
         stream.discard_previously_peeked_bits(code_length);
         return symbol_value;
     }
@@ -178,11 +181,239 @@ ErrorOr<u32> CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) cons
     return Error::from_string_literal("Symbol exceeds maximum symbol number");
 }
 
+ErrorOr<DeflateDecompressor::OutputWindow> DeflateDecompressor::OutputWindow::create()
+{
+    return OutputWindow { TRY(ByteBuffer::create_uninitialized(capacity)) };
+}
+
+DeflateDecompressor::OutputWindow::OutputWindow(ByteBuffer buffer)
+    : m_buffer(move(buffer))
+{
+}
+
+void DeflateDecompressor::OutputWindow::make_room_for(size_t size)
+{
+    if (m_buffer.size() - m_write_position >= size)
+        return;
+
+    // Keep the unread data and the history before it, and move it to the start of the buffer.
+    auto keep_from = min(m_read_position, m_write_position - min(m_write_position, history_size));
+    auto kept_size = m_write_position - keep_from;
+    __builtin_memmove(m_buffer.data(), m_buffer.data() + keep_from, kept_size);
+    m_read_position -= keep_from;
+    m_write_position = kept_size;
+
+    VERIFY(m_buffer.size() - m_write_position >= size);
+}
+
+void DeflateDecompressor::OutputWindow::did_write(size_t size)
+{
+    VERIFY(size <= m_buffer.size() - m_write_position);
+    m_write_position += size;
+}
+
+ErrorOr<void> DeflateDecompressor::OutputWindow::copy_from_seekback(size_t distance, size_t length)
+{
+    if (distance > m_write_position)
+        return Error::from_string_literal("Tried a seekback copy beyond the seekback limit");
+
+    make_room_for(length);
+
+    // The source and destination may overlap, in which case the copied bytes are repeated.
+    auto* destination = m_buffer.data() + m_write_position;
+    auto const* source = destination - distance;
+    for (size_t i = 0; i < length; ++i)
+        destination[i] = source[i];
+
+    m_write_position += length;
+    return {};
+}
+
+Bytes DeflateDecompressor::OutputWindow::read(Bytes bytes)
+{
+    auto size = min(bytes.size(), m_write_position - m_read_position);
+    m_buffer.bytes().slice(m_read_position, size).copy_to(bytes);
+    m_read_position += size;
+    return bytes.trim(size);
+}
+
+void DeflateDecompressor::FastDecodeTable::fill(CanonicalCode const& code, auto entry_for_symbol)
+{
+    auto bit_codes = code.bit_codes();
+    auto bit_code_lengths = code.bit_code_lengths();
+
+    for (size_t symbol = 0; symbol < bit_codes.size(); ++symbol) {
+        auto code_length = bit_code_lengths[symbol];
+        if (code_length == 0 || code_length > fast_table_bits)
+            continue;
+
+        Entry entry = entry_for_symbol(symbol);
+        entry.code_length = code_length;
+
+        // Every index that starts with the code of this symbol decodes to it.
+        for (size_t index = bit_codes[symbol]; index < m_entries.size(); index += 1u << code_length)
+            m_entries[index] = entry;
+    }
+}
+
+DeflateDecompressor::FastDecodeTable DeflateDecompressor::FastDecodeTable::for_literals(CanonicalCode const& code)
+{
+    FastDecodeTable table;
+    table.fill(code, [](size_t symbol) -> Entry {
+        if (symbol < EndOfBlock)
+            return { .kind = Entry::Kind::Literal, .value = static_cast<u16>(symbol) };
+        if (symbol == EndOfBlock)
+            return { .kind = Entry::Kind::EndOfBlock };
+        if (symbol <= 264)
+            return { .kind = Entry::Kind::LengthOrDistance, .value = static_cast<u16>(symbol - 254) };
+        if (symbol <= 284) {
+            auto extra_bits = (symbol - 261) / 4;
+            return { .kind = Entry::Kind::LengthOrDistance, .extra_bits = static_cast<u8>(extra_bits), .value = static_cast<u16>((((symbol - 265) % 4 + 4) << extra_bits) + 3) };
+        }
+        if (symbol == 285)
+            return { .kind = Entry::Kind::LengthOrDistance, .value = DeflateDecompressor::max_back_reference_length };
+        return { .kind = Entry::Kind::Invalid };
+    });
+
+    // Literals are often short enough that the bits after them in the table index are the complete code of another
+    // literal. Going backwards means that the entries that are looked up (which come before the current one) are
+    // still single literals.
+    for (size_t index = table.m_entries.size(); index-- > 0;) {
+        auto& entry = table.m_entries[index];
+        if (entry.kind != Entry::Kind::Literal)
+            continue;
+
+        auto const& next_entry = table.m_entries[index >> entry.code_length];
+        if (next_entry.kind != Entry::Kind::Literal || entry.code_length + next_entry.code_length > fast_table_bits)
+            continue;
+
+        entry.kind = Entry::Kind::TwoLiterals;
+        entry.value |= next_entry.value << 8;
+        entry.code_length += next_entry.code_length;
+    }
+
+    return table;
+}
+
+DeflateDecompressor::FastDecodeTable DeflateDecompressor::FastDecodeTable::for_distances(CanonicalCode const& code)
+{
+    FastDecodeTable table;
+    table.fill(code, [](size_t symbol) -> Entry {
+        if (symbol <= 3)
+            return { .kind = Entry::Kind::LengthOrDistance, .value = static_cast<u16>(symbol + 1) };
+        if (symbol <= 29) {
+            auto extra_bits = (symbol / 2) - 1;
+            return { .kind = Entry::Kind::LengthOrDistance, .extra_bits = static_cast<u8>(extra_bits), .value = static_cast<u16>(((symbol % 2 + 2) << extra_bits) + 1) };
+        }
+        return { .kind = Entry::Kind::Invalid };
+    });
+    return table;
+}
+
 DeflateDecompressor::CompressedBlock::CompressedBlock(DeflateDecompressor& decompressor, CanonicalCode literal_codes, Optional<CanonicalCode> distance_codes)
     : m_decompressor(decompressor)
     , m_literal_codes(literal_codes)
     , m_distance_codes(distance_codes)
+    , m_fast_literal_table(FastDecodeTable::for_literals(m_literal_codes))
+{
+    if (m_distance_codes.has_value())
+        m_fast_distance_table = FastDecodeTable::for_distances(m_distance_codes.value());
+}
+
+// Decodes symbols straight into the output window for as long as the bit buffer holds enough input for the next symbol,
+// and there is enough space to write the longest possible back reference with 8-byte copies. Stops at the first code
+// that is too long for the fast tables, and returns the number of decoded bytes.
+ErrorOr<size_t> DeflateDecompressor::CompressedBlock::decode_quickly()
 {
+    // 15 bits for the longest length code, 5 extra bits, 15 bits for the longest distance code and 13 extra bits.
+    static constexpr size_t max_bits_per_back_reference = 15 + 5 + 15 + 13;
+    static constexpr size_t copy_overrun = sizeof(u64);
+
+    auto& input_stream = *m_decompressor.m_input_stream;
+    auto& output_window = m_decompressor.m_output_window;
+
+    output_window.make_room_for(max_back_reference_length + copy_overrun);
+    auto output = output_window.free_space();
+    auto* const output_start = output.data();
+    auto* const output_limit = output_start + output.size() - max_back_reference_length - copy_overrun;
+    auto* out = output_start;
+    auto const history_size = output_window.written_size();
+
+    while (out <= output_limit) {
+        // Refilling the bit buffer is relatively expensive, so only ask for as many bits as the next symbol needs.
+        auto available_bits = TRY(input_stream.fill_buffer(FastDecodeTable::fast_table_bits));
+        if (available_bits < FastDecodeTable::fast_table_bits)
+            break;
+
+        auto bits = MUST(input_stream.peek_bits<u64>(available_bits));
+        auto const& entry = m_fast_literal_table.lookup(bits);
+
+        if (entry.kind == FastDecodeTable::Entry::Kind::Literal) {
+            *out++ = entry.value;
+            input_stream.discard_previously_peeked_bits(entry.code_length);
+            continue;
+        }
+
+        if (entry.kind == FastDecodeTable::Entry::Kind::TwoLiterals) {
+            out[0] = entry.value & 0xff;
+            out[1] = entry.value >> 8;
+            out += 2;
+            input_stream.discard_previously_peeked_bits(entry.code_length);
+            continue;
+        }
+
+        if (entry.kind == FastDecodeTable::Entry::Kind::EndOfBlock) {
+            input_stream.discard_previously_peeked_bits(entry.code_length);
+            m_eof = true;
+            break;
+        }
+
+        if (entry.kind == FastDecodeTable::Entry::Kind::Invalid)
+            return Error::from_string_literal("Invalid deflate literal/length symbol");
+
+        if (entry.kind == FastDecodeTable::Entry::Kind::LongCode || !m_fast_distance_table.has_value())
+            break;
+
+        if (available_bits < max_bits_per_back_reference) {
+            available_bits = TRY(input_stream.fill_buffer(max_bits_per_back_reference));
+            if (available_bits < max_bits_per_back_reference)
+                break;
+            bits = MUST(input_stream.peek_bits<u64>(available_bits));
+        }
+
+        bits >>= entry.code_length;
+        size_t length = entry.value + (bits & ((1u << entry.extra_bits) - 1));
+        bits >>= entry.extra_bits;
+
+        auto const& distance_entry = m_fast_distance_table->lookup(bits);
+        if (distance_entry.kind == FastDecodeTable::Entry::Kind::Invalid)
+            return Error::from_string_literal("Invalid deflate distance symbol");
+        if (distance_entry.kind == FastDecodeTable::Entry::Kind::LongCode)
+            break;
+
+        bits >>= distance_entry.code_length;
+        size_t distance = distance_entry.value + (bits & ((1u << distance_entry.extra_bits) - 1));
+        input_stream.discard_previously_peeked_bits(entry.code_length + entry.extra_bits + distance_entry.code_length + distance_entry.extra_bits);
+
+        if (distance > history_size + (out - output_start))
+            return Error::from_string_literal("Tried a seekback copy beyond the seekback limit");
+
+        auto const* source = out - distance;
+        if (distance >= copy_overrun) {
+            // Every 8 bytes that are read have been written already, even if the source and destination overlap.
+            for (size_t i = 0; i < length; i += copy_overrun)
+                __builtin_memcpy(out + i, source + i, copy_overrun);
+        } else if (distance == 1) {
+            __builtin_memset(out, *source, length);
+        } else {
+            for (size_t i = 0; i < length; ++i)
+                out[i] = source[i];
+        }
+        out += length;
+    }
+
+    output_window.did_write(out - output_start);
+    return out - output_start;
 }
 
 ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
@@ -190,14 +421,22 @@ ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
     if (m_eof == true)
         return false;
 
+    auto decoded_size = TRY(decode_quickly());
+    if (m_eof)
+        return decoded_size > 0;
+    if (decoded_size > 0)
+        return true;
+
+    // The fast path couldn't decode the next symbol, so decode it one step at a time.
     auto const symbol = TRY(m_literal_codes.read_symbol(*m_decompressor.m_input_stream));
 
     if (symbol >= 286)
         return Error::from_string_literal("Invalid deflate literal/length symbol");
 
     if (symbol < EndOfBlock) {
-        u8 byte_symbol = symbol;
-        m_decompressor.m_output_buffer.write({ &byte_symbol, sizeof(byte_symbol) });
+        m_decompressor.m_output_window.make_room_for(1);
+        m_decompressor.m_output_window.free_space()[0] = symbol;
+        m_decompressor.m_output_window.did_write(1);
         return true;
     }
 
@@ -215,11 +454,7 @@ ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
         return Error::from_string_literal("Invalid deflate distance symbol");
 
     auto const distance = TRY(m_decompressor.decode_distance(distance_symbol));
-
-    auto copied_length = TRY(m_decompressor.m_output_buffer.copy_from_seekback(distance, length));
-
-    // TODO: What should we do if the output buffer is full?
-    VERIFY(copied_length == length);
+    TRY(m_decompressor.m_output_window.copy_from_seekback(distance, length));
 
     return true;
 }
@@ -238,25 +473,24 @@ ErrorOr<bool> DeflateDecompressor::UncompressedBlock::try_read_more()
     if (m_decompressor.m_input_stream->is_eof())
         return Error::from_string_literal("Input data ends in the middle of an uncompressed DEFLATE block");
 
-    Array<u8, 4096> temporary_buffer;
-    auto readable_bytes = temporary_buffer.span().trim(min(m_bytes_remaining, m_decompressor.m_output_buffer.empty_space()));
-    auto read_bytes = TRY(m_decompressor.m_input_stream->read_some(readable_bytes));
-    auto written_bytes = m_decompressor.m_output_buffer.write(read_bytes);
-    VERIFY(read_bytes.size() == written_bytes);
+    auto& output_window = m_decompressor.m_output_window;
+    output_window.make_room_for(min(m_bytes_remaining, OutputWindow::capacity - OutputWindow::history_size));
+    auto read_bytes = TRY(m_decompressor.m_input_stream->read_some(output_window.free_space().trim(m_bytes_remaining)));
+    output_window.did_write(read_bytes.size());
 
-    m_bytes_remaining -= written_bytes;
+    m_bytes_remaining -= read_bytes.size();
     return true;
 }
 
 ErrorOr<NonnullOwnPtr<DeflateDecompressor>> DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream> stream)
 {
-    auto output_buffer = TRY(CircularBuffer::create_empty(32 * KiB));
-    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateDecompressor(move(stream), move(output_buffer))));
+    auto output_window = TRY(OutputWindow::create());
+    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateDecompressor(move(stream), move(output_window))));
 }
 
-DeflateDecompressor::DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, CircularBuffer output_buffer)
+DeflateDecompressor::DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, OutputWindow output_window)
     : m_input_stream(move(stream))
-    , m_output_buffer(move(output_buffer))
+    , m_output_window(move(output_window))
 {
 }
 
@@ -318,10 +552,10 @@ ErrorOr<Bytes> DeflateDecompressor::read_some(Bytes bytes)
         }
 
         if (m_state == State::ReadingCompressedBlock) {
-            auto nread = m_output_buffer.read(slice).size();
+            auto nread = m_output_window.read(slice).size();
 
             while (nread < slice.size() && TRY(m_compressed_block.try_read_more())) {
-                nread += m_output_buffer.read(slice.slice(nread)).size();
+                nread += m_output_window.read(slice.slice(nread)).size();
             }
 
             total_read += nread;
@@ -335,10 +569,10 @@ ErrorOr<Bytes> DeflateDecompressor::read_some(Bytes bytes)
         }
 
         if (m_state == State::ReadingUncompressedBlock) {
-            auto nread = m_output_buffer.read(slice).size();
+            auto nread = m_output_window.read(slice).size();
 
             while (nread < slice.size() && TRY(m_uncompressed_block.try_read_more())) {
-                nread += m_output_buffer.read(slice.slice(nread)).size();
+                nread += m_output_window.read(slice.slice(nread)).size();
             }
 
             total_read += nread;
@@ -580,7 +814,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_back_reference_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -590,8 +824,8 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             match_position = candidate;
             previous_match_length = match_length;
 
-            if (match_length == maximum_match_length)
-                return match_length; // bail if we got the maximum possible length
+            if (match_length == maximum_match_length || match_length >= m_compression_constants.great_match_length)
+                return match_length; // bail if we got the maximum possible length, or one that is good enough
         }
 
         candidate = m_hash_prev[candidate % window_size];
@@ -606,40 +840,97 @@ ALWAYS_INLINE u8 DeflateCompressor::distance_to_base(u16 distance)
     return (distance <= 256) ? distance_to_base_lo[distance - 1] : distance_to_base_hi[(distance - 1) >> 7];
 }
 
-void DeflateCompressor::lz77_compress_block()
+ALWAYS_INLINE void DeflateCompressor::insert_hash(size_t position, u16 hash)
+{
+    auto window_position = position % window_size;
+    m_hash_prev[window_position] = m_hash_head[hash];
+    m_hash_head[hash] = window_position;
+}
+
+ALWAYS_INLINE void DeflateCompressor::emit_literal(u16 literal)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = 0;
+    m_symbol_buffer[index].literal = literal;
+    m_symbol_frequencies[literal]++;
+}
+
+ALWAYS_INLINE void DeflateCompressor::emit_back_reference(u16 distance, u16 length)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = distance;
+    m_symbol_buffer[index].length = length;
+    m_symbol_frequencies[length_to_symbol[length]]++;
+    m_distance_frequencies[distance_to_base(distance)]++;
+}
+
+ErrorOr<void> DeflateCompressor::lz77_compress_block()
 {
     for (auto& slot : m_hash_head) { // initialize chained hash table
         slot = empty_slot;
     }
 
-    auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
-    };
+    for (auto position = block_size - m_history_size; position < block_size; ++position)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
 
-    auto emit_literal = [&](auto literal) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = 0;
-        m_symbol_buffer[index].literal = literal;
-        m_symbol_frequencies[literal]++;
-    };
+    VERIFY(m_compression_constants.great_match_length <= max_match_length);
 
-    auto emit_back_reference = [&](auto distance, auto length) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = distance;
-        m_symbol_buffer[index].length = length;
-        m_symbol_frequencies[length_to_symbol[length]]++;
-        m_distance_frequencies[distance_to_base(distance)]++;
-    };
+    switch (m_compression_constants.parser) {
+    case Parser::Greedy:
+        lz77_greedy_parse();
+        return {};
+    case Parser::Lazy:
+        lz77_lazy_parse();
+        return {};
+    case Parser::Optimal:
+        return lz77_optimal_parse();
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Takes the first match that the hash table turns up, and doesn't bother indexing the inside of long matches.
+void DeflateCompressor::lz77_greedy_parse()
+{
+    auto block_end = block_size + m_pending_block_size;
+    auto last_match_start = block_end - min_match_length + 1;
+
+    size_t current_position = block_size;
+    while (current_position < last_match_start) {
+        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        size_t match_position;
+        auto match_length = find_back_match(current_position, hash, 0,
+            min(max_match_length, block_end - current_position), match_position);
+
+        insert_hash(current_position, hash);
 
+        if (match_length == 0) {
+            emit_literal(m_rolling_window[current_position++]);
+            continue;
+        }
+
+        emit_back_reference(current_position - match_position, match_length);
+
+        auto match_end = current_position + match_length;
+        if (match_length <= m_compression_constants.max_lazy_length) {
+            for (auto j = current_position + 1; j < min(match_end, last_match_start); j++)
+                insert_hash(j, hash_sequence(&m_rolling_window[j]));
+        }
+        current_position = match_end;
+    }
+
+    while (current_position < block_end)
+        emit_literal(m_rolling_window[current_position++]);
+}
+
+// Before taking a match, checks whether the match at the next byte is longer, in which case the current byte is
+// emitted as a literal instead.
+void DeflateCompressor::lz77_lazy_parse()
+{
     size_t previous_match_length = 0;
     size_t previous_match_position = 0;
 
-    VERIFY(m_compression_constants.great_match_length <= max_match_length);
-
     // our block starts at block_size and is m_pending_block_size in length
     auto block_end = block_size + m_pending_block_size;
     size_t current_position;
@@ -647,7 +938,7 @@ void DeflateCompressor::lz77_compress_block()
         auto hash = hash_sequence(&m_rolling_window[current_position]);
         size_t match_position;
         auto match_length = find_back_match(current_position, hash, previous_match_length,
-            min(m_compression_constants.great_match_length, block_end - current_position), match_position);
+            min(max_match_length, block_end - current_position), match_position);
 
         insert_hash(current_position, hash);
 
@@ -691,6 +982,150 @@ void DeflateCompressor::lz77_compress_block()
     }
 }
 
+// Finds the cheapest way to encode the block as a whole, like zopfli does: every match the hash chains turn up is
+// considered at every length it could be cut to, and a shortest path search over the block picks the sequence of
+// literals and back references with the lowest cost. The cost of each symbol is first estimated from the fixed Huffman
+// codes, and then from the symbol frequencies of the previous pass.
+ErrorOr<void> DeflateCompressor::lz77_optimal_parse()
+{
+    static constexpr size_t optimal_parse_passes = 3;
+
+    auto block_end = block_size + m_pending_block_size;
+    auto last_match_start = block_end - min_match_length + 1;
+
+    // Find the matches at every position once; they don't depend on the costs.
+    // For each position, the matches are sorted by length (and distance), and only the closest match of every length is kept.
+    auto& matches = m_optimal_parse.matches;
+    auto& first_match_index = m_optimal_parse.first_match_index;
+    matches.clear_with_capacity();
+    TRY(first_match_index.try_resize(m_pending_block_size + 1));
+
+    for (size_t current_position = block_size; current_position < block_end; ++current_position) {
+        first_match_index[current_position - block_size] = matches.size();
+        if (current_position >= last_match_start)
+            continue;
+
+        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        auto maximum_match_length = min(max_match_length, block_end - current_position);
+        auto longest_match_length = min_match_length - 1;
+
+        auto candidate = m_hash_head[hash];
+        for (auto chain_length = m_compression_constants.max_chain; chain_length > 0 && longest_match_length < min(maximum_match_length, m_compression_constants.great_match_length); --chain_length) {
+            if (candidate == empty_slot || current_position - candidate > max_back_reference_distance)
+                break;
+
+            if (auto match_length = compare_match_candidate(current_position, candidate, longest_match_length, maximum_match_length); match_length != 0) {
+                TRY(matches.try_append({ static_cast<u16>(match_length), static_cast<u16>(current_position - candidate) }));
+                longest_match_length = match_length;
+            }
+
+            candidate = m_hash_prev[candidate % window_size];
+        }
+
+        insert_hash(current_position, hash);
+
+        // Long matches are almost always worth taking, so the positions they cover aren't worth a full search.
+        if (longest_match_length >= m_compression_constants.good_match_length) {
+            auto match_end = current_position + longest_match_length;
+            while (++current_position < match_end) {
+                first_match_index[current_position - block_size] = matches.size();
+                if (current_position < last_match_start)
+                    insert_hash(current_position, hash_sequence(&m_rolling_window[current_position]));
+            }
+            --current_position;
+        }
+    }
+    first_match_index[m_pending_block_size] = matches.size();
+
+    auto& costs = m_optimal_parse.costs;
+    auto& steps = m_optimal_parse.steps;
+    TRY(costs.try_resize(m_pending_block_size + 1));
+    TRY(steps.try_resize(m_pending_block_size + 1));
+
+    Array<float, max_huffman_literals> symbol_costs;
+    Array<float, max_huffman_distances> distance_costs;
+    for (size_t i = 0; i < max_huffman_literals; ++i)
+        symbol_costs[i] = fixed_literal_bit_lengths[i];
+    for (size_t i = 0; i < max_huffman_distances; ++i)
+        distance_costs[i] = fixed_distance_bit_lengths[i];
+
+    for (size_t pass = 0; pass < optimal_parse_passes; ++pass) {
+        if (pass > 0) {
+            // Estimate the cost of every symbol from how often the previous pass used it, i.e. the length of its
+            // code in an ideal (not length limited) prefix code. Unused symbols are made slightly more expensive than
+            // the rarest possible symbol, so that they can still be picked up if they are worth it.
+            auto estimate_costs = [](auto const& frequencies, auto& costs) {
+                u32 total = 0;
+                for (auto frequency : frequencies)
+                    total += frequency;
+                auto total_bits = log2(static_cast<float>(max(total, 1u)));
+                for (size_t i = 0; i < frequencies.size(); ++i)
+                    costs[i] = frequencies[i] == 0 ? total_bits + 1 : total_bits - log2(static_cast<float>(frequencies[i]));
+            };
+            estimate_costs(m_symbol_frequencies, symbol_costs);
+            estimate_costs(m_distance_frequencies, distance_costs);
+        }
+
+        Array<float, max_match_length + 1> length_costs;
+        for (size_t length = min_match_length; length <= max_match_length; ++length) {
+            auto symbol = length_to_symbol[length];
+            length_costs[length] = symbol_costs[symbol] + packed_length_symbols[symbol - 257].extra_bits;
+        }
+
+        // Shortest path search: costs[i] is the cheapest way to encode the first i bytes of the block.
+        costs[0] = 0;
+        for (size_t i = 1; i <= m_pending_block_size; ++i)
+            costs[i] = NumericLimits<float>::max();
+
+        for (size_t i = 0; i < m_pending_block_size; ++i) {
+            auto cost = costs[i];
+
+            if (auto literal_cost = cost + symbol_costs[m_rolling_window[block_size + i]]; literal_cost < costs[i + 1]) {
+                costs[i + 1] = literal_cost;
+                steps[i + 1] = { 1, 0 };
+            }
+
+            // A match can be cut down to any length between the previous (closer) match and its own length.
+            size_t shorter_match_length = min_match_length - 1;
+            for (auto match_index = first_match_index[i]; match_index < first_match_index[i + 1]; ++match_index) {
+                auto [match_length, distance] = matches[match_index];
+                auto distance_base = distance_to_base(distance);
+                auto distance_cost = cost + distance_costs[distance_base] + packed_distances[distance_base].extra_bits;
+
+                for (auto length = shorter_match_length + 1; length <= match_length; ++length) {
+                    if (auto match_cost = distance_cost + length_costs[length]; match_cost < costs[i + length]) {
+                        costs[i + length] = match_cost;
+                        steps[i + length] = { static_cast<u16>(length), distance };
+                    }
+                }
+                shorter_match_length = match_length;
+            }
+        }
+
+        // Walk the cheapest path back from the end of the block, and emit it in order.
+        m_pending_symbol_size = 0;
+        m_symbol_frequencies.fill(0);
+        m_distance_frequencies.fill(0);
+
+        for (auto i = m_pending_block_size; i > 0;) {
+            auto [length, distance] = steps[i];
+            i -= length;
+            if (distance == 0)
+                emit_literal(m_rolling_window[block_size + i]);
+            else
+                emit_back_reference(distance, length);
+        }
+        for (size_t i = 0, j = m_pending_symbol_size - 1; i < j; ++i, --j)
+            swap(m_symbol_buffer[i], m_symbol_buffer[j]);
+
+        // The end of block symbol is part of every block.
+        m_symbol_frequencies[EndOfBlock]++;
+    }
+
+    m_symbol_frequencies[EndOfBlock]--;
+    return {};
+}
+
 size_t DeflateCompressor::huffman_block_length(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths)
 {
     size_t length = 0;
@@ -894,7 +1329,7 @@ ErrorOr<void> DeflateCompressor::flush()
     // The following implementation of lz77 compression and huffman encoding is based on the reference implementation by Hans Wennborg https://www.hanshq.net/zip.html
 
     // this reads from the pending block and writes to m_symbol_buffer
-    lz77_compress_block();
+    TRY(lz77_compress_block());
 
     // insert EndOfBlock marker to the symbol buffer
     m_symbol_buffer[m_pending_symbol_size].distance = 0;
@@ -950,13 +1385,16 @@ ErrorOr<void> DeflateCompressor::flush()
     if (m_finished)
         TRY(m_output_stream->align_to_byte_boundary());
 
+    // the end of this block (and of the history before it, if the block was short) becomes the history of the next one
+    auto history_size = min(m_history_size + m_pending_block_size, block_size);
+    __builtin_memmove(m_rolling_window + block_size - history_size, m_rolling_window + block_size + m_pending_block_size - history_size, history_size);
+    m_history_size = history_size;
+
     // reset all block specific members
     m_pending_block_size = 0;
     m_pending_symbol_size = 0;
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
-    // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
-    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
 
     return {};
 }
@@ -970,6 +1408,30 @@ ErrorOr<void> DeflateCompressor::final_flush()
     return {};
 }
 
+ErrorOr<void> DeflateCompressor::sync_flush()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        TRY(flush());
+
+    TRY(m_output_stream->write_bits(0b000u, 3)); // not final, no compression
+    TRY(m_output_stream->align_to_byte_boundary());
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0));
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0xffff));
+    TRY(m_output_stream->flush_buffer_to_stream());
+    return {};
+}
+
+void DeflateCompressor::set_preset_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_history_size == 0 && m_pending_block_size == 0);
+
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+    dictionary.copy_to({ m_rolling_window + block_size - dictionary.size(), dictionary.size() });
+    m_history_size = dictionary.size();
+}
+
 ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
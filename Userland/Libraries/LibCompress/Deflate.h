@@ -30,6 +30,10 @@ public:
 
     static ErrorOr<CanonicalCode> from_bytes(ReadonlyBytes);
 
+    // The code of each symbol in the order in which its bits are read from the stream, and its length (0 if the symbol is unused).
+    ReadonlySpan<u16> bit_codes() const { return m_bit_codes; }
+    ReadonlySpan<u16> bit_code_lengths() const { return m_bit_code_lengths; }
+
 private:
     static constexpr size_t max_allowed_prefixed_code_length = 8;
 
@@ -64,6 +68,66 @@ ALWAYS_INLINE ErrorOr<void> CanonicalCode::write_symbol(LittleEndianOutputBitStr
 
 class DeflateDecompressor final : public Stream {
 private:
+    // Holds the decompressed data that hasn't been read yet, preceded by the data that back references can still refer to.
+    // Unlike in a CircularBuffer, the free space is always contiguous, so that symbols can be decoded right into it.
+    class OutputWindow {
+    public:
+        static constexpr size_t history_size = 32 * KiB;
+        static constexpr size_t capacity = 128 * KiB;
+
+        static ErrorOr<OutputWindow> create();
+
+        Bytes free_space() { return m_buffer.bytes().slice(m_write_position); }
+        size_t written_size() const { return m_write_position; }
+
+        // Makes room for at least `size` bytes by discarding data that is no longer needed.
+        void make_room_for(size_t size);
+        void did_write(size_t size);
+
+        ErrorOr<void> copy_from_seekback(size_t distance, size_t length);
+        Bytes read(Bytes);
+
+    private:
+        explicit OutputWindow(ByteBuffer);
+
+        ByteBuffer m_buffer;
+        size_t m_read_position { 0 };
+        size_t m_write_position { 0 };
+    };
+
+    // A lookup table that decodes a symbol (and for literals, often the one after it) or a length/distance together
+    // with its extra bits with a single lookup, as long as its code is at most fast_table_bits long.
+    class FastDecodeTable {
+    public:
+        static constexpr size_t fast_table_bits = 10;
+
+        struct Entry {
+            enum class Kind : u8 {
+                LongCode, // The code is longer than fast_table_bits, use the CanonicalCode instead.
+                Invalid,
+                Literal,
+                TwoLiterals,
+                EndOfBlock,
+                LengthOrDistance,
+            };
+
+            Kind kind { Kind::LongCode };
+            u8 code_length { 0 };
+            u8 extra_bits { 0 };
+            u16 value { 0 }; // The literal(s), or the base length or distance.
+        };
+
+        static FastDecodeTable for_literals(CanonicalCode const&);
+        static FastDecodeTable for_distances(CanonicalCode const&);
+
+        ALWAYS_INLINE Entry const& lookup(u64 bits) const { return m_entries[bits & ((1u << fast_table_bits) - 1)]; }
+
+    private:
+        void fill(CanonicalCode const&, auto entry_for_symbol);
+
+        Array<Entry, 1 << fast_table_bits> m_entries {};
+    };
+
     class CompressedBlock {
     public:
         CompressedBlock(DeflateDecompressor&, CanonicalCode literal_codes, Optional<CanonicalCode> distance_codes);
@@ -71,11 +135,16 @@ private:
         ErrorOr<bool> try_read_more();
 
     private:
+        ErrorOr<size_t> decode_quickly();
+
         bool m_eof { false };
 
         DeflateDecompressor& m_decompressor;
         CanonicalCode m_literal_codes;
         Optional<CanonicalCode> m_distance_codes;
+
+        FastDecodeTable m_fast_literal_table;
+        Optional<FastDecodeTable> m_fast_distance_table;
     };
 
     class UncompressedBlock {
@@ -111,7 +180,7 @@ public:
     static ErrorOr<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
-    DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, CircularBuffer buffer);
+    DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, OutputWindow);
 
     ErrorOr<u32> decode_length(u32);
     ErrorOr<u32> decode_distance(u32);
@@ -128,7 +197,7 @@ private:
     };
 
     MaybeOwned<LittleEndianInputBitStream> m_input_stream;
-    CircularBuffer m_output_buffer;
+    OutputWindow m_output_window;
 };
 
 class DeflateCompressor final : public Stream {
@@ -140,30 +209,43 @@ public:
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
     static constexpr u16 empty_slot = UINT16_MAX;
 
+    // How the input is split into literals and back references.
+    enum class Parser : u8 {
+        Greedy,  // Take the first match that is found
+        Lazy,    // Take a match unless the next byte starts a longer one
+        Optimal, // Pick the combination of literals and matches that is estimated to be the cheapest to encode
+    };
+
     struct CompressionConstants {
-        size_t good_match_length;  // Once we find a match of at least this length (a good enough match) we reduce max_chain to lower processing time
-        size_t max_lazy_length;    // If the match is at least this long we dont defer matching to the next byte (which takes time) as its good enough
+        Parser parser;
+        size_t good_match_length;  // Once we find a match of at least this length (a good enough match) we reduce max_chain to lower processing time; the optimal parser doesn't search inside such matches at all
+        size_t max_lazy_length;    // If the match is at least this long we dont defer matching to the next byte (which takes time) as its good enough; the greedy parser doesn't hash the inside of longer matches
         size_t great_match_length; // Once we find a match of at least this length (a great match) we can just stop searching for longer ones
         size_t max_chain;          // We only check the actual length of the max_chain closest matches
     };
 
-    // These constants were shamelessly "borrowed" from zlib
+    // The limits of FAST, GOOD and GREAT were shamelessly "borrowed" from zlib's levels 1, 6 and 9
     static constexpr CompressionConstants compression_constants[] = {
-        { 0, 0, 0, 0 },
-        { 4, 4, 8, 4 },
-        { 8, 16, 128, 128 },
-        { 32, 258, 258, 4096 },
-        { max_match_length, max_match_length, max_match_length, 1 << hash_bits } // disable all limits
+        { Parser::Greedy, 0, 0, 0, 0 },
+        { Parser::Greedy, 4, 4, max_match_length, 1 },
+        { Parser::Lazy, 4, 4, 8, 4 },
+        { Parser::Lazy, 8, 16, 128, 128 },
+        { Parser::Lazy, 32, 258, 258, 4096 },
+        { Parser::Lazy, max_match_length, max_match_length, max_match_length, 1 << hash_bits }, // disable all limits
+        { Parser::Optimal, 64, max_match_length, max_match_length, 128 },
     };
 
     enum class CompressionLevel : int {
         STORE = 0,
+        FASTEST,
         FAST,
         GOOD,
         GREAT,
-        BEST // WARNING: this one can take an unreasonable amount of time!
+        BEST,   // WARNING: this one can take an unreasonable amount of time!
+        OPTIMAL // WARNING: this one is an order of magnitude slower than GREAT!
     };
 
     static ErrorOr<NonnullOwnPtr<DeflateCompressor>> construct(MaybeOwned<Stream>, CompressionLevel = CompressionLevel::GOOD);
@@ -176,6 +258,15 @@ public:
     virtual void close() override;
     ErrorOr<void> final_flush();
 
+    // Ends the current block and pads the output to a byte boundary with an empty stored block, without ending
+    // the stream. Whatever is written next can be appended to the output as is, even by another compressor.
+    ErrorOr<void> sync_flush();
+
+    // Lets back references reach into the given data, as if it had been written right before the input. This is
+    // how a stream that is compressed in pieces keeps referring to what came before each piece.
+    // Must be called before anything is written.
+    void set_preset_dictionary(ReadonlyBytes);
+
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
 private:
@@ -187,7 +278,13 @@ private:
     static u16 hash_sequence(u8 const* bytes);
     size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
     size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
-    void lz77_compress_block();
+    void insert_hash(size_t position, u16 hash);
+    void emit_literal(u16 literal);
+    void emit_back_reference(u16 distance, u16 length);
+    ErrorOr<void> lz77_compress_block();
+    void lz77_greedy_parse();
+    void lz77_lazy_parse();
+    ErrorOr<void> lz77_optimal_parse();
 
     // Huffman Coding
     struct code_length_symbol {
@@ -211,7 +308,9 @@ private:
     CompressionConstants m_compression_constants;
     NonnullOwnPtr<LittleEndianOutputBitStream> m_output_stream;
 
+    // The pending block is preceded by up to block_size bytes of the input before it, which back references can reach.
     u8 m_rolling_window[window_size];
+    size_t m_history_size { 0 };
     size_t m_pending_block_size { 0 };
 
     struct [[gnu::packed]] {
@@ -228,6 +327,23 @@ private:
     // LZ77 Chained hash table
     u16 m_hash_head[1 << hash_bits];
     u16 m_hash_prev[window_size];
+
+    // Scratch space of the optimal parser, which is only allocated when it is used
+    struct {
+        struct Match {
+            u16 length;
+            u16 distance;
+        };
+        Vector<Match> matches;
+        Vector<u32> first_match_index; // For each position in the block, where its matches start in `matches`
+
+        struct Step {
+            u16 length;
+            u16 distance; // 0 for a literal
+        };
+        Vector<float> costs;
+        Vector<Step> steps; // For each position in the block, how the cheapest path gets there
+    } m_optimal_parse;
 };
 
 }
@@ -194,7 +194,7 @@ ErrorOr<Bytes> GzipCompressor::read_some(Bytes)
     return Error::from_errno(EBADF);
 }
 
-ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
+static ErrorOr<void> write_member_header(Stream& stream)
 {
     BlockHeader header;
     header.identification_1 = 0x1f;
@@ -204,7 +204,12 @@ ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
     header.modification_time = 0;
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
-    TRY(m_output_stream->write_until_depleted({ &header, sizeof(header) }));
+    return stream.write_until_depleted({ &header, sizeof(header) });
+}
+
+ErrorOr<size_t> GzipCompressor::write_some(ReadonlyBytes bytes)
+{
+    TRY(write_member_header(*m_output_stream));
     auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream)));
     TRY(compressed_stream->write_until_depleted(bytes));
     TRY(compressed_stream->final_flush());
@@ -239,4 +244,149 @@ ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
     return output_stream->read_until_eof();
 }
 
+ErrorOr<NonnullOwnPtr<ParallelGzipCompressor>> ParallelGzipCompressor::create(MaybeOwned<Stream> stream, size_t thread_count, DeflateCompressor::CompressionLevel compression_level)
+{
+    VERIFY(thread_count > 0);
+    auto compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ParallelGzipCompressor(move(stream), thread_count, compression_level)));
+    TRY(compressor->m_buffered_input.try_ensure_capacity(thread_count * chunk_size));
+    TRY(write_member_header(*compressor->m_output_stream));
+    return compressor;
+}
+
+ParallelGzipCompressor::ParallelGzipCompressor(MaybeOwned<Stream> stream, size_t thread_count, DeflateCompressor::CompressionLevel compression_level)
+    : m_output_stream(move(stream))
+    , m_compression_level(compression_level)
+    , m_thread_count(thread_count)
+    , m_thread_pool([](Function<void()> work) { work(); }, thread_count)
+{
+}
+
+ParallelGzipCompressor::~ParallelGzipCompressor()
+{
+    // If finish() wasn't called or failed, for example because writing to the output failed, the member is simply
+    // left without its trailer. No chunk is being compressed outside of a call, so there is nothing else to clean up.
+}
+
+ErrorOr<Bytes> ParallelGzipCompressor::read_some(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> ParallelGzipCompressor::write_some(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    auto batch_size = m_thread_count * chunk_size;
+    auto bytes_to_buffer = min(bytes.size(), batch_size - m_buffered_input.size());
+    TRY(m_buffered_input.try_append(bytes.trim(bytes_to_buffer)));
+
+    if (m_buffered_input.size() == batch_size)
+        TRY(compress_buffered_input(false));
+
+    return bytes_to_buffer;
+}
+
+bool ParallelGzipCompressor::is_eof() const
+{
+    return true;
+}
+
+bool ParallelGzipCompressor::is_open() const
+{
+    return m_output_stream->is_open();
+}
+
+void ParallelGzipCompressor::close()
+{
+}
+
+ErrorOr<void> ParallelGzipCompressor::finish()
+{
+    VERIFY(!m_finished);
+    TRY(compress_buffered_input(true));
+    m_finished = true;
+
+    TRY(m_output_stream->write_value<LittleEndian<u32>>(m_checksum));
+    TRY(m_output_stream->write_value<LittleEndian<u32>>(static_cast<u32>(m_total_input_size)));
+    return {};
+}
+
+ErrorOr<void> ParallelGzipCompressor::compress_chunk(Chunk& chunk, DeflateCompressor::CompressionLevel compression_level)
+{
+    AllocatingMemoryStream output_stream;
+    auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<Stream>(output_stream), compression_level));
+    deflate_stream->set_preset_dictionary(chunk.dictionary);
+    TRY(deflate_stream->write_until_depleted(chunk.input));
+
+    // Every chunk but the last one has to end on a byte boundary, so that the next one can be appended to it.
+    // Those chunks take their output right after the sync flush, and the final block that closes their stream is dropped.
+    if (chunk.is_last) {
+        TRY(deflate_stream->final_flush());
+        chunk.output = TRY(output_stream.read_until_eof());
+    } else {
+        TRY(deflate_stream->sync_flush());
+        chunk.output = TRY(output_stream.read_until_eof());
+        TRY(deflate_stream->final_flush());
+    }
+
+    chunk.checksum = Crypto::Checksum::CRC32 { chunk.input }.digest();
+    return {};
+}
+
+ErrorOr<void> ParallelGzipCompressor::compress_buffered_input(bool is_last)
+{
+    ReadonlyBytes input = m_buffered_input;
+
+    Vector<Chunk> chunks;
+    TRY(chunks.try_ensure_capacity(m_thread_count));
+    for (size_t offset = 0; offset < input.size() || (is_last && chunks.is_empty()); offset += chunk_size) {
+        Chunk chunk;
+        chunk.input = input.slice(offset, min(chunk_size, input.size() - offset));
+        chunk.dictionary = offset == 0 ? m_dictionary.bytes() : input.slice(offset - DeflateCompressor::max_back_reference_distance, DeflateCompressor::max_back_reference_distance);
+        chunk.is_last = is_last && offset + chunk_size >= input.size();
+        chunks.unchecked_append(move(chunk));
+    }
+
+    for (auto& chunk : chunks) {
+        m_thread_pool.submit([this, &chunk] {
+            if (auto result = compress_chunk(chunk, m_compression_level); result.is_error())
+                chunk.error = result.release_error();
+        });
+    }
+    m_thread_pool.wait_for_all();
+
+    for (auto& chunk : chunks) {
+        if (chunk.error.has_value())
+            return chunk.error.release_value();
+
+        TRY(m_output_stream->write_until_depleted(chunk.output));
+        m_checksum = m_total_input_size == 0 ? chunk.checksum : Crypto::Checksum::CRC32::combine(m_checksum, chunk.checksum, chunk.input.size());
+        m_total_input_size += chunk.input.size();
+    }
+
+    // The next batch is primed with the end of this one.
+    if (input.size() >= DeflateCompressor::max_back_reference_distance) {
+        m_dictionary.clear();
+        TRY(m_dictionary.try_append(input.slice_from_end(DeflateCompressor::max_back_reference_distance)));
+    } else {
+        TRY(m_dictionary.try_append(input));
+        if (m_dictionary.size() > DeflateCompressor::max_back_reference_distance)
+            m_dictionary = TRY(m_dictionary.slice(m_dictionary.size() - DeflateCompressor::max_back_reference_distance, DeflateCompressor::max_back_reference_distance));
+    }
+
+    m_buffered_input.clear();
+    return {};
+}
+
+ErrorOr<ByteBuffer> ParallelGzipCompressor::compress_all(ReadonlyBytes bytes, size_t thread_count)
+{
+    auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+    auto gzip_stream = TRY(ParallelGzipCompressor::create(MaybeOwned<Stream>(*output_stream), thread_count));
+
+    TRY(gzip_stream->write_until_depleted(bytes));
+    TRY(gzip_stream->finish());
+
+    return output_stream->read_until_eof();
+}
+
 }
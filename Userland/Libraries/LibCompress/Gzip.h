@@ -12,6 +12,7 @@
 #include <AK/Stream.h>
 #include <LibCompress/Deflate.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Compress {
 
@@ -97,4 +98,57 @@ private:
     MaybeOwned<Stream> m_output_stream;
 };
 
+// Compresses everything written to it into a single gzip member, spreading the work over multiple threads.
+//
+// The input is cut into chunks that are deflated independently and then concatenated. Each chunk is primed with
+// the 32 KiB of input before it, so back references can still cross chunk boundaries, and the output is only
+// slightly larger than that of a GzipCompressor.
+class ParallelGzipCompressor final : public Stream {
+public:
+    static constexpr size_t chunk_size = 128 * KiB;
+
+    static ErrorOr<NonnullOwnPtr<ParallelGzipCompressor>> create(MaybeOwned<Stream>, size_t thread_count, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD);
+    ~ParallelGzipCompressor();
+
+    virtual ErrorOr<Bytes> read_some(Bytes) override;
+    virtual ErrorOr<size_t> write_some(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+    // Compresses the remaining input and ends the member. Nothing can be written afterwards.
+    // Destroying the compressor without calling this leaves the member unfinished.
+    ErrorOr<void> finish();
+
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, size_t thread_count);
+
+private:
+    struct Chunk {
+        ReadonlyBytes dictionary;
+        ReadonlyBytes input;
+        bool is_last { false };
+
+        ByteBuffer output;
+        u32 checksum { 0 };
+        Optional<Error> error;
+    };
+
+    ParallelGzipCompressor(MaybeOwned<Stream>, size_t thread_count, DeflateCompressor::CompressionLevel);
+
+    static ErrorOr<void> compress_chunk(Chunk&, DeflateCompressor::CompressionLevel);
+    ErrorOr<void> compress_buffered_input(bool is_last);
+
+    MaybeOwned<Stream> m_output_stream;
+    DeflateCompressor::CompressionLevel m_compression_level;
+    size_t m_thread_count;
+    bool m_finished { false };
+
+    ByteBuffer m_buffered_input;
+    ByteBuffer m_dictionary;
+    u32 m_checksum { 0 };
+    u64 m_total_input_size { 0 };
+
+    Threading::ThreadPool<Function<void()>> m_thread_pool;
+};
+
 }
@@ -69,8 +69,20 @@ ErrorOr<NonnullOwnPtr<ZlibCompressor>> ZlibCompressor::construct(MaybeOwned<Stre
     // Zlib only defines Deflate as a compression method.
     auto compression_method = ZlibCompressionMethod::Deflate;
 
-    // FIXME: Find a way to compress with Deflate's "Best" compression level.
-    auto compressor_stream = TRY(DeflateCompressor::construct(MaybeOwned(*stream), static_cast<DeflateCompressor::CompressionLevel>(compression_level)));
+    auto deflate_compression_level = [&] {
+        switch (compression_level) {
+        case ZlibCompressionLevel::Fastest:
+            return DeflateCompressor::CompressionLevel::FASTEST;
+        case ZlibCompressionLevel::Fast:
+            return DeflateCompressor::CompressionLevel::FAST;
+        case ZlibCompressionLevel::Default:
+            return DeflateCompressor::CompressionLevel::GOOD;
+        case ZlibCompressionLevel::Best:
+            return DeflateCompressor::CompressionLevel::BEST;
+        }
+        VERIFY_NOT_REACHED();
+    }();
+    auto compressor_stream = TRY(DeflateCompressor::construct(MaybeOwned(*stream), deflate_compression_level));
 
     auto zlib_compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ZlibCompressor(move(stream), move(compressor_stream))));
     TRY(zlib_compressor->write_header(compression_method, compression_level));
@@ -48,6 +48,27 @@ bool has_flag(int value, int flag)
     return (value & flag) == flag;
 }
 
+NotificationType poll_events_to_notification_type(int events)
+{
+    NotificationType type = NotificationType::None;
+    if (has_flag(events, POLLIN))
+        type |= NotificationType::Read;
+    if (has_flag(events, POLLOUT))
+        type |= NotificationType::Write;
+    if (has_flag(events, POLLHUP))
+        type |= NotificationType::Read | NotificationType::HangUp;
+    if (has_flag(events, POLLERR))
+        type |= NotificationType::Error;
+    return type;
+}
+
+void post_notifier_activation(Notifier& notifier, int events)
+{
+    auto type = poll_events_to_notification_type(events) & notifier.type();
+    if (type != NotificationType::None)
+        ThreadEventQueue::current().post_event(notifier, make<NotifierActivationEvent>(notifier.fd(), type));
+}
+
 class EventLoopTimeout {
 public:
     static constexpr ssize_t INVALID_INDEX = NumericLimits<ssize_t>::max();
@@ -260,6 +281,10 @@ struct ThreadData {
 
     ~ThreadData()
     {
+#ifdef AK_OS_SERENITY
+        if (event_poll_fd != -1)
+            close(event_poll_fd);
+#endif
         pthread_rwlock_wrlock(&*s_thread_data_lock);
         s_thread_data.remove(s_thread_id);
         pthread_rwlock_unlock(&*s_thread_data_lock);
@@ -271,6 +296,12 @@ struct ThreadData {
             close(wake_pipe_fds[0]);
         if (wake_pipe_fds[1] != -1)
             close(wake_pipe_fds[1]);
+#ifdef AK_OS_SERENITY
+        if (event_poll_fd != -1) {
+            close(event_poll_fd);
+            event_poll_fd = -1;
+        }
+#endif
 
         auto result = Core::System::pipe2(O_CLOEXEC);
         if (result.is_error()) {
@@ -280,12 +311,66 @@ struct ThreadData {
 
         wake_pipe_fds = result.release_value();
 
+#ifdef AK_OS_SERENITY
+        if (initialize_event_poll())
+            return;
+#endif
+
         // The wake pipe informs us of POSIX signals as well as manual calls to wake()
         VERIFY(poll_fds.size() == 0);
         poll_fds.append({ .fd = wake_pipe_fds[0], .events = POLLIN, .revents = 0 });
         notifier_by_index.append(nullptr);
     }
 
+#ifdef AK_OS_SERENITY
+    bool uses_event_poll() const { return event_poll_fd != -1; }
+
+    bool initialize_event_poll()
+    {
+        VERIFY(notifiers_by_fd.is_empty());
+
+        auto result = Core::System::epoll_create(EPOLL_CLOEXEC);
+        if (result.is_error()) {
+            dbgln("EventLoopImplementationUnix: Falling back to poll(), failed to create event poll: {}", result.error());
+            return false;
+        }
+        event_poll_fd = result.release_value();
+
+        epoll_event event { .events = EPOLLIN, .data = { .fd = wake_pipe_fds[0] } };
+        if (auto add_result = Core::System::epoll_ctl(event_poll_fd, EPOLL_CTL_ADD, wake_pipe_fds[0], &event); add_result.is_error()) {
+            dbgln("EventLoopImplementationUnix: Falling back to poll(), failed to watch wake pipe: {}", add_result.error());
+            close(event_poll_fd);
+            event_poll_fd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    // Tells the kernel about the combined interest of all notifiers for the given file descriptor.
+    void update_event_poll_interest(int fd)
+    {
+        auto it = notifiers_by_fd.find(fd);
+        if (it == notifiers_by_fd.end() || it->value.is_empty()) {
+            if (it != notifiers_by_fd.end())
+                notifiers_by_fd.remove(it);
+            // The file descriptor might already have been closed, in which case the kernel has forgotten about it already.
+            (void)Core::System::epoll_ctl(event_poll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            return;
+        }
+
+        short events = 0;
+        for (auto* notifier : it->value)
+            events |= notification_type_to_poll_events(notifier->type());
+
+        epoll_event event { .events = static_cast<u32>(events), .data = { .fd = fd } };
+        auto result = Core::System::epoll_ctl(event_poll_fd, EPOLL_CTL_MOD, fd, &event);
+        if (result.is_error() && result.error().code() == ENOENT)
+            result = Core::System::epoll_ctl(event_poll_fd, EPOLL_CTL_ADD, fd, &event);
+        if (result.is_error())
+            dbgln("EventLoopImplementationUnix: Failed to watch fd {}: {}", fd, result.error());
+    }
+#endif
+
     // Each thread has its own timers, notifiers and a wake pipe.
     TimeoutSet timeouts;
 
@@ -293,6 +378,14 @@ struct ThreadData {
     HashMap<Notifier*, size_t> notifier_by_ptr;
     Vector<Notifier*> notifier_by_index;
 
+#ifdef AK_OS_SERENITY
+    // With an event poll, the kernel remembers which file descriptors we are interested in, so we don't have to pass
+    // all of them to every wait. Events only tell us the file descriptor, which can have multiple notifiers.
+    int event_poll_fd { -1 };
+    HashMap<int, Vector<Notifier*, 1>> notifiers_by_fd;
+    Array<epoll_event, 32> ready_events;
+#endif
+
     // The wake pipe is used to notify another event loop that someone has called wake(), or a signal has been received.
     // wake() writes 0i32 into the pipe, signals write the signal number (guaranteed non-zero).
     Array<int, 2> wake_pipe_fds { -1, -1 };
@@ -381,9 +474,18 @@ retry:
         }
     }
 
+    if (should_wait_forever)
+        timeout = -1;
+
 try_select_again:
     // select() and wait for file system events, calls to wake(), POSIX signals, or timer expirations.
-    ErrorOr<int> error_or_marked_fd_count = System::poll(thread_data.poll_fds, should_wait_forever ? -1 : timeout);
+#ifdef AK_OS_SERENITY
+    ErrorOr<int> error_or_marked_fd_count = thread_data.uses_event_poll()
+        ? System::epoll_wait(thread_data.event_poll_fd, thread_data.ready_events, timeout)
+        : System::poll(thread_data.poll_fds, timeout);
+#else
+    ErrorOr<int> error_or_marked_fd_count = System::poll(thread_data.poll_fds, timeout);
+#endif
     auto time_after_poll = MonotonicTime::now_coarse();
     // Because POSIX, we might spuriously return from select() with EINTR; just select again.
     if (error_or_marked_fd_count.is_error()) {
@@ -393,9 +495,22 @@ try_select_again:
         VERIFY_NOT_REACHED();
     }
 
+    bool wake_pipe_is_readable = false;
+#ifdef AK_OS_SERENITY
+    if (thread_data.uses_event_poll()) {
+        for (int i = 0; i < error_or_marked_fd_count.value(); ++i) {
+            if (thread_data.ready_events[i].data.fd == thread_data.wake_pipe_fds[0])
+                wake_pipe_is_readable = true;
+        }
+    } else
+#endif
+    {
+        wake_pipe_is_readable = has_flag(thread_data.poll_fds[0].revents, POLLIN);
+    }
+
     // We woke up due to a call to wake() or a POSIX signal.
     // Handle signals and see whether we need to handle events as well.
-    if (has_flag(thread_data.poll_fds[0].revents, POLLIN)) {
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         ssize_t nread;
         // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
@@ -426,24 +541,24 @@ try_select_again:
 
     if (error_or_marked_fd_count.value() != 0) {
         // Handle file system notifiers by making them normal events.
-        for (size_t i = 1; i < thread_data.poll_fds.size(); ++i) {
-            auto& revents = thread_data.poll_fds[i].revents;
-            auto& notifier = *thread_data.notifier_by_index[i];
-
-            NotificationType type = NotificationType::None;
-            if (has_flag(revents, POLLIN))
-                type |= NotificationType::Read;
-            if (has_flag(revents, POLLOUT))
-                type |= NotificationType::Write;
-            if (has_flag(revents, POLLHUP))
-                type |= NotificationType::Read | NotificationType::HangUp;
-            if (has_flag(revents, POLLERR))
-                type |= NotificationType::Error;
-
-            type &= notifier.type();
-
-            if (type != NotificationType::None)
-                ThreadEventQueue::current().post_event(notifier, make<NotifierActivationEvent>(notifier.fd(), type));
+#ifdef AK_OS_SERENITY
+        if (thread_data.uses_event_poll()) {
+            // The epoll events share their values with the poll events.
+            for (int i = 0; i < error_or_marked_fd_count.value(); ++i) {
+                auto& event = thread_data.ready_events[i];
+                if (event.data.fd == thread_data.wake_pipe_fds[0])
+                    continue;
+                auto it = thread_data.notifiers_by_fd.find(event.data.fd);
+                if (it == thread_data.notifiers_by_fd.end())
+                    continue;
+                for (auto* notifier : it->value)
+                    post_notifier_activation(*notifier, event.events);
+            }
+        } else
+#endif
+        {
+            for (size_t i = 1; i < thread_data.poll_fds.size(); ++i)
+                post_notifier_activation(*thread_data.notifier_by_index[i], thread_data.poll_fds[i].revents);
         }
     }
 
@@ -525,6 +640,10 @@ void EventLoopImplementationUnix::notify_forked_and_in_child()
     thread_data.poll_fds.clear();
     thread_data.notifier_by_ptr.clear();
     thread_data.notifier_by_index.clear();
+#ifdef AK_OS_SERENITY
+    // The event poll is shared with the parent, so we need our own one.
+    thread_data.notifiers_by_fd.clear();
+#endif
     thread_data.initialize_wake_pipe();
     if (auto* info = signals_info<false>()) {
         info->signal_handlers.clear();
@@ -680,6 +799,15 @@ void EventLoopManagerUnix::register_notifier(Notifier& notifier)
 {
     auto& thread_data = ThreadData::the();
 
+#ifdef AK_OS_SERENITY
+    if (thread_data.uses_event_poll()) {
+        thread_data.notifiers_by_fd.ensure(notifier.fd()).append(&notifier);
+        thread_data.update_event_poll_interest(notifier.fd());
+        notifier.set_owner_thread(s_thread_id);
+        return;
+    }
+#endif
+
     thread_data.notifier_by_ptr.set(&notifier, thread_data.poll_fds.size());
     thread_data.notifier_by_index.append(&notifier);
     thread_data.poll_fds.append({
@@ -698,6 +826,18 @@ void EventLoopManagerUnix::unregister_notifier(Notifier& notifier)
         return;
 
     auto& thread_data = *thread_data_ptr;
+
+#ifdef AK_OS_SERENITY
+    if (thread_data.uses_event_poll()) {
+        auto it = thread_data.notifiers_by_fd.find(notifier.fd());
+        VERIFY(it != thread_data.notifiers_by_fd.end());
+        bool did_remove = it->value.remove_first_matching([&](auto* other) { return other == &notifier; });
+        VERIFY(did_remove);
+        thread_data.update_event_poll_interest(notifier.fd());
+        return;
+    }
+#endif
+
     auto it = thread_data.notifier_by_ptr.find(&notifier);
     VERIFY(it != thread_data.notifier_by_ptr.end());
 
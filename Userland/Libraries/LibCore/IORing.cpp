@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <LibCore/IORing.h>
+#include <LibCore/System.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+namespace Core {
+
+ErrorOr<NonnullOwnPtr<IORing>> IORing::create(u32 entries)
+{
+    int fd = TRY(System::io_ring_create(entries, O_CLOEXEC));
+    ArmedScopeGuard close_fd = [&] { (void)System::close(fd); };
+
+    // The header tells us how large the whole mapping has to be.
+    auto* header_mapping = TRY(System::mmap(nullptr, PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0));
+    size_t mapping_size = static_cast<IORingHeader const*>(header_mapping)->mapping_size;
+    TRY(System::munmap(header_mapping, PAGE_SIZE));
+
+    auto* mapping = TRY(System::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0, 0, "IORing"sv));
+    auto ring = adopt_nonnull_own_or_enomem(new (nothrow) IORing(fd, mapping));
+    if (ring.is_error()) {
+        (void)System::munmap(mapping, mapping_size);
+        return ring.release_error();
+    }
+
+    close_fd.disarm();
+    return ring.release_value();
+}
+
+IORing::IORing(int fd, void* mapping)
+    : m_fd(fd)
+    , m_mapping(mapping)
+    , m_header(static_cast<IORingHeader*>(mapping))
+{
+    m_mapping_size = m_header->mapping_size;
+    m_submissions = reinterpret_cast<IORingSubmission*>(static_cast<u8*>(mapping) + m_header->submissions_offset);
+    m_completions = reinterpret_cast<IORingCompletion const*>(static_cast<u8*>(mapping) + m_header->completions_offset);
+}
+
+IORing::~IORing()
+{
+    MUST(System::munmap(m_mapping, m_mapping_size));
+    MUST(System::close(m_fd));
+}
+
+u32 IORing::queued_submission_count() const
+{
+    return m_header->submission_tail - AK::atomic_load(&m_header->submission_head, AK::memory_order_acquire);
+}
+
+u32 IORing::available_completion_count() const
+{
+    return AK::atomic_load(&m_header->completion_tail, AK::memory_order_acquire) - m_header->completion_head;
+}
+
+ErrorOr<void> IORing::queue(IORingSubmission const& submission)
+{
+    if (queued_submission_count() >= m_header->submission_entries)
+        return Error::from_errno(EBUSY);
+
+    auto tail = m_header->submission_tail;
+    m_submissions[tail & (m_header->submission_entries - 1)] = submission;
+    AK::atomic_store(&m_header->submission_tail, tail + 1, AK::memory_order_release);
+    return {};
+}
+
+ErrorOr<void> IORing::queue_nop(u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Nop, .reserved = {}, .fd = -1, .flags = 0, .length = 0, .offset = 0, .buffer = 0, .user_data = user_data });
+}
+
+ErrorOr<void> IORing::queue_read(int fd, Bytes buffer, u64 offset, u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Read, .reserved = {}, .fd = fd, .flags = 0, .length = static_cast<u32>(buffer.size()), .offset = offset, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .user_data = user_data });
+}
+
+ErrorOr<void> IORing::queue_write(int fd, ReadonlyBytes buffer, u64 offset, u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Write, .reserved = {}, .fd = fd, .flags = 0, .length = static_cast<u32>(buffer.size()), .offset = offset, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .user_data = user_data });
+}
+
+ErrorOr<void> IORing::queue_accept(int fd, int flags, u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Accept, .reserved = {}, .fd = fd, .flags = static_cast<u32>(flags), .length = 0, .offset = 0, .buffer = 0, .user_data = user_data });
+}
+
+ErrorOr<void> IORing::queue_send(int fd, ReadonlyBytes buffer, int flags, u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Send, .reserved = {}, .fd = fd, .flags = static_cast<u32>(flags), .length = static_cast<u32>(buffer.size()), .offset = 0, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .user_data = user_data });
+}
+
+ErrorOr<void> IORing::queue_receive(int fd, Bytes buffer, int flags, u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Receive, .reserved = {}, .fd = fd, .flags = static_cast<u32>(flags), .length = static_cast<u32>(buffer.size()), .offset = 0, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .user_data = user_data });
+}
+
+ErrorOr<void> IORing::queue_fsync(int fd, u64 user_data)
+{
+    return queue({ .opcode = IORingOpcode::Fsync, .reserved = {}, .fd = fd, .flags = 0, .length = 0, .offset = 0, .buffer = 0, .user_data = user_data });
+}
+
+ErrorOr<size_t> IORing::submit(u32 min_complete, Optional<Duration> timeout)
+{
+    timespec timeout_spec;
+    if (timeout.has_value())
+        timeout_spec = timeout->to_timespec();
+
+    for (;;) {
+        auto result = System::io_ring_enter(m_fd, queued_submission_count(), min_complete, timeout.has_value() ? &timeout_spec : nullptr);
+        if (result.is_error() && result.error().code() == EINTR)
+            continue;
+        return result;
+    }
+}
+
+}
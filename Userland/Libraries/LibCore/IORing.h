@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Time.h>
+#include <Kernel/API/IORing.h>
+
+namespace Core {
+
+// A wrapper around the kernel's submission and completion queues for batching I/O operations.
+// Operations are queued locally, passed to the kernel with submit(), and their results are retrieved with
+// for_each_completion(). Each operation's completion carries the user_data it was queued with.
+//
+// NOTE: Operations only make progress while the process that created the ring is inside submit(). Pending operations on
+//       sockets and pipes are only retried there, and even completed block device transfers are only posted there.
+//       Call submit() with a non-zero min_complete to wait for them, instead of expecting completions to show up.
+class IORing {
+    AK_MAKE_NONCOPYABLE(IORing);
+    AK_MAKE_NONMOVABLE(IORing);
+
+public:
+    static ErrorOr<NonnullOwnPtr<IORing>> create(u32 entries);
+    ~IORing();
+
+    int fd() const { return m_fd; }
+    u32 submission_entries() const { return m_header->submission_entries; }
+
+    // These fail with EBUSY if the submission queue is full, in which case submit() has to be called first.
+    ErrorOr<void> queue(IORingSubmission const&);
+    ErrorOr<void> queue_nop(u64 user_data);
+    ErrorOr<void> queue_read(int fd, Bytes, u64 offset, u64 user_data);
+    ErrorOr<void> queue_write(int fd, ReadonlyBytes, u64 offset, u64 user_data);
+    ErrorOr<void> queue_accept(int fd, int flags, u64 user_data);
+    ErrorOr<void> queue_send(int fd, ReadonlyBytes, int flags, u64 user_data);
+    ErrorOr<void> queue_receive(int fd, Bytes, int flags, u64 user_data);
+    ErrorOr<void> queue_fsync(int fd, u64 user_data);
+
+    u32 queued_submission_count() const;
+    u32 available_completion_count() const;
+
+    // Passes all queued operations to the kernel, and waits until at least `min_complete` completions are available.
+    // Returns how many operations the kernel has accepted.
+    ErrorOr<size_t> submit(u32 min_complete = 0, Optional<Duration> timeout = {});
+
+    template<typename Callback>
+    size_t for_each_completion(Callback callback)
+    {
+        auto tail = AK::atomic_load(&m_header->completion_tail, AK::memory_order_acquire);
+        auto head = m_header->completion_head;
+        size_t count = 0;
+        for (; head != tail; ++head, ++count)
+            callback(m_completions[head & (m_header->completion_entries - 1)]);
+        AK::atomic_store(&m_header->completion_head, head, AK::memory_order_release);
+        return count;
+    }
+
+private:
+    IORing(int fd, void* mapping);
+
+    int m_fd { -1 };
+    void* m_mapping { nullptr };
+    size_t m_mapping_size { 0 };
+    IORingHeader* m_header { nullptr };
+    IORingSubmission* m_submissions { nullptr };
+    IORingCompletion const* m_completions { nullptr };
+};
+
+}
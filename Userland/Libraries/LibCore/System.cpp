@@ -1770,6 +1770,47 @@ ErrorOr<int> poll(Span<struct pollfd> poll_fds, int timeout)
     return rc;
 }
 
+#ifdef AK_OS_SERENITY
+ErrorOr<int> epoll_create(int flags)
+{
+    int rc = ::epoll_create1(flags);
+    if (rc < 0)
+        return Error::from_syscall("epoll_create"sv, -errno);
+    return rc;
+}
+
+ErrorOr<void> epoll_ctl(int epoll_fd, int operation, int fd, struct epoll_event const* event)
+{
+    if (::epoll_ctl(epoll_fd, operation, fd, const_cast<struct epoll_event*>(event)) < 0)
+        return Error::from_syscall("epoll_ctl"sv, -errno);
+    return {};
+}
+
+ErrorOr<int> epoll_wait(int epoll_fd, Span<struct epoll_event> events, int timeout)
+{
+    auto const rc = ::epoll_wait(epoll_fd, events.data(), events.size(), timeout);
+    if (rc < 0)
+        return Error::from_syscall("epoll_wait"sv, -errno);
+    return rc;
+}
+
+ErrorOr<int> io_ring_create(u32 entries, int options)
+{
+    int rc = ::io_ring_create(entries, options);
+    if (rc < 0)
+        return Error::from_syscall("io_ring_create"sv, -errno);
+    return rc;
+}
+
+ErrorOr<size_t> io_ring_enter(int fd, u32 to_submit, u32 min_complete, struct timespec const* timeout)
+{
+    int rc = ::io_ring_enter(fd, to_submit, min_complete, timeout);
+    if (rc < 0)
+        return Error::from_syscall("io_ring_enter"sv, -errno);
+    return rc;
+}
+#endif
+
 #ifdef AK_OS_SERENITY
 ErrorOr<void> posix_fallocate(int fd, off_t offset, off_t length)
 {
@@ -47,6 +47,7 @@
 
 #ifdef AK_OS_SERENITY
 #    include <Kernel/API/Unshare.h>
+#    include <sys/epoll.h>
 #endif
 
 namespace Core::System {
@@ -244,6 +245,11 @@ ErrorOr<ByteString> readlink(StringView pathname);
 ErrorOr<int> poll(Span<struct pollfd>, int timeout);
 
 #ifdef AK_OS_SERENITY
+ErrorOr<int> epoll_create(int flags);
+ErrorOr<void> epoll_ctl(int epoll_fd, int operation, int fd, struct epoll_event const*);
+ErrorOr<int> epoll_wait(int epoll_fd, Span<struct epoll_event>, int timeout);
+ErrorOr<int> io_ring_create(u32 entries, int options);
+ErrorOr<size_t> io_ring_enter(int fd, u32 to_submit, u32 min_complete, struct timespec const* timeout);
 ErrorOr<void> create_block_device(StringView name, mode_t mode, unsigned major, unsigned minor);
 ErrorOr<void> create_char_device(StringView name, mode_t mode, unsigned major, unsigned minor);
 #endif
@@ -24,68 +24,7 @@ ErrorOr<ByteBuffer> ChaCha20Poly1305::poly1305_key()
 // https://datatracker.ietf.org/doc/html/rfc8439#section-2.8
 ErrorOr<ByteBuffer> ChaCha20Poly1305::encrypt(ReadonlyBytes aad, ReadonlyBytes input_plaintext)
 {
-    // First, a Poly1305 one-time key is generated from the 256-bit key
-    // and nonce using the procedure described in Section 2.6.
-    auto otk = TRY(poly1305_key());
-
-    // Next, the ChaCha20 encryption function is called to encrypt the
-    // plaintext, using the same key and nonce, and with the initial
-    // counter set to 1.
-    auto ciphertext_buffer = TRY(ByteBuffer::create_zeroed(input_plaintext.size()));
-    auto ciphertext = ciphertext_buffer.bytes();
-    auto chacha = Crypto::Cipher::ChaCha20(m_key, m_nonce, 1);
-    chacha.encrypt(input_plaintext, ciphertext);
-
-    // Finally, the Poly1305 function is called with the Poly1305 key
-    // calculated above, and a message constructed as a concatenation of
-    // the following:
-    auto mac_data = TRY(ByteBuffer::create_zeroed(0));
-    auto buffer_size = aad.size() + pad_to_16(aad) + ciphertext_buffer.size() + pad_to_16(ciphertext_buffer) + sizeof(u64) + sizeof(u64);
-    mac_data.ensure_capacity(buffer_size);
-
-    // The AAD
-    mac_data.append(aad);
-
-    // padding1 -- the padding is up to 15 zero bytes, and it brings
-    // the total length so far to an integral multiple of 16.  If the
-    // length of the AAD was already an integral multiple of 16 bytes,
-    // this field is zero-length.
-    for (size_t i = 0; i < pad_to_16(aad); ++i)
-        mac_data.append(0);
-
-    // The ciphertext
-    mac_data.append(ciphertext);
-
-    // padding2 -- the padding is up to 15 zero bytes, and it brings
-    // the total length so far to an integral multiple of 16.  If the
-    // length of the ciphertext was already an integral multiple of 16
-    // bytes, this field is zero-length.
-    for (size_t i = 0; i < pad_to_16(ciphertext); ++i)
-        mac_data.append(0);
-
-    u8 placeholder[8] = { 0 };
-    // The length of the additional data in octets (as a 64-bit little-endian integer).
-    mac_data.append(ReadonlyBytes { placeholder, 8 });
-    ByteReader::store(static_cast<u8*>(mac_data.end_pointer()) - sizeof(u64), AK::convert_between_host_and_little_endian(static_cast<u64>(aad.size())));
-
-    // The length of the ciphertext in octets (as a 64-bit little-endian integer).
-    mac_data.append(ReadonlyBytes { placeholder, 8 });
-    ByteReader::store(static_cast<u8*>(mac_data.end_pointer()) - sizeof(u64), AK::convert_between_host_and_little_endian(static_cast<u64>(ciphertext.size())));
-
-    Crypto::Authentication::Poly1305 mac_function(otk);
-    mac_function.update(mac_data.bytes());
-    auto tag = TRY(mac_function.digest());
-
-    // The output from the AEAD is the concatenation of:
-    auto result = TRY(ByteBuffer::create_zeroed(0));
-    result.ensure_capacity(ciphertext.size() + tag.size());
-
-    // A ciphertext of the same length as the plaintext.
-    result.append(ciphertext);
-
-    // A 128-bit tag, which is the output of the Poly1305 function.
-    result.append(tag);
-    return result;
+    return encrypt_or_decrypt(aad, input_plaintext, Direction::Encrypt);
 }
 
 // https://datatracker.ietf.org/doc/html/rfc8439#section-2.8
@@ -97,68 +36,72 @@ ErrorOr<ByteBuffer> ChaCha20Poly1305::decrypt(ReadonlyBytes aad, ReadonlyBytes c
     //    producing the plaintext.
     // o  The Poly1305 function is still run on the AAD and the ciphertext,
     //    not the plaintext.
+    return encrypt_or_decrypt(aad, ciphertext, Direction::Decrypt);
+}
+
+ErrorOr<ByteBuffer> ChaCha20Poly1305::encrypt_or_decrypt(ReadonlyBytes aad, ReadonlyBytes input, Direction direction)
+{
+    // The ciphertext is authenticated while it is still in the cache, so the input is processed in chunks
+    // that are a whole number of ChaCha20 blocks; the cipher starts a new block on every call.
+    static constexpr size_t chunk_size = 8 * 64;
+
+    static constexpr u8 zeroes[16] = {};
 
     // First, a Poly1305 one-time key is generated from the 256-bit key
     // and nonce using the procedure described in Section 2.6.
     auto otk = TRY(poly1305_key());
 
-    // Next, the ChaCha20 encryption function is called to decrypt the
-    // ciphertext, using the same key and nonce, and with the initial
-    // counter set to 1.
-    auto chacha = Crypto::Cipher::ChaCha20(m_key, m_nonce, 1);
-    auto plaintext_buffer = TRY(ByteBuffer::create_zeroed(ciphertext.size()));
-    auto plaintext = plaintext_buffer.bytes();
-    chacha.encrypt(ciphertext, plaintext);
+    // The output from the AEAD is the concatenation of:
+    // A ciphertext (or plaintext) of the same length as the input, and
+    // a 128-bit tag, which is the output of the Poly1305 function.
+    auto result = TRY(ByteBuffer::create_uninitialized(input.size() + 16));
+    auto output = result.bytes().trim(input.size());
 
-    // Finally, the Poly1305 function is called with the Poly1305 key
-    // calculated above, and a message constructed as a concatenation of
-    // the following:
-    auto mac_data = TRY(ByteBuffer::create_zeroed(0));
-    auto buffer_size = aad.size() + pad_to_16(aad) + ciphertext.size() + pad_to_16(ciphertext) + sizeof(u64) + sizeof(u64);
-    mac_data.ensure_capacity(buffer_size);
+    // The Poly1305 function is called with the Poly1305 key calculated
+    // above, and a message constructed as a concatenation of the following:
+    Crypto::Authentication::Poly1305 mac_function(otk);
 
     // The AAD
-    mac_data.append(aad);
+    mac_function.update(aad);
 
     // padding1 -- the padding is up to 15 zero bytes, and it brings
     // the total length so far to an integral multiple of 16.  If the
     // length of the AAD was already an integral multiple of 16 bytes,
     // this field is zero-length.
-    for (size_t i = 0; i < pad_to_16(aad); ++i)
-        mac_data.append(0);
+    mac_function.update({ zeroes, pad_to_16(aad) });
 
-    // The ciphertext
-    mac_data.append(ciphertext);
+    // The ChaCha20 encryption function is called to encrypt the
+    // plaintext, using the same key and nonce, and with the initial
+    // counter set to 1. The ciphertext is fed to Poly1305 as it is produced.
+    auto chacha = Crypto::Cipher::ChaCha20(m_key, m_nonce, 1);
+    for (size_t offset = 0; offset < input.size(); offset += chunk_size) {
+        auto size = min(chunk_size, input.size() - offset);
+        auto input_chunk = input.slice(offset, size);
+        auto output_chunk = output.slice(offset, size);
+
+        if (direction == Direction::Decrypt)
+            mac_function.update(input_chunk);
+        chacha.encrypt(input_chunk, output_chunk);
+        if (direction == Direction::Encrypt)
+            mac_function.update(output_chunk);
+    }
 
     // padding2 -- the padding is up to 15 zero bytes, and it brings
     // the total length so far to an integral multiple of 16.  If the
     // length of the ciphertext was already an integral multiple of 16
     // bytes, this field is zero-length.
-    for (size_t i = 0; i < pad_to_16(ciphertext); ++i)
-        mac_data.append(0);
+    mac_function.update({ zeroes, pad_to_16(input) });
 
-    u8 placeholder[8] = { 0 };
+    u8 lengths[16];
     // The length of the additional data in octets (as a 64-bit little-endian integer).
-    mac_data.append(ReadonlyBytes { placeholder, 8 });
-    ByteReader::store(static_cast<u8*>(mac_data.end_pointer()) - sizeof(u64), AK::convert_between_host_and_little_endian(static_cast<u64>(aad.size())));
-
+    ByteReader::store(lengths, AK::convert_between_host_and_little_endian(static_cast<u64>(aad.size())));
     // The length of the ciphertext in octets (as a 64-bit little-endian integer).
-    mac_data.append(ReadonlyBytes { placeholder, 8 });
-    ByteReader::store(static_cast<u8*>(mac_data.end_pointer()) - sizeof(u64), AK::convert_between_host_and_little_endian(static_cast<u64>(ciphertext.size())));
+    ByteReader::store(lengths + 8, AK::convert_between_host_and_little_endian(static_cast<u64>(input.size())));
+    mac_function.update({ lengths, 16 });
 
-    Crypto::Authentication::Poly1305 mac_function(otk);
-    mac_function.update(mac_data.bytes());
     auto tag = TRY(mac_function.digest());
+    tag.bytes().copy_to(result.bytes().slice(input.size()));
 
-    // The output from the AEAD is the concatenation of:
-    auto result = TRY(ByteBuffer::create_zeroed(0));
-    result.ensure_capacity(plaintext.size() + tag.size());
-
-    // A plaintext of the same length as the ciphertext.
-    result.append(plaintext);
-
-    // A 128-bit tag, which is the output of the Poly1305 function.
-    result.append(tag);
     return result;
 }
 
@@ -26,9 +26,15 @@ public:
 private:
     u8 pad_to_16(ReadonlyBytes data)
     {
-        return 16 - (data.size() % 16);
+        return (16 - (data.size() % 16)) % 16;
     }
 
+    enum class Direction {
+        Encrypt,
+        Decrypt,
+    };
+    ErrorOr<ByteBuffer> encrypt_or_decrypt(ReadonlyBytes aad, ReadonlyBytes input, Direction);
+
     ByteBuffer m_key;
     ByteBuffer m_nonce;
 };
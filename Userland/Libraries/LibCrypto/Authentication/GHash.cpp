@@ -5,7 +5,10 @@
  */
 
 #include <AK/ByteReader.h>
+#include <AK/CPUFeatures.h>
 #include <AK/Debug.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Authentication/GHash.h>
 
@@ -29,60 +32,212 @@ namespace Crypto::Authentication {
 
 GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
 {
-    u32 tag[4] { 0, 0, 0, 0 };
-
-    auto transform_one = [&](auto& buf) {
-        size_t i = 0;
-        for (; i < buf.size(); i += 16) {
-            if (i + 16 <= buf.size()) {
-                for (auto j = 0; j < 4; ++j) {
-                    tag[j] ^= to_u32(buf.offset(i + j * 4));
-                }
-                galois_multiply(tag, m_key, tag);
-            }
-        }
+    begin();
+    update(aad);
+    update(cipher);
+    return finish(aad.size(), cipher.size());
+}
+
+GHash::TagType GHash::finish(u64 aad_length, u64 cipher_length)
+{
+    auto aad_bits = 8 * aad_length;
+    auto cipher_bits = 8 * cipher_length;
+
+    auto high = [](u64 value) -> u32 { return value >> 32; };
+    auto low = [](u64 value) -> u32 { return value & 0xffffffff; };
+
+    if constexpr (GHASH_PROCESS_DEBUG) {
+        dbgln("AAD bits: {} : {}", high(aad_bits), low(aad_bits));
+        dbgln("Cipher bits: {} : {}", high(cipher_bits), low(cipher_bits));
+        dbgln("Tag bits: {} : {} : {} : {}", m_tag[0], m_tag[1], m_tag[2], m_tag[3]);
+    }
+
+    u32 const lengths[4] { high(aad_bits), low(aad_bits), high(cipher_bits), low(cipher_bits) };
+    u8 lengths_block[16];
+    to_u8s(lengths_block, lengths);
+    update({ lengths_block, sizeof(lengths_block) });
+
+    dbgln_if(GHASH_PROCESS_DEBUG, "Tag bits: {} : {} : {} : {}", m_tag[0], m_tag[1], m_tag[2], m_tag[3]);
+
+    TagType digest;
+    to_u8s(digest.data, m_tag);
+
+    return digest;
+}
 
-        if (i > buf.size()) {
-            u8 buffer[16] = {};
-            Bytes buffer_bytes { buffer, 16 };
-            buf.slice(i - 16).copy_to(buffer_bytes);
+template<>
+void GHash::expand_key_impl<CPUFeatures::None>()
+{
+}
+
+template<>
+void GHash::update_impl<CPUFeatures::None>(ReadonlyBytes data)
+{
+    auto& tag = m_tag;
 
+    size_t i = 0;
+    for (; i < data.size(); i += 16) {
+        if (i + 16 <= data.size()) {
             for (auto j = 0; j < 4; ++j) {
-                tag[j] ^= to_u32(buffer_bytes.offset(j * 4));
+                tag[j] ^= to_u32(data.offset(i + j * 4));
             }
             galois_multiply(tag, m_key, tag);
         }
+    }
+
+    if (i > data.size()) {
+        u8 buffer[16] = {};
+        Bytes buffer_bytes { buffer, 16 };
+        data.slice(i - 16).copy_to(buffer_bytes);
+
+        for (auto j = 0; j < 4; ++j) {
+            tag[j] ^= to_u32(buffer_bytes.offset(j * 4));
+        }
+        galois_multiply(tag, m_key, tag);
+    }
+}
+
+#if AK_CAN_CODEGEN_FOR_X86_PCLMUL && AK_CAN_CODEGEN_FOR_X86_SSE42
+// This follows Intel's "Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode".
+// Blocks are byte-reversed, which makes each one a little-endian 128-bit integer whose bits are the (reflected)
+// coefficients of the field element. Products of such integers end up shifted right by one bit, which is
+// corrected before reducing them. As reducing is linear, the products of several blocks with successive powers
+// of the key can be added up first and reduced only once.
+namespace PCLMUL {
+
+using AK::SIMD::u32x4;
+using AK::SIMD::u64x2;
+using AK::SIMD::u8x16;
+using illx2 = signed long long int __attribute__((vector_size(16)));
+
+struct Product {
+    u64x2 low;
+    u64x2 high;
+};
+
+template<int selector>
+[[gnu::target("pclmul"), gnu::always_inline]] static inline u64x2 carryless_multiply(u64x2 a, u64x2 b)
+{
+    return bit_cast<u64x2>(__builtin_ia32_pclmulqdq128(bit_cast<illx2>(a), bit_cast<illx2>(b), selector));
+}
+
+[[gnu::target("pclmul"), gnu::always_inline]] static inline Product multiply(u64x2 a, u64x2 b)
+{
+    auto middle = carryless_multiply<0x01>(a, b) ^ carryless_multiply<0x10>(a, b);
+    return {
+        carryless_multiply<0x00>(a, b) ^ u64x2 { 0, middle[0] },
+        carryless_multiply<0x11>(a, b) ^ u64x2 { middle[1], 0 },
     };
+}
 
-    transform_one(aad);
-    transform_one(cipher);
+[[gnu::target("sse4.2"), gnu::always_inline]] static inline u64x2 reduce(Product product)
+{
+    auto low = bit_cast<u32x4>(product.low);
+    auto high = bit_cast<u32x4>(product.high);
 
-    auto aad_bits = 8 * (u64)aad.size();
-    auto cipher_bits = 8 * (u64)cipher.size();
+    // Shift the 256-bit product left by one bit.
+    auto low_carries = low >> 31;
+    auto high_carries = high >> 31;
+    low = (low << 1) | u32x4 { 0, low_carries[0], low_carries[1], low_carries[2] };
+    high = (high << 1) | u32x4 { low_carries[3], high_carries[0], high_carries[1], high_carries[2] };
 
-    auto high = [](u64 value) -> u32 { return value >> 32; };
-    auto low = [](u64 value) -> u32 { return value & 0xffffffff; };
+    // Reduce it modulo x^128 + x^127 + x^126 + x^121 + 1, the reflected GCM polynomial.
+    auto first = (low << 31) ^ (low << 30) ^ (low << 25);
+    low ^= u32x4 { 0, 0, 0, first[0] };
+    auto second = (low >> 1) ^ (low >> 2) ^ (low >> 7) ^ u32x4 { first[1], first[2], first[3], 0 };
+    return bit_cast<u64x2>(high ^ low ^ second);
+}
 
-    if constexpr (GHASH_PROCESS_DEBUG) {
-        dbgln("AAD bits: {} : {}", high(aad_bits), low(aad_bits));
-        dbgln("Cipher bits: {} : {}", high(cipher_bits), low(cipher_bits));
-        dbgln("Tag bits: {} : {} : {} : {}", tag[0], tag[1], tag[2], tag[3]);
+[[gnu::target("sse4.2"), gnu::always_inline]] static inline u64x2 load_block(u8 const* data)
+{
+    return bit_cast<u64x2>(AK::SIMD::byte_reverse(AK::SIMD::load_unaligned<u8x16>(data)));
+}
+
+static inline u64x2 from_words(u32 const (&words)[4])
+{
+    return bit_cast<u64x2>(u32x4 { words[3], words[2], words[1], words[0] });
+}
+
+static inline void to_words(u32 (&words)[4], u64x2 value)
+{
+    auto vector = bit_cast<u32x4>(value);
+    for (size_t i = 0; i < 4; ++i)
+        words[i] = vector[3 - i];
+}
+
+}
+
+template<>
+[[gnu::target("pclmul,sse4.2")]] void GHash::expand_key_impl<CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42>()
+{
+    using namespace PCLMUL;
+
+    auto key = from_words(m_key);
+    auto power = key;
+    to_words(m_key_powers[0], power);
+    for (size_t i = 1; i < aggregated_blocks; ++i) {
+        power = reduce(multiply(power, key));
+        to_words(m_key_powers[i], power);
     }
+}
 
-    tag[0] ^= high(aad_bits);
-    tag[1] ^= low(aad_bits);
-    tag[2] ^= high(cipher_bits);
-    tag[3] ^= low(cipher_bits);
+template<>
+[[gnu::target("pclmul,sse4.2")]] void GHash::update_impl<CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42>(ReadonlyBytes data)
+{
+    using namespace PCLMUL;
 
-    dbgln_if(GHASH_PROCESS_DEBUG, "Tag bits: {} : {} : {} : {}", tag[0], tag[1], tag[2], tag[3]);
+    u64x2 powers[aggregated_blocks];
+    for (size_t i = 0; i < aggregated_blocks; ++i)
+        powers[i] = from_words(m_key_powers[i]);
 
-    galois_multiply(tag, m_key, tag);
+    auto tag = from_words(m_tag);
 
-    TagType digest;
-    to_u8s(digest.data, tag);
+    // tag' = (tag + X_1) * H^n + X_2 * H^(n-1) + ... + X_n * H
+    while (data.size() >= aggregated_blocks * 16) {
+        auto sum = multiply(tag ^ load_block(data.data()), powers[aggregated_blocks - 1]);
+        for (size_t i = 1; i < aggregated_blocks; ++i) {
+            auto product = multiply(load_block(data.offset(i * 16)), powers[aggregated_blocks - 1 - i]);
+            sum.low ^= product.low;
+            sum.high ^= product.high;
+        }
+        tag = reduce(sum);
+        data = data.slice(aggregated_blocks * 16);
+    }
 
-    return digest;
+    for (; data.size() >= 16; data = data.slice(16))
+        tag = reduce(multiply(tag ^ load_block(data.data()), powers[0]));
+
+    if (!data.is_empty()) {
+        u8 buffer[16] = {};
+        data.copy_to(buffer);
+        tag = reduce(multiply(tag ^ load_block(buffer), powers[0]));
+    }
+
+    to_words(m_tag, tag);
 }
+#endif
+
+decltype(GHash::expand_key_dispatched) GHash::expand_key_dispatched = [] {
+    [[maybe_unused]] CPUFeatures features = detect_cpu_features();
+
+    if constexpr (is_valid_feature(CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42)) {
+        if (has_flag(features, CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42))
+            return &GHash::expand_key_impl<CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42>;
+    }
+
+    return &GHash::expand_key_impl<CPUFeatures::None>;
+}();
+
+decltype(GHash::update_dispatched) GHash::update_dispatched = [] {
+    [[maybe_unused]] CPUFeatures features = detect_cpu_features();
+
+    if constexpr (is_valid_feature(CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42)) {
+        if (has_flag(features, CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42))
+            return &GHash::update_impl<CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42>;
+    }
+
+    return &GHash::update_impl<CPUFeatures::None>;
+}();
 
 /// Galois Field multiplication using <x^127 + x^7 + x^2 + x + 1>.
 /// Note that x, y, and z are strictly BE.
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/ByteReader.h>
+#include <AK/CPUFeatures.h>
 #include <AK/Endian.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/HashFunction.h>
@@ -43,6 +44,7 @@ public:
         for (size_t i = 0; i < 16; i += 4) {
             m_key[i / 4] = AK::convert_between_host_and_big_endian(ByteReader::load32(key.offset(i)));
         }
+        (this->*expand_key_dispatched)();
     }
 
     constexpr static size_t digest_size() { return TagType::Size; }
@@ -56,8 +58,28 @@ public:
 
     TagType process(ReadonlyBytes aad, ReadonlyBytes cipher);
 
+    // Incremental hashing, for callers that produce the ciphertext piece by piece (like GCM).
+    // Every piece of the AAD and of the ciphertext must be a multiple of 16 bytes long, except the last one of each.
+    void begin() { __builtin_memset(m_tag, 0, sizeof(m_tag)); }
+    void update(ReadonlyBytes data) { return (this->*update_dispatched)(data); }
+    TagType finish(u64 aad_length, u64 cipher_length);
+
 private:
+    template<CPUFeatures>
+    void expand_key_impl();
+    template<CPUFeatures>
+    void update_impl(ReadonlyBytes data);
+
+    static void (GHash::* const expand_key_dispatched)();
+    static void (GHash::* const update_dispatched)(ReadonlyBytes data);
+
+    // The accelerated implementations multiply up to this many blocks at once, with one reduction.
+    static constexpr size_t aggregated_blocks = 8;
+
     u32 m_key[4];
+    // H^1 to H^8, in the bit order the accelerated implementations use (see GHash.cpp). Unused otherwise.
+    u32 m_key_powers[aggregated_blocks][4];
+    u32 m_tag[4] {};
 };
 
 }
@@ -10,215 +10,138 @@
 
 namespace Crypto::Authentication {
 
-Poly1305::Poly1305(ReadonlyBytes key)
+// The accumulator is kept in 64-bit limbs, so products of two limbs need a 128-bit type.
+using DoubleWord = unsigned __int128;
+
+static ALWAYS_INLINE u64 load64(u8 const* address)
 {
-    for (size_t i = 0; i < 16; i += 4) {
-        m_state.r[i / 4] = AK::convert_between_host_and_little_endian(ByteReader::load32(key.offset(i)));
-    }
+    return AK::convert_between_host_and_little_endian(ByteReader::load64(address));
+}
 
+Poly1305::Poly1305(ReadonlyBytes key)
+{
     // r[3], r[7], r[11], and r[15] are required to have their top four bits clear (be smaller than 16)
     // r[4], r[8], and r[12] are required to have their bottom two bits clear (be divisible by 4)
-    m_state.r[0] &= 0x0FFFFFFF;
-    m_state.r[1] &= 0x0FFFFFFC;
-    m_state.r[2] &= 0x0FFFFFFC;
-    m_state.r[3] &= 0x0FFFFFFC;
+    m_state.r[0] = load64(key.offset(0)) & 0x0FFFFFFC0FFFFFFFULL;
+    m_state.r[1] = load64(key.offset(8)) & 0x0FFFFFFC0FFFFFFCULL;
 
-    for (size_t i = 16; i < 32; i += 4) {
-        m_state.s[(i - 16) / 4] = AK::convert_between_host_and_little_endian(ByteReader::load32(key.offset(i)));
-    }
+    m_state.s[0] = load64(key.offset(16));
+    m_state.s[1] = load64(key.offset(24));
 }
 
 void Poly1305::update(ReadonlyBytes message)
 {
-    size_t offset = 0;
-    while (offset < message.size()) {
-        u32 n = min(message.size() - offset, 16 - m_state.block_count);
-        memcpy(m_state.blocks + m_state.block_count, message.offset_pointer(offset), n);
+    if (message.is_empty())
+        return;
+
+    // Top up a partial block left over from the previous call first.
+    if (m_state.block_count != 0) {
+        size_t n = min(message.size(), 16 - m_state.block_count);
+        memcpy(m_state.blocks + m_state.block_count, message.data(), n);
         m_state.block_count += n;
-        offset += n;
+        message = message.slice(n);
+
+        if (m_state.block_count < 16)
+            return;
 
-        if (m_state.block_count == 16) {
-            process_block();
-            m_state.block_count = 0;
-        }
+        process_blocks({ m_state.blocks, 16 }, 1);
+        m_state.block_count = 0;
     }
+
+    // Then process all whole blocks straight from the message, and keep the rest for later.
+    size_t whole_blocks_size = message.size() & ~static_cast<size_t>(15);
+    process_blocks(message.trim(whole_blocks_size), 1);
+
+    // NOTE: An empty message may not point anywhere, and memcpy() must not be given a null pointer even for no bytes.
+    auto remaining = message.slice(whole_blocks_size);
+    if (remaining.is_empty())
+        return;
+    memcpy(m_state.blocks, remaining.data(), remaining.size());
+    m_state.block_count = remaining.size();
 }
 
-void Poly1305::process_block()
+void Poly1305::process_blocks(ReadonlyBytes blocks, u64 padding_bit)
 {
-    u32 a[5];
-    u8 n = m_state.block_count;
-
-    // Add one bit beyond the number of octets.  For a 16-byte block,
-    // this is equivalent to adding 2^128 to the number.  For the shorter
-    // block, it can be 2^120, 2^112, or any power of two that is evenly
-    // divisible by 8, all the way down to 2^8.
-    m_state.blocks[n++] = 0x01;
-
-    // If the block is not 17 bytes long (the last block), pad it with zeros.
-    // This is meaningless if you are treating the blocks as numbers.
-    while (n < 17) {
-        m_state.blocks[n++] = 0x00;
+    u64 r0 = m_state.r[0];
+    u64 r1 = m_state.r[1];
+    // Since the bottom two bits of r1 are clear, 2^130 = 5 (mod p) lets us fold h1 * r1 * 2^128 back in as h1 * (r1 + r1 / 4) * 4.
+    u64 s1 = r1 + (r1 >> 2);
+
+    u64 h0 = m_state.a[0];
+    u64 h1 = m_state.a[1];
+    u64 h2 = m_state.a[2];
+
+    for (size_t offset = 0; offset + 16 <= blocks.size(); offset += 16) {
+        // Add this number to the accumulator, together with the bit beyond the number of octets.
+        DoubleWord d0 = static_cast<DoubleWord>(h0) + load64(blocks.offset(offset));
+        h0 = static_cast<u64>(d0);
+        DoubleWord d1 = static_cast<DoubleWord>(h1) + (d0 >> 64) + load64(blocks.offset(offset + 8));
+        h1 = static_cast<u64>(d1);
+        h2 += static_cast<u64>(d1 >> 64) + padding_bit;
+
+        // Multiply by r.
+        d0 = static_cast<DoubleWord>(h0) * r0 + static_cast<DoubleWord>(h1) * s1;
+        d1 = static_cast<DoubleWord>(h0) * r1 + static_cast<DoubleWord>(h1) * r0 + static_cast<DoubleWord>(h2) * s1;
+        h2 = h2 * r0;
+
+        h0 = static_cast<u64>(d0);
+        d1 += d0 >> 64;
+        h1 = static_cast<u64>(d1);
+        h2 += static_cast<u64>(d1 >> 64);
+
+        // Fast modular reduction: everything above 2^130 is multiplied by 5 and added back in.
+        u64 c = (h2 >> 2) + (h2 & ~static_cast<u64>(3));
+        h2 &= 3;
+        h0 += c;
+        c = h0 < c;
+        h1 += c;
+        c = h1 < c;
+        h2 += c;
     }
 
-    // Read the block as a little-endian number.
-    for (size_t i = 0; i < 16; i += 4) {
-        a[i / 4] = AK::convert_between_host_and_little_endian(ByteReader::load32(m_state.blocks + i));
-    }
-    a[4] = m_state.blocks[16];
-
-    // Add this number to the accumulator.
-    m_state.a[0] += a[0];
-    m_state.a[1] += a[1];
-    m_state.a[2] += a[2];
-    m_state.a[3] += a[3];
-    m_state.a[4] += a[4];
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Only consider the least significant bits
-    a[0] = m_state.a[0] & 0xFFFFFFFF;
-    a[1] = m_state.a[1] & 0xFFFFFFFF;
-    a[2] = m_state.a[2] & 0xFFFFFFFF;
-    a[3] = m_state.a[3] & 0xFFFFFFFF;
-    a[4] = m_state.a[4] & 0xFFFFFFFF;
-
-    // Multiply by r
-    m_state.a[0] = (u64)a[0] * m_state.r[0];
-    m_state.a[1] = (u64)a[0] * m_state.r[1] + (u64)a[1] * m_state.r[0];
-    m_state.a[2] = (u64)a[0] * m_state.r[2] + (u64)a[1] * m_state.r[1] + (u64)a[2] * m_state.r[0];
-    m_state.a[3] = (u64)a[0] * m_state.r[3] + (u64)a[1] * m_state.r[2] + (u64)a[2] * m_state.r[1] + (u64)a[3] * m_state.r[0];
-    m_state.a[4] = (u64)a[1] * m_state.r[3] + (u64)a[2] * m_state.r[2] + (u64)a[3] * m_state.r[1] + (u64)a[4] * m_state.r[0];
-    m_state.a[5] = (u64)a[2] * m_state.r[3] + (u64)a[3] * m_state.r[2] + (u64)a[4] * m_state.r[1];
-    m_state.a[6] = (u64)a[3] * m_state.r[3] + (u64)a[4] * m_state.r[2];
-    m_state.a[7] = (u64)a[4] * m_state.r[3];
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-    m_state.a[5] += m_state.a[4] >> 32;
-    m_state.a[6] += m_state.a[5] >> 32;
-    m_state.a[7] += m_state.a[6] >> 32;
-
-    // Save the high part of the accumulator
-    a[0] = m_state.a[4] & 0xFFFFFFFC;
-    a[1] = m_state.a[5] & 0xFFFFFFFF;
-    a[2] = m_state.a[6] & 0xFFFFFFFF;
-    a[3] = m_state.a[7] & 0xFFFFFFFF;
-
-    // Only consider the least significant bits
-    m_state.a[0] &= 0xFFFFFFFF;
-    m_state.a[1] &= 0xFFFFFFFF;
-    m_state.a[2] &= 0xFFFFFFFF;
-    m_state.a[3] &= 0xFFFFFFFF;
-    m_state.a[4] &= 0x00000003;
-
-    // Fast modular reduction (first pass)
-    m_state.a[0] += a[0];
-    m_state.a[0] += (a[0] >> 2) | (a[1] << 30);
-    m_state.a[1] += a[1];
-    m_state.a[1] += (a[1] >> 2) | (a[2] << 30);
-    m_state.a[2] += a[2];
-    m_state.a[2] += (a[2] >> 2) | (a[3] << 30);
-    m_state.a[3] += a[3];
-    m_state.a[3] += (a[3] >> 2);
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Save the high part of the accumulator
-    a[0] = m_state.a[4] & 0xFFFFFFFC;
-
-    // Only consider the least significant bits
-    m_state.a[0] &= 0xFFFFFFFF;
-    m_state.a[1] &= 0xFFFFFFFF;
-    m_state.a[2] &= 0xFFFFFFFF;
-    m_state.a[3] &= 0xFFFFFFFF;
-    m_state.a[4] &= 0x00000003;
-
-    // Fast modular reduction (second pass)
-    m_state.a[0] += a[0];
-    m_state.a[0] += a[0] >> 2;
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Only consider the least significant bits
-    m_state.a[0] &= 0xFFFFFFFF;
-    m_state.a[1] &= 0xFFFFFFFF;
-    m_state.a[2] &= 0xFFFFFFFF;
-    m_state.a[3] &= 0xFFFFFFFF;
-    m_state.a[4] &= 0x00000003;
+    m_state.a[0] = h0;
+    m_state.a[1] = h1;
+    m_state.a[2] = h2;
 }
 
 ErrorOr<ByteBuffer> Poly1305::digest()
 {
-    if (m_state.block_count != 0)
-        process_block();
-
-    u32 b[4];
+    if (m_state.block_count != 0) {
+        // Add one bit beyond the number of octets. For the shorter
+        // block, it can be 2^120, 2^112, or any power of two that is evenly
+        // divisible by 8, all the way down to 2^8.
+        m_state.blocks[m_state.block_count] = 0x01;
+        memset(m_state.blocks + m_state.block_count + 1, 0, 15 - m_state.block_count);
+        process_blocks({ m_state.blocks, 16 }, 0);
+        m_state.block_count = 0;
+    }
 
-    // Save the accumulator
-    b[0] = m_state.a[0] & 0xFFFFFFFF;
-    b[1] = m_state.a[1] & 0xFFFFFFFF;
-    b[2] = m_state.a[2] & 0xFFFFFFFF;
-    b[3] = m_state.a[3] & 0xFFFFFFFF;
+    u64 h0 = m_state.a[0];
+    u64 h1 = m_state.a[1];
+    u64 h2 = m_state.a[2];
 
     // Compute a + 5
-    m_state.a[0] += 5;
+    DoubleWord t = static_cast<DoubleWord>(h0) + 5;
+    u64 g0 = static_cast<u64>(t);
+    t = static_cast<DoubleWord>(h1) + (t >> 64);
+    u64 g1 = static_cast<u64>(t);
+    u64 g2 = h2 + static_cast<u64>(t >> 64);
 
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Select mask based on (a + 5) >= 2^130
-    u32 mask = ((m_state.a[4] & 0x04) >> 2) - 1;
-
-    // Select based on mask
-    m_state.a[0] = (m_state.a[0] & ~mask) | (b[0] & mask);
-    m_state.a[1] = (m_state.a[1] & ~mask) | (b[1] & mask);
-    m_state.a[2] = (m_state.a[2] & ~mask) | (b[2] & mask);
-    m_state.a[3] = (m_state.a[3] & ~mask) | (b[3] & mask);
+    // Select a + 5 - 2^130 if (a + 5) >= 2^130, and a otherwise
+    u64 mask = 0 - (g2 >> 2);
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
 
     // Finally, the value of the secret key "s" is added to the accumulator,
     // and the 128 least significant bits are serialized in little-endian
     // order to form the tag.
-    m_state.a[0] += m_state.s[0];
-    m_state.a[1] += m_state.s[1];
-    m_state.a[2] += m_state.s[2];
-    m_state.a[3] += m_state.s[3];
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Only consider the least significant bits
-    b[0] = m_state.a[0] & 0xFFFFFFFF;
-    b[1] = m_state.a[1] & 0xFFFFFFFF;
-    b[2] = m_state.a[2] & 0xFFFFFFFF;
-    b[3] = m_state.a[3] & 0xFFFFFFFF;
+    t = static_cast<DoubleWord>(h0) + m_state.s[0];
+    h0 = static_cast<u64>(t);
+    h1 = h1 + m_state.s[1] + static_cast<u64>(t >> 64);
 
     ByteBuffer output = TRY(ByteBuffer::create_uninitialized(16));
-
-    for (auto i = 0; i < 4; i++) {
-        ByteReader::store(output.offset_pointer(i * 4), AK::convert_between_host_and_little_endian(b[i]));
-    }
+    ByteReader::store(output.offset_pointer(0), AK::convert_between_host_and_little_endian(h0));
+    ByteReader::store(output.offset_pointer(8), AK::convert_between_host_and_little_endian(h1));
 
     return output;
 }
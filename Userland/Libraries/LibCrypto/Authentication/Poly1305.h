@@ -11,10 +11,12 @@
 namespace Crypto::Authentication {
 
 struct State {
-    u32 r[4] {};
-    u32 s[4] {};
-    u64 a[8] {};
-    u8 blocks[17] {};
+    // The clamped key "r" and the key "s" as 64-bit little-endian limbs.
+    u64 r[2] {};
+    u64 s[2] {};
+    // The accumulator, which is kept below 2^131; only the lowest bits of a[2] are ever set.
+    u64 a[3] {};
+    u8 blocks[16] {};
     u8 block_count {};
 };
 
@@ -26,7 +28,9 @@ public:
     ErrorOr<ByteBuffer> digest();
 
 private:
-    void process_block();
+    // Adds each 16-byte block to the accumulator and multiplies by r. The padding bit is only
+    // clear for the final partial block, which gets padded manually.
+    void process_blocks(ReadonlyBytes blocks, u64 padding_bit);
 
     State m_state;
 };
@@ -13,9 +13,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     UnsignedBigInteger& ep,
     UnsignedBigInteger& base,
     UnsignedBigInteger const& m,
-    UnsignedBigInteger& temp_1,
-    UnsignedBigInteger& temp_2,
-    UnsignedBigInteger& temp_3,
+    UnsignedBigInteger& temp_scratch,
     UnsignedBigInteger& temp_multiply,
     UnsignedBigInteger& temp_quotient,
     UnsignedBigInteger& temp_remainder,
@@ -25,7 +23,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     while (!(ep < 1)) {
         if (ep.words()[0] % 2 == 1) {
             // exp = (exp * base) % m;
-            multiply_without_allocation(exp, base, temp_1, temp_2, temp_3, temp_multiply);
+            multiply_without_allocation(exp, base, temp_scratch, temp_multiply);
             divide_without_allocation(temp_multiply, m, temp_quotient, temp_remainder);
             exp.set_to(temp_remainder);
         }
@@ -34,7 +32,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
         ep.set_to(ep.shift_right(1));
 
         // base = (base * base) % m;
-        multiply_without_allocation(base, base, temp_1, temp_2, temp_3, temp_multiply);
+        square_without_allocation(base, temp_scratch, temp_multiply);
         divide_without_allocation(temp_multiply, m, temp_quotient, temp_remainder);
         base.set_to(temp_remainder);
 
@@ -119,6 +117,7 @@ UnsignedBigInteger::Word UnsignedBigIntegerAlgorithms::montgomery_fragment(Unsig
  * assuming :
  *  - x, y and modulo are all already padded to num_words
  *  - k = inverse_wrapped(modulo) (optimization to not recompute K each time)
+ * The full product is computed first (with a squaring if x and y are the same number), and then reduced word by word.
  * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
  */
 void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allocation(
@@ -126,6 +125,7 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     UnsignedBigInteger const& y,
     UnsignedBigInteger const& modulo,
     UnsignedBigInteger& z,
+    UnsignedBigInteger& scratch,
     UnsignedBigInteger::Word k,
     size_t num_words,
     UnsignedBigInteger& result)
@@ -134,37 +134,33 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     VERIFY(y.length() >= num_words);
     VERIFY(modulo.length() >= num_words);
 
-    z.set_to(0);
-    z.resize_with_leading_zeros(num_words * 2);
+    z.set_to_0();
+    z.m_words.resize_and_keep_capacity(num_words * 2);
 
-    UnsignedBigInteger::Word previous_double_carry { 0 };
+    // z = x * y
+    if (&x == &y) {
+        scratch.m_words.resize_and_keep_capacity(squaring_scratch_size(num_words));
+        square_words(z.m_words.data(), x.m_words.data(), num_words, scratch.m_words.data());
+    } else {
+        scratch.m_words.resize_and_keep_capacity(multiplication_scratch_size(num_words, num_words));
+        multiply_words(z.m_words.data(), x.m_words.data(), num_words, y.m_words.data(), num_words, scratch.m_words.data());
+    }
+
+    UnsignedBigInteger::Word previous_carry { 0 };
     for (size_t i = 0; i < num_words; ++i) {
-        // z[i->num_words+i] += x * y_i
-        UnsignedBigInteger::Word carry_1 = montgomery_fragment(z, i, x, y.m_words[i], num_words);
-        // z[i->num_words+i] += modulo * (z_i * k)
+        // z[i->num_words+i] += modulo * (z_i * k), which clears z_i
         UnsignedBigInteger::Word t = z.m_words[i] * k;
-        UnsignedBigInteger::Word carry_2 = montgomery_fragment(z, i, modulo, t, num_words);
+        UnsignedBigInteger::Word carry = montgomery_fragment(z, i, modulo, t, num_words);
 
-        // Compute the carry by combining all of the carries of the previous computations
-        // Put it "right after" the range that we computed above
-        UnsignedBigInteger::Word temp_carry = previous_double_carry + carry_1;
-        UnsignedBigInteger::Word overall_carry = temp_carry + carry_2;
-        z.m_words[num_words + i] = overall_carry;
-
-        // Detect if there was a "double carry" for this word by checking if our carry results are smaller than their components
-        previous_double_carry = (temp_carry < carry_1 || overall_carry < carry_2) ? 1 : 0;
+        // Put the carry "right after" the range that we computed above, together with the one that came out of that word the last time around.
+        u64 sum = static_cast<u64>(z.m_words[num_words + i]) + carry + previous_carry;
+        z.m_words[num_words + i] = static_cast<UnsignedBigInteger::Word>(sum);
+        previous_carry = static_cast<UnsignedBigInteger::Word>(sum >> UnsignedBigInteger::BITS_IN_WORD);
     }
 
-    if (previous_double_carry == 0) {
-        // Return the top num_words bytes of Z, which contains our result.
-        shift_right_by_n_words(z, num_words, result);
-        result.resize_with_leading_zeros(num_words);
-        return;
-    }
-
-    // We have a carry, so we're "one bigger" than we need to be.
-    // Subtract the modulo from the result (the top half of z), and write it to the bottom half of Z since we have space.
-    // (With carry, of course.)
+    // If we have a carry, we're "one bigger" than we need to be, and the modulo has to be subtracted from the result (the top half of z).
+    // The subtraction is always done (with carry, of course) and written to the bottom half of z, since we have space.
+    // The result is then picked with a mask instead of a branch, so that the timing doesn't reveal whether the carry was set.
     UnsignedBigInteger::Word c { 0 };
     for (size_t i = 0; i < num_words; ++i) {
         UnsignedBigInteger::Word z_digit = z.m_words[num_words + i];
@@ -175,14 +171,57 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
         c = ((modulo_digit & ~z_digit) | ((modulo_digit | ~z_digit) & new_z_digit)) >> (UnsignedBigInteger::BITS_IN_WORD - 1);
     }
 
-    // Return the bottom num_words bytes of Z (with the carry bit handled)
+    UnsignedBigInteger::Word carry_mask = static_cast<UnsignedBigInteger::Word>(0) - previous_carry;
+    for (size_t i = 0; i < num_words; ++i)
+        z.m_words[i] = (z.m_words[i] & carry_mask) | (z.m_words[num_words + i] & ~carry_mask);
+
+    // Return the bottom num_words bytes of Z
     z.m_words.resize(num_words);
     result.set_to(z);
     result.resize_with_leading_zeros(num_words);
 }
 
+/**
+ * Picks the size of the window for an exponent with the given number of bits, trading the cost of
+ * precomputing 2^window_size powers against the number of multiplications saved while scanning the exponent.
+ */
+static size_t window_size_for_exponent(size_t exponent_bits)
+{
+    if (exponent_bits > 960)
+        return 6;
+    if (exponent_bits > 320)
+        return 5;
+    if (exponent_bits > 96)
+        return 4;
+    if (exponent_bits > 24)
+        return 3;
+    if (exponent_bits > 4)
+        return 2;
+    return 1;
+}
+
+/**
+ * Copies powers[index] to output without the memory access pattern depending on index:
+ * every entry is read, and the one we want is picked out with a mask.
+ */
+static void constant_time_select(UnsignedBigInteger const* powers, size_t power_count, size_t index, size_t num_words, UnsignedBigInteger::Word* output)
+{
+    __builtin_memset(output, 0, num_words * sizeof(UnsignedBigInteger::Word));
+    for (size_t i = 0; i < power_count; ++i) {
+        // mask is all ones for the wanted entry, and zero otherwise.
+        UnsignedBigInteger::Word difference = static_cast<UnsignedBigInteger::Word>(i ^ index);
+        UnsignedBigInteger::Word mask = ((difference | (0 - difference)) >> (UnsignedBigInteger::BITS_IN_WORD - 1)) - 1;
+        auto const* words = powers[i].words().data();
+        for (size_t j = 0; j < num_words; ++j)
+            output[j] |= words[j] & mask;
+    }
+}
+
 /**
  * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
+ * The exponent may be secret (RSA private keys, DH), so it is scanned from the top with a fixed window: every window costs
+ * window_size squarings and one multiplication by a precomputed power, whatever its value, and that power is looked up
+ * in constant time. Only the bit length of the exponent shows in the timing.
  * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
  */
 void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(
@@ -200,9 +239,7 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
 {
     VERIFY(modulo.is_odd());
 
-    // Note: While this is a constexpr variable for clarity and could be changed in theory,
-    // various optimized parts of the algorithm rely on this value being exactly 4.
-    constexpr size_t window_size = 4;
+    constexpr size_t max_window_size = 6;
 
     size_t num_words = modulo.trimmed_length();
     UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
@@ -223,42 +260,57 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
     one.set_to(1);
     one.resize_with_leading_zeros(num_words);
 
-    // Compute the montgomery powers from 0 to 2^window_size. powers[i] = x^i
-    UnsignedBigInteger powers[1 << window_size];
-    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, powers[0]);
-    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[1]);
-    for (size_t i = 2; i < (1 << window_size); ++i)
-        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, k, num_words, powers[i]);
-
+    size_t exponent_bits = exponent.one_based_index_of_highest_set_bit();
+    size_t window_size = window_size_for_exponent(exponent_bits);
+    size_t power_count = 1u << window_size;
+    size_t exponent_length = exponent.length();
+    auto exponent_bit = [&](size_t index) -> size_t {
+        size_t word_index = index / UnsignedBigInteger::BITS_IN_WORD;
+        if (word_index >= exponent_length)
+            return 0;
+        return (exponent.m_words[word_index] >> (index % UnsignedBigInteger::BITS_IN_WORD)) & 1;
+    };
+
+    // Compute the montgomery powers, powers[i] = x^i (with powers[0] being 1 in montgomery form).
+    // From here on, temp_extra is only used as scratch space for the multiplications.
+    UnsignedBigInteger powers[1 << max_window_size];
+    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, temp_extra, k, num_words, powers[0]);
+    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, temp_extra, k, num_words, powers[1]);
+    for (size_t i = 2; i < power_count; ++i)
+        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, temp_extra, k, num_words, powers[i]);
+
+    // z = 1 in montgomery form, in case the exponent is zero.
     z.set_to(powers[0]);
-    z.resize_with_leading_zeros(num_words);
     zz.set_to(0);
     zz.resize_with_leading_zeros(num_words);
 
-    ssize_t exponent_length = exponent.trimmed_length();
-    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
-        UnsignedBigInteger::Word exponent_word = exponent.m_words[word_in_exponent];
-        size_t bit_in_word = 0;
-        while (bit_in_word < UnsignedBigInteger::BITS_IN_WORD) {
-            if (word_in_exponent != exponent_length - 1 || bit_in_word != 0) {
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-            }
-            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
-            auto& power = powers[power_index];
-            almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
+    // x holds the power picked for each window from here on.
+    x.set_to(0);
+    x.resize_with_leading_zeros(num_words);
 
-            swap(z, zz);
+    size_t window_count = (exponent_bits + window_size - 1) / window_size;
+    for (size_t window = window_count; window > 0; --window) {
+        size_t window_value = 0;
+        for (size_t i = window * window_size; i > (window - 1) * window_size; --i)
+            window_value = (window_value << 1) | exponent_bit(i - 1);
+
+        constant_time_select(powers, power_count, window_value, num_words, x.m_words.data());
 
-            // Move to the next window
-            exponent_word <<= window_size;
-            bit_in_word += window_size;
+        if (window == window_count) {
+            // Squaring one is pointless, so start straight from the first power.
+            z.set_to(x);
+            continue;
+        }
+
+        for (size_t i = 0; i < window_size; ++i) {
+            almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, temp_extra, k, num_words, zz);
+            swap(z, zz);
         }
+        almost_montgomery_multiplication_without_allocation(z, x, modulo, temp_z, temp_extra, k, num_words, zz);
+        swap(z, zz);
     }
 
-    almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, k, num_words, zz);
+    almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, temp_extra, k, num_words, zz);
 
     if (zz < modulo) {
         result.set_to(zz);
@@ -6,41 +6,267 @@
  */
 
 #include "UnsignedBigIntegerAlgorithms.h"
+#include <AK/BigIntBase.h>
 
 namespace Crypto {
 
+using AK::Detail::add_words;
+using AK::Detail::sub_words;
+using Word = UnsignedBigInteger::Word;
+using DoubleWord = AK::Detail::DoubleWord<Word>;
+
+// Below this many words, the extra additions of Karatsuba cost more than the multiplications they save.
+static constexpr size_t karatsuba_threshold = 32;
+
+/**
+ * Computes a += b, where a is at least as long as b, and returns the carry out of the top of a.
+ * The carry is rippled through all of a, so that the time taken doesn't depend on the values (the Montgomery exponentiation relies on that).
+ */
+static Word add_into(Word* a, size_t a_length, Word const* b, size_t b_length)
+{
+    bool carry = false;
+    size_t i = 0;
+    for (; i < b_length; ++i)
+        a[i] = add_words(a[i], b[i], carry);
+    for (; i < a_length; ++i)
+        a[i] = add_words(a[i], Word { 0 }, carry);
+    return carry;
+}
+
+/**
+ * Computes a -= b, where a is at least as long as b, and returns the borrow out of the top of a.
+ * Like add_into(), this always walks all of a.
+ */
+static Word subtract_from(Word* a, size_t a_length, Word const* b, size_t b_length)
+{
+    bool borrow = false;
+    size_t i = 0;
+    for (; i < b_length; ++i)
+        a[i] = sub_words(a[i], b[i], borrow);
+    for (; i < a_length; ++i)
+        a[i] = sub_words(a[i], Word { 0 }, borrow);
+    return borrow;
+}
+
+/**
+ * Complexity: O(N*M)
+ * Writes all left_length + right_length words of the product.
+ */
+static void schoolbook_multiply(Word* result, Word const* left, size_t left_length, Word const* right, size_t right_length)
+{
+    __builtin_memset(result, 0, (left_length + right_length) * sizeof(Word));
+
+    for (size_t i = 0; i < right_length; ++i) {
+        DoubleWord carry = 0;
+        Word right_word = right[i];
+        for (size_t j = 0; j < left_length; ++j) {
+            DoubleWord value = static_cast<DoubleWord>(left[j]) * right_word + result[i + j] + carry;
+            result[i + j] = static_cast<Word>(value);
+            carry = value >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        result[i + left_length] = static_cast<Word>(carry);
+    }
+}
+
+/**
+ * Complexity: O(N^2), but only about half the multiplications of schoolbook_multiply(),
+ * since every cross product a_i * a_j shows up twice in the square.
+ */
+static void schoolbook_square(Word* result, Word const* number, size_t length)
+{
+    __builtin_memset(result, 0, 2 * length * sizeof(Word));
+
+    // Sum up the cross products a_i * a_j with i < j...
+    for (size_t i = 0; i < length; ++i) {
+        DoubleWord carry = 0;
+        Word word = number[i];
+        for (size_t j = i + 1; j < length; ++j) {
+            DoubleWord value = static_cast<DoubleWord>(number[j]) * word + result[i + j] + carry;
+            result[i + j] = static_cast<Word>(value);
+            carry = value >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        result[i + length] = static_cast<Word>(carry);
+    }
+
+    // ...double them...
+    Word top_bit = 0;
+    for (size_t i = 0; i < 2 * length; ++i) {
+        Word word = result[i];
+        result[i] = (word << 1) | top_bit;
+        top_bit = word >> (UnsignedBigInteger::BITS_IN_WORD - 1);
+    }
+
+    // ...and add the squares on the diagonal.
+    Word carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+        DoubleWord low = static_cast<DoubleWord>(number[i]) * number[i] + result[2 * i] + carry;
+        result[2 * i] = static_cast<Word>(low);
+        DoubleWord high = static_cast<DoubleWord>(result[2 * i + 1]) + (low >> UnsignedBigInteger::BITS_IN_WORD);
+        result[2 * i + 1] = static_cast<Word>(high);
+        carry = static_cast<Word>(high >> UnsignedBigInteger::BITS_IN_WORD);
+    }
+}
+
+size_t UnsignedBigIntegerAlgorithms::multiplication_scratch_size(size_t left_length, size_t right_length)
+{
+    if (left_length < right_length)
+        swap(left_length, right_length);
+
+    if (right_length < karatsuba_threshold)
+        return 0;
+
+    if (left_length == right_length) {
+        // Two sums of high + 1 words and their product, followed by whatever the recursive calls need.
+        size_t high = left_length - left_length / 2;
+        return 4 * (high + 1) + max(multiplication_scratch_size(high, high), multiplication_scratch_size(high + 1, high + 1));
+    }
+
+    // The longer operand is multiplied in pieces the size of the shorter one, each into a buffer of its own.
+    size_t last_piece_length = left_length % right_length;
+    return 2 * right_length + max(multiplication_scratch_size(right_length, right_length), multiplication_scratch_size(right_length, last_piece_length));
+}
+
+size_t UnsignedBigIntegerAlgorithms::squaring_scratch_size(size_t length)
+{
+    if (length < karatsuba_threshold)
+        return 0;
+
+    // One sum of high + 1 words and its square, followed by whatever the recursive calls need.
+    size_t high = length - length / 2;
+    return 3 * (high + 1) + max(squaring_scratch_size(high), squaring_scratch_size(high + 1));
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N^1.585) for operands of similar length
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Karatsuba's method splits both operands in a low and a high half, x = x1 * B + x0 and y = y1 * B + y0.
+ * Then x * y = z2 * B^2 + z1 * B + z0, with z2 = x1 * y1, z0 = x0 * y0 and z1 = (x1 + x0) * (y1 + y0) - z2 - z0,
+ * which takes three multiplications of half the size instead of four.
+ * The result has to have space for left_length + right_length words, and scratch for multiplication_scratch_size() words.
+ */
+void UnsignedBigIntegerAlgorithms::multiply_words(Word* result, Word const* left, size_t left_length, Word const* right, size_t right_length, Word* scratch)
+{
+    if (left_length < right_length) {
+        swap(left, right);
+        swap(left_length, right_length);
+    }
+
+    if (right_length < karatsuba_threshold) {
+        schoolbook_multiply(result, left, left_length, right, right_length);
+        return;
+    }
+
+    if (left_length != right_length) {
+        __builtin_memset(result, 0, (left_length + right_length) * sizeof(Word));
+        Word* product = scratch;
+        for (size_t offset = 0; offset < left_length; offset += right_length) {
+            size_t piece_length = min(right_length, left_length - offset);
+            multiply_words(product, left + offset, piece_length, right, right_length, scratch + 2 * right_length);
+            add_into(result + offset, left_length + right_length - offset, product, piece_length + right_length);
+        }
+        return;
+    }
+
+    size_t length = left_length;
+    size_t low = length / 2;
+    size_t high = length - low;
+
+    // z0 and z2 go straight into their places in the result.
+    multiply_words(result, left, low, right, low, scratch);
+    multiply_words(result + 2 * low, left + low, high, right + low, high, scratch);
+
+    Word* left_sum = scratch;
+    Word* right_sum = left_sum + high + 1;
+    Word* middle = right_sum + high + 1;
+    Word* next_scratch = middle + 2 * (high + 1);
+
+    __builtin_memcpy(left_sum, left + low, high * sizeof(Word));
+    left_sum[high] = add_into(left_sum, high, left, low);
+    __builtin_memcpy(right_sum, right + low, high * sizeof(Word));
+    right_sum[high] = add_into(right_sum, high, right, low);
+
+    multiply_words(middle, left_sum, high + 1, right_sum, high + 1, next_scratch);
+    subtract_from(middle, 2 * (high + 1), result, 2 * low);
+    subtract_from(middle, 2 * (high + 1), result + 2 * low, 2 * high);
+
+    // z1 = x1 * y0 + x0 * y1 is less than 2 * B^(2 * high), so the top word of the middle product is always zero.
+    add_into(result + low, 2 * length - low, middle, 2 * high + 1);
+}
+
+/**
+ * Complexity: O(N^1.585)
+ * Same as multiply_words(), but z1 = (x1 + x0)^2 - z2 - z0 only needs a squaring.
+ */
+void UnsignedBigIntegerAlgorithms::square_words(Word* result, Word const* number, size_t length, Word* scratch)
+{
+    if (length < karatsuba_threshold) {
+        schoolbook_square(result, number, length);
+        return;
+    }
+
+    size_t low = length / 2;
+    size_t high = length - low;
+
+    square_words(result, number, low, scratch);
+    square_words(result + 2 * low, number + low, high, scratch);
+
+    Word* sum = scratch;
+    Word* middle = sum + high + 1;
+    Word* next_scratch = middle + 2 * (high + 1);
+
+    __builtin_memcpy(sum, number + low, high * sizeof(Word));
+    sum[high] = add_into(sum, high, number, low);
+
+    square_words(middle, sum, high + 1, next_scratch);
+    subtract_from(middle, 2 * (high + 1), result, 2 * low);
+    subtract_from(middle, 2 * (high + 1), result + 2 * low, 2 * high);
+
+    add_into(result + low, 2 * length - low, middle, 2 * high + 1);
+}
+
+/**
+ * Complexity: O(N^2) for small numbers, O(N^1.585) above the Karatsuba threshold,
+ * where N is the number of words in the larger number.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger& temp_scratch,
     UnsignedBigInteger& output)
 {
+    if (&left == &right) {
+        square_without_allocation(left, temp_scratch, output);
+        return;
+    }
+
     output.set_to_0();
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    size_t left_length = left.trimmed_length();
+    size_t right_length = right.trimmed_length();
+    if (left_length == 0 || right_length == 0)
+        return;
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
+    temp_scratch.m_words.resize_and_keep_capacity(multiplication_scratch_size(left_length, right_length));
+    multiply_words(output.m_words.data(), left.m_words.data(), left_length, right.m_words.data(), right_length, temp_scratch.m_words.data());
+    output.clamp_to_trimmed_length();
+}
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
-    }
+FLATTEN void UnsignedBigIntegerAlgorithms::square_without_allocation(
+    UnsignedBigInteger const& number,
+    UnsignedBigInteger& temp_scratch,
+    UnsignedBigInteger& output)
+{
+    output.set_to_0();
+
+    size_t length = number.trimmed_length();
+    if (length == 0)
+        return;
+
+    output.m_words.resize_and_keep_capacity(2 * length);
+    temp_scratch.m_words.resize_and_keep_capacity(squaring_scratch_size(length));
+    square_words(output.m_words.data(), number.m_words.data(), length, temp_scratch.m_words.data());
+    output.clamp_to_trimmed_length();
 }
 
 }
@@ -4,13 +4,19 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/CPUFeatures.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
 
 namespace Crypto::Checksum {
 
-void Adler32::update(ReadonlyBytes data)
+static constexpr u32 adler_modulus = 65521;
+
+template<>
+void Adler32::update_impl<CPUFeatures::None>(ReadonlyBytes data)
 {
     // See https://github.com/SerenityOS/serenity/pull/24408#discussion_r1609051678
     constexpr size_t iterations_without_overflow = 380368439;
@@ -32,14 +38,82 @@ void Adler32::update(ReadonlyBytes data)
             state_a += byte;
             state_b += state_a;
         }
-        state_a %= 65521;
-        state_b %= 65521;
+        state_a %= adler_modulus;
+        state_b %= adler_modulus;
         data = data.slice(chunk.size());
     }
     m_state_a = state_a;
     m_state_b = state_b;
 }
 
+#if AK_CAN_CODEGEN_FOR_X86_SSE42
+// Note: PMADDUBSW is part of SSSE3, which every CPU with SSE4.2 has.
+template<>
+[[gnu::target("sse4.2")]] void Adler32::update_impl<CPUFeatures::X86_SSE42>(ReadonlyBytes data)
+{
+    using AK::SIMD::c8x16, AK::SIMD::i16x8, AK::SIMD::i32x4, AK::SIMD::u32x4;
+
+    static constexpr size_t block_size = 32;
+    // The largest number of bytes for which state_b can't overflow a u32 before it is reduced (zlib's NMAX).
+    static constexpr size_t blocks_without_overflow = 5552 / block_size;
+
+    // Every byte of a block is added to state_b once for every remaining byte of the block, including itself.
+    static constexpr c8x16 first_half_weights { 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17 };
+    static constexpr c8x16 second_half_weights { 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+    static constexpr i16x8 ones { 1, 1, 1, 1, 1, 1, 1, 1 };
+
+    auto sum_bytes = [] [[gnu::target("sse4.2"), gnu::always_inline]] (c8x16 bytes) {
+        return bit_cast<u32x4>(__builtin_ia32_psadbw128(bytes, c8x16 {}));
+    };
+    auto sum_weighted_bytes = [] [[gnu::target("sse4.2"), gnu::always_inline]] (c8x16 bytes, c8x16 weights) {
+        return bit_cast<u32x4>(__builtin_ia32_pmaddwd128(__builtin_ia32_pmaddubsw128(bytes, weights), ones));
+    };
+    auto horizontal_sum = [](u32x4 vector) { return vector[0] + vector[1] + vector[2] + vector[3]; };
+
+    u32 state_a = m_state_a;
+    u32 state_b = m_state_b;
+
+    while (data.size() >= block_size) {
+        auto block_count = min(data.size() / block_size, blocks_without_overflow);
+
+        // Each block adds block_size times the current state_a to state_b. The running sum of state_a over all blocks
+        // is kept in previous_state_a_sum and multiplied in at the end.
+        u32x4 previous_state_a_sum { 0, 0, 0, state_a * static_cast<u32>(block_count) };
+        u32x4 vector_state_a {};
+        u32x4 vector_state_b { 0, 0, 0, state_b };
+
+        for (size_t i = 0; i < block_count; ++i) {
+            auto first_half = AK::SIMD::load_unaligned<c8x16>(data.offset(i * block_size));
+            auto second_half = AK::SIMD::load_unaligned<c8x16>(data.offset(i * block_size + 16));
+
+            previous_state_a_sum += vector_state_a;
+            vector_state_a += sum_bytes(first_half) + sum_bytes(second_half);
+            vector_state_b += sum_weighted_bytes(first_half, first_half_weights) + sum_weighted_bytes(second_half, second_half_weights);
+        }
+
+        vector_state_b += previous_state_a_sum * block_size;
+        state_a = (state_a + horizontal_sum(vector_state_a)) % adler_modulus;
+        state_b = horizontal_sum(vector_state_b) % adler_modulus;
+        data = data.slice(block_count * block_size);
+    }
+
+    m_state_a = state_a;
+    m_state_b = state_b;
+    update_impl<CPUFeatures::None>(data);
+}
+#endif
+
+decltype(Adler32::update_dispatched) Adler32::update_dispatched = [] {
+    [[maybe_unused]] CPUFeatures features = detect_cpu_features();
+
+    if constexpr (is_valid_feature(CPUFeatures::X86_SSE42)) {
+        if (has_flag(features, CPUFeatures::X86_SSE42))
+            return &Adler32::update_impl<CPUFeatures::X86_SSE42>;
+    }
+
+    return &Adler32::update_impl<CPUFeatures::None>;
+}();
+
 u32 Adler32::digest()
 {
     return (m_state_b << 16) | m_state_a;
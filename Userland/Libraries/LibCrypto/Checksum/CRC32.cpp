@@ -5,7 +5,10 @@
  */
 
 #include <AK/Array.h>
+#include <AK/CPUFeatures.h>
 #include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/CRC32.h>
@@ -16,8 +19,11 @@
 
 namespace Crypto::Checksum {
 
+static constexpr u32 ethernet_polynomial = 0xEDB88320;
+
 #if defined(__ARM_ACLE) && __ARM_ARCH >= 8 && defined(__ARM_FEATURE_CRC32)
-void CRC32::update(ReadonlyBytes span)
+template<>
+void CRC32::update_impl<CPUFeatures::None>(ReadonlyBytes span)
 {
     // FIXME: Does this require runtime checking on rpi?
     //        (Maybe the instruction is present on the rpi4 but not on the rpi3?)
@@ -46,12 +52,8 @@ void CRC32::update(ReadonlyBytes span)
     }
 }
 
-// FIXME: On Intel, use _mm_crc32_u8 / _mm_crc32_u64 if available (SSE 4.2).
-
 #else
 
-static constexpr size_t ethernet_polynomial = 0xEDB88320;
-
 #    if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
 
 // This implements Intel's slicing-by-8 algorithm. Their original paper is no longer on their website,
@@ -104,7 +106,8 @@ static constexpr u32 single_byte_crc(u32 crc, u8 byte)
     return (crc >> 8) ^ table[0][(crc & 0xff) ^ byte];
 }
 
-void CRC32::update(ReadonlyBytes data)
+template<>
+void CRC32::update_impl<CPUFeatures::None>(ReadonlyBytes data)
 {
     // The provided data may not be aligned to a 4-byte boundary, required to reinterpret its address
     // into a u32 in the loop below. So we split the bytes into two segments: the misaligned bytes
@@ -159,7 +162,8 @@ static constexpr auto generate_table()
 
 static constexpr auto table = generate_table();
 
-void CRC32::update(ReadonlyBytes data)
+template<>
+void CRC32::update_impl<CPUFeatures::None>(ReadonlyBytes data)
 {
     for (size_t i = 0; i < data.size(); i++) {
         m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
@@ -169,9 +173,137 @@ void CRC32::update(ReadonlyBytes data)
 #    endif
 #endif
 
+#if AK_CAN_CODEGEN_FOR_X86_PCLMUL && AK_CAN_CODEGEN_FOR_X86_SSE42
+// This folds the data with carry-less multiplications, as described in Intel's "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction". The constants are powers of x modulo the (bit-reflected) polynomial,
+// and are the same ones the Linux kernel and zlib-ng use.
+namespace PCLMUL {
+
+using AK::SIMD::u64x2;
+using illx2 = signed long long int __attribute__((vector_size(16)));
+
+// x^(4*128+32) and x^(4*128-32): fold 512 bits ahead.
+static constexpr u64x2 fold_by_4_constants { 0x154442bd4, 0x1c6e41596 };
+// x^(128+32) and x^(128-32): fold 128 bits ahead.
+static constexpr u64x2 fold_by_1_constants { 0x1751997d0, 0x0ccaa009e };
+// x^64: fold the last 64 bits into 32.
+static constexpr u64 fold_64_constant = 0x163cd6124;
+// The polynomial (with its implicit x^32 term) and floor(x^64 / polynomial), for the Barrett reduction.
+static constexpr u64 polynomial = 0x1db710641;
+static constexpr u64 barrett_constant = 0x1f7011641;
+
+template<int selector>
+[[gnu::target("pclmul"), gnu::always_inline]] static inline u64x2 multiply(u64x2 a, u64x2 b)
+{
+    return bit_cast<u64x2>(__builtin_ia32_pclmulqdq128(bit_cast<illx2>(a), bit_cast<illx2>(b), selector));
+}
+
+[[gnu::target("pclmul"), gnu::always_inline]] static inline u64x2 fold(u64x2 value, u64x2 constants)
+{
+    return multiply<0x00>(value, constants) ^ multiply<0x11>(value, constants);
+}
+
+}
+
+template<>
+[[gnu::target("pclmul,sse4.2")]] void CRC32::update_impl<CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42>(ReadonlyBytes data)
+{
+    using namespace PCLMUL;
+    using AK::SIMD::u32x4;
+
+    // Folding only pays off once there are a few blocks to fold.
+    if (data.size() < 64) {
+        update_impl<CPUFeatures::None>(data);
+        return;
+    }
+
+    auto load = [&](size_t offset) { return AK::SIMD::load_unaligned<u64x2>(data.offset(offset)); };
+
+    u64x2 lanes[4] { load(0), load(16), load(32), load(48) };
+    lanes[0] ^= u64x2 { m_state, 0 };
+    data = data.slice(64);
+
+    while (data.size() >= 64) {
+        for (size_t i = 0; i < 4; ++i)
+            lanes[i] = fold(lanes[i], fold_by_4_constants) ^ load(i * 16);
+        data = data.slice(64);
+    }
+
+    auto value = lanes[0];
+    for (size_t i = 1; i < 4; ++i)
+        value = fold(value, fold_by_1_constants) ^ lanes[i];
+
+    while (data.size() >= 16) {
+        value = fold(value, fold_by_1_constants) ^ load(0);
+        data = data.slice(16);
+    }
+
+    // Reduce the remaining 128 bits to 64, then to 32 bits (each time appending 32 zero bits to the message)...
+    value = multiply<0x00>(value, u64x2 { fold_by_1_constants[1], 0 }) ^ u64x2 { value[1], 0 };
+    auto words = bit_cast<u32x4>(value);
+    value = multiply<0x00>(u64x2 { words[0], 0 }, u64x2 { fold_64_constant, 0 }) ^ bit_cast<u64x2>(u32x4 { words[1], words[2], words[3], 0 });
+
+    // ...and compute the remainder of those 64 bits with a Barrett reduction.
+    auto quotient = multiply<0x00>(value & u64x2 { 0xffffffff, 0 }, u64x2 { barrett_constant, 0 });
+    auto product = multiply<0x00>(quotient & u64x2 { 0xffffffff, 0 }, u64x2 { polynomial, 0 });
+    m_state = bit_cast<u32x4>(value ^ product)[1];
+
+    update_impl<CPUFeatures::None>(data);
+}
+#endif
+
+decltype(CRC32::update_dispatched) CRC32::update_dispatched = [] {
+    [[maybe_unused]] CPUFeatures features = detect_cpu_features();
+
+    if constexpr (is_valid_feature(CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42)) {
+        if (has_flag(features, CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42))
+            return &CRC32::update_impl<CPUFeatures::X86_PCLMUL | CPUFeatures::X86_SSE42>;
+    }
+
+    return &CRC32::update_impl<CPUFeatures::None>;
+}();
+
 u32 CRC32::digest()
 {
     return ~m_state;
 }
 
+// Multiplies two polynomials modulo the CRC polynomial. Like the CRC itself, they are bit-reflected: x^0 is the top bit.
+static constexpr u32 multiply_modulo_polynomial(u32 a, u32 b)
+{
+    u32 product = 0;
+    for (u32 mask = 1u << 31; mask != 0; mask >>= 1) {
+        if (a & mask)
+            product ^= b;
+        b = (b & 1) ? (b >> 1) ^ ethernet_polynomial : b >> 1;
+    }
+    return product;
+}
+
+// x^(2^n) modulo the CRC polynomial, for every n.
+static constexpr auto generate_powers_of_x()
+{
+    Array<u32, 32> powers {};
+    u32 power = 1u << 30; // x^1
+    for (auto& entry : powers) {
+        entry = power;
+        power = multiply_modulo_polynomial(power, power);
+    }
+    return powers;
+}
+
+static constexpr auto powers_of_x = generate_powers_of_x();
+
+u32 CRC32::combine(u32 first_digest, u32 second_digest, u64 second_length)
+{
+    // Appending n bytes to a message multiplies its CRC by x^(8n), after which the CRC of the appended bytes is
+    // simply added. This is the approach zlib's crc32_combine() takes.
+    u32 shift = 1u << 31; // x^0
+    for (size_t n = 3; second_length != 0; second_length >>= 1, ++n) {
+        if (second_length & 1)
+            shift = multiply_modulo_polynomial(powers_of_x[n % powers_of_x.size()], shift);
+    }
+    return multiply_modulo_polynomial(shift, first_digest) ^ second_digest;
+}
+
 }
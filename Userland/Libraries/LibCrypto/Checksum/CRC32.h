@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/CPUFeatures.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/ChecksumFunction.h>
@@ -26,10 +27,18 @@ public:
         update(data);
     }
 
-    virtual void update(ReadonlyBytes data) override;
+    virtual void update(ReadonlyBytes data) override { return (this->*update_dispatched)(data); }
     virtual u32 digest() override;
 
+    // Returns the digest of two messages put together, given the digest of each and the length of the second one.
+    static u32 combine(u32 first_digest, u32 second_digest, u64 second_length);
+
 private:
+    template<CPUFeatures>
+    void update_impl(ReadonlyBytes data);
+
+    static void (CRC32::* const update_dispatched)(ReadonlyBytes);
+
     u32 m_state { ~0u };
 };
 
@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
 #include <AK/CPUFeatures.h>
+#include <AK/Endian.h>
 #include <AK/Platform.h>
 #include <AK/SIMD.h>
 #include <AK/SIMDExtras.h>
@@ -724,6 +726,90 @@ template<>
 }
 #endif
 
+template<>
+void AESCipher::encrypt_counter_blocks_impl<CPUFeatures::None>(ReadonlyBytes in, Bytes out, Bytes counter)
+{
+    auto block_size = AESCipherBlock::block_size();
+    VERIFY(in.size() % block_size == 0);
+    VERIFY(out.size() >= in.size());
+    VERIFY(counter.size() == block_size);
+
+    AESCipherBlock block;
+    for (size_t offset = 0; offset < in.size(); offset += block_size) {
+        block.overwrite(counter);
+        encrypt_block_impl<CPUFeatures::None>(block, block);
+        block.apply_initialization_vector(in.slice(offset, block_size));
+        block.bytes().copy_to(out.slice(offset));
+        IncrementInplace {}(counter);
+    }
+}
+
+#if AK_CAN_CODEGEN_FOR_X86_AES
+template<>
+[[gnu::target("aes")]] void AESCipher::encrypt_counter_blocks_impl<CPUFeatures::X86_AES>(ReadonlyBytes in, Bytes out, Bytes counter)
+{
+    using illx2 = signed long long int __attribute__((vector_size(16)));
+
+    auto block_size = AESCipherBlock::block_size();
+    VERIFY(in.size() % block_size == 0);
+    VERIFY(out.size() >= in.size());
+    VERIFY(counter.size() == block_size);
+
+    // AESENC has a latency of several cycles but can start every cycle, so encrypting a single block at a time
+    // leaves most of the AES unit idle.
+    static constexpr size_t blocks_in_flight = 8;
+
+    AESCipherKey const& key = m_key;
+    auto round_keys = key.round_keys();
+    auto n_rounds = key.rounds();
+    illx2 keys[15];
+    for (size_t i = 0; i <= n_rounds; ++i)
+        keys[i] = AK::SIMD::load_unaligned<illx2>(&round_keys[i * 4]);
+
+    // The counter is a big-endian 128-bit integer; keep it in registers rather than incrementing it bytewise.
+    u64 counter_high = AK::convert_between_host_and_big_endian(ByteReader::load64(counter.data()));
+    u64 counter_low = AK::convert_between_host_and_big_endian(ByteReader::load64(counter.offset(8)));
+    auto next_counter_block = [&] {
+        auto block = bit_cast<illx2>(AK::SIMD::u64x2 {
+            AK::convert_between_host_and_big_endian(counter_high),
+            AK::convert_between_host_and_big_endian(counter_low),
+        });
+        if (++counter_low == 0)
+            ++counter_high;
+        return block;
+    };
+
+    auto encrypt_blocks = [&]<size_t block_count> [[gnu::target("aes"), gnu::always_inline]] (u8 const* input, u8* output) {
+        illx2 values[block_count];
+#pragma GCC unroll 8
+        for (size_t i = 0; i < block_count; ++i)
+            values[i] = next_counter_block() ^ keys[0];
+        for (size_t round = 1; round < n_rounds; ++round) {
+#pragma GCC unroll 8
+            for (size_t i = 0; i < block_count; ++i)
+                values[i] = __builtin_ia32_aesenc128(values[i], keys[round]);
+        }
+#pragma GCC unroll 8
+        for (size_t i = 0; i < block_count; ++i) {
+            values[i] = __builtin_ia32_aesenclast128(values[i], keys[n_rounds]);
+            values[i] ^= AK::SIMD::load_unaligned<illx2>(input + i * block_size);
+            AK::SIMD::store_unaligned(output + i * block_size, values[i]);
+        }
+    };
+
+    auto const* input = in.data();
+    auto* output = out.data();
+    auto const* end = input + in.size();
+    for (; end - input >= static_cast<ssize_t>(blocks_in_flight * block_size); input += blocks_in_flight * block_size, output += blocks_in_flight * block_size)
+        encrypt_blocks.operator()<blocks_in_flight>(input, output);
+    for (; input < end; input += block_size, output += block_size)
+        encrypt_blocks.operator()<1>(input, output);
+
+    ByteReader::store(counter.data(), AK::convert_between_host_and_big_endian(counter_high));
+    ByteReader::store(counter.offset(8), AK::convert_between_host_and_big_endian(counter_low));
+}
+#endif
+
 decltype(AESCipher::encrypt_block_dispatched) AESCipher::encrypt_block_dispatched = [] {
     CPUFeatures features = detect_cpu_features();
 
@@ -746,6 +832,17 @@ decltype(AESCipher::decrypt_block_dispatched) AESCipher::decrypt_block_dispatche
     return &AESCipher::decrypt_block_impl<CPUFeatures::None>;
 }();
 
+decltype(AESCipher::encrypt_counter_blocks_dispatched) AESCipher::encrypt_counter_blocks_dispatched = [] {
+    CPUFeatures features = detect_cpu_features();
+
+    if constexpr (is_valid_feature(CPUFeatures::X86_AES)) {
+        if (has_flag(features, CPUFeatures::X86_AES))
+            return &AESCipher::encrypt_counter_blocks_impl<CPUFeatures::X86_AES>;
+    }
+
+    return &AESCipher::encrypt_counter_blocks_impl<CPUFeatures::None>;
+}();
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
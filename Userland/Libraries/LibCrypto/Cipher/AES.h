@@ -128,6 +128,11 @@ public:
     virtual void encrypt_block(BlockType const& in, BlockType& out) override { return (this->*encrypt_block_dispatched)(in, out); }
     virtual void decrypt_block(BlockType const& in, BlockType& out) override { return (this->*decrypt_block_dispatched)(in, out); }
 
+    // Encrypts (or, equivalently, decrypts) whole blocks in counter mode: every block of `in` is XORed with the
+    // encryption of `counter`, which is then incremented like IncrementInplace does. The modes use this to keep
+    // several blocks in flight at once.
+    void encrypt_counter_blocks(ReadonlyBytes in, Bytes out, Bytes counter) { return (this->*encrypt_counter_blocks_dispatched)(in, out, counter); }
+
 #ifndef KERNEL
     virtual ByteString class_name() const override
     {
@@ -143,9 +148,12 @@ private:
     void encrypt_block_impl(BlockType const& in, BlockType& out);
     template<CPUFeatures>
     void decrypt_block_impl(BlockType const& in, BlockType& out);
+    template<CPUFeatures>
+    void encrypt_counter_blocks_impl(ReadonlyBytes in, Bytes out, Bytes counter);
 
     static void (AESCipher::* const encrypt_block_dispatched)(BlockType const& in, BlockType& out);
     static void (AESCipher::* const decrypt_block_dispatched)(BlockType const& in, BlockType& out);
+    static void (AESCipher::* const encrypt_counter_blocks_dispatched)(ReadonlyBytes in, Bytes out, Bytes counter);
 };
 
 }
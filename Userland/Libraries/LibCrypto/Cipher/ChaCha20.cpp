@@ -5,7 +5,10 @@
  */
 
 #include <AK/ByteReader.h>
+#include <AK/CPUFeatures.h>
 #include <AK/Endian.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <LibCrypto/Cipher/ChaCha20.h>
 
 namespace Crypto::Cipher {
@@ -48,7 +51,7 @@ ChaCha20::ChaCha20(ReadonlyBytes key, ReadonlyBytes nonce, u32 initial_counter)
 
     // NOTE: In the case of an 8-byte nonce, we skip the 13th word
     u32 nonce_offset = nonce.size() == 8 ? 1 : 0;
-    for (u32 i = 0; i < 12; i += 4) {
+    for (u32 i = 0; i < nonce.size(); i += 4) {
         m_state[(i / 4) + 13 + nonce_offset] = AK::convert_between_host_and_little_endian(ByteReader::load32(nonce.offset(i)));
     }
 }
@@ -111,9 +114,163 @@ void ChaCha20::do_quarter_round(u32& a, u32& b, u32& c, u32& d)
     rotl(b, 7);
 }
 
-void ChaCha20::run_cipher(ReadonlyBytes input, Bytes& output)
+template<u32 n, typename Vector>
+ALWAYS_INLINE static Vector rotate_left(Vector x)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+template<typename Vector>
+ALWAYS_INLINE static void quarter_round(Vector& a, Vector& b, Vector& c, Vector& d)
+{
+    a += b;
+    d = rotate_left<16>(d ^ a);
+    c += d;
+    b = rotate_left<12>(b ^ c);
+    a += b;
+    d = rotate_left<8>(d ^ a);
+    c += d;
+    b = rotate_left<7>(b ^ c);
+}
+
+// Transposes the 4x4 matrices of words in each 128-bit lane of the vectors.
+template<typename Vector>
+ALWAYS_INLINE static void transpose_4x4(Vector& a, Vector& b, Vector& c, Vector& d)
+{
+    if constexpr (AK::SIMD::vector_length<Vector> == 4) {
+        Vector ab_low = __builtin_shufflevector(a, b, 0, 4, 1, 5);
+        Vector ab_high = __builtin_shufflevector(a, b, 2, 6, 3, 7);
+        Vector cd_low = __builtin_shufflevector(c, d, 0, 4, 1, 5);
+        Vector cd_high = __builtin_shufflevector(c, d, 2, 6, 3, 7);
+        a = __builtin_shufflevector(ab_low, cd_low, 0, 1, 4, 5);
+        b = __builtin_shufflevector(ab_low, cd_low, 2, 3, 6, 7);
+        c = __builtin_shufflevector(ab_high, cd_high, 0, 1, 4, 5);
+        d = __builtin_shufflevector(ab_high, cd_high, 2, 3, 6, 7);
+    } else {
+        static_assert(AK::SIMD::vector_length<Vector> == 8);
+        Vector ab_low = __builtin_shufflevector(a, b, 0, 8, 1, 9, 4, 12, 5, 13);
+        Vector ab_high = __builtin_shufflevector(a, b, 2, 10, 3, 11, 6, 14, 7, 15);
+        Vector cd_low = __builtin_shufflevector(c, d, 0, 8, 1, 9, 4, 12, 5, 13);
+        Vector cd_high = __builtin_shufflevector(c, d, 2, 10, 3, 11, 6, 14, 7, 15);
+        a = __builtin_shufflevector(ab_low, cd_low, 0, 1, 8, 9, 4, 5, 12, 13);
+        b = __builtin_shufflevector(ab_low, cd_low, 2, 3, 10, 11, 6, 7, 14, 15);
+        c = __builtin_shufflevector(ab_high, cd_high, 0, 1, 8, 9, 4, 5, 12, 13);
+        d = __builtin_shufflevector(ab_high, cd_high, 2, 3, 10, 11, 6, 7, 14, 15);
+    }
+}
+
+template<typename Vector>
+ALWAYS_INLINE static AK::SIMD::u32x4 extract_half(Vector v, size_t half)
 {
+    if constexpr (AK::SIMD::vector_length<Vector> == 4)
+        return v;
+    else if (half == 0)
+        return __builtin_shufflevector(v, v, 0, 1, 2, 3);
+    else
+        return __builtin_shufflevector(v, v, 4, 5, 6, 7);
+}
+
+// Runs the block function on as many consecutive blocks as the vector has lanes. Each vector holds one word of the
+// state for all of the blocks, so every operation of a round applies to all of them at once.
+template<typename Vector>
+ALWAYS_INLINE static void xor_with_blocks(u32 const (&state)[16], u8 const* input, u8* output)
+{
+    static constexpr size_t block_count = AK::SIMD::vector_length<Vector>;
+
+    Vector initial[16];
+    for (size_t i = 0; i < 16; ++i)
+        initial[i] = Vector {} + state[i];
+
+    // Every block gets its own counter, carrying over into word 13 like the scalar code does.
+    Vector lane_indices;
+    for (size_t i = 0; i < block_count; ++i)
+        lane_indices[i] = i;
+    initial[12] += lane_indices;
+    initial[13] -= bit_cast<Vector>(initial[12] < state[12]);
+
+    Vector x[16];
+    for (size_t i = 0; i < 16; ++i)
+        x[i] = initial[i];
+
+    for (size_t i = 0; i < 20; i += 2) {
+        quarter_round(x[0], x[4], x[8], x[12]);
+        quarter_round(x[1], x[5], x[9], x[13]);
+        quarter_round(x[2], x[6], x[10], x[14]);
+        quarter_round(x[3], x[7], x[11], x[15]);
+
+        quarter_round(x[0], x[5], x[10], x[15]);
+        quarter_round(x[1], x[6], x[11], x[12]);
+        quarter_round(x[2], x[7], x[8], x[13]);
+        quarter_round(x[3], x[4], x[9], x[14]);
+    }
+
+    for (size_t i = 0; i < 16; ++i)
+        x[i] += initial[i];
+
+    // Transposing each group of four words leaves words 4k to 4k+3 of block j (and of block j + 4, in the upper half)
+    // next to each other, so they can be XORed into the input sixteen bytes at a time.
+    for (size_t k = 0; k < 4; ++k) {
+        transpose_4x4(x[4 * k], x[4 * k + 1], x[4 * k + 2], x[4 * k + 3]);
+
+        for (size_t j = 0; j < 4; ++j) {
+            for (size_t half = 0; half < block_count / 4; ++half) {
+                auto offset = (j + 4 * half) * 64 + k * 16;
+                auto words = extract_half(x[4 * k + j], half);
+                if constexpr (!AK::HostIsLittleEndian)
+                    words = AK::SIMD::elementwise_byte_reverse(words);
+                auto data = AK::SIMD::load_unaligned<AK::SIMD::u32x4>(input + offset);
+                AK::SIMD::store_unaligned(output + offset, data ^ words);
+            }
+        }
+    }
+}
+
+template<typename Vector>
+ALWAYS_INLINE static size_t xor_with_all_blocks(u32 (&state)[16], ReadonlyBytes input, Bytes output)
+{
+    static constexpr size_t bytes_per_iteration = AK::SIMD::vector_length<Vector> * 64;
+
     size_t offset = 0;
+    for (; input.size() - offset >= bytes_per_iteration; offset += bytes_per_iteration) {
+        xor_with_blocks<Vector>(state, input.data() + offset, output.data() + offset);
+
+        auto counter = state[12];
+        state[12] += AK::SIMD::vector_length<Vector>;
+        if (state[12] < counter)
+            state[13]++;
+    }
+    return offset;
+}
+
+template<>
+size_t ChaCha20::run_cipher_on_blocks_impl<CPUFeatures::None>(ReadonlyBytes input, Bytes output)
+{
+    return xor_with_all_blocks<AK::SIMD::u32x4>(m_state, input, output);
+}
+
+#if AK_CAN_CODEGEN_FOR_X86_AVX2
+template<>
+[[gnu::target("avx2")]] size_t ChaCha20::run_cipher_on_blocks_impl<CPUFeatures::X86_AVX2>(ReadonlyBytes input, Bytes output)
+{
+    auto offset = xor_with_all_blocks<AK::SIMD::u32x8>(m_state, input, output);
+    return offset + xor_with_all_blocks<AK::SIMD::u32x4>(m_state, input.slice(offset), output.slice(offset));
+}
+#endif
+
+decltype(ChaCha20::run_cipher_on_blocks_dispatched) ChaCha20::run_cipher_on_blocks_dispatched = [] {
+    [[maybe_unused]] CPUFeatures features = detect_cpu_features();
+
+    if constexpr (is_valid_feature(CPUFeatures::X86_AVX2)) {
+        if (has_flag(features, CPUFeatures::X86_AVX2))
+            return &ChaCha20::run_cipher_on_blocks_impl<CPUFeatures::X86_AVX2>;
+    }
+
+    return &ChaCha20::run_cipher_on_blocks_impl<CPUFeatures::None>;
+}();
+
+void ChaCha20::run_cipher(ReadonlyBytes input, Bytes& output)
+{
+    size_t offset = (this->*run_cipher_on_blocks_dispatched)(input, output);
     size_t block_offset = 0;
     while (offset < input.size()) {
         if (block_offset == 0 || block_offset >= 64) {
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/CPUFeatures.h>
 
 namespace Crypto::Cipher {
 
@@ -26,6 +27,12 @@ private:
     void run_cipher(ReadonlyBytes input, Bytes& output);
     ALWAYS_INLINE void do_quarter_round(u32& a, u32& b, u32& c, u32& d);
 
+    // Encrypts as many whole blocks of the input as it can several at a time, and returns how many bytes that was.
+    template<CPUFeatures>
+    size_t run_cipher_on_blocks_impl(ReadonlyBytes input, Bytes output);
+
+    static size_t (ChaCha20::* const run_cipher_on_blocks_dispatched)(ReadonlyBytes input, Bytes output);
+
     u32 m_state[16] {};
     u32 m_block[16] {};
 };
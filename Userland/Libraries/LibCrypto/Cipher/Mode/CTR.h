@@ -170,6 +170,14 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        if constexpr (IsSame<IncrementFunctionType, IncrementInplace> && requires { cipher.encrypt_counter_blocks(ReadonlyBytes {}, Bytes {}, Bytes {}); }) {
+            if (in) {
+                offset = length - length % block_size;
+                cipher.encrypt_counter_blocks(in->trim(offset), out, iv);
+                length -= offset;
+            }
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
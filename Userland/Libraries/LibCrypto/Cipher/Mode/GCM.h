@@ -95,12 +95,20 @@ public:
         // Skip past block 0
         CTR<T>::increment(iv);
 
-        if (in.is_empty())
+        Authentication::GHashDigest auth_tag;
+        if (in.is_empty()) {
             CTR<T>::key_stream(out, iv);
-        else
-            CTR<T>::encrypt(in, out, iv);
+            auth_tag = m_ghash->process(aad, out);
+        } else {
+            m_ghash->begin();
+            m_ghash->update(aad);
+            for_each_chunk(in, out, [&](ReadonlyBytes in_chunk, Bytes out_chunk) {
+                CTR<T>::encrypt(in_chunk, out_chunk, iv, &iv);
+                m_ghash->update(out_chunk);
+            });
+            auth_tag = m_ghash->finish(aad.size(), in.size());
+        }
 
-        auto auth_tag = m_ghash->process(aad, out);
         block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
         block0.bytes().copy_to(tag);
     }
@@ -123,26 +131,39 @@ public:
         // Skip past block 0
         CTR<T>::increment(iv);
 
-        auto auth_tag = m_ghash->process(aad, in);
+        m_ghash->begin();
+        m_ghash->update(aad);
+        for_each_chunk(in, out, [&](ReadonlyBytes in_chunk, Bytes out_chunk) {
+            m_ghash->update(in_chunk);
+            CTR<T>::encrypt(in_chunk, out_chunk, iv, &iv);
+        });
+        auto auth_tag = m_ghash->finish(aad.size(), in.size());
         block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
 
-        auto test_consistency = [&] {
-            if (block0.block_size() != tag.size() || !timing_safe_compare(block0.bytes().data(), tag.data(), tag.size()))
-                return VerificationConsistency::Inconsistent;
-
-            return VerificationConsistency::Consistent;
-        };
-
-        if (in.is_empty()) {
+        if (in.is_empty())
             out = {};
-            return test_consistency();
-        }
 
-        CTR<T>::encrypt(in, out, iv);
-        return test_consistency();
+        if (block0.block_size() != tag.size() || !timing_safe_compare(block0.bytes().data(), tag.data(), tag.size()))
+            return VerificationConsistency::Inconsistent;
+
+        return VerificationConsistency::Consistent;
     }
 
 private:
+    // Encrypting and authenticating the data a few blocks at a time keeps the ciphertext in L1 between the two passes,
+    // and lets the CPU overlap hashing one chunk with encrypting the next.
+    static constexpr size_t chunk_size = 16 * T::BlockSizeInBits / 8;
+
+    template<typename Callback>
+    static void for_each_chunk(ReadonlyBytes in, Bytes out, Callback callback)
+    {
+        VERIFY(out.size() >= in.size());
+        for (size_t offset = 0; offset < in.size(); offset += chunk_size) {
+            auto length = min(chunk_size, in.size() - offset);
+            callback(in.slice(offset, length), out.slice(offset, length));
+        }
+    }
+
     static constexpr auto block_size = T::BlockType::BlockSizeInBits / 8;
     u8 m_auth_key_storage[block_size];
     Bytes m_auth_key { m_auth_key_storage, block_size };
@@ -19,10 +19,70 @@ void Curve25519::set(u32* state, u32 value)
     }
 }
 
+// Reduces the 512-bit product of two field elements modulo p
+static void reduce_product(u32* state, u32* output)
+{
+    // Reduce bit 255 (2^255 = 19 mod p)
+    u64 temp = (output[7] >> 31) * 19;
+    // Mask the most significant bit
+    output[7] &= 0x7FFFFFFF;
+
+    // Fast modular reduction 1st pass
+    for (auto i = 0; i < Curve25519::WORDS; i++) {
+        temp += output[i];
+        temp += (u64)output[i + 8] * 38;
+        output[i] = temp & 0xFFFFFFFF;
+        temp >>= 32;
+    }
+
+    // Reduce bit 256 (2^256 = 38 mod p)
+    temp *= 38;
+    // Reduce bit 255 (2^255 = 19 mod p)
+    temp += (output[7] >> 31) * 19;
+    // Mask the most significant bit
+    output[7] &= 0x7FFFFFFF;
+
+    // Fast modular reduction 2nd pass
+    for (auto i = 0; i < Curve25519::WORDS; i++) {
+        temp += output[i];
+        output[i] = temp & 0xFFFFFFFF;
+        temp >>= 32;
+    }
+
+    Curve25519::modular_reduce(state, output);
+}
+
 void Curve25519::modular_square(u32* state, u32 const* value)
 {
     // Compute R = (A ^ 2) mod p
-    modular_multiply(state, value, value);
+    u64 temp = 0;
+    u64 carry = 0;
+    u32 output[WORDS * 2];
+
+    // Comba's method, where every cross product A[j] * A[i - j] with j < i - j is computed once and added twice
+    for (auto i = 0; i < 16; i++) {
+        for (auto j = max(0, i - 7); j < i - j; j++) {
+            u64 product = (u64)value[j] * value[i - j];
+            temp += (product & 0xFFFFFFFF) << 1;
+            carry += (product >> 32) << 1;
+            carry += temp >> 32;
+            temp &= 0xFFFFFFFF;
+        }
+
+        if (i % 2 == 0) {
+            u64 product = (u64)value[i / 2] * value[i / 2];
+            temp += product & 0xFFFFFFFF;
+            carry += product >> 32;
+            carry += temp >> 32;
+            temp &= 0xFFFFFFFF;
+        }
+
+        output[i] = temp & 0xFFFFFFFF;
+        temp = carry & 0xFFFFFFFF;
+        carry >>= 32;
+    }
+
+    reduce_product(state, output);
 }
 
 void Curve25519::modular_subtract(u32* state, u32 const* first, u32 const* second)
@@ -84,34 +144,7 @@ void Curve25519::modular_multiply(u32* state, u32 const* first, u32 const* secon
         carry >>= 32;
     }
 
-    // Reduce bit 255 (2^255 = 19 mod p)
-    temp = (output[7] >> 31) * 19;
-    // Mask the most significant bit
-    output[7] &= 0x7FFFFFFF;
-
-    // Fast modular reduction 1st pass
-    for (auto i = 0; i < WORDS; i++) {
-        temp += output[i];
-        temp += (u64)output[i + 8] * 38;
-        output[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
-
-    // Reduce bit 256 (2^256 = 38 mod p)
-    temp *= 38;
-    // Reduce bit 255 (2^255 = 19 mod p)
-    temp += (output[7] >> 31) * 19;
-    // Mask the most significant bit
-    output[7] &= 0x7FFFFFFF;
-
-    // Fast modular reduction 2nd pass
-    for (auto i = 0; i < WORDS; i++) {
-        temp += output[i];
-        output[i] = temp & 0xFFFFFFFF;
-        temp >>= 32;
-    }
-
-    modular_reduce(state, output);
+    reduce_product(state, output);
 }
 
 void Curve25519::export_state(u32* state, u8* output)
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Endian.h>
 #include <AK/MemoryStream.h>
@@ -27,22 +28,47 @@ struct SECPxxxr1CurveParameters {
     StringView generator_point;
 };
 
+// SECP256r1 curve
+static constexpr SECPxxxr1CurveParameters SECP256r1_CURVE_PARAMETERS {
+    .prime = "FFFFFFFF_00000001_00000000_00000000_00000000_FFFFFFFF_FFFFFFFF_FFFFFFFF"sv,
+    .a = "FFFFFFFF_00000001_00000000_00000000_00000000_FFFFFFFF_FFFFFFFF_FFFFFFFC"sv,
+    .b = "5AC635D8_AA3A93E7_B3EBBD55_769886BC_651D06B0_CC53B0F6_3BCE3C3E_27D2604B"sv,
+    .order = "FFFFFFFF_00000000_FFFFFFFF_FFFFFFFF_BCE6FAAD_A7179E84_F3B9CAC2_FC632551"sv,
+    .generator_point = "04_6B17D1F2_E12C4247_F8BCE6E5_63A440F2_77037D81_2DEB33A0_F4A13945_D898C296_4FE342E2_FE1A7F9B_8EE7EB4A_7C0F9E16_2BCE3357_6B315ECE_CBB64068_37BF51F5"sv,
+};
+
+// SECP384r1 curve
+static constexpr SECPxxxr1CurveParameters SECP384r1_CURVE_PARAMETERS {
+    .prime = "FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFE_FFFFFFFF_00000000_00000000_FFFFFFFF"sv,
+    .a = "FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFE_FFFFFFFF_00000000_00000000_FFFFFFFC"sv,
+    .b = "B3312FA7_E23EE7E4_988E056B_E3F82D19_181D9C6E_FE814112_0314088F_5013875A_C656398D_8A2ED19D_2A85C8ED_D3EC2AEF"sv,
+    .order = "FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_C7634D81_F4372DDF_581A0DB2_48B0A77A_ECEC196A_CCC52973"sv,
+    .generator_point = "04_AA87CA22_BE8B0537_8EB1C71E_F320AD74_6E1D3B62_8BA79B98_59F741E0_82542A38_5502F25D_BF55296C_3A545E38_72760AB7_3617DE4A_96262C6F_5D9E98BF_9292DC29_F8F41DBD_289A147C_E9DA3113_B5F0B8C0_0A60B1CE_1D7E819D_7A431D7C_90EA0E5F"sv,
+};
+
 template<size_t bit_size, SECPxxxr1CurveParameters const& CURVE_PARAMETERS>
 class SECPxxxr1 : public EllipticCurve {
 private:
     using StorageType = AK::UFixedBigInt<bit_size>;
     using StorageTypeX2 = AK::UFixedBigInt<bit_size * 2>;
 
-    struct JacobianPoint {
+    // Homogeneous projective coordinates: (X : Y : Z) is the affine point (X/Z, Y/Z), and (0 : 1 : 0) is the point at infinity.
+    struct ProjectivePoint {
         StorageType x;
         StorageType y;
         StorageType z;
     };
 
+    struct AffinePoint {
+        StorageType x;
+        StorageType y;
+    };
+
     // Curve parameters
     static constexpr size_t KEY_BIT_SIZE = bit_size;
     static constexpr size_t KEY_BYTE_SIZE = KEY_BIT_SIZE / 8;
     static constexpr size_t POINT_BYTE_SIZE = 1 + 2 * KEY_BYTE_SIZE;
+    static constexpr size_t WORD_COUNT = KEY_BIT_SIZE / AK::native_word_size;
 
     static constexpr StorageType make_unsigned_fixed_big_int_from_string(StringView str)
     {
@@ -127,6 +153,13 @@ private:
     // Verify that A = -3 mod p, which is required for some optimizations
     static_assert(A == PRIME - 3);
 
+    // The NIST primes P-256 and P-384 are generalized Mersenne numbers, which allows reducing a product with a handful of
+    // additions and subtractions of its 32-bit words (Solinas reduction) instead of a full Montgomery reduction.
+    // For those curves, field elements are plain integers below 2^KEY_BIT_SIZE; all other curves use the Montgomery form.
+    static constexpr bool IS_P256 = KEY_BIT_SIZE == 256 && PRIME == make_unsigned_fixed_big_int_from_string(SECP256r1_CURVE_PARAMETERS.prime);
+    static constexpr bool IS_P384 = KEY_BIT_SIZE == 384 && PRIME == make_unsigned_fixed_big_int_from_string(SECP384r1_CURVE_PARAMETERS.prime);
+    static constexpr bool USE_SOLINAS_REDUCTION = IS_P256 || IS_P384;
+
     // Precomputed helper values for reduction and Montgomery multiplication
     static constexpr StorageType REDUCE_PRIME = StorageType { 0 } - PRIME;
     static constexpr StorageType REDUCE_ORDER = StorageType { 0 } - ORDER;
@@ -135,6 +168,16 @@ private:
     static constexpr StorageType R2_MOD_PRIME = calculate_r2_mod(PRIME);
     static constexpr StorageType R2_MOD_ORDER = calculate_r2_mod(ORDER);
 
+    // Generator multiplications use a fixed-base comb: the scalar is split into COMB_TEETH rows of COMB_SPACING bits,
+    // and every column of bits selects one of the 2^COMB_TEETH - 1 precomputed sums of the points 2^(i * COMB_SPACING) * G.
+    static constexpr size_t COMB_TEETH = 6;
+    static constexpr size_t COMB_SPACING = (KEY_BIT_SIZE + COMB_TEETH - 1) / COMB_TEETH;
+    static constexpr size_t COMB_TABLE_SIZE = (1 << COMB_TEETH) - 1;
+
+    // Multiplications of any other point use fixed windows of this many bits.
+    static constexpr size_t WINDOW_BITS = 4;
+    static_assert(KEY_BIT_SIZE % WINDOW_BITS == 0);
+
 public:
     size_t key_size() override { return POINT_BYTE_SIZE; }
 
@@ -147,25 +190,17 @@ public:
 
     ErrorOr<ByteBuffer> generate_public_key(ReadonlyBytes a) override
     {
-        return compute_coordinate(a, GENERATOR_POINT);
+        StorageType scalar = TRY(read_scalar(a));
+        return export_point(multiply_generator(scalar));
     }
 
     ErrorOr<ByteBuffer> compute_coordinate(ReadonlyBytes scalar_bytes, ReadonlyBytes point_bytes) override
     {
-        AK::FixedMemoryStream scalar_stream { scalar_bytes };
         AK::FixedMemoryStream point_stream { point_bytes };
 
-        StorageType scalar = TRY(scalar_stream.read_value<BigEndian<StorageType>>());
-        JacobianPoint point = TRY(read_uncompressed_point(point_stream));
-        JacobianPoint result = TRY(compute_coordinate_internal(scalar, point));
-
-        // Export the values into an output buffer
-        auto buf = TRY(ByteBuffer::create_uninitialized(POINT_BYTE_SIZE));
-        AK::FixedMemoryStream buf_stream { buf.bytes() };
-        TRY(buf_stream.write_value<u8>(0x04));
-        TRY(buf_stream.write_value<BigEndian<StorageType>>(result.x));
-        TRY(buf_stream.write_value<BigEndian<StorageType>>(result.y));
-        return buf;
+        StorageType scalar = TRY(read_scalar(scalar_bytes));
+        AffinePoint point = TRY(read_uncompressed_point(point_stream));
+        return export_point(multiply_point(scalar, point));
     }
 
     ErrorOr<ByteBuffer> derive_premaster_key(ReadonlyBytes shared_point) override
@@ -208,7 +243,7 @@ public:
         }
 
         AK::FixedMemoryStream pubkey_stream { pubkey };
-        JacobianPoint pubkey_point = TRY(read_uncompressed_point(pubkey_stream));
+        AffinePoint pubkey_point = TRY(read_uncompressed_point(pubkey_stream));
 
         StorageType r_mo = to_montgomery_order(r);
         StorageType s_mo = to_montgomery_order(s);
@@ -222,124 +257,121 @@ public:
         u1 = from_montgomery_order(u1);
         u2 = from_montgomery_order(u2);
 
-        JacobianPoint point1 = TRY(generate_public_key_internal(u1));
-        JacobianPoint point2 = TRY(compute_coordinate_internal(u2, pubkey_point));
-
-        // Convert the input point into Montgomery form
-        point1.x = to_montgomery(point1.x);
-        point1.y = to_montgomery(point1.y);
-        point1.z = to_montgomery(point1.z);
-
-        VERIFY(is_point_on_curve(point1));
-
-        // Convert the input point into Montgomery form
-        point2.x = to_montgomery(point2.x);
-        point2.y = to_montgomery(point2.y);
-        point2.z = to_montgomery(point2.z);
-
-        VERIFY(is_point_on_curve(point2));
-
-        JacobianPoint result = point_add(point1, point2);
+        // R = u1*G + u2*Q, where the complete addition formulas take care of any of these being the point at infinity
+        ProjectivePoint result = point_add(multiply_generator(u1), multiply_point(u2, pubkey_point));
+        if (modular_reduce(result.z).is_zero_constant_time())
+            return false;
 
-        // Convert from Jacobian coordinates back to Affine coordinates
-        convert_jacobian_to_affine(result);
+        AffinePoint affine_result = to_affine(result);
 
         // Make sure the resulting point is on the curve
-        VERIFY(is_point_on_curve(result));
+        VERIFY(is_point_on_curve(affine_result));
 
-        // Convert the result back from Montgomery form
-        result.x = from_montgomery(result.x);
-        result.y = from_montgomery(result.y);
-        // Final modular reduction on the coordinates
-        result.x = modular_reduce(result.x);
-        result.y = modular_reduce(result.y);
+        // Convert the x coordinate back to a plain integer, and compare it to r modulo the order
+        StorageType x = modular_reduce(from_field_element(affine_result.x));
+        x = modular_reduce_order(x);
 
-        return r.is_equal_to_constant_time(result.x);
+        return r.is_equal_to_constant_time(x);
     }
 
 private:
-    ErrorOr<JacobianPoint> generate_public_key_internal(StorageType a)
+    static ErrorOr<StorageType> read_scalar(ReadonlyBytes scalar_bytes)
     {
-        AK::FixedMemoryStream generator_point_stream { GENERATOR_POINT };
-        JacobianPoint point = TRY(read_uncompressed_point(generator_point_stream));
-        return compute_coordinate_internal(a, point);
-    }
+        AK::FixedMemoryStream scalar_stream { scalar_bytes };
+        StorageType scalar = TRY(scalar_stream.read_value<BigEndian<StorageType>>());
 
-    ErrorOr<JacobianPoint> compute_coordinate_internal(StorageType scalar, JacobianPoint point)
-    {
         // FIXME: This will slightly bias the distribution of client secrets
         scalar = modular_reduce_order(scalar);
         if (scalar.is_zero_constant_time())
             return Error::from_string_literal("SECPxxxr1: scalar is zero");
 
-        // Convert the input point into Montgomery form
-        point.x = to_montgomery(point.x);
-        point.y = to_montgomery(point.y);
-        point.z = to_montgomery(point.z);
+        return scalar;
+    }
+
+    static ErrorOr<AffinePoint> read_uncompressed_point(Stream& stream)
+    {
+        // Make sure the point is uncompressed
+        if (TRY(stream.read_value<u8>()) != 0x04)
+            return Error::from_string_literal("SECPxxxr1: point is not uncompressed format");
+
+        StorageType x = TRY(stream.read_value<BigEndian<StorageType>>());
+        StorageType y = TRY(stream.read_value<BigEndian<StorageType>>());
+        AffinePoint point { to_field_element(x), to_field_element(y) };
 
         // Check that the point is on the curve
         if (!is_point_on_curve(point))
             return Error::from_string_literal("SECPxxxr1: point is not on the curve");
 
-        JacobianPoint result { 0, 0, 0 };
-        JacobianPoint temp_result { 0, 0, 0 };
-
-        // Calculate the scalar times point multiplication in constant time
-        for (size_t i = 0; i < KEY_BIT_SIZE; i++) {
-            temp_result = point_add(result, point);
-
-            auto condition = (scalar & 1u) == 1u;
-            result.x = select(result.x, temp_result.x, condition);
-            result.y = select(result.y, temp_result.y, condition);
-            result.z = select(result.z, temp_result.z, condition);
-
-            point = point_double(point);
-            scalar >>= 1u;
-        }
+        return point;
+    }
 
-        // Convert from Jacobian coordinates back to Affine coordinates
-        convert_jacobian_to_affine(result);
+    static ErrorOr<ByteBuffer> export_point(ProjectivePoint const& point)
+    {
+        // Convert from projective coordinates back to affine coordinates
+        AffinePoint result = to_affine(point);
 
         // Make sure the resulting point is on the curve
         VERIFY(is_point_on_curve(result));
 
-        // Convert the result back from Montgomery form
-        result.x = from_montgomery(result.x);
-        result.y = from_montgomery(result.y);
-        result.z = from_montgomery(result.z);
-        // Final modular reduction on the coordinates
-        result.x = modular_reduce(result.x);
-        result.y = modular_reduce(result.y);
-        result.z = modular_reduce(result.z);
+        // Convert the result back to plain integers, with a final modular reduction
+        result.x = modular_reduce(from_field_element(result.x));
+        result.y = modular_reduce(from_field_element(result.y));
 
-        return result;
+        // Export the values into an output buffer
+        auto buf = TRY(ByteBuffer::create_uninitialized(POINT_BYTE_SIZE));
+        AK::FixedMemoryStream buf_stream { buf.bytes() };
+        TRY(buf_stream.write_value<u8>(0x04));
+        TRY(buf_stream.write_value<BigEndian<StorageType>>(result.x));
+        TRY(buf_stream.write_value<BigEndian<StorageType>>(result.y));
+        return buf;
     }
 
-    static ErrorOr<JacobianPoint> read_uncompressed_point(Stream& stream)
+    static constexpr StorageType select(StorageType const& left, StorageType const& right, bool condition)
     {
-        // Make sure the point is uncompressed
-        if (TRY(stream.read_value<u8>()) != 0x04)
-            return Error::from_string_literal("SECPxxxr1: point is not uncompressed format");
+        // If condition = 0 return left else right
+        AK::NativeWord mask = static_cast<AK::NativeWord>(condition) - 1;
+        AK::taint_for_optimizer(mask);
 
-        JacobianPoint point {
-            TRY(stream.read_value<BigEndian<StorageType>>()),
-            TRY(stream.read_value<BigEndian<StorageType>>()),
-            1u,
-        };
+        // Select word by word, so the mask can stay in a register
+        StorageType result = 0u;
+        auto const* left_words = left.span().data();
+        auto const* right_words = right.span().data();
+        auto* result_words = result.span().data();
+#pragma GCC unroll 16
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            result_words[i] = (left_words[i] & mask) | (right_words[i] & ~mask);
+        return result;
+    }
 
-        return point;
+    static constexpr ProjectivePoint select(ProjectivePoint const& left, ProjectivePoint const& right, bool condition)
+    {
+        return { select(left.x, right.x, condition), select(left.y, right.y, condition), select(left.z, right.z, condition) };
     }
 
-    constexpr StorageType select(StorageType const& left, StorageType const& right, bool condition)
+    static constexpr AffinePoint select(AffinePoint const& left, AffinePoint const& right, bool condition)
     {
-        // If condition = 0 return left else right
-        StorageType mask = static_cast<StorageType>(condition) - 1;
-        AK::taint_for_optimizer(mask);
+        return { select(left.x, right.x, condition), select(left.y, right.y, condition) };
+    }
+
+    template<typename Point, size_t size>
+    static constexpr Point select_from_table(Array<Point, size> const& table, size_t index)
+    {
+        // Read every entry of the table, so the memory access pattern does not depend on the (secret) index.
+        // If none of the entries match, the result is all zeroes.
+        Point result {};
+        for (size_t i = 0; i < size; i++)
+            result = select(result, table[i], i == index);
+        return result;
+    }
 
-        return (left & mask) | (right & ~mask);
+    static constexpr size_t bits_at(StorageType const& value, size_t index, size_t count)
+    {
+        // All callers read bit groups that do not cross a word boundary
+        AK::NativeWord word = value.span().data()[index / AK::native_word_size];
+        return (word >> (index % AK::native_word_size)) & ((1u << count) - 1);
     }
 
-    constexpr StorageType modular_reduce(StorageType const& value)
+    static constexpr StorageType modular_reduce(StorageType const& value)
     {
         // Add -prime % 2^KEY_BIT_SIZE
         bool carry = false;
@@ -349,7 +381,7 @@ private:
         return select(value, other, carry);
     }
 
-    constexpr StorageType modular_reduce_order(StorageType const& value)
+    static constexpr StorageType modular_reduce_order(StorageType const& value)
     {
         // Add -order % 2^KEY_BIT_SIZE
         bool carry = false;
@@ -359,82 +391,260 @@ private:
         return select(value, other, carry);
     }
 
-    constexpr StorageType modular_add(StorageType const& left, StorageType const& right, bool carry_in = false)
+    static constexpr AK::NativeWord mask_from(bool condition)
+    {
+        // All ones if condition = 1, all zeroes otherwise
+        AK::NativeWord mask = 0 - static_cast<AK::NativeWord>(condition);
+        AK::taint_for_optimizer(mask);
+        return mask;
+    }
+
+    static constexpr bool add_masked(StorageType& value, StorageType const& addend, AK::NativeWord mask, bool carry = false)
+    {
+        // value += addend & mask, returning the carry out of the top word
+        auto* words = value.span().data();
+        auto const* addend_words = addend.span().data();
+#pragma GCC unroll 16
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            words[i] = AK::Detail::add_words(words[i], addend_words[i] & mask, carry);
+        return carry;
+    }
+
+    static constexpr bool subtract_masked(StorageType& value, StorageType const& subtrahend, AK::NativeWord mask)
+    {
+        // value -= subtrahend & mask, returning the borrow out of the top word
+        bool borrow = false;
+        auto* words = value.span().data();
+        auto const* subtrahend_words = subtrahend.span().data();
+#pragma GCC unroll 16
+        for (size_t i = 0; i < WORD_COUNT; i++)
+            words[i] = AK::Detail::sub_words(words[i], subtrahend_words[i] & mask, borrow);
+        return borrow;
+    }
+
+    static constexpr StorageType modular_add(StorageType const& left, StorageType const& right, bool carry_in = false)
     {
-        bool carry = carry_in;
-        StorageType output = left.addc(right, carry);
+        StorageType output = left;
+        bool carry = add_masked(output, right, mask_from(true), carry_in);
 
         // If there is a carry, subtract p by adding 2^KEY_BIT_SIZE - p
-        StorageType addend = select(0u, REDUCE_PRIME, carry);
-        carry = false;
-        output = output.addc(addend, carry);
+        carry = add_masked(output, REDUCE_PRIME, mask_from(carry));
 
         // If there is still a carry, subtract p by adding 2^KEY_BIT_SIZE - p
-        addend = select(0u, REDUCE_PRIME, carry);
-        return output + addend;
+        add_masked(output, REDUCE_PRIME, mask_from(carry));
+        return output;
     }
 
-    constexpr StorageType modular_sub(StorageType const& left, StorageType const& right)
+    static constexpr StorageType modular_sub(StorageType const& left, StorageType const& right)
     {
-        bool borrow = false;
-        StorageType output = left.subc(right, borrow);
+        StorageType output = left;
+        bool borrow = subtract_masked(output, right, mask_from(true));
 
         // If there is a borrow, add p by subtracting 2^KEY_BIT_SIZE - p
-        StorageType sub = select(0u, REDUCE_PRIME, borrow);
-        borrow = false;
-        output = output.subc(sub, borrow);
+        borrow = subtract_masked(output, REDUCE_PRIME, mask_from(borrow));
 
         // If there is still a borrow, add p by subtracting 2^KEY_BIT_SIZE - p
-        sub = select(0u, REDUCE_PRIME, borrow);
-        return output - sub;
+        subtract_masked(output, REDUCE_PRIME, mask_from(borrow));
+        return output;
+    }
+
+    static constexpr StorageTypeX2 wide_multiply(StorageType const& left, StorageType const& right)
+    {
+        // Schoolbook multiplication, which the compiler can fully unroll for our fixed sizes
+        StorageTypeX2 result = 0u;
+        auto const* left_words = left.span().data();
+        auto const* right_words = right.span().data();
+        auto* result_words = result.span().data();
+#pragma GCC unroll 16
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            AK::NativeWord carry = 0;
+#pragma GCC unroll 16
+            for (size_t j = 0; j < WORD_COUNT; j++) {
+                auto product = static_cast<AK::Detail::NativeDoubleWord>(left_words[j]) * right_words[i] + result_words[i + j] + carry;
+                result_words[i + j] = static_cast<AK::NativeWord>(product);
+                carry = static_cast<AK::NativeWord>(product >> AK::native_word_size);
+            }
+            result_words[i + WORD_COUNT] = carry;
+        }
+        return result;
     }
 
-    constexpr StorageType modular_multiply(StorageType const& left, StorageType const& right)
+    static constexpr u32 word32_at(StorageTypeX2 const& value, size_t index)
     {
-        // Modular multiplication using the Montgomery method: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
-        // This requires that the inputs to this function are in Montgomery form.
+        auto const* words = value.span().data();
+        if constexpr (AK::native_word_size == 64)
+            return static_cast<u32>(words[index / 2] >> (32 * (index % 2)));
+        else
+            return words[index];
+    }
 
-        // T = left * right
-        StorageTypeX2 mult = left.wide_multiply(right);
-        StorageType mult_mod_r = static_cast<StorageType>(mult);
+    template<size_t word_count>
+    static constexpr i64 propagate_carries(i64 (&words)[word_count])
+    {
+        // Bring every word back into [0, 2^32), and return the (signed) carry out of the top word
+        i64 carry = 0;
+#pragma GCC unroll 16
+        for (auto& word : words) {
+            word += carry;
+            carry = word >> 32;
+            word &= 0xFFFFFFFF;
+        }
+        return carry;
+    }
 
-        // m = ((T mod R) * curve_p')
-        StorageType m = mult_mod_r * PRIME_INVERSE_MOD_R;
+    template<size_t word_count>
+    static constexpr StorageType from_words32(i64 const (&words)[word_count])
+    {
+        static_assert(word_count * 32 == KEY_BIT_SIZE);
 
-        // mp = (m mod R) * curve_p
-        StorageTypeX2 mp = m.wide_multiply(PRIME);
+        StorageType result = 0u;
+        auto* storage = result.span().data();
+#pragma GCC unroll 16
+        for (size_t i = 0; i < word_count; i++)
+            storage[i / (AK::native_word_size / 32)] |= static_cast<AK::NativeWord>(words[i]) << (32 * (i % (AK::native_word_size / 32)));
+        return result;
+    }
 
-        // t = (T + mp)
-        bool carry = false;
-        mult_mod_r.addc(static_cast<StorageType>(mp), carry);
+    static constexpr StorageType reduce_p256(StorageTypeX2 const& value)
+    {
+        // Fast reduction modulo p256, Algorithm 2.29 from "Guide to Elliptic Curve Cryptography" (Hankerson, Menezes, Vanstone):
+        // with c = (c15, ..., c0) as 32-bit words, the result is s1 + 2*s2 + 2*s3 + s4 + s5 - s6 - s7 - s8 - s9, where
+        // s1 = (c7, c6, c5, c4, c3, c2, c1, c0), s2 = (c15, c14, c13, c12, c11, 0, 0, 0), s3 = (0, c15, c14, c13, c12, 0, 0, 0),
+        // s4 = (c15, c14, 0, 0, 0, c10, c9, c8), s5 = (c8, c13, c15, c14, c13, c11, c10, c9), s6 = (c10, c8, 0, 0, 0, c13, c12, c11),
+        // s7 = (c11, c9, 0, 0, c15, c14, c13, c12), s8 = (c12, 0, c10, c9, c8, c15, c14, c13), s9 = (c13, 0, c11, c10, c9, 0, c15, c14).
+        i64 c[16];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < 16; i++)
+            c[i] = word32_at(value, i);
+
+        i64 words[8] {
+            c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14],
+            c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15],
+            c[2] + c[10] + c[11] - c[13] - c[14] - c[15],
+            c[3] + 2 * c[11] + 2 * c[12] + c[13] - c[15] - c[8] - c[9],
+            c[4] + 2 * c[12] + 2 * c[13] + c[14] - c[9] - c[10],
+            c[5] + 2 * c[13] + 2 * c[14] + c[15] - c[10] - c[11],
+            c[6] + 3 * c[14] + 2 * c[15] + c[13] - c[8] - c[9],
+            c[7] + 3 * c[15] + c[8] - c[10] - c[11] - c[12] - c[13],
+        };
 
-        // output = t / R
-        StorageType mult_high = static_cast<StorageType>(mult >> KEY_BIT_SIZE);
-        StorageType mp_high = static_cast<StorageType>(mp >> KEY_BIT_SIZE);
-        return modular_add(mult_high, mp_high, carry);
+        // The sum is within a few multiples of 2^256, fold the carry back in using 2^256 = 2^224 - 2^192 - 2^96 + 1 mod p.
+        // After the first fold the carry is at most one, and after the second fold the result fits in 256 bits.
+        for (size_t i = 0; i < 2; i++) {
+            i64 carry = propagate_carries(words);
+            words[0] += carry;
+            words[3] -= carry;
+            words[6] -= carry;
+            words[7] += carry;
+        }
+        propagate_carries(words);
+
+        return from_words32(words);
+    }
+
+    static constexpr StorageType reduce_p384(StorageTypeX2 const& value)
+    {
+        // Fast reduction modulo p384, Algorithm 2.30 from "Guide to Elliptic Curve Cryptography" (Hankerson, Menezes, Vanstone):
+        // with c = (c23, ..., c0) as 32-bit words, the result is s1 + 2*s2 + s3 + s4 + s5 + s6 + s7 - d1 - d2 - d3, where
+        // s1 = (c11, ..., c0), s2 = (0, 0, 0, 0, 0, c23, c22, c21, 0, 0, 0, 0), s3 = (c23, ..., c12),
+        // s4 = (c20, c19, c18, c17, c16, c15, c14, c13, c12, c23, c22, c21), s5 = (c19, c18, c17, c16, c15, c14, c13, c12, c20, 0, c23, 0),
+        // s6 = (0, 0, 0, 0, c23, c22, c21, c20, 0, 0, 0, 0), s7 = (0, 0, 0, 0, 0, 0, c23, c22, c21, 0, 0, c20),
+        // d1 = (c22, c21, c20, c19, c18, c17, c16, c15, c14, c13, c12, c23), d2 = (0, 0, 0, 0, 0, 0, 0, c23, c22, c21, c20, 0),
+        // d3 = (0, 0, 0, 0, 0, 0, 0, c23, c23, 0, 0, 0).
+        i64 c[24];
+#pragma GCC unroll 24
+        for (size_t i = 0; i < 24; i++)
+            c[i] = word32_at(value, i);
+
+        i64 words[12] {
+            c[0] + c[12] + c[21] + c[20] - c[23],
+            c[1] + c[13] + c[22] + c[23] - c[12] - c[20],
+            c[2] + c[14] + c[23] - c[13] - c[21],
+            c[3] + c[15] + c[12] + c[20] + c[21] - c[14] - c[22] - c[23],
+            c[4] + 2 * c[21] + c[16] + c[13] + c[12] + c[20] + c[22] - c[15] - 2 * c[23],
+            c[5] + 2 * c[22] + c[17] + c[14] + c[13] + c[21] + c[23] - c[16],
+            c[6] + 2 * c[23] + c[18] + c[15] + c[14] + c[22] - c[17],
+            c[7] + c[19] + c[16] + c[15] + c[23] - c[18],
+            c[8] + c[20] + c[17] + c[16] - c[19],
+            c[9] + c[21] + c[18] + c[17] - c[20],
+            c[10] + c[22] + c[19] + c[18] - c[21],
+            c[11] + c[23] + c[20] + c[19] - c[22],
+        };
+
+        // Fold the carry back in using 2^384 = 2^128 + 2^96 - 2^32 + 1 mod p, as in reduce_p256().
+        for (size_t i = 0; i < 2; i++) {
+            i64 carry = propagate_carries(words);
+            words[0] += carry;
+            words[1] -= carry;
+            words[3] += carry;
+            words[4] += carry;
+        }
+        propagate_carries(words);
+
+        return from_words32(words);
+    }
+
+    static constexpr StorageType modular_multiply(StorageType const& left, StorageType const& right)
+    {
+        if constexpr (IS_P256) {
+            return reduce_p256(wide_multiply(left, right));
+        } else if constexpr (IS_P384) {
+            return reduce_p384(wide_multiply(left, right));
+        } else {
+            // Modular multiplication using the Montgomery method: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
+            // This requires that the inputs to this function are in Montgomery form.
+
+            // T = left * right
+            StorageTypeX2 mult = wide_multiply(left, right);
+            StorageType mult_mod_r = static_cast<StorageType>(mult);
+
+            // m = ((T mod R) * curve_p')
+            StorageType m = mult_mod_r * PRIME_INVERSE_MOD_R;
+
+            // mp = (m mod R) * curve_p
+            StorageTypeX2 mp = wide_multiply(m, PRIME);
+
+            // t = (T + mp)
+            bool carry = false;
+            mult_mod_r.addc(static_cast<StorageType>(mp), carry);
+
+            // output = t / R
+            StorageType mult_high = static_cast<StorageType>(mult >> KEY_BIT_SIZE);
+            StorageType mp_high = static_cast<StorageType>(mp >> KEY_BIT_SIZE);
+            return modular_add(mult_high, mp_high, carry);
+        }
     }
 
-    constexpr StorageType modular_square(StorageType const& value)
+    static constexpr StorageType modular_square(StorageType const& value)
     {
         return modular_multiply(value, value);
     }
 
-    constexpr StorageType to_montgomery(StorageType const& value)
+    static constexpr StorageType to_field_element(StorageType const& value)
     {
-        return modular_multiply(value, R2_MOD_PRIME);
+        if constexpr (USE_SOLINAS_REDUCTION)
+            return value;
+        else
+            return modular_multiply(value, R2_MOD_PRIME);
     }
 
-    constexpr StorageType from_montgomery(StorageType const& value)
+    static constexpr StorageType from_field_element(StorageType const& value)
     {
-        return modular_multiply(value, 1u);
+        if constexpr (USE_SOLINAS_REDUCTION)
+            return value;
+        else
+            return modular_multiply(value, 1u);
     }
 
-    constexpr StorageType modular_inverse(StorageType const& value)
+    static constexpr StorageType ONE = to_field_element(1u);
+    static constexpr StorageType B_FIELD_ELEMENT = to_field_element(B);
+
+    static constexpr StorageType modular_inverse(StorageType const& value)
     {
         // Modular inverse modulo the curve prime can be computed using Fermat's little theorem: a^(p-2) mod p = a^-1 mod p.
         // Calculating a^(p-2) mod p can be done using the square-and-multiply exponentiation method, as p-2 is constant.
         StorageType base = value;
-        StorageType result = to_montgomery(1u);
+        StorageType result = ONE;
         StorageType prime_minus_2 = PRIME - 2u;
 
         for (size_t i = 0; i < KEY_BIT_SIZE; i++) {
@@ -448,35 +658,33 @@ private:
         return result;
     }
 
-    constexpr StorageType modular_add_order(StorageType const& left, StorageType const& right, bool carry_in = false)
+    static constexpr StorageType modular_add_order(StorageType const& left, StorageType const& right, bool carry_in = false)
     {
-        bool carry = carry_in;
-        StorageType output = left.addc(right, carry);
+        StorageType output = left;
+        bool carry = add_masked(output, right, mask_from(true), carry_in);
 
         // If there is a carry, subtract n by adding 2^KEY_BIT_SIZE - n
-        StorageType addend = select(0u, REDUCE_ORDER, carry);
-        carry = false;
-        output = output.addc(addend, carry);
+        carry = add_masked(output, REDUCE_ORDER, mask_from(carry));
 
         // If there is still a carry, subtract n by adding 2^KEY_BIT_SIZE - n
-        addend = select(0u, REDUCE_ORDER, carry);
-        return output + addend;
+        add_masked(output, REDUCE_ORDER, mask_from(carry));
+        return output;
     }
 
-    constexpr StorageType modular_multiply_order(StorageType const& left, StorageType const& right)
+    static constexpr StorageType modular_multiply_order(StorageType const& left, StorageType const& right)
     {
         // Modular multiplication using the Montgomery method: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
         // This requires that the inputs to this function are in Montgomery form.
 
         // T = left * right
-        StorageTypeX2 mult = left.wide_multiply(right);
+        StorageTypeX2 mult = wide_multiply(left, right);
         StorageType mult_mod_r = static_cast<StorageType>(mult);
 
         // m = ((T mod R) * curve_n')
         StorageType m = mult_mod_r * ORDER_INVERSE_MOD_R;
 
         // mp = (m mod R) * curve_n
-        StorageTypeX2 mp = m.wide_multiply(ORDER);
+        StorageTypeX2 mp = wide_multiply(m, ORDER);
 
         // t = (T + mp)
         bool carry = false;
@@ -488,22 +696,22 @@ private:
         return modular_add_order(mult_high, mp_high, carry);
     }
 
-    constexpr StorageType modular_square_order(StorageType const& value)
+    static constexpr StorageType modular_square_order(StorageType const& value)
     {
         return modular_multiply_order(value, value);
     }
 
-    constexpr StorageType to_montgomery_order(StorageType const& value)
+    static constexpr StorageType to_montgomery_order(StorageType const& value)
     {
         return modular_multiply_order(value, R2_MOD_ORDER);
     }
 
-    constexpr StorageType from_montgomery_order(StorageType const& value)
+    static constexpr StorageType from_montgomery_order(StorageType const& value)
     {
         return modular_multiply_order(value, 1u);
     }
 
-    constexpr StorageType modular_inverse_order(StorageType const& value)
+    static constexpr StorageType modular_inverse_order(StorageType const& value)
     {
         // Modular inverse modulo the curve order can be computed using Fermat's little theorem: a^(n-2) mod n = a^-1 mod n.
         // Calculating a^(n-2) mod n can be done using the square-and-multiply exponentiation method, as n-2 is constant.
@@ -522,138 +730,138 @@ private:
         return result;
     }
 
-    JacobianPoint point_double(JacobianPoint const& point)
-    {
-        // Based on "Point Doubling" from http://point-at-infinity.org/ecc/Prime_Curve_Jacobian_Coordinates.html
-
-        // if (Y == 0)
-        //   return POINT_AT_INFINITY
-        if (point.y.is_zero_constant_time()) {
-            VERIFY_NOT_REACHED();
-        }
-
-        StorageType temp;
-
-        // Y2 = Y^2
-        StorageType y2 = modular_square(point.y);
-
-        // S = 4*X*Y2
-        StorageType s = modular_multiply(point.x, y2);
-        s = modular_add(s, s);
-        s = modular_add(s, s);
-
-        // M = 3*X^2 + a*Z^4 = 3*(X + Z^2)*(X - Z^2)
-        // This specific equation from https://github.com/earlephilhower/bearssl-esp8266/blob/6105635531027f5b298aa656d44be2289b2d434f/src/ec/ec_p256_m64.c#L811-L816
-        // This simplification only works because a = -3 mod p
-        temp = modular_square(point.z);
-        StorageType m = modular_add(point.x, temp);
-        temp = modular_sub(point.x, temp);
-        m = modular_multiply(m, temp);
-        temp = modular_add(m, m);
-        m = modular_add(m, temp);
-
-        // X' = M^2 - 2*S
-        StorageType xp = modular_square(m);
-        xp = modular_sub(xp, s);
-        xp = modular_sub(xp, s);
-
-        // Y' = M*(S - X') - 8*Y2^2
-        StorageType yp = modular_sub(s, xp);
-        yp = modular_multiply(yp, m);
-        temp = modular_square(y2);
-        temp = modular_add(temp, temp);
-        temp = modular_add(temp, temp);
-        temp = modular_add(temp, temp);
-        yp = modular_sub(yp, temp);
-
-        // Z' = 2*Y*Z
-        StorageType zp = modular_multiply(point.y, point.z);
-        zp = modular_add(zp, zp);
-
-        // return (X', Y', Z')
-        return JacobianPoint { xp, yp, zp };
-    }
-
-    JacobianPoint point_add(JacobianPoint const& point_a, JacobianPoint const& point_b)
-    {
-        // Based on "Point Addition" from  http://point-at-infinity.org/ecc/Prime_Curve_Jacobian_Coordinates.html
-        if (point_a.x.is_zero_constant_time() && point_a.y.is_zero_constant_time() && point_a.z.is_zero_constant_time()) {
-            return point_b;
-        }
-
-        StorageType temp;
-
-        temp = modular_square(point_b.z);
-        // U1 = X1*Z2^2
-        StorageType u1 = modular_multiply(point_a.x, temp);
-        // S1 = Y1*Z2^3
-        StorageType s1 = modular_multiply(point_a.y, temp);
-        s1 = modular_multiply(s1, point_b.z);
-
-        temp = modular_square(point_a.z);
-        // U2 = X2*Z1^2
-        StorageType u2 = modular_multiply(point_b.x, temp);
-        // S2 = Y2*Z1^3
-        StorageType s2 = modular_multiply(point_b.y, temp);
-        s2 = modular_multiply(s2, point_a.z);
-
-        // if (U1 == U2)
-        //   if (S1 != S2)
-        //     return POINT_AT_INFINITY
-        //   else
-        //     return POINT_DOUBLE(X1, Y1, Z1)
-        if (u1.is_equal_to_constant_time(u2)) {
-            if (s1.is_equal_to_constant_time(s2)) {
-                return point_double(point_a);
-            } else {
-                VERIFY_NOT_REACHED();
-            }
-        }
-
-        // H = U2 - U1
-        StorageType h = modular_sub(u2, u1);
-        StorageType h2 = modular_square(h);
-        StorageType h3 = modular_multiply(h2, h);
-        // R = S2 - S1
-        StorageType r = modular_sub(s2, s1);
-        // X3 = R^2 - H^3 - 2*U1*H^2
-        StorageType x3 = modular_square(r);
-        x3 = modular_sub(x3, h3);
-        temp = modular_multiply(u1, h2);
-        temp = modular_add(temp, temp);
-        x3 = modular_sub(x3, temp);
-        // Y3 = R*(U1*H^2 - X3) - S1*H^3
-        StorageType y3 = modular_multiply(u1, h2);
-        y3 = modular_sub(y3, x3);
-        y3 = modular_multiply(y3, r);
-        temp = modular_multiply(s1, h3);
-        y3 = modular_sub(y3, temp);
-        // Z3 = H*Z1*Z2
-        StorageType z3 = modular_multiply(h, point_a.z);
-        z3 = modular_multiply(z3, point_b.z);
-        // return (X3, Y3, Z3)
-        return JacobianPoint { x3, y3, z3 };
-    }
-
-    void convert_jacobian_to_affine(JacobianPoint& point)
-    {
-        StorageType temp;
-        // X' = X/Z^2
-        temp = modular_square(point.z);
-        temp = modular_inverse(temp);
-        point.x = modular_multiply(point.x, temp);
-        // Y' = Y/Z^3
-        temp = modular_square(point.z);
-        temp = modular_multiply(temp, point.z);
-        temp = modular_inverse(temp);
-        point.y = modular_multiply(point.y, temp);
-        // Z' = 1
-        point.z = to_montgomery(1u);
-    }
-
-    bool is_point_on_curve(JacobianPoint const& point)
-    {
-        // This check requires the point to be in Montgomery form, with Z=1
+    static constexpr ProjectivePoint point_at_infinity()
+    {
+        return { 0u, ONE, 0u };
+    }
+
+    // The point arithmetic below uses the complete formulas for a = -3 from "Complete addition formulas for prime order elliptic curves"
+    // (Renes, Costello, Batina): they give the right result for every pair of inputs, including doubling and the point at infinity,
+    // so there are no special cases to branch on.
+
+    static ProjectivePoint point_double(ProjectivePoint const& point)
+    {
+        // Algorithm 6: Exception-free point doubling
+        StorageType t0 = modular_square(point.x);
+        StorageType t1 = modular_square(point.y);
+        StorageType t2 = modular_square(point.z);
+        StorageType t3 = modular_multiply(point.x, point.y);
+        t3 = modular_add(t3, t3);
+        StorageType z3 = modular_multiply(point.x, point.z);
+        z3 = modular_add(z3, z3);
+        StorageType y3 = modular_multiply(B_FIELD_ELEMENT, t2);
+        y3 = modular_sub(y3, z3);
+        StorageType x3 = modular_add(y3, y3);
+        y3 = modular_add(x3, y3);
+        x3 = modular_sub(t1, y3);
+        y3 = modular_add(t1, y3);
+        y3 = modular_multiply(x3, y3);
+        x3 = modular_multiply(x3, t3);
+        t3 = modular_add(t2, t2);
+        t2 = modular_add(t2, t3);
+        z3 = modular_multiply(B_FIELD_ELEMENT, z3);
+        z3 = modular_sub(z3, t2);
+        z3 = modular_sub(z3, t0);
+        t3 = modular_add(z3, z3);
+        z3 = modular_add(z3, t3);
+        t3 = modular_add(t0, t0);
+        t0 = modular_add(t3, t0);
+        t0 = modular_sub(t0, t2);
+        t0 = modular_multiply(t0, z3);
+        y3 = modular_add(y3, t0);
+        t0 = modular_multiply(point.y, point.z);
+        t0 = modular_add(t0, t0);
+        z3 = modular_multiply(t0, z3);
+        x3 = modular_sub(x3, z3);
+        z3 = modular_multiply(t0, t1);
+        z3 = modular_add(z3, z3);
+        z3 = modular_add(z3, z3);
+        return { x3, y3, z3 };
+    }
+
+    static ProjectivePoint point_add(ProjectivePoint const& point_a, ProjectivePoint const& point_b)
+    {
+        // Algorithm 4: Complete, projective point addition
+        StorageType t0 = modular_multiply(point_a.x, point_b.x);
+        StorageType t1 = modular_multiply(point_a.y, point_b.y);
+        StorageType t2 = modular_multiply(point_a.z, point_b.z);
+        StorageType t3 = modular_add(point_a.x, point_a.y);
+        StorageType t4 = modular_add(point_b.x, point_b.y);
+        t3 = modular_multiply(t3, t4);
+        t4 = modular_add(t0, t1);
+        t3 = modular_sub(t3, t4);
+        t4 = modular_add(point_a.y, point_a.z);
+        StorageType x3 = modular_add(point_b.y, point_b.z);
+        t4 = modular_multiply(t4, x3);
+        x3 = modular_add(t1, t2);
+        t4 = modular_sub(t4, x3);
+        x3 = modular_add(point_a.x, point_a.z);
+        StorageType y3 = modular_add(point_b.x, point_b.z);
+        x3 = modular_multiply(x3, y3);
+        y3 = modular_add(t0, t2);
+        y3 = modular_sub(x3, y3);
+        return finish_point_add(t0, t1, t2, t3, t4, y3);
+    }
+
+    static ProjectivePoint point_add_mixed(ProjectivePoint const& point_a, AffinePoint const& point_b)
+    {
+        // Algorithm 5: Complete, mixed point addition, where the second point has Z = 1 (and thus can't be the point at infinity)
+        StorageType t0 = modular_multiply(point_a.x, point_b.x);
+        StorageType t1 = modular_multiply(point_a.y, point_b.y);
+        StorageType t3 = modular_add(point_b.x, point_b.y);
+        StorageType t4 = modular_add(point_a.x, point_a.y);
+        t3 = modular_multiply(t3, t4);
+        t4 = modular_add(t0, t1);
+        t3 = modular_sub(t3, t4);
+        t4 = modular_multiply(point_b.y, point_a.z);
+        t4 = modular_add(t4, point_a.y);
+        StorageType y3 = modular_multiply(point_b.x, point_a.z);
+        y3 = modular_add(y3, point_a.x);
+        return finish_point_add(t0, t1, point_a.z, t3, t4, y3);
+    }
+
+    static ProjectivePoint finish_point_add(StorageType t0, StorageType t1, StorageType t2, StorageType const& t3, StorageType const& t4, StorageType y3)
+    {
+        // The second half of both addition algorithms, which only differ in how these intermediate values are computed:
+        // t0 = X1*X2, t1 = Y1*Y2, t2 = Z1*Z2, t3 = X1*Y2 + X2*Y1, t4 = Y1*Z2 + Y2*Z1, y3 = X1*Z2 + X2*Z1
+        StorageType z3 = modular_multiply(B_FIELD_ELEMENT, t2);
+        StorageType x3 = modular_sub(y3, z3);
+        z3 = modular_add(x3, x3);
+        x3 = modular_add(x3, z3);
+        z3 = modular_sub(t1, x3);
+        x3 = modular_add(t1, x3);
+        y3 = modular_multiply(B_FIELD_ELEMENT, y3);
+        t1 = modular_add(t2, t2);
+        t2 = modular_add(t1, t2);
+        y3 = modular_sub(y3, t2);
+        y3 = modular_sub(y3, t0);
+        t1 = modular_add(y3, y3);
+        y3 = modular_add(t1, y3);
+        t1 = modular_add(t0, t0);
+        t0 = modular_add(t1, t0);
+        t0 = modular_sub(t0, t2);
+        t1 = modular_multiply(t4, y3);
+        t2 = modular_multiply(t0, y3);
+        y3 = modular_multiply(x3, z3);
+        y3 = modular_add(y3, t2);
+        x3 = modular_multiply(t3, x3);
+        x3 = modular_sub(x3, t1);
+        z3 = modular_multiply(t4, z3);
+        t1 = modular_multiply(t3, t0);
+        z3 = modular_add(z3, t1);
+        return { x3, y3, z3 };
+    }
+
+    static AffinePoint to_affine(ProjectivePoint const& point)
+    {
+        // X' = X/Z, Y' = Y/Z
+        StorageType z_inverse = modular_inverse(point.z);
+        return { modular_multiply(point.x, z_inverse), modular_multiply(point.y, z_inverse) };
+    }
+
+    static bool is_point_on_curve(AffinePoint const& point)
+    {
+        // This check requires the point to be made of field elements
         StorageType temp, temp2;
 
         // Calulcate Y^2 - X^3 - a*X - b = Y^2 - X^3 + 3*X - b
@@ -664,31 +872,108 @@ private:
         temp = modular_add(temp, point.x);
         temp = modular_add(temp, point.x);
         temp = modular_add(temp, point.x);
-        temp = modular_sub(temp, to_montgomery(B));
+        temp = modular_sub(temp, B_FIELD_ELEMENT);
         temp = modular_reduce(temp);
 
-        return temp.is_zero_constant_time() && point.z.is_equal_to_constant_time(to_montgomery(1u));
+        return temp.is_zero_constant_time();
     }
-};
 
-// SECP256r1 curve
-static constexpr SECPxxxr1CurveParameters SECP256r1_CURVE_PARAMETERS {
-    .prime = "FFFFFFFF_00000001_00000000_00000000_00000000_FFFFFFFF_FFFFFFFF_FFFFFFFF"sv,
-    .a = "FFFFFFFF_00000001_00000000_00000000_00000000_FFFFFFFF_FFFFFFFF_FFFFFFFC"sv,
-    .b = "5AC635D8_AA3A93E7_B3EBBD55_769886BC_651D06B0_CC53B0F6_3BCE3C3E_27D2604B"sv,
-    .order = "FFFFFFFF_00000000_FFFFFFFF_FFFFFFFF_BCE6FAAD_A7179E84_F3B9CAC2_FC632551"sv,
-    .generator_point = "04_6B17D1F2_E12C4247_F8BCE6E5_63A440F2_77037D81_2DEB33A0_F4A13945_D898C296_4FE342E2_FE1A7F9B_8EE7EB4A_7C0F9E16_2BCE3357_6B315ECE_CBB64068_37BF51F5"sv,
-};
-using SECP256r1 = SECPxxxr1<256, SECP256r1_CURVE_PARAMETERS>;
+    static Array<AffinePoint, COMB_TABLE_SIZE> make_generator_comb_table()
+    {
+        AK::FixedMemoryStream generator_point_stream { GENERATOR_POINT };
+        AffinePoint generator = MUST(read_uncompressed_point(generator_point_stream));
+
+        // Entry i is the sum of the points 2^(j * COMB_SPACING) * G for all bits j that are set in i
+        Array<ProjectivePoint, COMB_TABLE_SIZE + 1> points;
+        points[0] = point_at_infinity();
+        ProjectivePoint tooth { generator.x, generator.y, ONE };
+        for (size_t j = 0; j < COMB_TEETH; j++) {
+            for (size_t i = 0; i < (1u << j); i++)
+                points[(1u << j) + i] = point_add(points[i], tooth);
+            for (size_t i = 0; i < COMB_SPACING; i++)
+                tooth = point_double(tooth);
+        }
 
-// SECP384r1 curve
-static constexpr SECPxxxr1CurveParameters SECP384r1_CURVE_PARAMETERS {
-    .prime = "FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFE_FFFFFFFF_00000000_00000000_FFFFFFFF"sv,
-    .a = "FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFE_FFFFFFFF_00000000_00000000_FFFFFFFC"sv,
-    .b = "B3312FA7_E23EE7E4_988E056B_E3F82D19_181D9C6E_FE814112_0314088F_5013875A_C656398D_8A2ED19D_2A85C8ED_D3EC2AEF"sv,
-    .order = "FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF_C7634D81_F4372DDF_581A0DB2_48B0A77A_ECEC196A_CCC52973"sv,
-    .generator_point = "04_AA87CA22_BE8B0537_8EB1C71E_F320AD74_6E1D3B62_8BA79B98_59F741E0_82542A38_5502F25D_BF55296C_3A545E38_72760AB7_3617DE4A_96262C6F_5D9E98BF_9292DC29_F8F41DBD_289A147C_E9DA3113_B5F0B8C0_0A60B1CE_1D7E819D_7A431D7C_90EA0E5F"sv,
+        // Convert all entries to affine coordinates with a single inversion, using Montgomery's trick:
+        // the inverse of each Z is the inverse of the product of all of them, times the product of all the others.
+        Array<StorageType, COMB_TABLE_SIZE> partial_products;
+        StorageType product = ONE;
+        for (size_t i = 0; i < COMB_TABLE_SIZE; i++) {
+            partial_products[i] = product;
+            product = modular_multiply(product, points[i + 1].z);
+        }
+
+        StorageType inverse = modular_inverse(product);
+        Array<AffinePoint, COMB_TABLE_SIZE> table;
+        for (size_t i = COMB_TABLE_SIZE; i-- > 0;) {
+            StorageType z_inverse = modular_multiply(inverse, partial_products[i]);
+            inverse = modular_multiply(inverse, points[i + 1].z);
+            table[i] = { modular_multiply(points[i + 1].x, z_inverse), modular_multiply(points[i + 1].y, z_inverse) };
+        }
+
+        return table;
+    }
+
+    static Array<AffinePoint, COMB_TABLE_SIZE> const& generator_comb_table()
+    {
+        static Array<AffinePoint, COMB_TABLE_SIZE> const table = make_generator_comb_table();
+        return table;
+    }
+
+    static ProjectivePoint multiply_generator(StorageType const& scalar)
+    {
+        auto const& table = generator_comb_table();
+
+        // Calculate the scalar times generator multiplication in constant time, going through the columns of the comb
+        // from the most significant one down.
+        ProjectivePoint result = point_at_infinity();
+        for (size_t column = COMB_SPACING; column-- > 0;) {
+            result = point_double(result);
+
+            size_t index = 0;
+            for (size_t tooth = 0; tooth < COMB_TEETH; tooth++) {
+                size_t bit_index = column + tooth * COMB_SPACING;
+                if (bit_index < KEY_BIT_SIZE)
+                    index |= bits_at(scalar, bit_index, 1) << tooth;
+            }
+
+            // An all-zero column still performs an addition, with a dummy point, and then throws its result away
+            AffinePoint addend = select_from_table(table, index - 1);
+            result = select(result, point_add_mixed(result, addend), index != 0);
+        }
+
+        return result;
+    }
+
+    static ProjectivePoint multiply_point(StorageType const& scalar, AffinePoint const& point)
+    {
+        // Precompute 0*P, 1*P, ..., (2^WINDOW_BITS - 1)*P
+        Array<ProjectivePoint, 1 << WINDOW_BITS> multiples;
+        multiples[0] = point_at_infinity();
+        multiples[1] = { point.x, point.y, ONE };
+        for (size_t i = 2; i < multiples.size(); i++) {
+            if (i % 2 == 0)
+                multiples[i] = point_double(multiples[i / 2]);
+            else
+                multiples[i] = point_add_mixed(multiples[i - 1], point);
+        }
+
+        // Calculate the scalar times point multiplication in constant time, with fixed windows from the most significant one down:
+        // every window performs the same doublings, table scan and addition, whatever the scalar bits are.
+        ProjectivePoint result = point_at_infinity();
+        for (size_t window = KEY_BIT_SIZE / WINDOW_BITS; window-- > 0;) {
+            for (size_t i = 0; i < WINDOW_BITS; i++)
+                result = point_double(result);
+
+            size_t digit = bits_at(scalar, window * WINDOW_BITS, WINDOW_BITS);
+            result = point_add(result, select_from_table(multiples, digit));
+        }
+
+        return result;
+    }
 };
+
+using SECP256r1 = SECPxxxr1<256, SECP256r1_CURVE_PARAMETERS>;
 using SECP384r1 = SECPxxxr1<384, SECP384r1_CURVE_PARAMETERS>;
 
 }
@@ -385,6 +385,16 @@ struct X86_64Assembler {
 
     void mov8(Operand dst, Operand src, Extension extension = Extension::ZeroExtend)
     {
+        if (dst.type == Operand::Type::Mem64BaseAndOffset && src.type == Operand::Type::Reg) {
+            // mov r/m8, r8
+            // NOTE: Without a REX prefix, 4-7 encode AH, CH, DH and BH instead of SPL, BPL, SIL and DIL.
+            VERIFY(to_underlying(src.reg) < 4 || to_underlying(src.reg) >= 8);
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x88);
+            emit_modrm_mr(dst, src);
+            return;
+        }
+
         VERIFY(dst.type == Operand::Type::Reg && src.type == Operand::Type::Mem64BaseAndOffset);
         // mov[sz]x r32, r/m8
         emit_rex_for_rm(dst, src, REX_W::No);
@@ -395,6 +405,15 @@ struct X86_64Assembler {
 
     void mov16(Operand dst, Operand src, Extension extension = Extension::ZeroExtend)
     {
+        if (dst.type == Operand::Type::Mem64BaseAndOffset && src.type == Operand::Type::Reg) {
+            // mov r/m16, r16
+            emit8(0x66);
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x89);
+            emit_modrm_mr(dst, src);
+            return;
+        }
+
         VERIFY(dst.type == Operand::Type::Reg && src.is_register_or_memory());
         // mov[sz]x r32, r/m16
         emit_rex_for_rm(dst, src, REX_W::No);
@@ -405,6 +424,14 @@ struct X86_64Assembler {
 
     void mov32(Operand dst, Operand src, Extension extension = Extension::ZeroExtend)
     {
+        if (dst.type == Operand::Type::Mem64BaseAndOffset && src.type == Operand::Type::Reg) {
+            // mov r/m32, r32
+            emit_rex_for_mr(dst, src, REX_W::No);
+            emit8(0x89);
+            emit_modrm_mr(dst, src);
+            return;
+        }
+
         VERIFY(dst.type == Operand::Type::Reg && src.is_register_or_memory());
         if (extension == Extension::ZeroExtend) {
             // mov r32, r/m32
@@ -640,6 +667,18 @@ struct X86_64Assembler {
         }
     }
 
+    void bitwise_xor(Operand dst, Operand src)
+    {
+        // xor dst,src
+        if (dst.is_register_or_memory() && src.type == Operand::Type::Reg) {
+            emit_rex_for_mr(dst, src, REX_W::Yes);
+            emit8(0x31);
+            emit_modrm_mr(dst, src);
+        } else {
+            VERIFY_NOT_REACHED();
+        }
+    }
+
     void bitwise_xor32(Operand dst, Operand src)
     {
         if (dst.is_register_or_memory() && src.type == Operand::Type::Reg) {
@@ -663,7 +702,13 @@ struct X86_64Assembler {
 
     void mul(Operand dest, Operand src)
     {
-        if (dest.type == Operand::Type::FReg && src.type == Operand::Type::FReg) {
+        if (dest.type == Operand::Type::Reg && src.is_register_or_memory()) {
+            // imul dest, src (64-bit)
+            emit_rex_for_rm(dest, src, REX_W::Yes);
+            emit8(0x0f);
+            emit8(0xaf);
+            emit_modrm_rm(dest, src);
+        } else if (dest.type == Operand::Type::FReg && src.type == Operand::Type::FReg) {
             emit8(0xf2);
             emit8(0x0f);
             emit8(0x59);
@@ -32,6 +32,7 @@
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/PromiseCapability.h>
 #include <LibJS/Runtime/PromiseConstructor.h>
+#include <LibJS/Runtime/Realm.h>
 #include <LibJS/Runtime/Reference.h>
 #include <LibJS/Runtime/RegExpObject.h>
 #include <LibJS/Runtime/Shape.h>
@@ -52,6 +53,22 @@ SourceRange ASTNode::source_range() const
     return m_source_code->range_from_offsets(m_start_offset, m_end_offset);
 }
 
+Bytecode::Executable* Statement::bytecode_executable(Realm const& realm) const
+{
+    // NOTE: Nothing can use the executable once its realm is gone, so we let it go as well.
+    if (!m_bytecode_executable_realm)
+        m_bytecode_executable = {};
+    if (m_bytecode_executable_realm.ptr() != &realm)
+        return nullptr;
+    return m_bytecode_executable;
+}
+
+void Statement::set_bytecode_executable(Realm& realm, Bytecode::Executable* bytecode_executable)
+{
+    m_bytecode_executable_realm = realm.make_weak_ptr<Realm>();
+    m_bytecode_executable = make_handle(bytecode_executable);
+}
+
 ByteString ASTNode::class_name() const
 {
     // NOTE: We strip the "JS::" prefix.
@@ -15,6 +15,7 @@
 #include <AK/RefPtr.h>
 #include <AK/Variant.h>
 #include <AK/Vector.h>
+#include <AK/WeakPtr.h>
 #include <LibJS/Bytecode/CodeGenerationError.h>
 #include <LibJS/Bytecode/Executable.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
@@ -159,11 +160,14 @@ public:
     {
     }
 
-    Bytecode::Executable* bytecode_executable() const { return m_bytecode_executable; }
-    void set_bytecode_executable(Bytecode::Executable* bytecode_executable) { m_bytecode_executable = make_handle(bytecode_executable); }
+    // NOTE: The same AST can be shared between realms through the ParsedProgramCache, but an executable is only handed
+    //       back to the realm it was compiled for, since its inline caches are only valid there.
+    Bytecode::Executable* bytecode_executable(Realm const&) const;
+    void set_bytecode_executable(Realm&, Bytecode::Executable*);
 
 private:
-    Handle<Bytecode::Executable> m_bytecode_executable;
+    WeakPtr<Realm> m_bytecode_executable_realm;
+    mutable Handle<Bytecode::Executable> m_bytecode_executable;
 };
 
 // 14.13 Labelled Statements, https://tc39.es/ecma262/#sec-labelled-statements
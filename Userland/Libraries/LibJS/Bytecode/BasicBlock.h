@@ -44,6 +44,13 @@ public:
 
     void grow(size_t additional_size);
 
+    void replace_instruction_stream(Badge<Optimizer>, Vector<u8> buffer, HashMap<size_t, SourceRecord> source_map, size_t last_instruction_start_offset)
+    {
+        m_buffer = move(buffer);
+        m_source_map = move(source_map);
+        m_last_instruction_start_offset = last_instruction_start_offset;
+    }
+
     void terminate(Badge<Generator>) { m_terminated = true; }
     bool is_terminated() const { return m_terminated; }
 
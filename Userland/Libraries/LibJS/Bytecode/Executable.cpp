@@ -7,7 +7,9 @@
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Executable.h>
 #include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Op.h>
 #include <LibJS/Bytecode/RegexTable.h>
+#include <LibJS/JIT/Compiler.h>
 #include <LibJS/SourceCode.h>
 
 namespace JS::Bytecode {
@@ -40,6 +42,17 @@ Executable::Executable(
 
 Executable::~Executable() = default;
 
+JIT::NativeExecutable const* Executable::get_or_create_native_executable()
+{
+    if (m_did_try_jitting)
+        return m_native_executable.ptr();
+    if (++m_hotness < JIT::Compiler::hotness_threshold)
+        return nullptr;
+    m_did_try_jitting = true;
+    m_native_executable = JIT::Compiler::compile(*this);
+    return m_native_executable.ptr();
+}
+
 void Executable::dump() const
 {
     warnln("\033[37;1mJS bytecode executable\033[0m \"{}\"", name);
@@ -83,6 +96,57 @@ void Executable::dump() const
     warnln("");
 }
 
+void Executable::dump_property_lookup_cache_statistics() const
+{
+    if (property_lookup_caches.is_empty())
+        return;
+
+    warnln("\033[37;1mProperty lookup caches\033[0m in \"{}\"", name);
+
+    auto cache_index_for = [](Instruction const& instruction) -> Optional<u32> {
+        switch (instruction.type()) {
+#define __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(op) \
+    case Instruction::Type::op:                     \
+        return static_cast<Op::op const&>(instruction).cache_index();
+            __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(GetById)
+            __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(GetByIdWithThis)
+            __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(GetLength)
+            __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(GetLengthWithThis)
+            __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(PutById)
+            __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE(PutByIdWithThis)
+#undef __BYTECODE_OP_WITH_PROPERTY_LOOKUP_CACHE
+        default:
+            return {};
+        }
+    };
+
+    for (InstructionStreamIterator it(bytecode, this); !it.at_end(); ++it) {
+        auto cache_index = cache_index_for(*it);
+        if (!cache_index.has_value())
+            continue;
+        auto const& cache = property_lookup_caches[*cache_index];
+        auto lookup_count = cache.hit_count + cache.megamorphic_hit_count + cache.miss_count;
+        if (lookup_count == 0)
+            continue;
+
+        size_t shape_count = 0;
+        for (auto const& entry : cache.entries) {
+            if (entry.shape)
+                ++shape_count;
+        }
+
+        warnln("    [{:4x}] {}", it.offset(), (*it).to_byte_string(*this));
+        warnln("           {} hits, {} megamorphic hits, {} misses ({:.1}% hit rate), {}/{} shapes{}",
+            cache.hit_count,
+            cache.megamorphic_hit_count,
+            cache.miss_count,
+            100.0 * (cache.hit_count + cache.megamorphic_hit_count) / lookup_count,
+            shape_count,
+            PropertyLookupCache::max_entry_count,
+            cache.is_megamorphic ? ", megamorphic" : "");
+    }
+}
+
 void Executable::visit_edges(Visitor& visitor)
 {
     Base::visit_edges(visitor);
@@ -13,6 +13,7 @@
 #include <AK/WeakPtr.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/PropertyLookupCache.h>
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Heap/Cell.h>
@@ -22,18 +23,6 @@
 
 namespace JS::Bytecode {
 
-struct PropertyLookupCache {
-    WeakPtr<Shape> shape;
-    Optional<u32> property_offset;
-    WeakPtr<Object> prototype;
-    WeakPtr<PrototypeChainValidity> prototype_chain_validity;
-};
-
-struct GlobalVariableCache : public PropertyLookupCache {
-    u64 environment_serial_number { 0 };
-    Optional<u32> environment_binding_index;
-};
-
 struct SourceRecord {
     u32 source_start_offset {};
     u32 source_end_offset {};
@@ -102,10 +91,20 @@ public:
 
     [[nodiscard]] UnrealizedSourceRange source_range_at(size_t offset) const;
 
+    // Counts this executable as entered (or looped) once more. Returns its native code once it has become hot
+    // enough to be compiled, and nullptr before that or if compilation failed.
+    JIT::NativeExecutable const* get_or_create_native_executable();
+    JIT::NativeExecutable const* native_executable() const { return m_native_executable.ptr(); }
+
     void dump() const;
+    void dump_property_lookup_cache_statistics() const;
 
 private:
     virtual void visit_edges(Visitor&) override;
+
+    OwnPtr<JIT::NativeExecutable> m_native_executable;
+    u32 m_hotness { 0 };
+    bool m_did_try_jitting { false };
 };
 
 }
@@ -11,6 +11,7 @@
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Optimizer.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Runtime/ECMAScriptFunctionObject.h>
 #include <LibJS/Runtime/VM.h>
@@ -243,6 +244,21 @@ CodeGenerationErrorOr<NonnullGCPtr<Executable>> Generator::compile(VM& vm, ASTNo
         }
     }
 
+    if (g_optimization_level > 0) {
+        auto statistics = Optimizer::optimize(generator, min(g_optimization_level, Optimizer::max_level));
+        if (g_dump_optimization_statistics) {
+            warnln("Optimized \"{}\" at -O{}: {} -> {} instructions ({} copies propagated, {} constants folded, {} jumps fused, {} dead stores eliminated)",
+                function ? function->name().view() : "(top level)"sv,
+                min(g_optimization_level, Optimizer::max_level),
+                statistics.instruction_count_before,
+                statistics.instruction_count_after,
+                statistics.propagated_copies,
+                statistics.folded_constants,
+                statistics.fused_jumps,
+                statistics.eliminated_stores);
+        }
+    }
+
     bool is_strict_mode = false;
     if (is<Program>(node))
         is_strict_mode = static_cast<Program const&>(node).is_strict_mode();
@@ -341,6 +341,8 @@ public:
     [[nodiscard]] bool must_propagate_completion() const { return m_must_propagate_completion; }
 
 private:
+    friend class Optimizer;
+
     VM& m_vm;
 
     static CodeGenerationErrorOr<NonnullGCPtr<Executable>> compile(VM&, ASTNode const&, FunctionKind, GCPtr<ECMAScriptFunctionObject const>, MustPropagateCompletion, Vector<DeprecatedFlyString> local_variable_names);
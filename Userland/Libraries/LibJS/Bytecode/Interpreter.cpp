@@ -14,6 +14,7 @@
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/NativeExecutable.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/Array.h>
@@ -39,6 +40,7 @@
 namespace JS::Bytecode {
 
 bool g_dump_bytecode = false;
+bool g_jit_enabled = false;
 
 static ByteString format_operand(StringView name, Operand operand, Bytecode::Executable const& executable)
 {
@@ -332,6 +334,50 @@ Interpreter::HandleExceptionResponse Interpreter::handle_exception(size_t& progr
     VERIFY_NOT_REACHED();
 }
 
+Optional<size_t> Interpreter::continue_pending_unwind(size_t program_counter, Label resume_target)
+{
+    auto& running_execution_context = this->running_execution_context();
+
+    if (auto exception = reg(Register::exception()); !exception.is_empty()) {
+        if (handle_exception(program_counter, exception) == HandleExceptionResponse::ExitFromExecutable)
+            return {};
+        return program_counter;
+    }
+    if (!saved_return_value().is_empty()) {
+        do_return(saved_return_value());
+        if (auto handlers = current_executable().exception_handlers_for_offset(program_counter); handlers.has_value()) {
+            if (auto finalizer = handlers.value().finalizer_offset; finalizer.has_value()) {
+                VERIFY(!running_execution_context.unwind_contexts.is_empty());
+                auto& unwind_context = running_execution_context.unwind_contexts.last();
+                VERIFY(unwind_context.executable == m_current_executable);
+                reg(Register::saved_return_value()) = reg(Register::return_value());
+                reg(Register::return_value()) = {};
+                // the unwind_context will be pop'ed when entering the finally block
+                return finalizer.value();
+            }
+        }
+        return {};
+    }
+    auto const old_scheduled_jump = running_execution_context.previously_scheduled_jumps.take_last();
+    if (m_scheduled_jump.has_value()) {
+        auto target = m_scheduled_jump.value();
+        m_scheduled_jump = {};
+        return target;
+    }
+    // set the scheduled jump to the old value if we continue
+    // where we left it
+    m_scheduled_jump = old_scheduled_jump;
+    return resume_target.address();
+}
+
+bool Interpreter::try_run_native_code(size_t program_counter)
+{
+    auto const* native_executable = current_executable().get_or_create_native_executable();
+    if (!native_executable)
+        return false;
+    return native_executable->run(*this, program_counter);
+}
+
 // FIXME: GCC takes a *long* time to compile with flattening, and it will time out our CI. :|
 #if defined(AK_COMPILER_CLANG)
 #    define FLATTEN_ON_CLANG FLATTEN
@@ -356,6 +402,9 @@ FLATTEN_ON_CLANG void Interpreter::run_bytecode(size_t entry_point)
 
     TemporaryChange change(m_program_counter, Optional<size_t&>(program_counter));
 
+    if (g_jit_enabled && try_run_native_code(program_counter))
+        return;
+
     // Declare a lookup table for computed goto with each of the `handle_*` labels
     // to avoid the overhead of a switch statement.
     // This is a GCC extension, but it's also supported by Clang.
@@ -407,7 +456,16 @@ FLATTEN_ON_CLANG void Interpreter::run_bytecode(size_t entry_point)
 
         handle_Jump: {
             auto& instruction = *reinterpret_cast<Op::Jump const*>(&bytecode[program_counter]);
-            program_counter = instruction.target().address();
+            auto target = instruction.target().address();
+            // NOTE: Backward jumps close loops, so they count towards the JIT threshold as well.
+            //       Once the executable has been compiled, we finish running it as native code.
+            if (g_jit_enabled && target <= program_counter) {
+                program_counter = target;
+                if (try_run_native_code(program_counter))
+                    return;
+                goto start;
+            }
+            program_counter = target;
             goto start;
         }
 
@@ -497,37 +555,10 @@ FLATTEN_ON_CLANG void Interpreter::run_bytecode(size_t entry_point)
 
         handle_ContinuePendingUnwind: {
             auto& instruction = *reinterpret_cast<Op::ContinuePendingUnwind const*>(&bytecode[program_counter]);
-            if (auto exception = reg(Register::exception()); !exception.is_empty()) {
-                if (handle_exception(program_counter, exception) == HandleExceptionResponse::ExitFromExecutable)
-                    return;
-                goto start;
-            }
-            if (!saved_return_value().is_empty()) {
-                do_return(saved_return_value());
-                if (auto handlers = executable.exception_handlers_for_offset(program_counter); handlers.has_value()) {
-                    if (auto finalizer = handlers.value().finalizer_offset; finalizer.has_value()) {
-                        VERIFY(!running_execution_context.unwind_contexts.is_empty());
-                        auto& unwind_context = running_execution_context.unwind_contexts.last();
-                        VERIFY(unwind_context.executable == m_current_executable);
-                        reg(Register::saved_return_value()) = reg(Register::return_value());
-                        reg(Register::return_value()) = {};
-                        program_counter = finalizer.value();
-                        // the unwind_context will be pop'ed when entering the finally block
-                        goto start;
-                    }
-                }
+            auto next_program_counter = continue_pending_unwind(program_counter, instruction.resume_target());
+            if (!next_program_counter.has_value())
                 return;
-            }
-            auto const old_scheduled_jump = running_execution_context.previously_scheduled_jumps.take_last();
-            if (m_scheduled_jump.has_value()) {
-                program_counter = m_scheduled_jump.value();
-                m_scheduled_jump = {};
-            } else {
-                program_counter = instruction.resume_target().address();
-                // set the scheduled jump to the old value if we continue
-                // where we left it
-                m_scheduled_jump = old_scheduled_jump;
-            }
+            program_counter = next_program_counter.value();
             goto start;
         }
 
@@ -981,44 +1012,58 @@ inline ThrowCompletionOr<Value> get_by_id(VM& vm, Optional<IdentifierTableIndex>
 
     auto& shape = base_obj->shape();
 
-    if (cache.prototype) {
-        // OPTIMIZATION: If the prototype chain hasn't been mutated in a way that would invalidate the cache, we can use it.
-        bool can_use_cache = [&]() -> bool {
-            if (&shape != cache.shape)
-                return false;
-            if (!cache.prototype_chain_validity)
-                return false;
-            if (!cache.prototype_chain_validity->is_valid())
-                return false;
-            return true;
-        }();
-        if (can_use_cache) {
-            auto value = cache.prototype->get_direct(cache.property_offset.value());
-            if (value.is_accessor())
-                return TRY(call(vm, value.as_accessor().getter(), this_value));
-            return value;
-        }
-    } else if (&shape == cache.shape) {
-        // OPTIMIZATION: If the shape of the object hasn't changed, we can use the cached property offset.
-        auto value = base_obj->get_direct(cache.property_offset.value());
+    auto value_from_cache = [&](Object const& holder, u32 property_offset) -> ThrowCompletionOr<Value> {
+        auto value = holder.get_direct(property_offset);
         if (value.is_accessor())
             return TRY(call(vm, value.as_accessor().getter(), this_value));
         return value;
+    };
+
+    for (auto& entry : cache.entries) {
+        if (&shape != entry.shape)
+            continue;
+        if (entry.prototype) {
+            // OPTIMIZATION: If the prototype chain hasn't been mutated in a way that would invalidate the cache, we can use it.
+            if (!entry.prototype_chain_validity || !entry.prototype_chain_validity->is_valid())
+                break;
+            ++cache.hit_count;
+            return value_from_cache(*entry.prototype, entry.property_offset);
+        }
+        // OPTIMIZATION: If the shape of the object hasn't changed, we can use the cached property offset.
+        ++cache.hit_count;
+        return value_from_cache(*base_obj, entry.property_offset);
+    }
+
+    auto const& name = executable.get_identifier(property);
+    auto& megamorphic_cache = vm.bytecode_interpreter().megamorphic_get_cache();
+
+    if (cache.is_megamorphic) {
+        // OPTIMIZATION: This site has seen too many shapes to remember them all, but some other site may have seen this one.
+        if (auto property_offset = megamorphic_cache.lookup(shape, name); property_offset.has_value()) {
+            ++cache.megamorphic_hit_count;
+            return value_from_cache(*base_obj, *property_offset);
+        }
     }
 
+    ++cache.miss_count;
+
     CacheablePropertyMetadata cacheable_metadata;
-    auto value = TRY(base_obj->internal_get(executable.get_identifier(property), this_value, &cacheable_metadata));
+    auto value = TRY(base_obj->internal_get(name, this_value, &cacheable_metadata));
 
-    if (cacheable_metadata.type == CacheablePropertyMetadata::Type::OwnProperty) {
-        cache = {};
-        cache.shape = shape;
-        cache.property_offset = cacheable_metadata.property_offset.value();
-    } else if (cacheable_metadata.type == CacheablePropertyMetadata::Type::InPrototypeChain) {
-        cache = {};
-        cache.shape = &base_obj->shape();
-        cache.property_offset = cacheable_metadata.property_offset.value();
-        cache.prototype = *cacheable_metadata.prototype;
-        cache.prototype_chain_validity = *cacheable_metadata.prototype->shape().prototype_chain_validity();
+    if (cacheable_metadata.type == CacheablePropertyMetadata::Type::NotCacheable)
+        return value;
+
+    // NOTE: internal_get() may have run a getter that changed the object's shape, so we cache the one we started with.
+    if (auto* entry = cache.entry_to_update(shape)) {
+        *entry = {};
+        entry->shape = shape;
+        entry->property_offset = cacheable_metadata.property_offset.value();
+        if (cacheable_metadata.type == CacheablePropertyMetadata::Type::InPrototypeChain) {
+            entry->prototype = *cacheable_metadata.prototype;
+            entry->prototype_chain_validity = *cacheable_metadata.prototype->shape().prototype_chain_validity();
+        }
+    } else if (cacheable_metadata.type == CacheablePropertyMetadata::Type::OwnProperty) {
+        megamorphic_cache.set(shape, name, cacheable_metadata.property_offset.value());
     }
 
     return value;
@@ -1188,17 +1233,39 @@ inline ThrowCompletionOr<void> put_by_property_key(VM& vm, Value base, Value thi
         break;
     }
     case Op::PropertyKind::KeyValue: {
-        if (cache && cache->shape == &object->shape()) {
-            object->put_direct(*cache->property_offset, value);
-            return {};
+        auto& megamorphic_cache = vm.bytecode_interpreter().megamorphic_put_cache();
+
+        if (cache) {
+            auto& shape = object->shape();
+            for (auto& entry : cache->entries) {
+                if (&shape == entry.shape) {
+                    ++cache->hit_count;
+                    object->put_direct(entry.property_offset, value);
+                    return {};
+                }
+            }
+            if (cache->is_megamorphic) {
+                if (auto property_offset = megamorphic_cache.lookup(shape, name.as_string()); property_offset.has_value()) {
+                    ++cache->megamorphic_hit_count;
+                    object->put_direct(*property_offset, value);
+                    return {};
+                }
+            }
+            ++cache->miss_count;
         }
 
         CacheablePropertyMetadata cacheable_metadata;
         bool succeeded = TRY(object->internal_set(name, value, this_value, &cacheable_metadata));
 
         if (succeeded && cache && cacheable_metadata.type == CacheablePropertyMetadata::Type::OwnProperty) {
-            cache->shape = object->shape();
-            cache->property_offset = cacheable_metadata.property_offset.value();
+            auto& shape = object->shape();
+            if (auto* entry = cache->entry_to_update(shape)) {
+                *entry = {};
+                entry->shape = shape;
+                entry->property_offset = cacheable_metadata.property_offset.value();
+            } else {
+                megamorphic_cache.set(shape, name.as_string(), cacheable_metadata.property_offset.value());
+            }
         }
 
         if (!succeeded && vm.in_strict_mode()) {
@@ -3260,6 +3327,23 @@ ByteString JumpNullish::to_byte_string_impl(Bytecode::Executable const& executab
         m_false_target);
 }
 
+#define DEFINE_COMPARISON_OP_COMPARE(op_TitleCase, op_snake_case, numeric_operator)                \
+    ThrowCompletionOr<bool> Jump##op_TitleCase::compare(Bytecode::Interpreter& interpreter) const \
+    {                                                                                              \
+        auto lhs = interpreter.get(m_lhs);                                                         \
+        auto rhs = interpreter.get(m_rhs);                                                         \
+        if (lhs.is_number() && rhs.is_number()) {                                                  \
+            if (lhs.is_int32() && rhs.is_int32())                                                  \
+                return lhs.as_i32() numeric_operator rhs.as_i32();                                 \
+            return lhs.as_double() numeric_operator rhs.as_double();                               \
+        }                                                                                          \
+        auto result = TRY(op_snake_case(interpreter.vm(), lhs, rhs));                              \
+        return result.to_boolean();                                                                \
+    }
+
+JS_ENUMERATE_COMPARISON_OPS(DEFINE_COMPARISON_OP_COMPARE)
+#undef DEFINE_COMPARISON_OP_COMPARE
+
 #define HANDLE_COMPARISON_OP(op_TitleCase, op_snake_case, numeric_operator)                          \
     ByteString Jump##op_TitleCase::to_byte_string_impl(Bytecode::Executable const& executable) const \
     {                                                                                                \
@@ -80,8 +80,17 @@ public:
 
     ExecutionContext& running_execution_context() { return *m_running_execution_context; }
 
+    // Shared by all property access sites that have seen too many shapes for their own PropertyLookupCache.
+    // Gets and puts use separate tables, since a get may be cached for properties a put can't write directly.
+    MegamorphicPropertyCache& megamorphic_get_cache() { return m_megamorphic_get_cache; }
+    MegamorphicPropertyCache& megamorphic_put_cache() { return m_megamorphic_put_cache; }
+
 private:
+    friend class JIT::Compiler;
+    friend class JIT::NativeExecutable;
+
     void run_bytecode(size_t entry_point);
+    bool try_run_native_code(size_t program_counter);
 
     enum class HandleExceptionResponse {
         ExitFromExecutable,
@@ -89,6 +98,9 @@ private:
     };
     [[nodiscard]] HandleExceptionResponse handle_exception(size_t& program_counter, Value exception);
 
+    // Returns the offset to continue at, or nothing if we should exit from the executable.
+    [[nodiscard]] Optional<size_t> continue_pending_unwind(size_t program_counter, Label resume_target);
+
     VM& m_vm;
     Optional<size_t> m_scheduled_jump;
     GCPtr<Executable> m_current_executable { nullptr };
@@ -99,9 +111,12 @@ private:
     Span<Value> m_arguments;
     Span<Value> m_registers_and_constants_and_locals;
     ExecutionContext* m_running_execution_context { nullptr };
+    MegamorphicPropertyCache m_megamorphic_get_cache;
+    MegamorphicPropertyCache m_megamorphic_put_cache;
 };
 
 extern bool g_dump_bytecode;
+extern bool g_jit_enabled;
 
 ThrowCompletionOr<NonnullGCPtr<Bytecode::Executable>> compile(VM&, ASTNode const&, JS::FunctionKind kind, DeprecatedFlyString const& name);
 ThrowCompletionOr<NonnullGCPtr<Bytecode::Executable>> compile(VM&, ECMAScriptFunctionObject const&);
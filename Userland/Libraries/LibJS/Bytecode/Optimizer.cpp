@@ -0,0 +1,661 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Optimizer.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Runtime/ValueInlines.h>
+
+namespace JS::Bytecode {
+
+unsigned g_optimization_level = 0;
+bool g_dump_optimization_statistics = false;
+
+namespace {
+
+// How an instruction known to the optimizer uses its operands.
+// Instructions that aren't known may read and write any of their operands, and may throw.
+struct OperandUses {
+    Operand* write { nullptr };
+    Operand* read_write { nullptr };
+    Vector<Operand*, 2> reads;
+    bool may_throw { true };
+};
+
+Optional<OperandUses> operand_uses_for(Instruction& instruction)
+{
+    Vector<Operand*, 4> operands;
+    instruction.visit_operands([&](Operand& operand) { operands.append(&operand); });
+
+    OperandUses uses;
+
+    switch (instruction.type()) {
+#define __BYTECODE_OP(op_TitleCase, ...) case Instruction::Type::op_TitleCase:
+#define __BYTECODE_JUMP_OP(op_TitleCase, ...) case Instruction::Type::Jump##op_TitleCase:
+        JS_ENUMERATE_COMMON_BINARY_OPS_WITH_FAST_PATH(__BYTECODE_OP)
+        JS_ENUMERATE_COMMON_BINARY_OPS_WITHOUT_FAST_PATH(__BYTECODE_OP)
+        JS_ENUMERATE_COMMON_UNARY_OPS(__BYTECODE_OP)
+    case Instruction::Type::Mov:
+        uses.write = operands[0];
+        for (size_t i = 1; i < operands.size(); ++i)
+            uses.reads.append(operands[i]);
+        break;
+    case Instruction::Type::Increment:
+    case Instruction::Type::Decrement:
+        uses.read_write = operands[0];
+        break;
+        JS_ENUMERATE_COMPARISON_OPS(__BYTECODE_JUMP_OP)
+    case Instruction::Type::Jump:
+    case Instruction::Type::JumpIf:
+    case Instruction::Type::JumpNullish:
+    case Instruction::Type::JumpUndefined:
+    case Instruction::Type::Return:
+    case Instruction::Type::End:
+        for (auto* operand : operands)
+            uses.reads.append(operand);
+        break;
+#undef __BYTECODE_OP
+#undef __BYTECODE_JUMP_OP
+    default:
+        return {};
+    }
+
+    switch (instruction.type()) {
+    case Instruction::Type::Mov:
+    case Instruction::Type::Not:
+    case Instruction::Type::Typeof:
+    case Instruction::Type::Jump:
+    case Instruction::Type::JumpIf:
+    case Instruction::Type::JumpNullish:
+    case Instruction::Type::JumpUndefined:
+    case Instruction::Type::End:
+        uses.may_throw = false;
+        break;
+    default:
+        break;
+    }
+
+    return uses;
+}
+
+struct InstructionAndOffset {
+    Instruction* instruction;
+    size_t offset;
+};
+
+Vector<InstructionAndOffset> instructions_in(BasicBlock const& block)
+{
+    Vector<InstructionAndOffset> instructions;
+    for (InstructionStreamIterator it(block.instruction_stream()); !it.at_end(); ++it)
+        instructions.append({ const_cast<Instruction*>(&*it), it.offset() });
+    return instructions;
+}
+
+// Rebuilds the instruction stream of a basic block, keeping, dropping or replacing each of its instructions in turn.
+class BlockRewriter {
+public:
+    explicit BlockRewriter(BasicBlock& block)
+        : m_block(block)
+    {
+        m_buffer.ensure_capacity(block.size());
+    }
+
+    void keep(InstructionAndOffset const& original)
+    {
+        begin_instruction(original.offset);
+        m_buffer.append(reinterpret_cast<u8 const*>(original.instruction), original.instruction->length());
+    }
+
+    void drop(InstructionAndOffset const& original)
+    {
+        Instruction::destroy(*original.instruction);
+        m_did_change = true;
+    }
+
+    // NOTE: The new instruction takes over the source location of the instruction at `source_offset`.
+    template<typename OpType, typename... Args>
+    void replace(InstructionAndOffset const& original, size_t source_offset, Args&&... args)
+    {
+        auto offset = begin_instruction(source_offset);
+        m_buffer.resize(offset + sizeof(OpType));
+        new (m_buffer.data() + offset) OpType(forward<Args>(args)...);
+        Instruction::destroy(*original.instruction);
+        m_did_change = true;
+    }
+
+    template<typename OpType, typename... Args>
+    void replace(InstructionAndOffset const& original, Args&&... args)
+    {
+        replace<OpType>(original, original.offset, forward<Args>(args)...);
+    }
+
+    void commit(Badge<Optimizer> badge)
+    {
+        // NOTE: The instructions we kept were moved into the new buffer, so the old one must not destroy them.
+        if (m_did_change)
+            m_block.replace_instruction_stream(move(badge), move(m_buffer), move(m_source_map), m_last_instruction_start_offset);
+    }
+
+private:
+    size_t begin_instruction(size_t source_offset)
+    {
+        auto offset = m_buffer.size();
+        m_last_instruction_start_offset = offset;
+        if (auto source_record = m_block.source_map().get(source_offset); source_record.has_value())
+            m_source_map.set(offset, *source_record);
+        return offset;
+    }
+
+    BasicBlock& m_block;
+    Vector<u8> m_buffer;
+    HashMap<size_t, SourceRecord> m_source_map;
+    size_t m_last_instruction_start_offset { 0 };
+    bool m_did_change { false };
+};
+
+// NOTE: With two Number operands, none of these can throw or call into user code.
+Optional<Value> fold_binary_operation(VM& vm, Instruction::Type type, Value lhs, Value rhs)
+{
+    if (!lhs.is_number() || !rhs.is_number())
+        return {};
+
+    switch (type) {
+#define __BYTECODE_OP(op_TitleCase, op_snake_case) \
+    case Instruction::Type::op_TitleCase:          \
+        return MUST(op_snake_case(vm, lhs, rhs));
+        JS_ENUMERATE_COMMON_BINARY_OPS_WITH_FAST_PATH(__BYTECODE_OP)
+        __BYTECODE_OP(Div, div)
+        __BYTECODE_OP(Exp, exp)
+        __BYTECODE_OP(Mod, mod)
+#undef __BYTECODE_OP
+    case Instruction::Type::LooselyEquals:
+        return Value(MUST(is_loosely_equal(vm, lhs, rhs)));
+    case Instruction::Type::LooselyInequals:
+        return Value(!MUST(is_loosely_equal(vm, lhs, rhs)));
+    case Instruction::Type::StrictlyEquals:
+        return Value(is_strictly_equal(lhs, rhs));
+    case Instruction::Type::StrictlyInequals:
+        return Value(!is_strictly_equal(lhs, rhs));
+    default:
+        return {};
+    }
+}
+
+Optional<Value> fold_unary_operation(VM& vm, Instruction::Type type, Value value)
+{
+    switch (type) {
+    case Instruction::Type::Not:
+        return Value(!value.to_boolean());
+    case Instruction::Type::BitwiseNot:
+        if (value.is_number())
+            return MUST(bitwise_not(vm, value));
+        return {};
+    case Instruction::Type::UnaryMinus:
+        if (value.is_number())
+            return MUST(unary_minus(vm, value));
+        return {};
+    case Instruction::Type::UnaryPlus:
+        if (value.is_number())
+            return value;
+        return {};
+    default:
+        return {};
+    }
+}
+
+bool is_undefined_constant(Optional<Value> const& value)
+{
+    return value.has_value() && value->is_undefined();
+}
+
+}
+
+Optimizer::RegisterSet::RegisterSet(size_t register_count)
+{
+    m_words.resize(ceil_div(register_count, static_cast<size_t>(64)));
+}
+
+bool Optimizer::RegisterSet::contains(Operand operand) const
+{
+    if (!operand.is_register() || operand.index() < Register::reserved_register_count)
+        return false;
+    return m_words[operand.index() / 64] & (1ull << (operand.index() % 64));
+}
+
+void Optimizer::RegisterSet::add(Operand operand)
+{
+    if (!operand.is_register() || operand.index() < Register::reserved_register_count)
+        return;
+    m_words[operand.index() / 64] |= 1ull << (operand.index() % 64);
+}
+
+void Optimizer::RegisterSet::remove(Operand operand)
+{
+    if (!operand.is_register() || operand.index() < Register::reserved_register_count)
+        return;
+    m_words[operand.index() / 64] &= ~(1ull << (operand.index() % 64));
+}
+
+void Optimizer::RegisterSet::add_all(RegisterSet const& other)
+{
+    for (size_t i = 0; i < m_words.size(); ++i)
+        m_words[i] |= other.m_words[i];
+}
+
+Optimizer::Optimizer(Generator& generator)
+    : m_generator(generator)
+    , m_blocks(generator.m_root_basic_blocks)
+{
+}
+
+Optimizer::Statistics Optimizer::optimize(Generator& generator, unsigned level)
+{
+    Optimizer optimizer(generator);
+    optimizer.m_statistics.instruction_count_before = optimizer.count_instructions();
+
+    if (level >= 1) {
+        // Folding leaves behind Movs of constants, which can be propagated and folded further in turn.
+        for (size_t round = 0; round < 4; ++round) {
+            auto folded_constants = optimizer.m_statistics.folded_constants;
+            optimizer.propagate_copies();
+            optimizer.fold_constants();
+            if (optimizer.m_statistics.folded_constants == folded_constants)
+                break;
+        }
+    }
+
+    if (level >= 2) {
+        optimizer.compute_liveness();
+        optimizer.fuse_compare_and_jump();
+        optimizer.compute_liveness();
+        optimizer.eliminate_dead_stores();
+    }
+
+    optimizer.m_statistics.instruction_count_after = optimizer.count_instructions();
+    return optimizer.m_statistics;
+}
+
+size_t Optimizer::count_instructions() const
+{
+    size_t count = 0;
+    for (auto& block : m_blocks) {
+        for (InstructionStreamIterator it(block->instruction_stream()); !it.at_end(); ++it)
+            ++count;
+    }
+    return count;
+}
+
+bool Optimizer::is_temporary(Operand operand) const
+{
+    return operand.is_register() && operand.index() >= Register::reserved_register_count;
+}
+
+Optional<Value> Optimizer::constant_value(Operand operand) const
+{
+    if (!operand.is_constant())
+        return {};
+    auto value = m_generator.m_constants[operand.index()];
+    if (value.is_empty())
+        return {};
+    return value;
+}
+
+// Within each block, rewrites reads of a temporary that holds a copy of a constant or of another temporary
+// into reads of the original.
+void Optimizer::propagate_copies()
+{
+    for (auto& block : m_blocks) {
+        HashMap<u32, Operand> copies;
+
+        auto invalidate = [&](Operand operand) {
+            if (!is_temporary(operand))
+                return;
+            copies.remove(operand.index());
+            copies.remove_all_matching([&](u32, Operand const& source) { return source == operand; });
+        };
+
+        for (auto& [instruction, offset] : instructions_in(*block)) {
+            auto uses = operand_uses_for(*instruction);
+            if (!uses.has_value()) {
+                instruction->visit_operands([&](Operand& operand) { invalidate(operand); });
+                continue;
+            }
+
+            for (auto* read : uses->reads) {
+                if (!is_temporary(*read))
+                    continue;
+                if (auto source = copies.get(read->index()); source.has_value()) {
+                    *read = *source;
+                    ++m_statistics.propagated_copies;
+                }
+            }
+
+            if (uses->read_write)
+                invalidate(*uses->read_write);
+            if (!uses->write)
+                continue;
+            invalidate(*uses->write);
+
+            if (instruction->type() != Instruction::Type::Mov)
+                continue;
+            auto& mov = static_cast<Op::Mov const&>(*instruction);
+            if (is_temporary(mov.dst()) && mov.src() != mov.dst() && (mov.src().is_constant() || is_temporary(mov.src())))
+                copies.set(mov.dst().index(), mov.src());
+        }
+    }
+}
+
+// Evaluates arithmetic on constant Number operands, and turns conditional jumps on constants into plain jumps.
+void Optimizer::fold_constants()
+{
+    auto& vm = m_generator.vm();
+
+    for (auto& block : m_blocks) {
+        BlockRewriter rewriter(*block);
+
+        for (auto& original : instructions_in(*block)) {
+            auto& instruction = *original.instruction;
+
+            switch (instruction.type()) {
+#define __BYTECODE_OP(op_TitleCase, ...)                                                                         \
+    case Instruction::Type::op_TitleCase: {                                                                      \
+        auto& op = static_cast<Op::op_TitleCase const&>(instruction);                                            \
+        auto lhs = constant_value(op.lhs());                                                                     \
+        auto rhs = constant_value(op.rhs());                                                                     \
+        if (lhs.has_value() && rhs.has_value()) {                                                                \
+            if (auto result = fold_binary_operation(vm, instruction.type(), *lhs, *rhs); result.has_value()) { \
+                rewriter.replace<Op::Mov>(original, op.dst(), m_generator.add_constant(*result).operand());      \
+                ++m_statistics.folded_constants;                                                                 \
+                continue;                                                                                        \
+            }                                                                                                    \
+        }                                                                                                        \
+        break;                                                                                                   \
+    }
+                JS_ENUMERATE_COMMON_BINARY_OPS_WITH_FAST_PATH(__BYTECODE_OP)
+                JS_ENUMERATE_COMMON_BINARY_OPS_WITHOUT_FAST_PATH(__BYTECODE_OP)
+#undef __BYTECODE_OP
+
+#define __BYTECODE_OP(op_TitleCase, ...)                                                                      \
+    case Instruction::Type::op_TitleCase: {                                                                   \
+        auto& op = static_cast<Op::op_TitleCase const&>(instruction);                                         \
+        if (auto value = constant_value(op.src()); value.has_value()) {                                       \
+            if (auto result = fold_unary_operation(vm, instruction.type(), *value); result.has_value()) {     \
+                rewriter.replace<Op::Mov>(original, op.dst(), m_generator.add_constant(*result).operand());   \
+                ++m_statistics.folded_constants;                                                              \
+                continue;                                                                                     \
+            }                                                                                                 \
+        }                                                                                                     \
+        break;                                                                                                \
+    }
+                JS_ENUMERATE_COMMON_UNARY_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+
+#define __BYTECODE_OP(op_TitleCase, ...)                                                                                 \
+    case Instruction::Type::Jump##op_TitleCase: {                                                                        \
+        auto& jump = static_cast<Op::Jump##op_TitleCase const&>(instruction);                                            \
+        auto lhs = constant_value(jump.lhs());                                                                           \
+        auto rhs = constant_value(jump.rhs());                                                                           \
+        if (lhs.has_value() && rhs.has_value()) {                                                                        \
+            if (auto result = fold_binary_operation(vm, Instruction::Type::op_TitleCase, *lhs, *rhs); result.has_value()) { \
+                rewriter.replace<Op::Jump>(original, result->as_bool() ? jump.true_target() : jump.false_target());      \
+                ++m_statistics.folded_constants;                                                                         \
+                continue;                                                                                                \
+            }                                                                                                            \
+        }                                                                                                                \
+        break;                                                                                                           \
+    }
+                JS_ENUMERATE_COMPARISON_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+
+            case Instruction::Type::JumpIf: {
+                auto& jump = static_cast<Op::JumpIf const&>(instruction);
+                auto condition = constant_value(jump.condition());
+                if (condition.has_value() || jump.true_target().basic_block_index() == jump.false_target().basic_block_index()) {
+                    rewriter.replace<Op::Jump>(original, !condition.has_value() || condition->to_boolean() ? jump.true_target() : jump.false_target());
+                    ++m_statistics.folded_constants;
+                    continue;
+                }
+                break;
+            }
+            case Instruction::Type::JumpNullish: {
+                auto& jump = static_cast<Op::JumpNullish const&>(instruction);
+                if (auto condition = constant_value(jump.condition()); condition.has_value()) {
+                    rewriter.replace<Op::Jump>(original, condition->is_nullish() ? jump.true_target() : jump.false_target());
+                    ++m_statistics.folded_constants;
+                    continue;
+                }
+                break;
+            }
+            case Instruction::Type::JumpUndefined: {
+                auto& jump = static_cast<Op::JumpUndefined const&>(instruction);
+                if (auto condition = constant_value(jump.condition()); condition.has_value()) {
+                    rewriter.replace<Op::Jump>(original, condition->is_undefined() ? jump.true_target() : jump.false_target());
+                    ++m_statistics.folded_constants;
+                    continue;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            rewriter.keep(original);
+        }
+
+        rewriter.commit({});
+    }
+}
+
+Optimizer::RegisterSet Optimizer::live_after_block(BasicBlock const& block) const
+{
+    RegisterSet live(m_generator.m_next_register);
+    for (auto successor : m_successors[block.index()])
+        live.add_all(m_live_in[successor]);
+    return live;
+}
+
+Optimizer::RegisterSet Optimizer::live_at_exception_handlers(BasicBlock const& block) const
+{
+    RegisterSet live(m_generator.m_next_register);
+    if (block.handler())
+        live.add_all(m_live_in[block.handler()->index()]);
+    if (block.finalizer())
+        live.add_all(m_live_in[block.finalizer()->index()]);
+    return live;
+}
+
+// Updates `live` from the set of temporaries live after the instruction to the set live before it.
+void Optimizer::step_liveness_backward(Instruction& instruction, RegisterSet& live, RegisterSet const& live_at_exception_handlers) const
+{
+    auto uses = operand_uses_for(instruction);
+    if (uses.has_value()) {
+        if (uses->write)
+            live.remove(*uses->write);
+        if (uses->read_write)
+            live.add(*uses->read_write);
+        for (auto* read : uses->reads)
+            live.add(*read);
+        if (!uses->may_throw)
+            return;
+    } else {
+        instruction.visit_operands([&](Operand& operand) { live.add(operand); });
+    }
+
+    // If the instruction throws, anything the exception handler reads has to have survived until here.
+    live.add_all(live_at_exception_handlers);
+}
+
+void Optimizer::compute_liveness()
+{
+    m_successors.clear();
+    m_successors.resize(m_blocks.size());
+
+    // NOTE: ContinuePendingUnwind may resume at the target of any ScheduleJump that led into the finalizer.
+    Vector<u32> scheduled_jump_targets;
+    for (auto& block : m_blocks) {
+        for (auto& [instruction, offset] : instructions_in(*block)) {
+            if (instruction->type() == Instruction::Type::ScheduleJump)
+                scheduled_jump_targets.append(static_cast<Op::ScheduleJump const&>(*instruction).target().basic_block_index());
+        }
+    }
+
+    for (auto& block : m_blocks) {
+        auto& successors = m_successors[block->index()];
+        for (auto& [instruction, offset] : instructions_in(*block)) {
+            instruction->visit_labels([&](Label& label) { successors.append(label.basic_block_index()); });
+            if (instruction->type() == Instruction::Type::ContinuePendingUnwind)
+                successors.extend(scheduled_jump_targets);
+        }
+    }
+
+    m_live_in.clear();
+    m_live_in.resize(m_blocks.size());
+    for (auto& live_in : m_live_in)
+        live_in = RegisterSet(m_generator.m_next_register);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = m_blocks.size(); i-- > 0;) {
+            auto& block = *m_blocks[i];
+            auto live = live_after_block(block);
+            auto live_at_handlers = live_at_exception_handlers(block);
+            auto instructions = instructions_in(block);
+            for (size_t j = instructions.size(); j-- > 0;)
+                step_liveness_backward(*instructions[j].instruction, live, live_at_handlers);
+            if (live != m_live_in[i]) {
+                m_live_in[i] = move(live);
+                changed = true;
+            }
+        }
+    }
+}
+
+// Turns a comparison (or Not) into a temporary, followed by a JumpIf on that temporary, into a single jump
+// instruction, as long as nothing reads the temporary after the jump.
+void Optimizer::fuse_compare_and_jump()
+{
+    for (auto& block : m_blocks) {
+        auto instructions = instructions_in(*block);
+        if (instructions.size() < 2 || instructions.last().instruction->type() != Instruction::Type::JumpIf)
+            continue;
+
+        auto& jump_original = instructions.last();
+        auto& compare_original = instructions[instructions.size() - 2];
+        auto& jump = static_cast<Op::JumpIf const&>(*jump_original.instruction);
+        auto& compare = *compare_original.instruction;
+
+        auto condition = jump.condition();
+        if (!is_temporary(condition)
+            || m_live_in[jump.true_target().basic_block_index()].contains(condition)
+            || m_live_in[jump.false_target().basic_block_index()].contains(condition))
+            continue;
+
+        BlockRewriter rewriter(*block);
+        for (size_t i = 0; i < instructions.size() - 2; ++i)
+            rewriter.keep(instructions[i]);
+
+        auto fuse = [&]<typename OpType, typename... Args>(Args&&... args) {
+            rewriter.drop(compare_original);
+            rewriter.replace<OpType>(jump_original, compare_original.offset, forward<Args>(args)...);
+            rewriter.commit({});
+            ++m_statistics.fused_jumps;
+        };
+
+        switch (compare.type()) {
+        case Instruction::Type::Not: {
+            auto& op = static_cast<Op::Not const&>(compare);
+            if (op.dst() == condition)
+                fuse.operator()<Op::JumpIf>(op.src(), jump.false_target(), jump.true_target());
+            break;
+        }
+        case Instruction::Type::StrictlyEquals:
+        case Instruction::Type::StrictlyInequals: {
+            // NOTE: Unlike `x == null`, which is also true for objects with [[IsHTMLDDA]], this can't be a JumpNullish.
+            auto& op = static_cast<Op::StrictlyEquals const&>(compare);
+            if (op.dst() != condition)
+                break;
+            auto is_equals = compare.type() == Instruction::Type::StrictlyEquals;
+            auto true_target = is_equals ? jump.true_target() : jump.false_target();
+            auto false_target = is_equals ? jump.false_target() : jump.true_target();
+            if (is_undefined_constant(constant_value(op.rhs())))
+                fuse.operator()<Op::JumpUndefined>(op.lhs(), true_target, false_target);
+            else if (is_undefined_constant(constant_value(op.lhs())))
+                fuse.operator()<Op::JumpUndefined>(op.rhs(), true_target, false_target);
+            else if (is_equals)
+                fuse.operator()<Op::JumpStrictlyEquals>(op.lhs(), op.rhs(), jump.true_target(), jump.false_target());
+            else
+                fuse.operator()<Op::JumpStrictlyInequals>(op.lhs(), op.rhs(), jump.true_target(), jump.false_target());
+            break;
+        }
+#define __BYTECODE_OP(op_TitleCase, ...)                                                                                \
+    case Instruction::Type::op_TitleCase: {                                                                             \
+        auto& op = static_cast<Op::op_TitleCase const&>(compare);                                                       \
+        if (op.dst() == condition)                                                                                      \
+            fuse.operator()<Op::Jump##op_TitleCase>(op.lhs(), op.rhs(), jump.true_target(), jump.false_target());        \
+        break;                                                                                                          \
+    }
+            __BYTECODE_OP(LessThan)
+            __BYTECODE_OP(LessThanEquals)
+            __BYTECODE_OP(GreaterThan)
+            __BYTECODE_OP(GreaterThanEquals)
+            __BYTECODE_OP(LooselyEquals)
+            __BYTECODE_OP(LooselyInequals)
+#undef __BYTECODE_OP
+        default:
+            break;
+        }
+    }
+}
+
+// Removes side-effect free instructions (like Mov) whose result is never read, and Movs of an operand to itself.
+void Optimizer::eliminate_dead_stores()
+{
+    for (auto& block : m_blocks) {
+        auto instructions = instructions_in(*block);
+        Vector<bool> is_dead;
+        is_dead.resize(instructions.size());
+
+        auto live = live_after_block(*block);
+        auto live_at_handlers = live_at_exception_handlers(*block);
+        bool found_dead_store = false;
+
+        for (size_t i = instructions.size(); i-- > 0;) {
+            auto& instruction = *instructions[i].instruction;
+            auto uses = operand_uses_for(instruction);
+            if (uses.has_value() && uses->write && !uses->may_throw) {
+                auto is_self_move = instruction.type() == Instruction::Type::Mov
+                    && static_cast<Op::Mov const&>(instruction).src() == *uses->write;
+                if (is_self_move || (is_temporary(*uses->write) && !live.contains(*uses->write))) {
+                    is_dead[i] = true;
+                    found_dead_store = true;
+                    continue;
+                }
+            }
+            step_liveness_backward(instruction, live, live_at_handlers);
+        }
+
+        if (!found_dead_store)
+            continue;
+
+        BlockRewriter rewriter(*block);
+        for (size_t i = 0; i < instructions.size(); ++i) {
+            if (is_dead[i]) {
+                rewriter.drop(instructions[i]);
+                ++m_statistics.eliminated_stores;
+            } else {
+                rewriter.keep(instructions[i]);
+            }
+        }
+        rewriter.commit({});
+    }
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Operand.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// Optimization passes over the basic blocks of a Generator, run before they are linked into an Executable.
+//
+// Level 1 runs the block-local passes: copy propagation and constant folding.
+// Level 2 additionally computes register liveness across blocks, and uses it to fuse comparisons into the
+// conditional jumps that consume them, and to eliminate stores to registers that are never read.
+//
+// NOTE: Only temporary registers (the ones handed out by Generator::allocate_register()) are ever rewritten.
+//       Locals and the reserved registers can be read and written behind our back, by closures, the unwind
+//       machinery and the like.
+class Optimizer {
+public:
+    static constexpr unsigned max_level = 2;
+
+    struct Statistics {
+        size_t instruction_count_before { 0 };
+        size_t instruction_count_after { 0 };
+        size_t propagated_copies { 0 };
+        size_t folded_constants { 0 };
+        size_t fused_jumps { 0 };
+        size_t eliminated_stores { 0 };
+    };
+
+    static Statistics optimize(Generator&, unsigned level);
+
+private:
+    explicit Optimizer(Generator&);
+
+    size_t count_instructions() const;
+
+    void propagate_copies();
+    void fold_constants();
+    void compute_liveness();
+    void fuse_compare_and_jump();
+    void eliminate_dead_stores();
+
+    bool is_temporary(Operand) const;
+    Optional<Value> constant_value(Operand) const;
+
+    class RegisterSet {
+    public:
+        RegisterSet() = default;
+        explicit RegisterSet(size_t register_count);
+
+        bool contains(Operand) const;
+        void add(Operand);
+        void remove(Operand);
+        void add_all(RegisterSet const&);
+
+        bool operator==(RegisterSet const&) const = default;
+
+    private:
+        Vector<u64> m_words;
+    };
+
+    RegisterSet live_after_block(BasicBlock const&) const;
+    RegisterSet live_at_exception_handlers(BasicBlock const&) const;
+    void step_liveness_backward(Instruction&, RegisterSet& live, RegisterSet const& live_at_exception_handlers) const;
+
+    Generator& m_generator;
+    Vector<NonnullOwnPtr<BasicBlock>>& m_blocks;
+    Statistics m_statistics;
+
+    Vector<Vector<u32>> m_successors;
+    Vector<RegisterSet> m_live_in;
+};
+
+extern unsigned g_optimization_level;
+extern bool g_dump_optimization_statistics;
+
+}
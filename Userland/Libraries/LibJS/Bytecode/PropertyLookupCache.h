@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/DeprecatedFlyString.h>
+#include <AK/HashFunctions.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+// A polymorphic inline cache for a single property access site. Each entry remembers one shape seen at the site,
+// along with where the property lives for objects of that shape: either at an offset in the object itself, or at an
+// offset in one of its prototypes.
+struct PropertyLookupCache {
+    static constexpr size_t max_entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        // NOTE: Only meaningful while shape is set. This is a plain u32 so that JIT-compiled code can load it.
+        u32 property_offset { 0 };
+        WeakPtr<Object> prototype;
+        WeakPtr<PrototypeChainValidity> prototype_chain_validity;
+    };
+
+    // Returns the entry to fill in for the given shape: the one already holding it, or a free one.
+    // Returns nullptr and marks the site as megamorphic once all entries are taken by other shapes.
+    Entry* entry_to_update(Shape const& shape)
+    {
+        Entry* free_entry = nullptr;
+        for (auto& entry : entries) {
+            if (entry.shape == &shape)
+                return &entry;
+            if (!free_entry && !entry.shape)
+                free_entry = &entry;
+        }
+        if (!free_entry)
+            is_megamorphic = true;
+        return free_entry;
+    }
+
+    AK::Array<Entry, max_entry_count> entries;
+
+    // Once a site has seen more shapes than it has entries, own properties are looked up in the interpreter's
+    // MegamorphicPropertyCache as well.
+    bool is_megamorphic { false };
+
+    u64 hit_count { 0 };
+    u64 megamorphic_hit_count { 0 };
+    u64 miss_count { 0 };
+};
+
+struct GlobalVariableCache {
+    WeakPtr<Shape> shape;
+    Optional<u32> property_offset;
+    u64 environment_serial_number { 0 };
+    Optional<u32> environment_binding_index;
+};
+
+// A direct-mapped table of (shape, property name) -> own property offset, shared by all megamorphic access sites.
+// Colliding entries simply replace each other.
+class MegamorphicPropertyCache {
+    AK_MAKE_NONCOPYABLE(MegamorphicPropertyCache);
+    AK_MAKE_NONMOVABLE(MegamorphicPropertyCache);
+
+public:
+    static constexpr size_t entry_count = 1024;
+
+    MegamorphicPropertyCache() = default;
+
+    Optional<u32> lookup(Shape const& shape, DeprecatedFlyString const& name) const
+    {
+        auto const& entry = m_entries[index_for(shape, name)];
+        if (entry.shape != &shape || entry.name != name)
+            return {};
+        return entry.property_offset;
+    }
+
+    void set(Shape& shape, DeprecatedFlyString const& name, u32 property_offset)
+    {
+        auto& entry = m_entries[index_for(shape, name)];
+        entry.shape = shape;
+        entry.name = name;
+        entry.property_offset = property_offset;
+    }
+
+private:
+    static size_t index_for(Shape const& shape, DeprecatedFlyString const& name)
+    {
+        return pair_int_hash(ptr_hash(&shape), name.hash()) % entry_count;
+    }
+
+    struct Entry {
+        // NOTE: This is a WeakPtr so that a new shape allocated at the address of a dead one can't hit a stale entry.
+        WeakPtr<Shape> shape;
+        DeprecatedFlyString name;
+        u32 property_offset { 0 };
+    };
+
+    AK::Array<Entry, entry_count> m_entries;
+};
+
+}
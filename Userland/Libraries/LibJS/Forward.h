@@ -194,6 +194,7 @@ class Module;
 struct ModuleRequest;
 class NativeFunction;
 class ObjectEnvironment;
+class ParsedProgramCache;
 class Parser;
 struct ParserError;
 class PrimitiveString;
@@ -321,8 +322,14 @@ class Generator;
 class Instruction;
 class Interpreter;
 class Operand;
+class Optimizer;
 class RegexTable;
 class Register;
 }
 
+namespace JIT {
+class Compiler;
+class NativeExecutable;
+}
+
 }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/Platform.h>
+#include <AK/QuickSort.h>
 #include <AK/Random.h>
 #include <AK/Vector.h>
 #include <LibJS/Heap/BlockAllocator.h>
@@ -25,6 +26,7 @@ namespace JS {
 
 BlockAllocator::~BlockAllocator()
 {
+    m_blocks.extend(move(m_blocks_pending_decommit));
     for (auto* block : m_blocks) {
         ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
         if (munmap(block, HeapBlock::block_size) < 0) {
@@ -36,10 +38,13 @@ BlockAllocator::~BlockAllocator()
 
 void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 {
-    if (!m_blocks.is_empty()) {
+    // NOTE: Prefer blocks that haven't been decommitted yet, as we don't have to fault their pages back in.
+    auto& cached_blocks = m_blocks_pending_decommit.is_empty() ? m_blocks : m_blocks_pending_decommit;
+
+    if (!cached_blocks.is_empty()) {
         // To reduce predictability, take a random block from the cache.
-        size_t random_index = get_random_uniform(m_blocks.size());
-        auto* block = m_blocks.unstable_take(random_index);
+        size_t random_index = get_random_uniform(cached_blocks.size());
+        auto* block = cached_blocks.unstable_take(random_index);
         ASAN_UNPOISON_MEMORY_REGION(block, HeapBlock::block_size);
         LSAN_REGISTER_ROOT_REGION(block, HeapBlock::block_size);
 #ifdef AK_OS_SERENITY
@@ -65,31 +70,63 @@ void BlockAllocator::deallocate_block(void* block)
 {
     VERIFY(block);
 
+    ASAN_POISON_MEMORY_REGION(block, HeapBlock::block_size);
+    LSAN_UNREGISTER_ROOT_REGION(block, HeapBlock::block_size);
+    m_blocks_pending_decommit.append(block);
+}
+
+void BlockAllocator::decommit_deallocated_blocks()
+{
+    if (m_blocks_pending_decommit.is_empty())
+        return;
+
 #if defined(USE_FALLBACK_BLOCK_DEALLOCATION)
     // If we can't use any of the nicer techniques, unmap and remap the block to return the physical pages while keeping the VM.
-    if (munmap(block, HeapBlock::block_size) < 0) {
-        perror("munmap");
-        VERIFY_NOT_REACHED();
-    }
-    if (mmap(block, HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0) != block) {
-        perror("mmap");
-        VERIFY_NOT_REACHED();
-    }
-#elif defined(MADV_FREE)
-    if (madvise(block, HeapBlock::block_size, MADV_FREE) < 0) {
-        perror("madvise(MADV_FREE)");
-        VERIFY_NOT_REACHED();
+    // NOTE: We don't coalesce adjacent blocks here, since each block has to stay its own mapping.
+    for (auto* block : m_blocks_pending_decommit) {
+        if (munmap(block, HeapBlock::block_size) < 0) {
+            perror("munmap");
+            VERIFY_NOT_REACHED();
+        }
+        if (mmap(block, HeapBlock::block_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0) != block) {
+            perror("mmap");
+            VERIFY_NOT_REACHED();
+        }
     }
-#elif defined(MADV_DONTNEED)
-    if (madvise(block, HeapBlock::block_size, MADV_DONTNEED) < 0) {
-        perror("madvise(MADV_DONTNEED)");
-        VERIFY_NOT_REACHED();
+#else
+    // Sort the blocks by address so that runs of adjacent blocks can be decommitted with a single madvise() call.
+    quick_sort(m_blocks_pending_decommit);
+
+    auto decommit_range = [](void* base, size_t size) {
+#    if defined(MADV_FREE)
+        if (madvise(base, size, MADV_FREE) < 0) {
+            perror("madvise(MADV_FREE)");
+            VERIFY_NOT_REACHED();
+        }
+#    elif defined(MADV_DONTNEED)
+        if (madvise(base, size, MADV_DONTNEED) < 0) {
+            perror("madvise(MADV_DONTNEED)");
+            VERIFY_NOT_REACHED();
+        }
+#    endif
+    };
+
+    auto* run_start = static_cast<u8*>(m_blocks_pending_decommit.first());
+    size_t run_size = HeapBlock::block_size;
+    for (size_t i = 1; i < m_blocks_pending_decommit.size(); ++i) {
+        auto* block = static_cast<u8*>(m_blocks_pending_decommit[i]);
+        if (block == run_start + run_size) {
+            run_size += HeapBlock::block_size;
+            continue;
+        }
+        decommit_range(run_start, run_size);
+        run_start = block;
+        run_size = HeapBlock::block_size;
     }
+    decommit_range(run_start, run_size);
 #endif
 
-    ASAN_POISON_MEMORY_REGION(block, HeapBlock::block_size);
-    LSAN_UNREGISTER_ROOT_REGION(block, HeapBlock::block_size);
-    m_blocks.append(block);
+    m_blocks.extend(move(m_blocks_pending_decommit));
 }
 
 }
@@ -19,8 +19,14 @@ public:
     void* allocate_block(char const* name);
     void deallocate_block(void*);
 
+    // Returns the physical memory of all deallocated blocks to the system in one batch.
+    void decommit_deallocated_blocks();
+
 private:
     Vector<void*> m_blocks;
+
+    // Deallocated blocks that still have their physical memory, and can be reused without faulting it back in.
+    Vector<void*> m_blocks_pending_decommit;
 };
 
 }
@@ -27,15 +27,24 @@ namespace JS {
 #    define IGNORE_GC
 #endif
 
-#define JS_CELL(class_, base_class)                \
-public:                                            \
-    using Base = base_class;                       \
-    virtual StringView class_name() const override \
-    {                                              \
-        return #class_##sv;                        \
-    }                                              \
+#define JS_CELL(class_, base_class)                       \
+public:                                                   \
+    using Base = base_class;                              \
+    virtual StringView class_name() const override        \
+    {                                                     \
+        return #class_##sv;                               \
+    }                                                     \
+    virtual bool has_write_barrier() const override       \
+    {                                                     \
+        return JS::CellTypeHasWriteBarrier<class_>;       \
+    }                                                     \
     friend class JS::Heap;
 
+// Cell types that call Cell::write_barrier() after every store of a GC pointer into themselves opt in by specializing this.
+// NOTE: This is checked for the exact type of a cell, since subclasses usually have members of their own.
+template<typename T>
+inline constexpr bool CellTypeHasWriteBarrier = false;
+
 class Cell : public Weakable<Cell> {
     AK_MAKE_NONCOPYABLE(Cell);
     AK_MAKE_NONMOVABLE(Cell);
@@ -47,16 +56,40 @@ public:
     bool is_marked() const { return m_mark; }
     void set_marked(bool b) { m_mark = b; }
 
-    enum class State : bool {
+    enum class State : u8 {
         Live,
         Dead,
+        // Found dead by the last garbage collection, but not swept yet.
+        Dying,
     };
 
     State state() const { return m_state; }
     void set_state(State state) { m_state = state; }
 
+    // NOTE: Weak pointers are revoked as soon as a cell is found dead, since it may be swept much later.
+    void set_dying(Badge<Heap>)
+    {
+        m_state = State::Dying;
+        revoke_weak_ptrs();
+    }
+
     virtual StringView class_name() const = 0;
 
+    // Old cells that may point to young cells are remembered by the Heap, so that a young generation
+    // collection only has to visit the edges of those instead of the edges of every old cell.
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(Badge<Heap>, bool remembered) { m_remembered = remembered; }
+    static size_t remembered_offset() { return __builtin_offsetof(Cell, m_remembered); }
+
+    virtual bool has_write_barrier() const { return false; }
+
+    ALWAYS_INLINE void write_barrier()
+    {
+        if (m_remembered || HeapBlockBase::from_cell(this)->is_nursery())
+            return;
+        remember();
+    }
+
     class Visitor {
     public:
         void visit(Cell* cell)
@@ -177,9 +210,12 @@ protected:
     void set_overrides_must_survive_garbage_collection(bool b) { m_overrides_must_survive_garbage_collection = b; }
 
 private:
+    void remember();
+
     bool m_mark : 1 { false };
     bool m_overrides_must_survive_garbage_collection : 1 { false };
-    State m_state : 1 { State::Live };
+    State m_state : 2 { State::Live };
+    bool m_remembered { false };
 };
 
 }
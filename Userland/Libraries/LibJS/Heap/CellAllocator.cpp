@@ -5,6 +5,7 @@
  */
 
 #include <AK/Badge.h>
+#include <AK/Debug.h>
 #include <LibJS/Heap/BlockAllocator.h>
 #include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Heap.h>
@@ -23,6 +24,10 @@ Cell* CellAllocator::allocate_cell(Heap& heap)
     if (!m_list_node.is_in_list())
         heap.register_cell_allocator({}, *this);
 
+    // NOTE: Sweeping one of our own blocks is cheaper than asking for a new one.
+    if (m_usable_blocks.is_empty() && !m_blocks_pending_sweep.is_empty())
+        sweep_next_pending_block();
+
     if (m_usable_blocks.is_empty()) {
         auto block = HeapBlock::create_with_cell_size(heap, *this, m_cell_size, m_class_name);
         auto block_ptr = reinterpret_cast<FlatPtr>(block.ptr());
@@ -41,7 +46,34 @@ Cell* CellAllocator::allocate_cell(Heap& heap)
     return cell;
 }
 
-void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
+void CellAllocator::block_has_dying_cells(Badge<Heap>, HeapBlock& block)
+{
+    m_blocks_pending_sweep.append(&block);
+}
+
+void CellAllocator::sweep_next_pending_block()
+{
+    auto& block = *m_blocks_pending_sweep.take_last();
+    bool block_was_full = block.is_full();
+    bool block_has_live_cells = false;
+
+    block.for_each_cell([&](Cell* cell) {
+        if (cell->state() == Cell::State::Dying)
+            block.deallocate(cell);
+        else if (cell->state() == Cell::State::Live)
+            block_has_live_cells = true;
+    });
+
+    if (!block_has_live_cells) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", &block, block.cell_size());
+        block_did_become_empty(block);
+    } else if (block_was_full) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", &block, block.cell_size());
+        block_did_become_usable(block);
+    }
+}
+
+void CellAllocator::block_did_become_empty(HeapBlock& block)
 {
     block.m_list_node.remove();
     // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
@@ -49,10 +81,18 @@ void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
     m_block_allocator.deallocate_block(&block);
 }
 
-void CellAllocator::block_did_become_usable(Badge<Heap>, HeapBlock& block)
+void CellAllocator::block_did_become_usable(HeapBlock& block)
 {
     VERIFY(!block.is_full());
+    // NOTE: We only allocate from nursery blocks, so an old block that has free cells again rejoins the nursery.
+    block.set_nursery({}, true);
     m_usable_blocks.append(block);
 }
 
+void CellAllocator::promote_block(Badge<Heap>, HeapBlock& block)
+{
+    VERIFY(block.is_full());
+    block.set_nursery({}, false);
+}
+
 }
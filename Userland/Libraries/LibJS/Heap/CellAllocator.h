@@ -9,6 +9,7 @@
 #include <AK/IntrusiveList.h>
 #include <AK/NeverDestroyed.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Heap/BlockAllocator.h>
 #include <LibJS/Heap/HeapBlock.h>
@@ -44,8 +45,11 @@ public:
         return IterationDecision::Continue;
     }
 
-    void block_did_become_empty(Badge<Heap>, HeapBlock&);
-    void block_did_become_usable(Badge<Heap>, HeapBlock&);
+    void block_has_dying_cells(Badge<Heap>, HeapBlock&);
+    void promote_block(Badge<Heap>, HeapBlock&);
+
+    bool has_blocks_pending_sweep() const { return !m_blocks_pending_sweep.is_empty(); }
+    void sweep_pending_block(Badge<Heap>) { sweep_next_pending_block(); }
 
     IntrusiveListNode<CellAllocator> m_list_node;
     using List = IntrusiveList<&CellAllocator::m_list_node>;
@@ -55,6 +59,10 @@ public:
     FlatPtr max_block_address() const { return m_max_block_address; }
 
 private:
+    void sweep_next_pending_block();
+    void block_did_become_empty(HeapBlock&);
+    void block_did_become_usable(HeapBlock&);
+
     char const* const m_class_name { nullptr };
     size_t const m_cell_size;
 
@@ -63,6 +71,7 @@ private:
     using BlockList = IntrusiveList<&HeapBlock::m_list_node>;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
+    Vector<HeapBlock*> m_blocks_pending_sweep;
     FlatPtr m_min_block_address { explode_byte(0xff) };
     FlatPtr m_max_block_address { 0 };
 };
@@ -69,12 +69,24 @@ Heap::~Heap()
 
 void Heap::will_allocate(size_t size)
 {
+    // NOTE: With generational collection, the nursery is kept small, and the full collection threshold is
+    //       applied to the number of bytes promoted out of it instead.
+    auto gc_bytes_threshold = m_generational_collection_enabled ? GC_MIN_BYTES_THRESHOLD : m_gc_bytes_threshold;
+
     if (should_collect_on_every_allocation()) {
         m_allocated_bytes_since_last_gc = 0;
         collect_garbage();
-    } else if (m_allocated_bytes_since_last_gc + size > m_gc_bytes_threshold) {
+    } else if (m_allocated_bytes_since_last_gc + size > gc_bytes_threshold) {
         m_allocated_bytes_since_last_gc = 0;
-        collect_garbage();
+        collect_garbage(next_automatic_collection_type());
+    } else if (m_has_blocks_pending_sweep) {
+        // NOTE: Sweep the blocks left behind by the last collection in small slices, paced by allocation,
+        //       so dying cells don't pile up until the next collection has to destroy them all at once.
+        m_allocated_bytes_since_last_sweep_slice += size;
+        if (m_allocated_bytes_since_last_sweep_slice > INCREMENTAL_SWEEP_BYTES_PER_SLICE) {
+            m_allocated_bytes_since_last_sweep_slice = 0;
+            sweep_pending_blocks(INCREMENTAL_SWEEP_SLICE_BUDGET);
+        }
     }
 
     m_allocated_bytes_since_last_gc += size;
@@ -260,6 +272,15 @@ AK::JsonObject Heap::dump_graph()
     return visitor.dump();
 }
 
+Heap::CollectionType Heap::next_automatic_collection_type() const
+{
+    if (!m_generational_collection_enabled)
+        return CollectionType::CollectGarbage;
+    if (m_bytes_promoted_since_last_full_collection > m_gc_bytes_threshold)
+        return CollectionType::CollectGarbage;
+    return CollectionType::CollectYoungGeneration;
+}
+
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 {
     VERIFY(!m_collecting_garbage);
@@ -270,21 +291,27 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     perf_event(PERF_EVENT_SIGNPOST, gc_perf_string_id, global_gc_counter++);
 #endif
 
-    Core::ElapsedTimer collection_measurement_timer;
-    if (print_report)
-        collection_measurement_timer.start();
+    auto collection_measurement_timer = Core::ElapsedTimer::start_new(Core::TimerType::Precise);
+
+    // NOTE: Cells left dying by the previous collection must be gone before we start marking.
+    finish_sweeping();
 
-    if (collection_type == CollectionType::CollectGarbage) {
+    if (collection_type != CollectionType::CollectEverything) {
         if (m_gc_deferrals) {
+            // NOTE: If both kinds of collection were requested while deferred, the full one wins.
+            if (!m_should_gc_when_deferral_ends || collection_type == CollectionType::CollectGarbage)
+                m_collection_type_when_deferral_ends = collection_type;
             m_should_gc_when_deferral_ends = true;
             return;
         }
         HashMap<Cell*, HeapRoot> roots;
         gather_roots(roots);
-        mark_live_cells(roots);
+        mark_live_cells(roots, collection_type);
     }
-    finalize_unmarked_cells();
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    if (collection_type != CollectionType::CollectYoungGeneration)
+        forget_remembered_cells();
+    finalize_unmarked_cells(collection_type);
+    sweep_dead_cells(collection_type, print_report, collection_measurement_timer);
 }
 
 void Heap::gather_roots(HashMap<Cell*, HeapRoot>& roots)
@@ -390,8 +417,9 @@ NO_SANITIZE_ADDRESS void Heap::gather_conservative_roots(HashMap<Cell*, HeapRoot
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    explicit MarkingVisitor(Heap& heap, HashMap<Cell*, HeapRoot> const& roots)
+    explicit MarkingVisitor(Heap& heap, HashMap<Cell*, HeapRoot> const& roots, Heap::CollectionType collection_type)
         : m_heap(heap)
+        , m_collecting_young_generation(collection_type == Heap::CollectionType::CollectYoungGeneration)
     {
         m_heap.find_min_and_max_block_addresses(m_min_block_address, m_max_block_address);
         m_heap.for_each_block([&](auto& block) {
@@ -402,10 +430,16 @@ public:
         for (auto* root : roots.keys()) {
             visit(root);
         }
+
+        if (m_collecting_young_generation)
+            m_heap.visit_remembered_cells(*this);
     }
 
     virtual void visit_impl(Cell& cell) override
     {
+        if (!should_mark(cell))
+            return;
+        ++m_markable_edge_count;
         if (cell.is_marked())
             return;
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
@@ -423,10 +457,13 @@ public:
             add_possible_value(possible_pointers, raw_pointer_sized_values[i], HeapRoot { .type = HeapRoot::Type::HeapFunctionCapturedPointer }, m_min_block_address, m_max_block_address);
 
         for_each_cell_among_possible_pointers(m_all_live_heap_blocks, possible_pointers, [&](Cell* cell, FlatPtr) {
-            if (cell->is_marked())
-                return;
             if (cell->state() != Cell::State::Live)
                 return;
+            if (!should_mark(*cell))
+                return;
+            ++m_markable_edge_count;
+            if (cell->is_marked())
+                return;
             cell->set_marked(true);
             m_work_queue.append(*cell);
         });
@@ -439,26 +476,93 @@ public:
         }
     }
 
+    // Returns whether the old cell points to any young cells.
+    bool visit_edges_of_old_cell(Cell& cell)
+    {
+        auto markable_edge_count = m_markable_edge_count;
+        cell.visit_edges(*this);
+        return m_markable_edge_count != markable_edge_count;
+    }
+
 private:
+    // NOTE: When only collecting the young generation, cells in old blocks are neither marked nor swept.
+    bool should_mark(Cell const& cell) const
+    {
+        return !m_collecting_young_generation || HeapBlock::from_cell(&cell)->is_nursery();
+    }
+
     Heap& m_heap;
+    bool m_collecting_young_generation { false };
+    size_t m_markable_edge_count { 0 };
     Vector<NonnullGCPtr<Cell>> m_work_queue;
     HashTable<HeapBlock*> m_all_live_heap_blocks;
     FlatPtr m_min_block_address;
     FlatPtr m_max_block_address;
 };
 
-void Heap::mark_live_cells(HashMap<Cell*, HeapRoot> const& roots)
+// A young generation collection has to treat old cells that may point to young cells as roots. Old cells are
+// visited once here, but never traced through.
+void Heap::visit_remembered_cells(MarkingVisitor& visitor)
+{
+    Vector<NonnullGCPtr<Cell>> still_remembered_cells;
+    still_remembered_cells.ensure_capacity(m_remembered_cells.size());
+
+    for (size_t i = 0; i < m_remembered_cells.size(); ++i) {
+        auto& cell = *m_remembered_cells[i];
+        // NOTE: Incremental sweeping may have returned the cell's block to the nursery since it was remembered.
+        if (HeapBlock::from_cell(&cell)->is_nursery()) {
+            cell.set_remembered({}, false);
+            continue;
+        }
+        bool has_young_edges = visitor.visit_edges_of_old_cell(cell);
+        // NOTE: A store may happen after its write barrier (e.g. through Object::indexed_properties()), and a collection
+        //       may happen in between, so cells remembered since the last collection are kept until the next one.
+        bool was_remembered_since_last_collection = i >= m_remembered_cells_checked_by_last_collection;
+        if (has_young_edges || was_remembered_since_last_collection || !cell.has_write_barrier())
+            still_remembered_cells.unchecked_append(cell);
+        else
+            cell.set_remembered({}, false);
+    }
+
+    // Cells without a write barrier can be given pointers to young cells through any kind of store (GCPtr, Value,
+    // Vector, ...), so they are remembered for as long as they are old.
+    if (!m_remembered_set_is_complete) {
+        for_each_block([&](auto& block) {
+            if (block.is_nursery())
+                return IterationDecision::Continue;
+            block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+                if (cell->is_remembered())
+                    return;
+                if (visitor.visit_edges_of_old_cell(*cell) || !cell->has_write_barrier()) {
+                    cell->set_remembered({}, true);
+                    still_remembered_cells.append(*cell);
+                }
+            });
+            return IterationDecision::Continue;
+        });
+        m_remembered_set_is_complete = true;
+    }
+
+    m_remembered_cells = move(still_remembered_cells);
+    m_remembered_cells_checked_by_last_collection = m_remembered_cells.size();
+}
+
+void Heap::mark_live_cells(HashMap<Cell*, HeapRoot> const& roots, CollectionType collection_type)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
 
-    MarkingVisitor visitor(*this, roots);
+    MarkingVisitor visitor(*this, roots, collection_type);
 
     visitor.mark_all_live_cells();
 
-    for (auto& inverse_root : m_uprooted_cells)
-        inverse_root->set_marked(false);
-
-    m_uprooted_cells.clear();
+    // NOTE: Uprooted cells in the old generation are not swept by a young generation collection,
+    //       so we hold on to them until the next full collection.
+    m_uprooted_cells.remove_all_matching([&](auto& uprooted_cell) {
+        if (collection_type == CollectionType::CollectYoungGeneration && !HeapBlock::from_cell(uprooted_cell.ptr())->is_nursery())
+            return false;
+        uprooted_cell->set_marked(false);
+        return true;
+    });
 }
 
 bool Heap::cell_must_survive_garbage_collection(Cell const& cell)
@@ -468,9 +572,9 @@ bool Heap::cell_must_survive_garbage_collection(Cell const& cell)
     return cell.must_survive_garbage_collection();
 }
 
-void Heap::finalize_unmarked_cells()
+void Heap::finalize_unmarked_cells(CollectionType collection_type)
 {
-    for_each_block([&](auto& block) {
+    for_each_block_to_collect(collection_type, [&](auto& block) {
         block.template for_each_cell_in_state<Cell::State::Live>([](Cell* cell) {
             if (!cell->is_marked() && !cell_must_survive_garbage_collection(*cell))
                 cell->finalize();
@@ -479,24 +583,25 @@ void Heap::finalize_unmarked_cells()
     });
 }
 
-void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measurement_timer)
+void Heap::sweep_dead_cells(CollectionType collection_type, bool print_report, Core::ElapsedTimer const& measurement_timer)
 {
     dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
-    Vector<HeapBlock*, 32> empty_blocks;
-    Vector<HeapBlock*, 32> full_blocks_that_became_usable;
 
     size_t collected_cells = 0;
     size_t live_cells = 0;
     size_t collected_cell_bytes = 0;
     size_t live_cell_bytes = 0;
+    size_t empty_blocks = 0;
+    size_t promoted_blocks = 0;
 
-    for_each_block([&](auto& block) {
+    for_each_block_to_collect(collection_type, [&](auto& block) {
         bool block_has_live_cells = false;
-        bool block_was_full = block.is_full();
+        bool block_has_dying_cells = false;
         block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
             if (!cell->is_marked() && !cell_must_survive_garbage_collection(*cell)) {
                 dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
-                block.deallocate(cell);
+                cell->set_dying({});
+                block_has_dying_cells = true;
                 ++collected_cells;
                 collected_cell_bytes += block.cell_size();
             } else {
@@ -506,37 +611,56 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
                 live_cell_bytes += block.cell_size();
             }
         });
+        if (block_has_dying_cells) {
+            block.cell_allocator().block_has_dying_cells({}, block);
+        } else if (block.is_nursery() && block.is_full()) {
+            block.cell_allocator().promote_block({}, block);
+            ++promoted_blocks;
+            // NOTE: After a full collection, the next young generation collection looks at all old cells anyway.
+            if (collection_type == CollectionType::CollectYoungGeneration) {
+                block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+                    remember_cell(*cell);
+                });
+            }
+        }
         if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
+            ++empty_blocks;
         return IterationDecision::Continue;
     });
 
     for (auto& weak_container : m_weak_containers)
         weak_container.remove_dead_cells({});
 
-    for (auto* block : empty_blocks) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", block, block->cell_size());
-        block->cell_allocator().block_did_become_empty({}, *block);
-    }
-
-    for (auto* block : full_blocks_that_became_usable) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", block, block->cell_size());
-        block->cell_allocator().block_did_become_usable({}, *block);
+    // NOTE: Unless sweeping incrementally, we destroy the dying cells right away.
+    //       We always do so when collecting everything, since the heap is going away.
+    if (!m_incremental_sweeping_enabled || collection_type == CollectionType::CollectEverything) {
+        finish_sweeping();
+    } else {
+        m_has_blocks_pending_sweep = true;
+        m_allocated_bytes_since_last_sweep_slice = 0;
     }
 
     if constexpr (HEAP_DEBUG) {
         for_each_block([&](auto& block) {
-            dbgln(" > Live HeapBlock @ {}: cell_size={}", &block, block.cell_size());
+            dbgln(" > Live HeapBlock @ {}: cell_size={}, nursery={}", &block, block.cell_size(), block.is_nursery());
             return IterationDecision::Continue;
         });
     }
 
-    m_gc_bytes_threshold = live_cell_bytes > GC_MIN_BYTES_THRESHOLD ? live_cell_bytes : GC_MIN_BYTES_THRESHOLD;
+    if (collection_type == CollectionType::CollectYoungGeneration) {
+        m_bytes_promoted_since_last_full_collection += promoted_blocks * HeapBlock::block_size;
+    } else {
+        m_bytes_promoted_since_last_full_collection = 0;
+        m_gc_bytes_threshold = live_cell_bytes > GC_MIN_BYTES_THRESHOLD ? live_cell_bytes : GC_MIN_BYTES_THRESHOLD;
+    }
+
+    Duration const time_spent = measurement_timer.elapsed_time();
+    auto& statistics = collection_type == CollectionType::CollectYoungGeneration ? m_young_generation_collection_statistics : m_full_collection_statistics;
+    ++statistics.collection_count;
+    statistics.total_pause_time += time_spent;
+    statistics.longest_pause_time = max(statistics.longest_pause_time, time_spent);
 
     if (print_report) {
-        Duration const time_spent = measurement_timer.elapsed_time();
         size_t live_block_count = 0;
         for_each_block([&](auto&) {
             ++live_block_count;
@@ -545,15 +669,62 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
 
         dbgln("Garbage collection report");
         dbgln("=============================================");
+        dbgln("Collection type: {}", collection_type == CollectionType::CollectYoungGeneration ? "Young generation"sv : "Full"sv);
         dbgln("     Time spent: {} ms", time_spent.to_milliseconds());
         dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
         dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
-        dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln("   Empty blocks: {} ({} bytes)", empty_blocks, empty_blocks * HeapBlock::block_size);
+        dbgln("Promoted blocks: {} ({} bytes)", promoted_blocks, promoted_blocks * HeapBlock::block_size);
+        dbgln("Remembered cells: {}", m_remembered_cells.size());
+        dbgln("=============================================");
+        dbgln(" Young pauses: {} (total {} ms, longest {} ms)", m_young_generation_collection_statistics.collection_count, m_young_generation_collection_statistics.total_pause_time.to_milliseconds(), m_young_generation_collection_statistics.longest_pause_time.to_milliseconds());
+        dbgln("  Full pauses: {} (total {} ms, longest {} ms)", m_full_collection_statistics.collection_count, m_full_collection_statistics.total_pause_time.to_milliseconds(), m_full_collection_statistics.longest_pause_time.to_milliseconds());
         dbgln("=============================================");
     }
 }
 
+void Heap::finish_sweeping()
+{
+    for (auto& allocator : m_all_cell_allocators) {
+        while (allocator.has_blocks_pending_sweep())
+            allocator.sweep_pending_block({});
+    }
+    m_has_blocks_pending_sweep = false;
+    decommit_empty_blocks();
+}
+
+void Heap::decommit_empty_blocks()
+{
+    for (auto& allocator : m_all_cell_allocators)
+        allocator.block_allocator().decommit_deallocated_blocks();
+}
+
+bool Heap::sweep_pending_blocks(Duration time_budget)
+{
+    auto timer = Core::ElapsedTimer::start_new(Core::TimerType::Precise);
+    bool has_more_work = false;
+
+    for (auto& allocator : m_all_cell_allocators) {
+        while (allocator.has_blocks_pending_sweep()) {
+            if (timer.elapsed_time() >= time_budget) {
+                has_more_work = true;
+                break;
+            }
+            allocator.sweep_pending_block({});
+        }
+        if (has_more_work)
+            break;
+    }
+
+    if (!has_more_work)
+        decommit_empty_blocks();
+
+    m_longest_sweep_slice = max(m_longest_sweep_slice, timer.elapsed_time());
+    m_has_blocks_pending_sweep = has_more_work;
+    return has_more_work;
+}
+
 void Heap::defer_gc()
 {
     ++m_gc_deferrals;
@@ -566,7 +737,7 @@ void Heap::undefer_gc()
 
     if (!m_gc_deferrals) {
         if (m_should_gc_when_deferral_ends)
-            collect_garbage();
+            collect_garbage(m_collection_type_when_deferral_ends);
         m_should_gc_when_deferral_ends = false;
     }
 }
@@ -576,6 +747,22 @@ void Heap::uproot_cell(Cell* cell)
     m_uprooted_cells.append(cell);
 }
 
+void Heap::remember_cell(Cell& cell)
+{
+    VERIFY(!cell.is_remembered());
+    cell.set_remembered({}, true);
+    m_remembered_cells.append(cell);
+}
+
+void Heap::forget_remembered_cells()
+{
+    for (auto& cell : m_remembered_cells)
+        cell->set_remembered({}, false);
+    m_remembered_cells.clear();
+    m_remembered_cells_checked_by_last_collection = 0;
+    m_remembered_set_is_complete = false;
+}
+
 void register_safe_function_closure(void* base, size_t size, SourceLocation* location)
 {
     if (!s_custom_ranges_for_conservative_scan) {
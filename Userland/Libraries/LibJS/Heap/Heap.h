@@ -11,6 +11,8 @@
 #include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
+#include <AK/TypeCasts.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -28,6 +30,8 @@
 
 namespace JS {
 
+class MarkingVisitor;
+
 class Heap : public HeapBase {
     AK_MAKE_NONCOPYABLE(Heap);
     AK_MAKE_NONMOVABLE(Heap);
@@ -60,6 +64,7 @@ public:
 
     enum class CollectionType {
         CollectGarbage,
+        CollectYoungGeneration,
         CollectEverything,
     };
 
@@ -69,6 +74,49 @@ public:
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
     void set_should_collect_on_every_allocation(bool b) { m_should_collect_on_every_allocation = b; }
 
+    // When enabled, collections triggered by allocation only collect the young generation (the nursery blocks),
+    // until enough cells have been promoted to the old generation to warrant a full collection.
+    bool is_generational_collection_enabled() const { return m_generational_collection_enabled; }
+    void set_generational_collection_enabled(bool b) { m_generational_collection_enabled = b; }
+
+    // When enabled, cells found dead are only destroyed lazily: either when their CellAllocator needs a block,
+    // or by sweep_pending_blocks(), which allocation calls in short slices. Weak pointers to them are revoked right away.
+    // NOTE: This means destructors may run long after the collection, which not all cell types are prepared for.
+    // NOTE: Sweeping always stays on the main thread, since destructors touch main-thread-only state. Even Object's do:
+    //       the intrinsic accessor map, and the FlyString table through the names of private elements.
+    bool is_incremental_sweeping_enabled() const { return m_incremental_sweeping_enabled; }
+    void set_incremental_sweeping_enabled(bool b) { m_incremental_sweeping_enabled = b; }
+
+    // Sweeps blocks left behind by the last collection until the time budget is used up.
+    // Returns true if there is still sweeping left to do.
+    bool sweep_pending_blocks(Duration time_budget);
+    void finish_sweeping();
+
+    // Calls the callback for every live cell of type T. Pending sweeping is finished first, so cells found dead by the
+    // last collection aren't visited.
+    template<typename T, typename Callback>
+    void for_each_live_cell_of_type(Callback callback)
+    {
+        finish_sweeping();
+        for_each_block([&](auto& block) {
+            block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+                if (is<T>(*cell))
+                    callback(static_cast<T&>(*cell));
+            });
+            return IterationDecision::Continue;
+        });
+    }
+
+    struct CollectionStatistics {
+        size_t collection_count { 0 };
+        Duration total_pause_time;
+        Duration longest_pause_time;
+    };
+
+    CollectionStatistics const& young_generation_collection_statistics() const { return m_young_generation_collection_statistics; }
+    CollectionStatistics const& full_collection_statistics() const { return m_full_collection_statistics; }
+    Duration longest_sweep_slice() const { return m_longest_sweep_slice; }
+
     void did_create_handle(Badge<HandleImpl>, HandleImpl&);
     void did_destroy_handle(Badge<HandleImpl>, HandleImpl&);
 
@@ -88,6 +136,9 @@ public:
 
     void uproot_cell(Cell* cell);
 
+    void remember_cell(Badge<Cell>, Cell& cell) { remember_cell(cell); }
+    size_t remembered_cell_count() const { return m_remembered_cells.size(); }
+
 private:
     friend class MarkingVisitor;
     friend class GraphConstructorVisitor;
@@ -116,9 +167,16 @@ private:
     void gather_roots(HashMap<Cell*, HeapRoot>&);
     void gather_conservative_roots(HashMap<Cell*, HeapRoot>&);
     void gather_asan_fake_stack_roots(HashMap<FlatPtr, HeapRoot>&, FlatPtr, FlatPtr min_block_address, FlatPtr max_block_address);
-    void mark_live_cells(HashMap<Cell*, HeapRoot> const& live_cells);
-    void finalize_unmarked_cells();
-    void sweep_dead_cells(bool print_report, Core::ElapsedTimer const&);
+    void mark_live_cells(HashMap<Cell*, HeapRoot> const& live_cells, CollectionType);
+    void finalize_unmarked_cells(CollectionType);
+    void sweep_dead_cells(CollectionType, bool print_report, Core::ElapsedTimer const&);
+
+    CollectionType next_automatic_collection_type() const;
+    void decommit_empty_blocks();
+
+    void remember_cell(Cell&);
+    void forget_remembered_cells();
+    void visit_remembered_cells(MarkingVisitor&);
 
     ALWAYS_INLINE CellAllocator& allocator_for_size(size_t cell_size)
     {
@@ -140,12 +198,44 @@ private:
         }
     }
 
+    template<typename Callback>
+    void for_each_block_to_collect(CollectionType collection_type, Callback callback)
+    {
+        for_each_block([&](auto& block) {
+            if (collection_type == CollectionType::CollectYoungGeneration && !block.is_nursery())
+                return IterationDecision::Continue;
+            return callback(block);
+        });
+    }
+
     static constexpr size_t GC_MIN_BYTES_THRESHOLD { 4 * 1024 * 1024 };
     size_t m_gc_bytes_threshold { GC_MIN_BYTES_THRESHOLD };
     size_t m_allocated_bytes_since_last_gc { 0 };
 
     bool m_should_collect_on_every_allocation { false };
 
+    bool m_generational_collection_enabled { false };
+    size_t m_bytes_promoted_since_last_full_collection { 0 };
+
+    // Old cells a young generation collection has to visit. Cells from the front of the list have been checked for
+    // pointers to young cells by the last collection, the rest were added by write barriers or promotion since then.
+    // NOTE: A full collection forgets every remembered cell, and the next young generation collection looks at all old cells again.
+    Vector<NonnullGCPtr<Cell>> m_remembered_cells;
+    size_t m_remembered_cells_checked_by_last_collection { 0 };
+    bool m_remembered_set_is_complete { true };
+
+    CollectionStatistics m_young_generation_collection_statistics;
+    CollectionStatistics m_full_collection_statistics;
+
+    // Allocating this many bytes while blocks are pending sweep triggers another sweep slice.
+    static constexpr size_t INCREMENTAL_SWEEP_BYTES_PER_SLICE { 256 * 1024 };
+    static constexpr Duration INCREMENTAL_SWEEP_SLICE_BUDGET { Duration::from_microseconds(500) };
+
+    bool m_incremental_sweeping_enabled { false };
+    bool m_has_blocks_pending_sweep { false };
+    size_t m_allocated_bytes_since_last_sweep_slice { 0 };
+    Duration m_longest_sweep_slice;
+
     Vector<NonnullOwnPtr<CellAllocator>> m_size_based_cell_allocators;
     CellAllocator::List m_all_cell_allocators;
 
@@ -158,6 +248,7 @@ private:
 
     size_t m_gc_deferrals { 0 };
     bool m_should_gc_when_deferral_ends { false };
+    CollectionType m_collection_type_when_deferral_ends { CollectionType::CollectYoungGeneration };
 
     bool m_collecting_garbage { false };
 };
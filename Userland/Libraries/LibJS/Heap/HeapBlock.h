@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Platform.h>
 #include <AK/StringView.h>
@@ -32,6 +33,8 @@ public:
     size_t cell_count() const { return (block_size - sizeof(HeapBlock)) / m_cell_size; }
     bool is_full() const { return !has_lazy_freelist() && !m_freelist; }
 
+    void set_nursery(Badge<CellAllocator>, bool is_nursery) { m_is_nursery = is_nursery; }
+
     ALWAYS_INLINE Cell* allocate()
     {
         Cell* allocated_cell = nullptr;
@@ -41,6 +41,11 @@ public:
 
     Heap& heap() { return m_heap; }
 
+    // New cells are only ever allocated in nursery blocks. A block leaves the nursery once a collection
+    // finds it full of survivors, and returns to it when a full collection frees some of its cells.
+    bool is_nursery() const { return m_is_nursery; }
+    static size_t is_nursery_offset() { return __builtin_offsetof(HeapBlockBase, m_is_nursery); }
+
 protected:
     HeapBlockBase(Heap& heap)
         : m_heap(heap)
@@ -48,6 +53,7 @@ protected:
     }
 
     Heap& m_heap;
+    bool m_is_nursery { true };
 };
 
 }
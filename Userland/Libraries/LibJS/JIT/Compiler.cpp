@@ -0,0 +1,757 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BinarySearch.h>
+#include <AK/BitCast.h>
+#include <AK/Debug.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/ValueInlines.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifdef JIT_ARCH_SUPPORTED
+
+namespace JS::JIT {
+
+using Assembler = ::JIT::Assembler;
+
+// Pinned for the whole lifetime of the native code (all of these are callee-saved).
+static constexpr auto REGISTER_ARRAY_BASE = Assembler::Reg::RBX;
+static constexpr auto INTERPRETER = Assembler::Reg::R12;
+static constexpr auto ARGUMENTS_BASE = Assembler::Reg::R14;
+
+static constexpr auto ARG0 = Assembler::Reg::RDI;
+static constexpr auto ARG1 = Assembler::Reg::RSI;
+static constexpr auto ARG2 = Assembler::Reg::RDX;
+static constexpr auto ARG3 = Assembler::Reg::RCX;
+static constexpr auto RET = Assembler::Reg::RAX;
+
+static constexpr auto GPR0 = Assembler::Reg::RAX;
+static constexpr auto GPR1 = Assembler::Reg::RCX;
+// Clobbered by tag checks and boxing.
+static constexpr auto GPR2 = Assembler::Reg::RDX;
+
+template<typename OpType>
+concept HasExecuteImpl = requires(OpType const& instruction, Bytecode::Interpreter& interpreter) {
+    instruction.execute_impl(interpreter);
+};
+
+template<typename OpType>
+static constexpr bool execute_impl_can_throw = !IsSame<decltype(declval<OpType const&>().execute_impl(declval<Bytecode::Interpreter&>())), void>;
+
+static Assembler::Operand operand_slot(Bytecode::Operand operand)
+{
+    return Assembler::Operand::Mem64BaseAndOffset(REGISTER_ARRAY_BASE, operand.index() * sizeof(Value));
+}
+
+void Compiler::load_operand(Assembler::Reg dst, Bytecode::Operand src)
+{
+    m_assembler.mov(Assembler::Operand::Register(dst), operand_slot(src));
+}
+
+void Compiler::store_operand(Bytecode::Operand dst, Assembler::Reg src)
+{
+    m_assembler.mov(operand_slot(dst), Assembler::Operand::Register(src));
+}
+
+void Compiler::jump_if_not_tag(Assembler::Reg value, u64 tag, Assembler::Label& label)
+{
+    VERIFY(value != GPR2);
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Register(value));
+    m_assembler.shift_right(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(TAG_SHIFT));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR2), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(tag), label);
+}
+
+void Compiler::jump_if_tag(Assembler::Reg value, u64 tag, Assembler::Label& label)
+{
+    VERIFY(value != GPR2);
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Register(value));
+    m_assembler.shift_right(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(TAG_SHIFT));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR2), Assembler::Condition::EqualTo, Assembler::Operand::Imm(tag), label);
+}
+
+void Compiler::load_object_pointer(Bytecode::Operand operand, Assembler::Label& not_an_object)
+{
+    load_operand(GPR0, operand);
+    jump_if_not_tag(GPR0, OBJECT_TAG, not_an_object);
+    // NOTE: The top 16 bits of a pointer have to repeat bit 47, see Value::extract_pointer_bits().
+    m_assembler.shift_left(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(64 - TAG_SHIFT));
+    m_assembler.arithmetic_right_shift(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(64 - TAG_SHIFT));
+}
+
+void Compiler::load_cached_own_property_slot(Bytecode::PropertyLookupCache& cache, Assembler::Label& slow_case)
+{
+    using Entry = Bytecode::PropertyLookupCache::Entry;
+    // NOTE: We look through these without going through their accessors.
+    static_assert(sizeof(GCPtr<Shape>) == sizeof(Shape*));
+    static_assert(sizeof(WeakPtr<Shape>) == sizeof(AK::WeakLink*));
+    static_assert(sizeof(Value) == 1 << 3);
+
+    Assembler::Label hit;
+    m_assembler.mov(
+        Assembler::Operand::Register(GPR1),
+        Assembler::Operand::Mem64BaseAndOffset(GPR0, Object::shape_offset()));
+
+    // The slow case keeps filling in entries, so all of them have to be checked every time.
+    // A matching entry is left in ARG0.
+    for (auto& entry : cache.entries) {
+        Assembler::Label next_entry;
+        m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Imm(bit_cast<u64>(&entry)));
+        m_assembler.mov(
+            Assembler::Operand::Register(GPR2),
+            Assembler::Operand::Mem64BaseAndOffset(ARG0, offsetof(Entry, shape)));
+        m_assembler.jump_if(Assembler::Operand::Register(GPR2), Assembler::Condition::EqualTo, Assembler::Operand::Imm(0), next_entry);
+        m_assembler.mov(
+            Assembler::Operand::Register(GPR2),
+            Assembler::Operand::Mem64BaseAndOffset(GPR2, AK::WeakLink::ptr_offset()));
+        m_assembler.jump_if(Assembler::Operand::Register(GPR2), Assembler::Condition::EqualTo, Assembler::Operand::Register(GPR1), hit);
+        next_entry.link(m_assembler);
+    }
+    m_assembler.jump(slow_case);
+
+    hit.link(m_assembler);
+    // Properties that live in a prototype are only valid as long as the prototype chain is, which the slow case checks.
+    m_assembler.mov(
+        Assembler::Operand::Register(GPR2),
+        Assembler::Operand::Mem64BaseAndOffset(ARG0, offsetof(Entry, prototype)));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR2), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(0), slow_case);
+
+    m_assembler.mov32(
+        Assembler::Operand::Register(GPR1),
+        Assembler::Operand::Mem64BaseAndOffset(ARG0, offsetof(Entry, property_offset)));
+    m_assembler.shift_left(Assembler::Operand::Register(GPR1), Assembler::Operand::Imm(3));
+    m_assembler.mov(
+        Assembler::Operand::Register(GPR0),
+        Assembler::Operand::Mem64BaseAndOffset(GPR0, Object::storage_offset() + Vector<Value>::outline_buffer_offset()));
+    m_assembler.add(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+}
+
+void Compiler::jump_if_write_barrier_needed(Assembler::Label& label)
+{
+    // NOTE: This is Cell::write_barrier(), except that the slow case runs the barrier for us.
+    static_assert(sizeof(bool) == 1);
+    Assembler::Label no_barrier_needed;
+    m_assembler.mov8(
+        Assembler::Operand::Register(GPR1),
+        Assembler::Operand::Mem64BaseAndOffset(GPR0, Cell::remembered_offset()));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR1), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(0), no_barrier_needed);
+    m_assembler.mov(Assembler::Operand::Register(GPR1), Assembler::Operand::Register(GPR0));
+    m_assembler.bitwise_and(Assembler::Operand::Register(GPR1), Assembler::Operand::Imm(~(HeapBlockBase::block_size - 1)));
+    m_assembler.mov8(
+        Assembler::Operand::Register(GPR1),
+        Assembler::Operand::Mem64BaseAndOffset(GPR1, HeapBlockBase::is_nursery_offset()));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR1), Assembler::Condition::EqualTo, Assembler::Operand::Imm(0), label);
+    no_barrier_needed.link(m_assembler);
+}
+
+void Compiler::count_cache_hit(Bytecode::PropertyLookupCache& cache)
+{
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(bit_cast<u64>(&cache.hit_count)));
+    m_assembler.add(Assembler::Operand::Mem64BaseAndOffset(GPR2, 0), Assembler::Operand::Imm(1));
+}
+
+void Compiler::box_int32(Assembler::Reg value)
+{
+    // NOTE: 32-bit operations zero the upper half of the destination register, so all we have to do is OR in the tag.
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(SHIFTED_INT32_TAG));
+    m_assembler.bitwise_or(Assembler::Operand::Register(value), Assembler::Operand::Register(GPR2));
+}
+
+template<typename OpType>
+void Compiler::call_slow_path(OpType const& instruction, u64 (*function)(Bytecode::Interpreter&, OpType const&, size_t))
+{
+    m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(INTERPRETER));
+    m_assembler.mov(Assembler::Operand::Register(ARG1), Assembler::Operand::Imm(bit_cast<u64>(&instruction)));
+    m_assembler.mov(Assembler::Operand::Register(ARG2), Assembler::Operand::Imm(m_current_offset));
+    m_assembler.native_call(bit_cast<u64>(function));
+}
+
+void Compiler::jump_to_returned_address_if_nonzero()
+{
+    Assembler::Label fall_through;
+    m_assembler.jump_if(Assembler::Operand::Register(RET), Assembler::Condition::EqualTo, Assembler::Operand::Imm(0), fall_through);
+    m_assembler.jump(Assembler::Operand::Register(RET));
+    fall_through.link(m_assembler);
+}
+
+Assembler::Label& Compiler::label_for(Bytecode::Label const& label)
+{
+    size_t block_index = 0;
+    auto* block_start_offset = binary_search(m_bytecode_executable.basic_block_start_offsets, label.address(), &block_index);
+    VERIFY(block_start_offset);
+    return m_block_labels[block_index];
+}
+
+template<typename OpType>
+u64 Compiler::cxx_execute(Bytecode::Interpreter& interpreter, OpType const& instruction, size_t program_counter)
+{
+    interpreter.m_program_counter.value() = program_counter;
+    if constexpr (execute_impl_can_throw<OpType>) {
+        auto result = instruction.execute_impl(interpreter);
+        if (result.is_error())
+            return unwind(interpreter, program_counter, result.error_value());
+    } else {
+        instruction.execute_impl(interpreter);
+    }
+    return 0;
+}
+
+template<typename OpType>
+u64 Compiler::cxx_jump_comparison(Bytecode::Interpreter& interpreter, OpType const& instruction, size_t program_counter)
+{
+    interpreter.m_program_counter.value() = program_counter;
+    auto result = instruction.compare(interpreter);
+    if (result.is_error())
+        return unwind(interpreter, program_counter, result.error_value());
+    return result.value() ? 1 : 0;
+}
+
+u64 Compiler::cxx_continue_pending_unwind(Bytecode::Interpreter& interpreter, Bytecode::Op::ContinuePendingUnwind const& instruction, size_t program_counter)
+{
+    interpreter.m_program_counter.value() = program_counter;
+    auto const& native_executable = *interpreter.current_executable().native_executable();
+    auto next_program_counter = interpreter.continue_pending_unwind(program_counter, instruction.resume_target());
+    if (!next_program_counter.has_value())
+        return native_executable.exit_address();
+    return native_executable.address_for_block(next_program_counter.value());
+}
+
+u64 Compiler::cxx_schedule_jump(Bytecode::Interpreter& interpreter, Bytecode::Op::ScheduleJump const& instruction, size_t program_counter)
+{
+    interpreter.m_scheduled_jump = instruction.target().address();
+    auto finalizer = interpreter.current_executable().exception_handlers_for_offset(program_counter).value().finalizer_offset;
+    VERIFY(finalizer.has_value());
+    return interpreter.current_executable().native_executable()->address_for_block(finalizer.value());
+}
+
+u64 Compiler::cxx_enter_unwind_context(Bytecode::Interpreter& interpreter)
+{
+    interpreter.enter_unwind_context();
+    return 0;
+}
+
+u64 Compiler::cxx_to_boolean(Value const* value)
+{
+    return value->to_boolean();
+}
+
+u64 Compiler::unwind(Bytecode::Interpreter& interpreter, size_t program_counter, Value exception)
+{
+    auto const& native_executable = *interpreter.current_executable().native_executable();
+    if (interpreter.handle_exception(program_counter, exception) == Bytecode::Interpreter::HandleExceptionResponse::ExitFromExecutable)
+        return native_executable.exit_address();
+    return native_executable.address_for_block(program_counter);
+}
+
+template<typename OpType>
+void Compiler::compile_generic(OpType const& instruction)
+{
+    call_slow_path(instruction, &cxx_execute<OpType>);
+    if constexpr (execute_impl_can_throw<OpType>)
+        jump_to_returned_address_if_nonzero();
+}
+
+template<typename OpType>
+void Compiler::compile_terminator(OpType const& instruction)
+{
+    call_slow_path(instruction, &cxx_execute<OpType>);
+    m_assembler.jump(m_exit_label);
+}
+
+void Compiler::compile_mov(Bytecode::Op::Mov const& instruction)
+{
+    load_operand(GPR0, instruction.src());
+    store_operand(instruction.dst(), GPR0);
+}
+
+void Compiler::compile_get_argument(Bytecode::Op::GetArgument const& instruction)
+{
+    m_assembler.mov(
+        Assembler::Operand::Register(GPR0),
+        Assembler::Operand::Mem64BaseAndOffset(ARGUMENTS_BASE, instruction.index() * sizeof(Value)));
+    store_operand(instruction.dst(), GPR0);
+}
+
+void Compiler::compile_set_argument(Bytecode::Op::SetArgument const& instruction)
+{
+    load_operand(GPR0, instruction.src());
+    m_assembler.mov(
+        Assembler::Operand::Mem64BaseAndOffset(ARGUMENTS_BASE, instruction.index() * sizeof(Value)),
+        Assembler::Operand::Register(GPR0));
+}
+
+void Compiler::compile_end(Bytecode::Op::End const& instruction)
+{
+    load_operand(GPR0, instruction.value());
+    store_operand(Bytecode::Operand(Bytecode::Register::accumulator()), GPR0);
+    m_assembler.jump(m_exit_label);
+}
+
+void Compiler::compile_jump(Bytecode::Op::Jump const& instruction)
+{
+    m_assembler.jump(label_for(instruction.target()));
+}
+
+void Compiler::branch_on_to_boolean(Bytecode::Operand condition, Assembler::Label& true_label, Assembler::Label& false_label)
+{
+    Assembler::Label slow_case;
+
+    // OPTIMIZATION: Most conditions are the result of a comparison, so check for booleans inline.
+    load_operand(GPR0, condition);
+    jump_if_not_tag(GPR0, BOOLEAN_TAG, slow_case);
+    m_assembler.test(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(1));
+    m_assembler.jump_if(Assembler::Condition::NotEqualTo, true_label);
+    m_assembler.jump(false_label);
+
+    slow_case.link(m_assembler);
+    m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(REGISTER_ARRAY_BASE));
+    m_assembler.add(Assembler::Operand::Register(ARG0), Assembler::Operand::Imm(condition.index() * sizeof(Value)));
+    m_assembler.native_call(bit_cast<u64>(&cxx_to_boolean));
+    m_assembler.jump_if(Assembler::Operand::Register(RET), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(0), true_label);
+    m_assembler.jump(false_label);
+}
+
+void Compiler::compile_jump_if(Bytecode::Op::JumpIf const& instruction)
+{
+    branch_on_to_boolean(instruction.condition(), label_for(instruction.true_target()), label_for(instruction.false_target()));
+}
+
+void Compiler::compile_jump_true(Bytecode::Op::JumpTrue const& instruction)
+{
+    Assembler::Label fall_through;
+    branch_on_to_boolean(instruction.condition(), label_for(instruction.target()), fall_through);
+    fall_through.link(m_assembler);
+}
+
+void Compiler::compile_jump_false(Bytecode::Op::JumpFalse const& instruction)
+{
+    Assembler::Label fall_through;
+    branch_on_to_boolean(instruction.condition(), fall_through, label_for(instruction.target()));
+    fall_through.link(m_assembler);
+}
+
+void Compiler::compile_jump_nullish(Bytecode::Op::JumpNullish const& instruction)
+{
+    load_operand(GPR0, instruction.condition());
+    m_assembler.shift_right(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(TAG_SHIFT));
+    m_assembler.bitwise_and(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(IS_NULLISH_EXTRACT_PATTERN));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR0), Assembler::Condition::EqualTo, Assembler::Operand::Imm(IS_NULLISH_PATTERN), label_for(instruction.true_target()));
+    m_assembler.jump(label_for(instruction.false_target()));
+}
+
+void Compiler::compile_jump_undefined(Bytecode::Op::JumpUndefined const& instruction)
+{
+    load_operand(GPR0, instruction.condition());
+    m_assembler.shift_right(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(TAG_SHIFT));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR0), Assembler::Condition::EqualTo, Assembler::Operand::Imm(UNDEFINED_TAG), label_for(instruction.true_target()));
+    m_assembler.jump(label_for(instruction.false_target()));
+}
+
+void Compiler::compile_enter_unwind_context(Bytecode::Op::EnterUnwindContext const& instruction)
+{
+    m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(INTERPRETER));
+    m_assembler.native_call(bit_cast<u64>(&cxx_enter_unwind_context));
+    m_assembler.jump(label_for(instruction.entry_point()));
+}
+
+void Compiler::compile_continue_pending_unwind(Bytecode::Op::ContinuePendingUnwind const& instruction)
+{
+    call_slow_path(instruction, &cxx_continue_pending_unwind);
+    m_assembler.jump(Assembler::Operand::Register(RET));
+}
+
+void Compiler::compile_schedule_jump(Bytecode::Op::ScheduleJump const& instruction)
+{
+    call_slow_path(instruction, &cxx_schedule_jump);
+    m_assembler.jump(Assembler::Operand::Register(RET));
+}
+
+template<typename OpType>
+void Compiler::compile_get_by_id(OpType const& instruction)
+{
+    Assembler::Label slow_case;
+    Assembler::Label end;
+    auto& cache = m_bytecode_executable.property_lookup_caches[instruction.cache_index()];
+
+    // OPTIMIZATION: Own properties of objects with a cached shape are loaded directly, just like the interpreter does.
+    load_object_pointer(instruction.base(), slow_case);
+    if constexpr (IsOneOf<OpType, Bytecode::Op::GetLength, Bytecode::Op::GetLengthWithThis>) {
+        // Arrays keep their length outside of their shape.
+        m_assembler.mov8(
+            Assembler::Operand::Register(GPR1),
+            Assembler::Operand::Mem64BaseAndOffset(GPR0, Object::has_magical_length_property_offset()));
+        m_assembler.jump_if(Assembler::Operand::Register(GPR1), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(0), slow_case);
+    }
+    load_cached_own_property_slot(cache, slow_case);
+    m_assembler.mov(Assembler::Operand::Register(GPR0), Assembler::Operand::Mem64BaseAndOffset(GPR0, 0));
+    // Getters have to be called, so leave them to the slow case.
+    jump_if_tag(GPR0, ACCESSOR_TAG, slow_case);
+    count_cache_hit(cache);
+    store_operand(instruction.dst(), GPR0);
+    m_assembler.jump(end);
+
+    slow_case.link(m_assembler);
+    compile_generic(instruction);
+    end.link(m_assembler);
+}
+
+template<typename OpType>
+void Compiler::compile_put_by_id(OpType const& instruction)
+{
+    // Only plain assignments use the cache, everything else defines properties.
+    if (instruction.kind() != Bytecode::Op::PropertyKind::KeyValue)
+        return compile_generic(instruction);
+
+    Assembler::Label slow_case;
+    Assembler::Label end;
+    auto& cache = m_bytecode_executable.property_lookup_caches[instruction.cache_index()];
+
+    // OPTIMIZATION: Own properties of objects with a cached shape are stored directly, just like the interpreter does.
+    load_object_pointer(instruction.base(), slow_case);
+    jump_if_write_barrier_needed(slow_case);
+    load_cached_own_property_slot(cache, slow_case);
+    load_operand(GPR1, instruction.src());
+    m_assembler.mov(Assembler::Operand::Mem64BaseAndOffset(GPR0, 0), Assembler::Operand::Register(GPR1));
+    count_cache_hit(cache);
+    m_assembler.jump(end);
+
+    slow_case.link(m_assembler);
+    compile_generic(instruction);
+    end.link(m_assembler);
+}
+
+template<typename OpType, typename EmitOperation>
+void Compiler::compile_int32_binary_operation(OpType const& instruction, EmitOperation emit_operation)
+{
+    Assembler::Label slow_case;
+    Assembler::Label end;
+
+    load_operand(GPR0, instruction.lhs());
+    jump_if_not_tag(GPR0, INT32_TAG, slow_case);
+    load_operand(GPR1, instruction.rhs());
+    jump_if_not_tag(GPR1, INT32_TAG, slow_case);
+    // NOTE: The operation leaves its result in GPR0 and may bail out to the slow case (e.g. on overflow),
+    //       which starts over by loading the operands from memory again.
+    emit_operation(slow_case);
+    store_operand(instruction.dst(), GPR0);
+    m_assembler.jump(end);
+
+    slow_case.link(m_assembler);
+    compile_generic(instruction);
+    end.link(m_assembler);
+}
+
+void Compiler::compile_add(Bytecode::Op::Add const& instruction)
+{
+    compile_int32_binary_operation(instruction, [&](Assembler::Label& slow_case) {
+        m_assembler.add32(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1), slow_case);
+        box_int32(GPR0);
+    });
+}
+
+void Compiler::compile_sub(Bytecode::Op::Sub const& instruction)
+{
+    compile_int32_binary_operation(instruction, [&](Assembler::Label& slow_case) {
+        m_assembler.sub32(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1), slow_case);
+        box_int32(GPR0);
+    });
+}
+
+void Compiler::compile_mul(Bytecode::Op::Mul const& instruction)
+{
+    compile_int32_binary_operation(instruction, [&](Assembler::Label& slow_case) {
+        m_assembler.mul32(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1), slow_case);
+        box_int32(GPR0);
+    });
+}
+
+void Compiler::compile_bitwise_and(Bytecode::Op::BitwiseAnd const& instruction)
+{
+    // NOTE: Both operands carry the same tag, so we can operate on the encoded values directly.
+    compile_int32_binary_operation(instruction, [&](Assembler::Label&) {
+        m_assembler.bitwise_and(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+    });
+}
+
+void Compiler::compile_bitwise_or(Bytecode::Op::BitwiseOr const& instruction)
+{
+    compile_int32_binary_operation(instruction, [&](Assembler::Label&) {
+        m_assembler.bitwise_or(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+    });
+}
+
+void Compiler::compile_bitwise_xor(Bytecode::Op::BitwiseXor const& instruction)
+{
+    compile_int32_binary_operation(instruction, [&](Assembler::Label&) {
+        m_assembler.bitwise_xor32(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+        box_int32(GPR0);
+    });
+}
+
+void Compiler::compile_increment(Bytecode::Op::Increment const& instruction)
+{
+    Assembler::Label slow_case;
+    Assembler::Label end;
+
+    load_operand(GPR0, instruction.dst());
+    jump_if_not_tag(GPR0, INT32_TAG, slow_case);
+    m_assembler.inc32(Assembler::Operand::Register(GPR0), slow_case);
+    box_int32(GPR0);
+    store_operand(instruction.dst(), GPR0);
+    m_assembler.jump(end);
+
+    slow_case.link(m_assembler);
+    compile_generic(instruction);
+    end.link(m_assembler);
+}
+
+void Compiler::compile_decrement(Bytecode::Op::Decrement const& instruction)
+{
+    Assembler::Label slow_case;
+    Assembler::Label end;
+
+    load_operand(GPR0, instruction.dst());
+    jump_if_not_tag(GPR0, INT32_TAG, slow_case);
+    m_assembler.dec32(Assembler::Operand::Register(GPR0), slow_case);
+    box_int32(GPR0);
+    store_operand(instruction.dst(), GPR0);
+    m_assembler.jump(end);
+
+    slow_case.link(m_assembler);
+    compile_generic(instruction);
+    end.link(m_assembler);
+}
+
+template<typename OpType>
+void Compiler::compile_int32_comparison(OpType const& instruction, Assembler::Condition condition)
+{
+    Assembler::Label slow_case;
+    Assembler::Label end;
+
+    load_operand(GPR0, instruction.lhs());
+    jump_if_not_tag(GPR0, INT32_TAG, slow_case);
+    load_operand(GPR1, instruction.rhs());
+    jump_if_not_tag(GPR1, INT32_TAG, slow_case);
+    m_assembler.sign_extend_32_to_64_bits(GPR0);
+    m_assembler.sign_extend_32_to_64_bits(GPR1);
+    m_assembler.cmp(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+    // NOTE: These are 64-bit immediate moves, which leave the flags alone.
+    m_assembler.mov(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(Value(false).encoded()));
+    m_assembler.mov(Assembler::Operand::Register(GPR1), Assembler::Operand::Imm(Value(true).encoded()));
+    m_assembler.mov_if(condition, Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+    store_operand(instruction.dst(), GPR0);
+    m_assembler.jump(end);
+
+    slow_case.link(m_assembler);
+    compile_generic(instruction);
+    end.link(m_assembler);
+}
+
+template<typename OpType>
+void Compiler::compile_jump_comparison(OpType const& instruction, Assembler::Condition condition)
+{
+    Assembler::Label slow_case;
+    auto& true_label = label_for(instruction.true_target());
+    auto& false_label = label_for(instruction.false_target());
+
+    load_operand(GPR0, instruction.lhs());
+    jump_if_not_tag(GPR0, INT32_TAG, slow_case);
+    load_operand(GPR1, instruction.rhs());
+    jump_if_not_tag(GPR1, INT32_TAG, slow_case);
+    m_assembler.sign_extend_32_to_64_bits(GPR0);
+    m_assembler.sign_extend_32_to_64_bits(GPR1);
+    m_assembler.jump_if(Assembler::Operand::Register(GPR0), condition, Assembler::Operand::Register(GPR1), true_label);
+    m_assembler.jump(false_label);
+
+    slow_case.link(m_assembler);
+    call_slow_path(instruction, &cxx_jump_comparison<OpType>);
+    m_assembler.jump_if(Assembler::Operand::Register(RET), Assembler::Condition::EqualTo, Assembler::Operand::Imm(0), false_label);
+    m_assembler.jump_if(Assembler::Operand::Register(RET), Assembler::Condition::EqualTo, Assembler::Operand::Imm(1), true_label);
+    m_assembler.jump(Assembler::Operand::Register(RET));
+}
+
+void Compiler::compile_instruction(Bytecode::Instruction const& instruction)
+{
+    using Bytecode::Instruction;
+    using Condition = Assembler::Condition;
+    namespace Op = Bytecode::Op;
+
+    switch (instruction.type()) {
+    case Instruction::Type::Mov:
+        return compile_mov(static_cast<Op::Mov const&>(instruction));
+    case Instruction::Type::GetArgument:
+        return compile_get_argument(static_cast<Op::GetArgument const&>(instruction));
+    case Instruction::Type::SetArgument:
+        return compile_set_argument(static_cast<Op::SetArgument const&>(instruction));
+    case Instruction::Type::End:
+        return compile_end(static_cast<Op::End const&>(instruction));
+    case Instruction::Type::Jump:
+        return compile_jump(static_cast<Op::Jump const&>(instruction));
+    case Instruction::Type::JumpIf:
+        return compile_jump_if(static_cast<Op::JumpIf const&>(instruction));
+    case Instruction::Type::JumpTrue:
+        return compile_jump_true(static_cast<Op::JumpTrue const&>(instruction));
+    case Instruction::Type::JumpFalse:
+        return compile_jump_false(static_cast<Op::JumpFalse const&>(instruction));
+    case Instruction::Type::JumpNullish:
+        return compile_jump_nullish(static_cast<Op::JumpNullish const&>(instruction));
+    case Instruction::Type::JumpUndefined:
+        return compile_jump_undefined(static_cast<Op::JumpUndefined const&>(instruction));
+    case Instruction::Type::EnterUnwindContext:
+        return compile_enter_unwind_context(static_cast<Op::EnterUnwindContext const&>(instruction));
+    case Instruction::Type::ContinuePendingUnwind:
+        return compile_continue_pending_unwind(static_cast<Op::ContinuePendingUnwind const&>(instruction));
+    case Instruction::Type::ScheduleJump:
+        return compile_schedule_jump(static_cast<Op::ScheduleJump const&>(instruction));
+    case Instruction::Type::Return:
+        return compile_terminator(static_cast<Op::Return const&>(instruction));
+    case Instruction::Type::Yield:
+        return compile_terminator(static_cast<Op::Yield const&>(instruction));
+    case Instruction::Type::Await:
+        return compile_terminator(static_cast<Op::Await const&>(instruction));
+    case Instruction::Type::GetById:
+        return compile_get_by_id(static_cast<Op::GetById const&>(instruction));
+    case Instruction::Type::GetByIdWithThis:
+        return compile_get_by_id(static_cast<Op::GetByIdWithThis const&>(instruction));
+    case Instruction::Type::GetLength:
+        return compile_get_by_id(static_cast<Op::GetLength const&>(instruction));
+    case Instruction::Type::GetLengthWithThis:
+        return compile_get_by_id(static_cast<Op::GetLengthWithThis const&>(instruction));
+    case Instruction::Type::PutById:
+        return compile_put_by_id(static_cast<Op::PutById const&>(instruction));
+    case Instruction::Type::PutByIdWithThis:
+        return compile_put_by_id(static_cast<Op::PutByIdWithThis const&>(instruction));
+    case Instruction::Type::Add:
+        return compile_add(static_cast<Op::Add const&>(instruction));
+    case Instruction::Type::Sub:
+        return compile_sub(static_cast<Op::Sub const&>(instruction));
+    case Instruction::Type::Mul:
+        return compile_mul(static_cast<Op::Mul const&>(instruction));
+    case Instruction::Type::BitwiseAnd:
+        return compile_bitwise_and(static_cast<Op::BitwiseAnd const&>(instruction));
+    case Instruction::Type::BitwiseOr:
+        return compile_bitwise_or(static_cast<Op::BitwiseOr const&>(instruction));
+    case Instruction::Type::BitwiseXor:
+        return compile_bitwise_xor(static_cast<Op::BitwiseXor const&>(instruction));
+    case Instruction::Type::Increment:
+        return compile_increment(static_cast<Op::Increment const&>(instruction));
+    case Instruction::Type::Decrement:
+        return compile_decrement(static_cast<Op::Decrement const&>(instruction));
+    case Instruction::Type::LessThan:
+        return compile_int32_comparison(static_cast<Op::LessThan const&>(instruction), Condition::SignedLessThan);
+    case Instruction::Type::LessThanEquals:
+        return compile_int32_comparison(static_cast<Op::LessThanEquals const&>(instruction), Condition::SignedLessThanOrEqualTo);
+    case Instruction::Type::GreaterThan:
+        return compile_int32_comparison(static_cast<Op::GreaterThan const&>(instruction), Condition::SignedGreaterThan);
+    case Instruction::Type::GreaterThanEquals:
+        return compile_int32_comparison(static_cast<Op::GreaterThanEquals const&>(instruction), Condition::SignedGreaterThanOrEqualTo);
+    case Instruction::Type::JumpLessThan:
+        return compile_jump_comparison(static_cast<Op::JumpLessThan const&>(instruction), Condition::SignedLessThan);
+    case Instruction::Type::JumpLessThanEquals:
+        return compile_jump_comparison(static_cast<Op::JumpLessThanEquals const&>(instruction), Condition::SignedLessThanOrEqualTo);
+    case Instruction::Type::JumpGreaterThan:
+        return compile_jump_comparison(static_cast<Op::JumpGreaterThan const&>(instruction), Condition::SignedGreaterThan);
+    case Instruction::Type::JumpGreaterThanEquals:
+        return compile_jump_comparison(static_cast<Op::JumpGreaterThanEquals const&>(instruction), Condition::SignedGreaterThanOrEqualTo);
+    case Instruction::Type::JumpLooselyEquals:
+        return compile_jump_comparison(static_cast<Op::JumpLooselyEquals const&>(instruction), Condition::EqualTo);
+    case Instruction::Type::JumpLooselyInequals:
+        return compile_jump_comparison(static_cast<Op::JumpLooselyInequals const&>(instruction), Condition::NotEqualTo);
+    case Instruction::Type::JumpStrictlyEquals:
+        return compile_jump_comparison(static_cast<Op::JumpStrictlyEquals const&>(instruction), Condition::EqualTo);
+    case Instruction::Type::JumpStrictlyInequals:
+        return compile_jump_comparison(static_cast<Op::JumpStrictlyInequals const&>(instruction), Condition::NotEqualTo);
+    default:
+        break;
+    }
+
+    // Everything else calls into the bytecode interpreter's implementation of the instruction.
+    switch (instruction.type()) {
+#define COMPILE_GENERIC(name)                                                  \
+    case Instruction::Type::name:                                              \
+        if constexpr (HasExecuteImpl<Op::name>)                                \
+            return compile_generic(static_cast<Op::name const&>(instruction)); \
+        VERIFY_NOT_REACHED();
+        ENUMERATE_BYTECODE_OPS(COMPILE_GENERIC)
+#undef COMPILE_GENERIC
+    }
+    VERIFY_NOT_REACHED();
+}
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable& bytecode_executable)
+{
+    Compiler compiler { bytecode_executable };
+    auto& assembler = compiler.m_assembler;
+
+    // The native code is entered through a single prologue, which pins the interpreter state into callee-saved
+    // registers and then jumps to the basic block we were asked to start at (see NativeExecutable::run()).
+    assembler.enter();
+    assembler.mov(Assembler::Operand::Register(REGISTER_ARRAY_BASE), Assembler::Operand::Register(ARG0));
+    assembler.mov(Assembler::Operand::Register(INTERPRETER), Assembler::Operand::Register(ARG1));
+    assembler.mov(Assembler::Operand::Register(ARGUMENTS_BASE), Assembler::Operand::Register(ARG2));
+    assembler.jump(Assembler::Operand::Register(ARG3));
+
+    auto exit_offset = compiler.m_output.size();
+    compiler.m_exit_label.link(assembler);
+    assembler.exit();
+
+    auto const& block_start_offsets = bytecode_executable.basic_block_start_offsets;
+    compiler.m_block_labels.resize(block_start_offsets.size());
+    size_t next_block_index = 0;
+
+    for (Bytecode::InstructionStreamIterator it(bytecode_executable.bytecode.span()); !it.at_end(); ++it) {
+        compiler.m_current_offset = it.offset();
+        // NOTE: Empty blocks share their start offset with the block after them.
+        while (next_block_index < block_start_offsets.size() && block_start_offsets[next_block_index] == compiler.m_current_offset)
+            compiler.m_block_labels[next_block_index++].link(assembler);
+        compiler.compile_instruction(*it);
+    }
+
+    // Every block ends in a terminator, so falling off the end of the bytecode would be a bug.
+    while (next_block_index < block_start_offsets.size())
+        compiler.m_block_labels[next_block_index++].link(assembler);
+    assembler.verify_not_reached();
+
+    HashMap<size_t, size_t> block_entry_points;
+    for (size_t i = 0; i < block_start_offsets.size(); ++i)
+        block_entry_points.set(block_start_offsets[i], compiler.m_block_labels[i].offset_of_label_in_instruction_stream.value());
+
+    auto& output = compiler.m_output;
+    auto* executable_memory = mmap(nullptr, output.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (executable_memory == MAP_FAILED) {
+        dbgln("JIT: Failed to allocate executable memory: {}", strerror(errno));
+        return nullptr;
+    }
+    memcpy(executable_memory, output.data(), output.size());
+    if (mprotect(executable_memory, output.size(), PROT_READ | PROT_EXEC) < 0) {
+        dbgln("JIT: Failed to make executable memory executable: {}", strerror(errno));
+        munmap(executable_memory, output.size());
+        return nullptr;
+    }
+
+    dbgln_if(JIT_DEBUG, "JIT: Compiled {} ({} bytes of bytecode) to {} bytes of native code", bytecode_executable.name, bytecode_executable.bytecode.size(), output.size());
+
+    return make<NativeExecutable>(executable_memory, output.size(), move(block_entry_points), exit_offset);
+}
+
+}
+
+#else
+
+namespace JS::JIT {
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable&)
+{
+    return nullptr;
+}
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJIT/Assembler.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/NativeExecutable.h>
+
+namespace JS::JIT {
+
+// A baseline JIT: every bytecode instruction is translated one by one into machine code, with inline fast paths for
+// the common Int32 and boolean cases, and for property accesses that hit their PropertyLookupCache. Everything else
+// calls back into the instruction's execute_impl(), so the native code shares all of its state (registers, unwind
+// contexts, scheduled jumps) with the bytecode interpreter.
+class Compiler {
+public:
+    // Returns nullptr if the current architecture isn't supported, or if we failed to allocate executable memory.
+    static OwnPtr<NativeExecutable> compile(Bytecode::Executable&);
+
+    // How many times an executable has to be entered (or take a backward jump) before we compile it.
+    static constexpr u32 hotness_threshold = 32;
+
+private:
+#ifdef JIT_ARCH_SUPPORTED
+    using Assembler = ::JIT::Assembler;
+
+    explicit Compiler(Bytecode::Executable& bytecode_executable)
+        : m_bytecode_executable(bytecode_executable)
+    {
+    }
+
+    void compile_instruction(Bytecode::Instruction const&);
+
+    void compile_mov(Bytecode::Op::Mov const&);
+    void compile_get_argument(Bytecode::Op::GetArgument const&);
+    void compile_set_argument(Bytecode::Op::SetArgument const&);
+    void compile_end(Bytecode::Op::End const&);
+    void compile_jump(Bytecode::Op::Jump const&);
+    void compile_jump_if(Bytecode::Op::JumpIf const&);
+    void compile_jump_true(Bytecode::Op::JumpTrue const&);
+    void compile_jump_false(Bytecode::Op::JumpFalse const&);
+    void compile_jump_nullish(Bytecode::Op::JumpNullish const&);
+    void compile_jump_undefined(Bytecode::Op::JumpUndefined const&);
+    void compile_enter_unwind_context(Bytecode::Op::EnterUnwindContext const&);
+    void compile_continue_pending_unwind(Bytecode::Op::ContinuePendingUnwind const&);
+    void compile_schedule_jump(Bytecode::Op::ScheduleJump const&);
+
+    void compile_add(Bytecode::Op::Add const&);
+    void compile_sub(Bytecode::Op::Sub const&);
+    void compile_mul(Bytecode::Op::Mul const&);
+    void compile_bitwise_and(Bytecode::Op::BitwiseAnd const&);
+    void compile_bitwise_or(Bytecode::Op::BitwiseOr const&);
+    void compile_bitwise_xor(Bytecode::Op::BitwiseXor const&);
+    void compile_increment(Bytecode::Op::Increment const&);
+    void compile_decrement(Bytecode::Op::Decrement const&);
+
+    template<typename OpType>
+    void compile_get_by_id(OpType const&);
+    template<typename OpType>
+    void compile_put_by_id(OpType const&);
+    template<typename OpType>
+    void compile_int32_comparison(OpType const&, Assembler::Condition);
+    template<typename OpType>
+    void compile_jump_comparison(OpType const&, Assembler::Condition);
+    template<typename OpType, typename EmitOperation>
+    void compile_int32_binary_operation(OpType const&, EmitOperation);
+    template<typename OpType>
+    void compile_generic(OpType const&);
+    template<typename OpType>
+    void compile_terminator(OpType const&);
+
+    void branch_on_to_boolean(Bytecode::Operand condition, Assembler::Label& true_label, Assembler::Label& false_label);
+
+    void load_operand(Assembler::Reg, Bytecode::Operand);
+    void store_operand(Bytecode::Operand, Assembler::Reg);
+    void jump_if_not_tag(Assembler::Reg, u64 tag, Assembler::Label&);
+    void jump_if_tag(Assembler::Reg, u64 tag, Assembler::Label&);
+    void box_int32(Assembler::Reg);
+
+    // Loads the object in the given operand into GPR0, or jumps to the given label if it's not an object.
+    void load_object_pointer(Bytecode::Operand, Assembler::Label& not_an_object);
+    // Turns the object in GPR0 into the address of the property's value, if the cache has an entry for the object's
+    // shape and the property is an own property. Jumps to the slow case otherwise.
+    void load_cached_own_property_slot(Bytecode::PropertyLookupCache&, Assembler::Label& slow_case);
+    void jump_if_write_barrier_needed(Assembler::Label&);
+    void count_cache_hit(Bytecode::PropertyLookupCache&);
+
+    template<typename OpType>
+    void call_slow_path(OpType const&, u64 (*)(Bytecode::Interpreter&, OpType const&, size_t));
+    void jump_to_returned_address_if_nonzero();
+
+    Assembler::Label& label_for(Bytecode::Label const&);
+
+    // Slow paths, called from native code. Unless noted otherwise, they return 0 to continue with the next
+    // instruction, or the native address to jump to (an exception handler, a finalizer, or the exit stub).
+    template<typename OpType>
+    static u64 cxx_execute(Bytecode::Interpreter&, OpType const&, size_t program_counter);
+    // Returns 0 for false and 1 for true, or the native address to jump to if the comparison threw.
+    template<typename OpType>
+    static u64 cxx_jump_comparison(Bytecode::Interpreter&, OpType const&, size_t program_counter);
+    static u64 cxx_continue_pending_unwind(Bytecode::Interpreter&, Bytecode::Op::ContinuePendingUnwind const&, size_t program_counter);
+    static u64 cxx_schedule_jump(Bytecode::Interpreter&, Bytecode::Op::ScheduleJump const&, size_t program_counter);
+    static u64 cxx_enter_unwind_context(Bytecode::Interpreter&);
+    static u64 cxx_to_boolean(Value const*);
+
+    static u64 unwind(Bytecode::Interpreter&, size_t program_counter, Value exception);
+
+    Bytecode::Executable& m_bytecode_executable;
+    Vector<u8> m_output;
+    Assembler m_assembler { m_output };
+    Assembler::Label m_exit_label;
+    Vector<Assembler::Label> m_block_labels;
+    size_t m_current_offset { 0 };
+#endif
+};
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibJIT/GDB.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/JIT/NativeExecutable.h>
+#include <sys/mman.h>
+
+namespace JS::JIT {
+
+NativeExecutable::NativeExecutable(void* code, size_t size, HashMap<size_t, size_t> block_entry_points, size_t exit_offset)
+    : m_code(code)
+    , m_size(size)
+    , m_block_entry_points(move(block_entry_points))
+    , m_exit_offset(exit_offset)
+{
+    if constexpr (JIT_DEBUG) {
+        m_gdb_object = ::JIT::GDB::build_gdb_image(code_bytes(), "LibJS JIT"sv, "NativeExecutable"sv);
+        if (m_gdb_object.has_value())
+            ::JIT::GDB::register_into_gdb(m_gdb_object->span());
+    }
+}
+
+NativeExecutable::~NativeExecutable()
+{
+    if (m_gdb_object.has_value())
+        ::JIT::GDB::unregister_from_gdb(m_gdb_object->span());
+    munmap(m_code, m_size);
+}
+
+bool NativeExecutable::run(Bytecode::Interpreter& interpreter, size_t program_counter) const
+{
+    auto native_offset = m_block_entry_points.get(program_counter);
+    if (!native_offset.has_value())
+        return false;
+
+    // NOTE: This matches the prologue emitted by JIT::Compiler.
+    using EntryPoint = void (*)(Value* registers_and_constants_and_locals, Bytecode::Interpreter*, Value* arguments, FlatPtr native_address);
+    auto entry_point = reinterpret_cast<EntryPoint>(m_code);
+    entry_point(
+        interpreter.m_registers_and_constants_and_locals.data(),
+        &interpreter,
+        interpreter.m_arguments.data(),
+        reinterpret_cast<FlatPtr>(m_code) + native_offset.value());
+    return true;
+}
+
+FlatPtr NativeExecutable::address_for_block(size_t program_counter) const
+{
+    auto native_offset = m_block_entry_points.get(program_counter);
+    VERIFY(native_offset.has_value());
+    return reinterpret_cast<FlatPtr>(m_code) + native_offset.value();
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/FixedArray.h>
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+#include <LibJS/Forward.h>
+
+namespace JS::JIT {
+
+class NativeExecutable {
+    AK_MAKE_NONCOPYABLE(NativeExecutable);
+    AK_MAKE_NONMOVABLE(NativeExecutable);
+
+public:
+    NativeExecutable(void* code, size_t size, HashMap<size_t, size_t> block_entry_points, size_t exit_offset);
+    ~NativeExecutable();
+
+    // Runs the native code starting at the basic block at `program_counter`, until it returns, yields or throws out of
+    // the executable. Returns false without running anything if no basic block starts there.
+    [[nodiscard]] bool run(Bytecode::Interpreter&, size_t program_counter) const;
+
+    // Used by slow paths to tell the native code where to continue after an exception or an unwind.
+    [[nodiscard]] FlatPtr address_for_block(size_t program_counter) const;
+    [[nodiscard]] FlatPtr exit_address() const { return reinterpret_cast<FlatPtr>(m_code) + m_exit_offset; }
+
+    ReadonlyBytes code_bytes() const { return { static_cast<u8 const*>(m_code), m_size }; }
+
+private:
+    void* m_code { nullptr };
+    size_t m_size { 0 };
+    HashMap<size_t, size_t> m_block_entry_points;
+    size_t m_exit_offset { 0 };
+    Optional<FixedArray<u8>> m_gdb_object;
+};
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/ParsedProgramCache.h>
+#include <LibJS/SourceCode.h>
+
+namespace JS {
+
+static size_t source_size_of(Program const& program)
+{
+    return program.source_code().code().bytes().size();
+}
+
+RefPtr<Program> ParsedProgramCache::get(StringView source_text, StringView filename, size_t line_number_offset, Program::Type type)
+{
+    if (m_source_size_budget == 0)
+        return nullptr;
+
+    auto source_hash = source_text.hash();
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        auto& entry = m_entries[i];
+        if (entry.source_hash != source_hash
+            || entry.line_number_offset != line_number_offset
+            || entry.program->type() != type
+            || entry.filename != filename
+            || entry.program->source_code().code().bytes_as_string_view() != source_text)
+            continue;
+
+        auto program = entry.program;
+        if (i != m_entries.size() - 1)
+            m_entries.append(m_entries.take(i));
+        ++m_hit_count;
+        return program;
+    }
+
+    ++m_miss_count;
+    return nullptr;
+}
+
+void ParsedProgramCache::set(StringView source_text, StringView filename, size_t line_number_offset, NonnullRefPtr<Program> program)
+{
+    if (m_source_size_budget == 0 || source_text.length() > m_source_size_budget)
+        return;
+
+    m_source_size += source_size_of(*program);
+    m_entries.append({
+        .source_hash = source_text.hash(),
+        .filename = filename,
+        .line_number_offset = line_number_offset,
+        .program = move(program),
+    });
+    evict_until_within_budget();
+}
+
+void ParsedProgramCache::clear()
+{
+    m_entries.clear();
+    m_source_size = 0;
+}
+
+void ParsedProgramCache::set_source_size_budget(size_t budget)
+{
+    m_source_size_budget = budget;
+    evict_until_within_budget();
+}
+
+void ParsedProgramCache::evict_until_within_budget()
+{
+    while (m_source_size > m_source_size_budget) {
+        auto entry = m_entries.take_first();
+        m_source_size -= source_size_of(*entry.program);
+    }
+}
+
+}
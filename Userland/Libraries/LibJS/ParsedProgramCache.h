@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteString.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/AST.h>
+
+namespace JS {
+
+// Remembers the Programs parsed from recently loaded source texts, so that loading the exact same source again (for
+// example when a page is reloaded) skips the parser entirely. A Program doesn't belong to any realm, so it can be handed
+// to any realm that loads the same source.
+// NOTE: The bytecode generated for a function is kept on its AST node, but only reused by the realm it was generated
+//       for, since its inline caches are only valid there. See Statement::bytecode_executable().
+class ParsedProgramCache {
+    AK_MAKE_NONCOPYABLE(ParsedProgramCache);
+    AK_MAKE_NONMOVABLE(ParsedProgramCache);
+
+public:
+    ParsedProgramCache() = default;
+    ~ParsedProgramCache() = default;
+
+    RefPtr<Program> get(StringView source_text, StringView filename, size_t line_number_offset, Program::Type);
+    void set(StringView source_text, StringView filename, size_t line_number_offset, NonnullRefPtr<Program>);
+    void clear();
+
+    // The total size of the source texts to keep Programs around for. Least recently used Programs are evicted first.
+    // NOTE: This is 0 by default, which disables the cache.
+    size_t source_size_budget() const { return m_source_size_budget; }
+    void set_source_size_budget(size_t);
+
+    size_t hit_count() const { return m_hit_count; }
+    size_t miss_count() const { return m_miss_count; }
+
+private:
+    struct Entry {
+        unsigned source_hash { 0 };
+        ByteString filename;
+        size_t line_number_offset { 0 };
+        NonnullRefPtr<Program> program;
+    };
+
+    void evict_until_within_budget();
+
+    // Ordered from least to most recently used.
+    Vector<Entry> m_entries;
+    size_t m_source_size { 0 };
+    size_t m_source_size_budget { 0 };
+    size_t m_hit_count { 0 };
+    size_t m_miss_count { 0 };
+};
+
+}
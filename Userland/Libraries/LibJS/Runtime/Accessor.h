@@ -13,6 +13,9 @@
 
 namespace JS {
 
+template<>
+inline constexpr bool CellTypeHasWriteBarrier<Accessor> = true;
+
 class Accessor final : public Cell {
     JS_CELL(Accessor, Cell);
     JS_DECLARE_ALLOCATOR(Accessor);
@@ -24,10 +27,18 @@ public:
     }
 
     FunctionObject* getter() const { return m_getter; }
-    void set_getter(FunctionObject* getter) { m_getter = getter; }
+    void set_getter(FunctionObject* getter)
+    {
+        m_getter = getter;
+        write_barrier();
+    }
 
     FunctionObject* setter() const { return m_setter; }
-    void set_setter(FunctionObject* setter) { m_setter = setter; }
+    void set_setter(FunctionObject* setter)
+    {
+        m_setter = setter;
+        write_barrier();
+    }
 
     void visit_edges(Cell::Visitor& visitor) override
     {
@@ -19,6 +19,9 @@
 
 namespace JS {
 
+template<>
+inline constexpr bool CellTypeHasWriteBarrier<Array> = true;
+
 class Array : public Object {
     JS_OBJECT(Array, Object);
     JS_DECLARE_ALLOCATOR(Array);
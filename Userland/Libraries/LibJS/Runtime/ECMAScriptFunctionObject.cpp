@@ -823,14 +823,14 @@ Completion ECMAScriptFunctionObject::ordinary_call_evaluate_body()
     auto& realm = *vm.current_realm();
 
     if (!m_bytecode_executable) {
-        if (!m_ecmascript_code->bytecode_executable()) {
+        if (!m_ecmascript_code->bytecode_executable(realm)) {
             if (is_module_wrapper()) {
-                const_cast<Statement&>(*m_ecmascript_code).set_bytecode_executable(TRY(Bytecode::compile(vm, *m_ecmascript_code, m_kind, m_name)));
+                const_cast<Statement&>(*m_ecmascript_code).set_bytecode_executable(realm, TRY(Bytecode::compile(vm, *m_ecmascript_code, m_kind, m_name)));
             } else {
-                const_cast<Statement&>(*m_ecmascript_code).set_bytecode_executable(TRY(Bytecode::compile(vm, *this)));
+                const_cast<Statement&>(*m_ecmascript_code).set_bytecode_executable(realm, TRY(Bytecode::compile(vm, *this)));
             }
         }
-        m_bytecode_executable = m_ecmascript_code->bytecode_executable();
+        m_bytecode_executable = m_ecmascript_code->bytecode_executable(realm);
     }
 
     vm.running_execution_context().registers_and_constants_and_locals.resize(m_local_variables_names.size() + m_bytecode_executable->number_of_registers + m_bytecode_executable->constants.size());
@@ -28,6 +28,10 @@ namespace JS {
 
 #define JS_OBJECT(class_, base_class) JS_CELL(class_, base_class)
 
+// NOTE: Everything an Object points to is stored through the functions below, which run the write barrier.
+template<>
+inline constexpr bool CellTypeHasWriteBarrier<Object> = true;
+
 struct PrivateElement {
     enum class Kind {
         Field,
@@ -209,15 +213,32 @@ public:
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
-    void put_direct(size_t index, Value value) { m_storage[index] = value; }
+    void put_direct(size_t index, Value value)
+    {
+        m_storage[index] = value;
+        write_barrier();
+    }
 
     IndexedProperties const& indexed_properties() const { return m_indexed_properties; }
-    IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    IndexedProperties& indexed_properties()
+    {
+        write_barrier();
+        return m_indexed_properties;
+    }
+    void set_indexed_property_elements(Vector<Value>&& values)
+    {
+        m_indexed_properties = IndexedProperties(move(values));
+        write_barrier();
+    }
 
     Shape& shape() { return *m_shape; }
     Shape const& shape() const { return *m_shape; }
 
+    // Used by the JIT to access the shape and the properties directly.
+    static size_t shape_offset() { return __builtin_offsetof(Object, m_shape); }
+    static size_t storage_offset() { return __builtin_offsetof(Object, m_storage); }
+    static size_t has_magical_length_property_offset() { return __builtin_offsetof(Object, m_has_magical_length_property); }
+
     void convert_to_prototype_if_needed();
 
     template<typename T>
@@ -254,7 +275,11 @@ protected:
     bool m_is_typed_array { false };
 
 private:
-    void set_shape(Shape& shape) { m_shape = &shape; }
+    void set_shape(Shape& shape)
+    {
+        m_shape = &shape;
+        write_barrier();
+    }
 
     Object* prototype() { return shape().prototype(); }
 
@@ -20,6 +20,10 @@
 
 namespace JS {
 
+// NOTE: The rope halves are only ever set on construction, and cleared once the rope is resolved.
+template<>
+inline constexpr bool CellTypeHasWriteBarrier<PrimitiveString> = true;
+
 class PrimitiveString final : public Cell {
     JS_CELL(PrimitiveString, Cell);
     JS_DECLARE_ALLOCATOR(PrimitiveString);
@@ -15,6 +15,7 @@
 #include <LibFileSystem/FileSystem.h>
 #include <LibJS/AST.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/ParsedProgramCache.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/ArrayBuffer.h>
@@ -67,6 +68,7 @@ VM::VM(OwnPtr<CustomData> custom_data, ErrorMessages error_messages)
     , m_custom_data(move(custom_data))
 {
     m_bytecode_interpreter = make<Bytecode::Interpreter>(*this);
+    m_parsed_program_cache = make<ParsedProgramCache>();
 
     m_empty_string = m_heap.allocate_without_realm<PrimitiveString>(String {});
 
@@ -8,6 +8,7 @@
 #include <AK/Debug.h>
 #include <AK/QuickSort.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/ParsedProgramCache.h>
 #include <LibJS/Parser.h>
 #include <LibJS/Runtime/AsyncFunctionDriverWrapper.h>
 #include <LibJS/Runtime/ECMAScriptFunctionObject.h>
@@ -129,12 +130,18 @@ void SourceTextModule::visit_edges(Cell::Visitor& visitor)
 Result<NonnullGCPtr<SourceTextModule>, Vector<ParserError>> SourceTextModule::parse(StringView source_text, Realm& realm, StringView filename, Script::HostDefined* host_defined)
 {
     // 1. Let body be ParseText(sourceText, Module).
-    auto parser = Parser(Lexer(source_text, filename), Program::Type::Module);
-    auto body = parser.parse_program();
+    auto& parsed_program_cache = realm.vm().parsed_program_cache();
+    auto body = parsed_program_cache.get(source_text, filename, 0, Program::Type::Module);
+    if (!body) {
+        auto parser = Parser(Lexer(source_text, filename), Program::Type::Module);
+        body = parser.parse_program();
 
-    // 2. If body is a List of errors, return body.
-    if (parser.has_errors())
-        return parser.errors();
+        // 2. If body is a List of errors, return body.
+        if (parser.has_errors())
+            return parser.errors();
+
+        parsed_program_cache.set(source_text, filename, 0, *body);
+    }
 
     // 3. Let requestedModules be the ModuleRequests of body.
     auto requested_modules = module_requests(*body);
@@ -251,7 +258,7 @@ Result<NonnullGCPtr<SourceTextModule>, Vector<ParserError>> SourceTextModule::pa
         filename,
         host_defined,
         async,
-        move(body),
+        body.release_nonnull(),
         move(requested_modules),
         move(import_entries),
         move(local_export_entries),
@@ -0,0 +1,83 @@
+// NOTE: These exercise the patterns rewritten by the bytecode optimizer. Run test-js with -O2 to optimize them.
+
+test("copies and constants are propagated into arithmetic", () => {
+    function f(a) {
+        let x = 2;
+        let y = x * 3;
+        return a + y + (1 << 4) + -x;
+    }
+    expect(f(1)).toBe(21);
+    expect(f("a")).toBe("a616-2");
+});
+
+test("copies are not propagated past a write to their source", () => {
+    function f() {
+        let a = 1;
+        return a + (a = 10) + a;
+    }
+    expect(f()).toBe(21);
+});
+
+test("conditional jumps on constants", () => {
+    function f() {
+        if (1 < 2) return "yes";
+        return "no";
+    }
+    expect(f()).toBe("yes");
+
+    let visited = false;
+    while (!true) visited = true;
+    expect(visited).toBeFalse();
+});
+
+test("comparisons fused into jumps", () => {
+    function classify(x) {
+        if (x === undefined) return "undefined";
+        if (x !== undefined && !(x < 0)) return "non-negative";
+        return "negative";
+    }
+    expect(classify(undefined)).toBe("undefined");
+    expect(classify(null)).toBe("non-negative");
+    expect(classify(5)).toBe("non-negative");
+    expect(classify(-5)).toBe("negative");
+
+    let count = 0;
+    for (let i = 0; i < 10; ++i) {
+        if (i == 3 || i >= 8) ++count;
+    }
+    expect(count).toBe(3);
+});
+
+test("values read by exception handlers survive", () => {
+    function f(thrower) {
+        let result = "before";
+        try {
+            result = "during";
+            thrower();
+            result = "after";
+        } catch {
+            return result;
+        }
+        return result;
+    }
+    expect(f(() => {})).toBe("after");
+    expect(
+        f(() => {
+            throw 1;
+        })
+    ).toBe("during");
+
+    function g() {
+        let value = 1;
+        for (let i = 0; i < 3; ++i) {
+            try {
+                if (i === 1) break;
+                value += 10;
+            } finally {
+                value *= 2;
+            }
+        }
+        return value;
+    }
+    expect(g()).toBe(44);
+});
@@ -16,3 +16,64 @@ test("Inline cache invalidated by deleting property from unique shape", () => {
     expect(first).toBe(2);
     expect(second).toBeUndefined();
 });
+
+test("Polymorphic inline cache keeps objects of different shapes apart", () => {
+    function get(o) {
+        return o.x;
+    }
+
+    function put(o, value) {
+        o.x = value;
+    }
+
+    let objects = [
+        { x: 0 },
+        { a: 1, x: 1 },
+        { a: 1, b: 2, x: 2 },
+        { a: 1, b: 2, c: 3, x: 3 },
+        Object.create({ x: 4 }),
+    ];
+
+    for (let i = 0; i < 3; ++i) {
+        for (let j = 0; j < objects.length; ++j) expect(get(objects[j])).toBe(j);
+    }
+
+    for (let j = 0; j < 4; ++j) put(objects[j], j * 10);
+    for (let j = 0; j < 4; ++j) expect(get(objects[j])).toBe(j * 10);
+});
+
+test("Megamorphic inline cache keeps objects of different shapes apart", () => {
+    function get(o) {
+        return o.x;
+    }
+
+    function put(o, value) {
+        o.x = value;
+    }
+
+    let objects = [];
+    for (let i = 0; i < 20; ++i) {
+        let o = {};
+        for (let j = 0; j < i; ++j) o["p" + j] = j;
+        o.x = i;
+        objects.push(o);
+    }
+
+    for (let round = 0; round < 3; ++round) {
+        for (let i = 0; i < objects.length; ++i) {
+            expect(get(objects[i])).toBe(i + round * 100);
+            put(objects[i], i + (round + 1) * 100);
+        }
+    }
+
+    objects.push({
+        get x() {
+            return "getter";
+        },
+    });
+    expect(get(objects[objects.length - 1])).toBe("getter");
+
+    let frozen = Object.freeze({ x: "frozen" });
+    put(frozen, 1);
+    expect(get(frozen)).toBe("frozen");
+});
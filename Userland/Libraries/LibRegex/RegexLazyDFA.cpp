@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <LibRegex/RegexLazyDFA.h>
+
+namespace regex {
+
+static unsigned hash_state(ReadonlySpan<u32> nodes, bool accepting)
+{
+    unsigned hash = accepting;
+    for (auto node : nodes)
+        hash = pair_int_hash(hash, node);
+    return hash;
+}
+
+unsigned LazyDFA::StateTraits::hash(State const* state)
+{
+    return hash_state(state->nodes, state->accepting);
+}
+
+void LazyDFA::StateCache::clear()
+{
+    unique_states.clear();
+    start_states.clear();
+    states.clear();
+    ++flush_count;
+}
+
+RefPtr<LazyDFA> LazyDFA::try_create(ByteCode const& bytecode)
+{
+    auto dfa = adopt_ref(*new LazyDFA);
+    if (!dfa->compile(bytecode))
+        return nullptr;
+    return dfa;
+}
+
+bool LazyDFA::compile(ByteCode const& bytecode)
+{
+    auto bytecode_size = bytecode.size();
+
+    HashMap<size_t, u32> instruction_at_position;
+    Vector<size_t> worklist;
+    MatchState state;
+
+    auto instruction_for = [&](size_t position) -> u32 {
+        // Everything past the end of the bytecode is an implicit Exit.
+        position = min(position, bytecode_size);
+        if (auto index = instruction_at_position.get(position); index.has_value())
+            return *index;
+
+        auto index = static_cast<u32>(m_instructions.size());
+        m_instructions.append({ .kind = Instruction::Kind::Accept, .position = position, .successors = {} });
+        instruction_at_position.set(position, index);
+        worklist.append(position);
+        return index;
+    };
+
+    instruction_for(0);
+
+    while (!worklist.is_empty()) {
+        auto position = worklist.take_last();
+        auto index = instruction_at_position.get(position).value();
+        if (position >= bytecode_size)
+            continue;
+
+        state.instruction_position = position;
+        auto& opcode = bytecode.get_opcode(state);
+        auto next_position = position + opcode.size();
+
+        Instruction instruction { .kind = Instruction::Kind::Epsilon, .position = position, .successors = {} };
+
+        auto jump_target = [&](ssize_t offset) -> Optional<u32> {
+            auto target = static_cast<ssize_t>(next_position) + offset;
+            if (target < 0)
+                return {};
+            return instruction_for(static_cast<size_t>(target));
+        };
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Exit:
+            instruction.kind = Instruction::Kind::Accept;
+            break;
+        case OpCodeId::Checkpoint:
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+            instruction.successors.append(instruction_for(next_position));
+            break;
+        case OpCodeId::Jump: {
+            auto target = jump_target(static_cast<OpCode_Jump const&>(opcode).offset());
+            if (!target.has_value())
+                return false;
+            instruction.successors.append(*target);
+            break;
+        }
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+        case OpCodeId::JumpNonEmpty: {
+            // Both sides of a fork are taken; JumpNonEmpty is treated as a fork, as whether the loop body matched
+            // something depends on the path taken through it.
+            ssize_t offset;
+            if (opcode.opcode_id() == OpCodeId::JumpNonEmpty)
+                offset = static_cast<OpCode_JumpNonEmpty const&>(opcode).offset();
+            else if (opcode.opcode_id() == OpCodeId::ForkJump || opcode.opcode_id() == OpCodeId::ForkReplaceJump)
+                offset = static_cast<OpCode_ForkJump const&>(opcode).offset();
+            else
+                offset = static_cast<OpCode_ForkStay const&>(opcode).offset();
+
+            auto next = instruction_for(next_position);
+            auto target = jump_target(offset);
+            if (!target.has_value())
+                return false;
+            instruction.successors.append(next);
+            instruction.successors.append(*target);
+            break;
+        }
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            if (m_assertion_positions.size() == max_assertions)
+                return false;
+            instruction.kind = Instruction::Kind::Assertion;
+            instruction.node_or_assertion = m_assertion_positions.size();
+            m_assertion_positions.append(position);
+            instruction.successors.append(instruction_for(next_position));
+            break;
+        case OpCodeId::Compare: {
+            auto& compare = static_cast<OpCode_Compare const&>(opcode);
+            auto argument_count = compare.arguments_count();
+
+            Optional<size_t> string_offset;
+            size_t offset = position + 3;
+            for (size_t i = 0; i < argument_count; ++i) {
+                auto compare_type = static_cast<CharacterCompareType>(bytecode.at(offset++));
+                switch (compare_type) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                case CharacterCompareType::And:
+                case CharacterCompareType::Or:
+                case CharacterCompareType::EndAndOr:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                case CharacterCompareType::Property:
+                case CharacterCompareType::GeneralCategory:
+                case CharacterCompareType::Script:
+                case CharacterCompareType::ScriptExtension:
+                    ++offset;
+                    break;
+                case CharacterCompareType::LookupTable:
+                    offset += bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::String:
+                    // A string is split into a node per character, which only works if it is alone in the compare
+                    // and every character is a single code unit.
+                    if (argument_count != 1)
+                        return false;
+                    string_offset = offset;
+                    offset += bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::Reference:
+                default:
+                    return false;
+                }
+            }
+
+            if (!string_offset.has_value()) {
+                instruction.kind = Instruction::Kind::Consume;
+                instruction.node_or_assertion = m_nodes.size();
+                m_nodes.append({ .instruction = index, .literal = {}, .next_in_string = {} });
+                instruction.successors.append(instruction_for(next_position));
+                break;
+            }
+
+            auto length = bytecode.at(*string_offset);
+            for (size_t i = 0; i < length; ++i) {
+                if (bytecode.at(*string_offset + 1 + i) >= 0x80)
+                    return false;
+            }
+
+            instruction.successors.append(instruction_for(next_position));
+            if (length == 0)
+                break;
+
+            m_has_string_compares = true;
+            instruction.kind = Instruction::Kind::Consume;
+            instruction.node_or_assertion = m_nodes.size();
+            for (size_t i = 0; i < length; ++i) {
+                Optional<u32> next_in_string;
+                if (i + 1 < length)
+                    next_in_string = static_cast<u32>(m_nodes.size() + 1);
+                m_nodes.append({ .instruction = index, .literal = static_cast<u32>(bytecode.at(*string_offset + 1 + i)), .next_in_string = next_in_string });
+            }
+            break;
+        }
+        default:
+            // FailForks, Save, Restore and GoBack implement lookaround; Repeat and ResetRepeat count.
+            return false;
+        }
+
+        m_instructions[index] = move(instruction);
+    }
+
+    return true;
+}
+
+bool LazyDFA::can_run_on(MatchInput const& input) const
+{
+    // Nodes consume exactly one code unit, so positions must be counted in code units.
+    if (input.view.unicode() || input.view.is_u8_view())
+        return false;
+
+    // String nodes compare code units verbatim.
+    if (m_has_string_compares && input.regex_options.has_flag_set(AllFlags::Insensitive))
+        return false;
+
+    return true;
+}
+
+void LazyDFA::prepare_for(Cache& cache, MatchInput const& input) const
+{
+    cache.instruction_marks.resize(m_instructions.size());
+    cache.node_marks.resize(m_nodes.size());
+
+    // Compares and assertions depend on the options, so states built under other options can't be reused.
+    auto options = input.regex_options.value();
+    if (cache.options == options)
+        return;
+
+    cache.anchored.clear();
+    cache.unanchored.clear();
+    cache.options = options;
+}
+
+u32 LazyDFA::context_at(Cache& cache, ByteCode const& bytecode, MatchInput const& input, size_t position) const
+{
+    u32 context = 0;
+    for (size_t i = 0; i < m_assertion_positions.size(); ++i) {
+        cache.scratch_state.instruction_position = m_assertion_positions[i];
+        cache.scratch_state.string_position = position;
+        cache.scratch_state.string_position_in_code_units = position;
+
+        auto& opcode = bytecode.get_opcode(cache.scratch_state);
+        if (opcode.execute(input, cache.scratch_state) == ExecutionResult::Continue)
+            context |= 1u << i;
+    }
+    return context;
+}
+
+bool LazyDFA::node_matches(Cache& cache, ByteCode const& bytecode, MatchInput const& input, Node const& node, size_t position) const
+{
+    if (node.literal.has_value())
+        return input.view.code_unit_at(position) == *node.literal;
+
+    cache.scratch_state.instruction_position = m_instructions[node.instruction].position;
+    cache.scratch_state.string_position = position;
+    cache.scratch_state.string_position_in_code_units = position;
+
+    auto& opcode = bytecode.get_opcode(cache.scratch_state);
+    auto result = opcode.execute(input, cache.scratch_state);
+    return result == ExecutionResult::Continue && cache.scratch_state.string_position == position + 1;
+}
+
+void LazyDFA::begin_closure(Cache& cache)
+{
+    if (++cache.current_mark != 0)
+        return;
+
+    // The marks wrapped around, so a stale mark could be mistaken for a current one.
+    for (auto& mark : cache.instruction_marks)
+        mark = 0;
+    for (auto& mark : cache.node_marks)
+        mark = 0;
+    cache.current_mark = 1;
+}
+
+void LazyDFA::add_node(Cache& cache, u32 node, Vector<u32>& nodes)
+{
+    if (cache.node_marks[node] == cache.current_mark)
+        return;
+    cache.node_marks[node] = cache.current_mark;
+    nodes.append(node);
+}
+
+void LazyDFA::add_closure(Cache& cache, u32 instruction_index, u32 context, Vector<u32>& nodes, bool& accepting) const
+{
+    Vector<u32, 16> stack;
+    stack.append(instruction_index);
+
+    while (!stack.is_empty()) {
+        auto index = stack.take_last();
+        if (cache.instruction_marks[index] == cache.current_mark)
+            continue;
+        cache.instruction_marks[index] = cache.current_mark;
+
+        auto const& instruction = m_instructions[index];
+        switch (instruction.kind) {
+        case Instruction::Kind::Consume:
+            add_node(cache, instruction.node_or_assertion, nodes);
+            break;
+        case Instruction::Kind::Epsilon:
+            for (auto successor : instruction.successors)
+                stack.append(successor);
+            break;
+        case Instruction::Kind::Assertion:
+            if (context & (1u << instruction.node_or_assertion))
+                stack.append(instruction.successors[0]);
+            break;
+        case Instruction::Kind::Accept:
+            accepting = true;
+            break;
+        }
+    }
+}
+
+LazyDFA::State* LazyDFA::intern(StateCache& cache, Vector<u32>&& nodes, bool accepting)
+{
+    auto hash = hash_state(nodes, accepting);
+    auto it = cache.unique_states.find(hash, [&](State* state) {
+        return state->accepting == accepting && state->nodes == nodes;
+    });
+    if (it != cache.unique_states.end())
+        return *it;
+
+    if (cache.states.size() >= max_cached_states)
+        cache.clear();
+
+    auto state = make<State>();
+    state->nodes = move(nodes);
+    state->accepting = accepting;
+
+    auto* state_ptr = state.ptr();
+    cache.states.append(move(state));
+    cache.unique_states.set(state_ptr);
+    return state_ptr;
+}
+
+LazyDFA::State* LazyDFA::start_state(Cache& cache, bool unanchored, ByteCode const& bytecode, MatchInput const& input, size_t position) const
+{
+    auto& state_cache = unanchored ? cache.unanchored : cache.anchored;
+    auto context = context_at(cache, bytecode, input, position);
+    if (auto state = state_cache.start_states.get(context); state.has_value())
+        return *state;
+
+    Vector<u32> nodes;
+    bool accepting = false;
+    begin_closure(cache);
+    add_closure(cache, 0, context, nodes, accepting);
+    quick_sort(nodes);
+
+    auto* state = intern(state_cache, move(nodes), accepting);
+    state_cache.start_states.set(context, state);
+    return state;
+}
+
+LazyDFA::State* LazyDFA::step(Cache& cache, bool unanchored, State* from, ByteCode const& bytecode, MatchInput const& input, size_t position) const
+{
+    auto& state_cache = unanchored ? cache.unanchored : cache.anchored;
+    TransitionKey key {
+        .code_point = input.view[position],
+        .code_unit = input.view.code_unit_at(position),
+        .context = context_at(cache, bytecode, input, position + 1),
+    };
+
+    auto is_ascii = key.code_point == key.code_unit && key.code_point < from->ascii_transitions.size() && key.context == 0;
+    if (is_ascii) {
+        if (auto* to = from->ascii_transitions[key.code_point])
+            return to;
+    } else if (auto to = from->transitions.get(key); to.has_value()) {
+        return *to;
+    }
+
+    Vector<u32> nodes;
+    bool accepting = false;
+    begin_closure(cache);
+    for (auto node_index : from->nodes) {
+        auto const& node = m_nodes[node_index];
+        if (!node_matches(cache, bytecode, input, node, position))
+            continue;
+        if (node.next_in_string.has_value())
+            add_node(cache, *node.next_in_string, nodes);
+        else
+            add_closure(cache, m_instructions[node.instruction].successors[0], key.context, nodes, accepting);
+    }
+    // Searching for a match is the same as allowing a new one to start at every position.
+    if (unanchored)
+        add_closure(cache, 0, key.context, nodes, accepting);
+    quick_sort(nodes);
+
+    auto flush_count = state_cache.flush_count;
+    auto* to = intern(state_cache, move(nodes), accepting);
+
+    // If the cache was flushed, `from` is gone along with it.
+    if (state_cache.flush_count != flush_count)
+        return to;
+
+    if (is_ascii)
+        from->ascii_transitions[key.code_point] = to;
+    else
+        from->transitions.set(key, to);
+    return to;
+}
+
+Optional<size_t> LazyDFA::find_earliest_match_end(Cache& cache, ByteCode const& bytecode, MatchInput const& input, size_t start) const
+{
+    prepare_for(cache, input);
+
+    auto length = input.view.length();
+    auto* state = start_state(cache, true, bytecode, input, start);
+    for (auto position = start;; ++position) {
+        if (state->accepting)
+            return position;
+        if (position >= length)
+            return {};
+        state = step(cache, true, state, bytecode, input, position);
+    }
+}
+
+bool LazyDFA::may_match_at(Cache& cache, ByteCode const& bytecode, MatchInput const& input, size_t position) const
+{
+    prepare_for(cache, input);
+
+    auto length = input.view.length();
+    auto* state = start_state(cache, false, bytecode, input, position);
+    for (;; ++position) {
+        if (state->accepting)
+            return true;
+        if (state->nodes.is_empty() || position >= length)
+            return false;
+        state = step(cache, false, state, bytecode, input, position);
+    }
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+#include "RegexOptions.h"
+
+#include <AK/Array.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// A DFA over the bytecode of a pattern, built one state at a time while scanning the input.
+//
+// The bytecode is read as an NFA: every Compare is a node that consumes a single code unit, forks and jumps are
+// epsilon edges, and capture groups and checkpoints are ignored. Since this accepts a superset of what the
+// backtracking VM accepts, the DFA can only prove that there is *no* match; the Matcher uses it to skip the start
+// positions (or the entire rest of the input) where running the VM would be pointless, and still runs the VM
+// wherever a match may start, so the match positions and capture groups are exactly what they were before.
+//
+// Scanning takes linear time no matter how the pattern is written. The states are cached across matches, and
+// thrown away whenever there would be more than max_cached_states of them.
+//
+// The LazyDFA itself is never modified once it's compiled, so it can be shared by every copy of a parse result.
+// The states built while scanning live in a Cache instead, which each Matcher keeps for itself.
+class LazyDFA : public RefCounted<LazyDFA> {
+public:
+    static constexpr size_t max_cached_states = 1024;
+    static constexpr size_t max_assertions = 8;
+
+    class Cache;
+
+    // Returns nullptr if the pattern uses anything a finite automaton can't express: backreferences, lookaround
+    // and counted repetition.
+    static RefPtr<LazyDFA> try_create(ByteCode const&);
+
+    bool can_run_on(MatchInput const&) const;
+
+    // Returns the first position at or after `start` at which a match could end, or nothing if no match can start
+    // at or after `start`.
+    Optional<size_t> find_earliest_match_end(Cache&, ByteCode const&, MatchInput const&, size_t start) const;
+
+    // Returns false if no match can start at `position`.
+    bool may_match_at(Cache&, ByteCode const&, MatchInput const&, size_t position) const;
+
+private:
+    struct Instruction {
+        enum class Kind : u8 {
+            Consume,
+            Epsilon,
+            Assertion,
+            Accept,
+        };
+
+        Kind kind;
+        size_t position;
+        Vector<u32, 2> successors;
+        u32 node_or_assertion { 0 };
+    };
+
+    // A position in the pattern that consumes one code unit. Each character of a String compare gets a node of its own.
+    struct Node {
+        u32 instruction;
+        Optional<u32> literal;
+        Optional<u32> next_in_string;
+    };
+
+    struct TransitionKey {
+        u32 code_point;
+        u32 code_unit;
+        u32 context;
+
+        bool operator==(TransitionKey const&) const = default;
+    };
+
+    struct TransitionKeyTraits : public DefaultTraits<TransitionKey> {
+        static unsigned hash(TransitionKey const& key) { return pair_int_hash(pair_int_hash(key.code_point, key.code_unit), key.context); }
+    };
+
+    // The nodes that want to consume the code unit at some position, and whether a match may end at that position.
+    struct State {
+        Vector<u32> nodes;
+        bool accepting { false };
+
+        Array<State*, 128> ascii_transitions {};
+        HashMap<TransitionKey, State*, TransitionKeyTraits> transitions;
+    };
+
+    struct StateTraits : public DefaultTraits<State*> {
+        static unsigned hash(State const* state);
+        static bool equals(State const* a, State const* b) { return a->accepting == b->accepting && a->nodes == b->nodes; }
+    };
+
+    struct StateCache {
+        Vector<NonnullOwnPtr<State>> states;
+        HashTable<State*, StateTraits> unique_states;
+        HashMap<u32, State*> start_states;
+        size_t flush_count { 0 };
+
+        void clear();
+    };
+
+    LazyDFA() = default;
+
+    bool compile(ByteCode const&);
+
+    void prepare_for(Cache&, MatchInput const&) const;
+    u32 context_at(Cache&, ByteCode const&, MatchInput const&, size_t position) const;
+    bool node_matches(Cache&, ByteCode const&, MatchInput const&, Node const&, size_t position) const;
+
+    static void begin_closure(Cache&);
+    void add_closure(Cache&, u32 instruction, u32 context, Vector<u32>& nodes, bool& accepting) const;
+    static void add_node(Cache&, u32 node, Vector<u32>& nodes);
+
+    static State* intern(StateCache&, Vector<u32>&& nodes, bool accepting);
+    State* start_state(Cache&, bool unanchored, ByteCode const&, MatchInput const&, size_t position) const;
+    State* step(Cache&, bool unanchored, State*, ByteCode const&, MatchInput const&, size_t position) const;
+
+    Vector<Instruction> m_instructions;
+    Vector<Node> m_nodes;
+    Vector<size_t> m_assertion_positions;
+    bool m_has_string_compares { false };
+};
+
+class LazyDFA::Cache {
+private:
+    friend class LazyDFA;
+
+    StateCache anchored;
+    StateCache unanchored;
+    Optional<AllFlags> options;
+    MatchState scratch_state;
+
+    Vector<u32> instruction_marks;
+    Vector<u32> node_marks;
+    u32 current_mark { 0 };
+};
+
+}
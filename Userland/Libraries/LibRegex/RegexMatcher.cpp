@@ -7,6 +7,7 @@
 #include <AK/BumpAllocator.h>
 #include <AK/ByteString.h>
 #include <AK/Debug.h>
+#include <AK/MemMem.h>
 #include <AK/StringBuilder.h>
 #include <LibRegex/RegexMatcher.h>
 #include <LibRegex/RegexParser.h>
@@ -114,6 +115,49 @@ RegexResult Matcher<Parser>::match(RegexStringView view, Optional<typename Parse
     return match(views, regex_options);
 }
 
+// Both of these count in code units, so they can only be used if positions in the view do too.
+static Optional<size_t> find_literal(RegexStringView const& view, StringView literal, size_t start)
+{
+    if (view.is_string_view()) {
+        auto haystack = view.string_view().substring_view(start);
+        auto offset = AK::memmem_optional(haystack.characters_without_null_termination(), haystack.length(), literal.characters_without_null_termination(), literal.length());
+        if (!offset.has_value())
+            return {};
+        return start + *offset;
+    }
+
+    auto length = view.length();
+    for (auto position = start; position + literal.length() <= length; ++position) {
+        size_t i = 0;
+        while (i < literal.length() && view.code_unit_at(position + i) == static_cast<u8>(literal[i]))
+            ++i;
+        if (i == literal.length())
+            return position;
+    }
+    return {};
+}
+
+static Optional<size_t> find_leading_character(RegexStringView const& view, Array<bool, 128> const& characters, size_t start)
+{
+    if (view.is_string_view()) {
+        auto haystack = view.string_view();
+        for (auto position = start; position < haystack.length(); ++position) {
+            auto ch = static_cast<u8>(haystack[position]);
+            if (ch < 0x80 && characters[ch])
+                return position;
+        }
+        return {};
+    }
+
+    auto length = view.length();
+    for (auto position = start; position < length; ++position) {
+        auto ch = view.code_unit_at(position);
+        if (ch < 0x80 && characters[ch])
+            return position;
+    }
+    return {};
+}
+
 template<typename Parser>
 RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
 {
@@ -200,6 +244,37 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         state.string_position_in_code_units = view_index;
         bool succeeded = false;
 
+        auto const& optimization_data = m_pattern->parser_result.optimization_data;
+
+        auto* lazy_dfa = optimization_data.lazy_dfa.ptr();
+        if (lazy_dfa && !lazy_dfa->can_run_on(input))
+            lazy_dfa = nullptr;
+        if (lazy_dfa && !m_lazy_dfa_cache)
+            m_lazy_dfa_cache = make<LazyDFA::Cache>();
+        Optional<size_t> earliest_possible_match_end;
+
+        auto can_use_prefilter = !input.view.unicode() && !input.view.is_u8_view();
+        auto can_use_literals = can_use_prefilter && !input.regex_options.has_flag_set(AllFlags::Insensitive);
+        Optional<size_t> required_literal_position;
+
+        // Returns the first position at or after `start` where a match could start, judging only by the literals
+        // the pattern is made of.
+        auto find_match_candidate = [&](size_t start) -> Optional<size_t> {
+            if (can_use_literals && optimization_data.required_literal.has_value()) {
+                // A match that starts after the literal we found needs another one.
+                if (!required_literal_position.has_value() || *required_literal_position < start) {
+                    required_literal_position = find_literal(input.view, *optimization_data.required_literal, start);
+                    if (!required_literal_position.has_value())
+                        return {};
+                }
+            }
+            if (can_use_literals && optimization_data.literal_prefix.has_value())
+                return find_literal(input.view, *optimization_data.literal_prefix, start);
+            if (can_use_prefilter && optimization_data.leading_characters.has_value())
+                return find_leading_character(input.view, *optimization_data.leading_characters, start);
+            return start;
+        };
+
         if (view_index == view_length && m_pattern->parser_result.match_length_minimum == 0) {
             // Run the code until it tries to consume something.
             // This allows non-consuming code to run on empty strings, for instance
@@ -232,6 +307,11 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         }
 
         for (; view_index <= view_length; ++view_index) {
+            auto candidate = find_match_candidate(view_index);
+            if (!candidate.has_value() || (!continue_search && *candidate != view_index))
+                break;
+            view_index = *candidate;
+
             if (view_index == view_length && input.regex_options.has_flag_set(AllFlags::Multiline))
                 break;
 
@@ -245,6 +325,21 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             if (match_length_minimum && match_length_minimum > view_length - view_index)
                 break;
 
+            // Let the DFA rule out the positions where no match can start, so the VM only runs where it might succeed.
+            if (lazy_dfa) {
+                auto const& bytecode = m_pattern->parser_result.bytecode;
+                if (continue_search && (!earliest_possible_match_end.has_value() || view_index > *earliest_possible_match_end)) {
+                    earliest_possible_match_end = lazy_dfa->find_earliest_match_end(*m_lazy_dfa_cache, bytecode, input, view_index);
+                    if (!earliest_possible_match_end.has_value())
+                        break;
+                }
+                if (!lazy_dfa->may_match_at(*m_lazy_dfa_cache, bytecode, input, view_index)) {
+                    if (!continue_search)
+                        break;
+                    continue;
+                }
+            }
+
             input.column = match_count;
             input.match_index = match_count;
 
@@ -78,6 +78,10 @@ private:
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+
+    // The states of the pattern's LazyDFA built by earlier matches. The LazyDFA is shared with every copy of the
+    // parse result, so the states can't live in it.
+    mutable OwnPtr<LazyDFA::Cache> m_lazy_dfa_cache;
 };
 
 template<class Parser>
@@ -233,6 +237,7 @@ private:
     void run_optimization_passes();
     void attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&);
     bool attempt_rewrite_entire_match_as_substring_search(BasicBlockList const&);
+    void extract_prefilter_literals();
 };
 
 // free standing functions for match, search and has_match
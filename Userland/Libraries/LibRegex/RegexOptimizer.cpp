@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <AK/Function.h>
+#include <AK/HashTable.h>
 #include <AK/Queue.h>
 #include <AK/QuickSort.h>
 #include <AK/RedBlackTree.h>
@@ -29,14 +30,20 @@ void Regex<Parser>::run_optimization_passes()
     parser_result.bytecode.flatten();
 
     auto blocks = split_basic_blocks(parser_result.bytecode);
-    if (attempt_rewrite_entire_match_as_substring_search(blocks))
+    if (attempt_rewrite_entire_match_as_substring_search(blocks)) {
+        extract_prefilter_literals();
         return;
+    }
 
     // Rewrite fork loops as atomic groups
     // e.g. a*b -> (ATOMIC a*)b
     attempt_rewrite_loops_as_atomic_groups(blocks);
 
     parser_result.bytecode.flatten();
+    extract_prefilter_literals();
+
+    if (parser_result.error == Error::NoError)
+        parser_result.optimization_data.lazy_dfa = LazyDFA::try_create(parser_result.bytecode);
 }
 
 template<typename Parser>
@@ -651,6 +658,259 @@ bool Regex<Parser>::attempt_rewrite_entire_match_as_substring_search(BasicBlockL
     return true;
 }
 
+// Returns the text matched by a compare that only ever matches one string of ASCII characters.
+static Optional<ByteString> literal_of_compare(ByteCode const& bytecode, OpCode_Compare const& compare, size_t position)
+{
+    if (compare.arguments_count() != 1)
+        return {};
+
+    auto offset = position + 3;
+    auto compare_type = (CharacterCompareType)bytecode.at(offset++);
+
+    size_t length = 1;
+    if (compare_type == CharacterCompareType::String)
+        length = bytecode.at(offset++);
+    else if (compare_type != CharacterCompareType::Char)
+        return {};
+
+    StringBuilder builder;
+    for (size_t i = 0; i < length; ++i) {
+        auto ch = bytecode.at(offset + i);
+        if (ch >= 0x80)
+            return {};
+        builder.append(static_cast<char>(ch));
+    }
+    return builder.to_byte_string();
+}
+
+// Adds every ASCII character the compare could consume first. Case is ignored, so the set is right whether or not
+// the match is case-insensitive. Returns false if the compare could consume anything outside of ASCII.
+static bool add_leading_characters(ByteCode const& bytecode, OpCode_Compare const& compare, size_t position, Array<bool, 128>& characters)
+{
+    auto add = [&](u32 ch) {
+        characters[ch] = true;
+        characters[to_ascii_lowercase(ch)] = true;
+        characters[to_ascii_uppercase(ch)] = true;
+    };
+    auto add_range = [&](CharRange range) {
+        if (range.to >= 0x80)
+            return false;
+        for (auto ch = range.from; ch <= range.to; ++ch)
+            add(ch);
+        // Case-insensitive ranges are compared in lowercase, which can put other characters in range, e.g. [@-Z].
+        for (auto ch = to_ascii_lowercase(range.from); ch <= to_ascii_lowercase(range.to); ++ch)
+            add(ch);
+        return true;
+    };
+
+    auto offset = position + 3;
+    for (size_t i = 0; i < compare.arguments_count(); ++i) {
+        auto compare_type = (CharacterCompareType)bytecode.at(offset++);
+        switch (compare_type) {
+        case CharacterCompareType::Char: {
+            auto ch = bytecode.at(offset++);
+            if (ch >= 0x80)
+                return false;
+            add(ch);
+            break;
+        }
+        case CharacterCompareType::String: {
+            auto length = bytecode.at(offset++);
+            if (length == 0 || bytecode.at(offset) >= 0x80)
+                return false;
+            add(bytecode.at(offset));
+            offset += length;
+            break;
+        }
+        case CharacterCompareType::CharRange:
+            if (!add_range(CharRange { bytecode.at(offset++) }))
+                return false;
+            break;
+        case CharacterCompareType::LookupTable: {
+            auto count = bytecode.at(offset++);
+            for (size_t j = 0; j < count; ++j) {
+                if (!add_range(CharRange { bytecode.at(offset++) }))
+                    return false;
+            }
+            break;
+        }
+        case CharacterCompareType::CharClass: {
+            auto character_class = (CharClass)bytecode.at(offset++);
+            // \s also matches non-ASCII whitespace.
+            if (character_class == CharClass::Space)
+                return false;
+            for (u32 ch = 0; ch < 0x80; ++ch) {
+                if (OpCode_Compare::matches_character_class(character_class, ch, true))
+                    add(ch);
+            }
+            break;
+        }
+        default:
+            // Inversions, the wildcard, Unicode properties and backreferences can consume almost anything.
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Parser>
+void Regex<Parser>::extract_prefilter_literals()
+{
+    auto& bytecode = parser_result.bytecode;
+    auto& optimization_data = parser_result.optimization_data;
+    auto bytecode_size = bytecode.size();
+
+    auto jump_target = [&](OpCode const& opcode, size_t position) -> Optional<ssize_t> {
+        auto next_position = static_cast<ssize_t>(position + opcode.size());
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Jump:
+            return next_position + static_cast<OpCode_Jump const&>(opcode).offset();
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            return next_position + static_cast<OpCode_ForkJump const&>(opcode).offset();
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            return next_position + static_cast<OpCode_ForkStay const&>(opcode).offset();
+        case OpCodeId::JumpNonEmpty:
+            return next_position + static_cast<OpCode_JumpNonEmpty const&>(opcode).offset();
+        default:
+            return {};
+        }
+    };
+
+    // Instructions that consume nothing and never branch, including the no-op jumps left behind by alternations.
+    auto is_zero_width = [&](OpCode const& opcode, size_t position) {
+        if (opcode.opcode_id() == OpCodeId::Jump)
+            return jump_target(opcode, position) == static_cast<ssize_t>(position + opcode.size());
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::Checkpoint:
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            return true;
+        default:
+            return false;
+        }
+    };
+
+    // The literal prefix: the literals the pattern starts with, before anything that could branch.
+    MatchState state;
+    StringBuilder prefix;
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        if (opcode.opcode_id() == OpCodeId::Compare) {
+            auto literal = literal_of_compare(bytecode, static_cast<OpCode_Compare const&>(opcode), state.instruction_position);
+            if (!literal.has_value())
+                break;
+            prefix.append(*literal);
+        } else if (!is_zero_width(opcode, state.instruction_position)) {
+            break;
+        }
+        state.instruction_position += opcode.size();
+    }
+    if (!prefix.is_empty())
+        optimization_data.literal_prefix = prefix.to_byte_string();
+
+    // The required literal: the longest run of literals that every path through the pattern goes through.
+    // An instruction is skipped by some path if and only if a forward jump or fork passes over it.
+    Vector<ssize_t> skipping_edges;
+    skipping_edges.resize(bytecode_size + 1);
+    bool has_lookaround = false;
+    for (state.instruction_position = 0; state.instruction_position < bytecode_size;) {
+        auto& opcode = bytecode.get_opcode(state);
+        auto id = opcode.opcode_id();
+        if (id == OpCodeId::Save || id == OpCodeId::Restore || id == OpCodeId::GoBack || id == OpCodeId::FailForks)
+            has_lookaround = true;
+
+        auto next_position = state.instruction_position + opcode.size();
+        if (auto target = jump_target(opcode, state.instruction_position); target.has_value() && *target > static_cast<ssize_t>(next_position)) {
+            ++skipping_edges[next_position];
+            --skipping_edges[min(static_cast<size_t>(*target), bytecode_size)];
+        }
+        state.instruction_position = next_position;
+    }
+
+    if (!has_lookaround) {
+        StringBuilder run;
+        ByteString longest_run;
+        ssize_t edges_over_position = 0;
+        for (state.instruction_position = 0; state.instruction_position < bytecode_size;) {
+            auto& opcode = bytecode.get_opcode(state);
+            edges_over_position += skipping_edges[state.instruction_position];
+
+            Optional<ByteString> literal;
+            if (opcode.opcode_id() == OpCodeId::Compare)
+                literal = literal_of_compare(bytecode, static_cast<OpCode_Compare const&>(opcode), state.instruction_position);
+
+            if (edges_over_position == 0 && literal.has_value()) {
+                run.append(*literal);
+            } else if (edges_over_position != 0 || !is_zero_width(opcode, state.instruction_position)) {
+                if (run.length() > longest_run.length())
+                    longest_run = run.to_byte_string();
+                run.clear();
+            }
+            state.instruction_position += opcode.size();
+        }
+        if (run.length() > longest_run.length())
+            longest_run = run.to_byte_string();
+
+        // Only worth searching for if it's more than the prefix already tells us.
+        if (longest_run.length() > prefix.length())
+            optimization_data.required_literal = move(longest_run);
+    }
+
+    if (optimization_data.literal_prefix.has_value())
+        return;
+
+    // The leading characters: whatever the compares that can come first may consume.
+    Array<bool, 128> leading_characters {};
+    HashTable<size_t> visited;
+    Vector<size_t> worklist;
+    worklist.append(0);
+    while (!worklist.is_empty()) {
+        state.instruction_position = worklist.take_last();
+        if (visited.set(state.instruction_position) != HashSetResult::InsertedNewEntry)
+            continue;
+
+        // A match that reaches the end without consuming anything can start anywhere.
+        if (state.instruction_position >= bytecode_size)
+            return;
+
+        auto& opcode = bytecode.get_opcode(state);
+        auto next_position = state.instruction_position + opcode.size();
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare:
+            if (!add_leading_characters(bytecode, static_cast<OpCode_Compare const&>(opcode), state.instruction_position, leading_characters))
+                return;
+            break;
+        case OpCodeId::Jump:
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+        case OpCodeId::JumpNonEmpty: {
+            auto target = jump_target(opcode, state.instruction_position).value();
+            if (target < 0)
+                return;
+            if (opcode.opcode_id() != OpCodeId::Jump)
+                worklist.append(next_position);
+            worklist.append(target);
+            break;
+        }
+        default:
+            if (!is_zero_width(opcode, state.instruction_position))
+                return;
+            worklist.append(next_position);
+            break;
+        }
+    }
+    optimization_data.leading_characters = leading_characters;
+}
+
 template<typename Parser>
 void Regex<Parser>::attempt_rewrite_loops_as_atomic_groups(BasicBlockList const& basic_blocks)
 {
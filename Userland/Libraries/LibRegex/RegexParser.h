@@ -8,9 +8,11 @@
 
 #include "RegexByteCode.h"
 #include "RegexError.h"
+#include "RegexLazyDFA.h"
 #include "RegexLexer.h"
 #include "RegexOptions.h"
 
+#include <AK/Array.h>
 #include <AK/Forward.h>
 #include <AK/StringBuilder.h>
 #include <AK/Types.h>
@@ -58,6 +60,13 @@ public:
 
         struct {
             Optional<ByteString> pure_substring_search;
+            RefPtr<LazyDFA> lazy_dfa;
+
+            // ASCII literals the matcher can search for before it runs the VM: every match starts with the
+            // literal_prefix and contains the required_literal, and starts with one of the leading_characters.
+            Optional<ByteString> literal_prefix;
+            Optional<ByteString> required_literal;
+            Optional<Array<bool, 128>> leading_characters;
         } optimization_data {};
     };
 
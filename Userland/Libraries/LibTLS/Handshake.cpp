@@ -15,9 +15,134 @@
 
 namespace TLS {
 
+void TLSv12::offer_cached_session()
+{
+    m_context.offered_session.clear();
+    // Without a port, we can't tell which server on that host we're talking to (e.g. when connecting through a proxy).
+    if (m_context.is_server || !m_context.options.session_cache || m_context.extensions.SNI.is_empty() || m_context.port == 0)
+        return;
+
+    auto session = m_context.options.session_cache->find(m_context.extensions.SNI, m_context.port);
+    if (!session.has_value() || !m_context.options.usable_cipher_suites.contains_slow(session->cipher))
+        return;
+
+    if (!session->ticket.is_empty()) {
+        // RFC 5077 section 3.4: When presenting a ticket, the client MAY generate and include a Session ID in the TLS ClientHello.
+        //                       If the server accepts the ticket and the Session ID is not empty, then it MUST respond with
+        //                       the same Session ID present in the ClientHello.
+        fill_with_random(m_context.session_id);
+        m_context.session_id_size = sizeof(m_context.session_id);
+    } else {
+        VERIFY(session->session_id.size() <= sizeof(m_context.session_id));
+        memcpy(m_context.session_id, session->session_id.data(), session->session_id.size());
+        m_context.session_id_size = session->session_id.size();
+    }
+
+    dbgln_if(TLS_DEBUG, "Offering to resume a session with {}:{}", m_context.extensions.SNI, m_context.port);
+    m_context.offered_session = session.release_value();
+}
+
+ssize_t TLSv12::resume_offered_session()
+{
+    auto& session = m_context.offered_session.value();
+
+    // RFC 5246 section 7.4.1.3: If the ClientHello.session_id was non-empty, the server will look in its session cache for
+    //                           a match. If a match is found and the server is willing to establish the new connection
+    //                           using the specified session state, the server will respond with the same value as was
+    //                           supplied by the client.
+    // Such a session has to continue with the cipher suite it was established with.
+    if (m_context.cipher != session.cipher) {
+        dbgln("resume_offered_session: Server changed the cipher suite of a resumed session");
+        return (i8)Error::NotSafe;
+    }
+
+    // RFC 7627 section 5.3: If the original session used the "extended_master_secret" extension but the new ServerHello does
+    //                       not contain the extension, the client MUST abort the handshake. If the original session did not
+    //                       use the extension but the new ServerHello contains the extension, the client MUST abort the handshake.
+    if (m_context.extensions.extended_master_secret != session.extended_master_secret) {
+        dbgln("resume_offered_session: Server changed the extended master secret setting of a resumed session");
+        return (i8)Error::NotSafe;
+    }
+
+    auto master_key_result = ByteBuffer::copy(session.master_key);
+    if (master_key_result.is_error()) {
+        dbgln("resume_offered_session: Not enough memory");
+        return (i8)Error::OutOfMemory;
+    }
+    m_context.master_key = master_key_result.release_value();
+
+    // The server skips straight to its ChangeCipherSpec and Finished messages, with keys derived from the old master secret.
+    m_context.is_resumed_session = true;
+    m_context.connection_status = ConnectionStatus::KeyExchange;
+    if (!expand_key())
+        return (i8)Error::NotSafe;
+
+    return 0;
+}
+
+void TLSv12::cache_established_session()
+{
+    auto& cache = m_context.options.session_cache;
+    if (!cache || m_context.is_server || m_context.extensions.SNI.is_empty() || m_context.port == 0)
+        return;
+
+    // A resumed session can stay in the cache as it is, unless the server issued a new ticket for it.
+    if (m_context.is_resumed_session && m_context.session_ticket.is_empty())
+        return;
+
+    Session session;
+    if (m_context.is_resumed_session) {
+        session = m_context.offered_session.release_value();
+    } else {
+        if (m_context.session_id_size == 0 && m_context.session_ticket.is_empty()) {
+            // The server can't resume this session, so stop offering it an older one.
+            cache->remove(m_context.extensions.SNI, m_context.port);
+            return;
+        }
+
+        auto session_id_result = ByteBuffer::copy(m_context.session_id, m_context.session_id_size);
+        auto master_key_result = ByteBuffer::copy(m_context.master_key);
+        if (session_id_result.is_error() || master_key_result.is_error()) {
+            dbgln("cache_established_session: Not enough memory");
+            return;
+        }
+        session.session_id = session_id_result.release_value();
+        session.master_key = master_key_result.release_value();
+        session.cipher = m_context.cipher;
+        session.extended_master_secret = m_context.extensions.extended_master_secret;
+    }
+
+    auto lifetime = SessionCache::default_session_lifetime;
+    if (!m_context.session_ticket.is_empty()) {
+        session.ticket = move(m_context.session_ticket);
+        if (m_context.session_ticket_lifetime_hint != 0)
+            lifetime = Duration::from_seconds(m_context.session_ticket_lifetime_hint);
+    }
+    session.expiry = UnixDateTime::now() + lifetime;
+
+    cache->store(m_context.extensions.SNI, m_context.port, move(session));
+}
+
+void TLSv12::handshake_did_finish()
+{
+    m_context.connection_status = ConnectionStatus::Established;
+    cache_established_session();
+
+    if (m_handshake_timeout_timer) {
+        // Disable the handshake timeout timer as handshake has been established.
+        m_handshake_timeout_timer->stop();
+        m_handshake_timeout_timer->remove_from_parent();
+        m_handshake_timeout_timer = nullptr;
+    }
+
+    if (on_connected)
+        on_connected();
+}
+
 ByteBuffer TLSv12::build_hello()
 {
     fill_with_random(m_context.local_random);
+    offer_cached_session();
 
     auto packet_version = (u16)m_context.options.version;
     auto version = (u16)m_context.options.version;
@@ -75,6 +200,8 @@ ByteBuffer TLSv12::build_hello()
     auto supported_ec_point_formats_length = m_context.options.supported_ec_point_formats.size();
     bool supports_elliptic_curves = elliptic_curves_length && supported_ec_point_formats_length;
     bool enable_extended_master_secret = m_context.options.enable_extended_master_secret;
+    bool enable_session_tickets = m_context.options.session_cache && !m_context.is_server;
+    size_t session_ticket_length = m_context.offered_session.has_value() ? m_context.offered_session->ticket.size() : 0;
 
     // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
     extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
@@ -89,6 +216,9 @@ ByteBuffer TLSv12::build_hello()
     if (enable_extended_master_secret)
         extension_length += 4;
 
+    if (enable_session_tickets)
+        extension_length += 4 + session_ticket_length;
+
     builder.append((u16)extension_length);
 
     if (sni_length) {
@@ -139,6 +269,14 @@ ByteBuffer TLSv12::build_hello()
         builder.append((u16)0);
     }
 
+    if (enable_session_tickets) {
+        // session_ticket extension, which is empty unless we have a ticket for the server
+        builder.append((u16)ExtensionType::SESSION_TICKET);
+        builder.append((u16)session_ticket_length);
+        if (session_ticket_length)
+            builder.append(m_context.offered_session->ticket.bytes());
+    }
+
     if (alpn_length) {
         // TODO
         VERIFY_NOT_REACHED();
@@ -187,7 +325,8 @@ ByteBuffer TLSv12::build_handshake_finished()
     auto outbuffer = Bytes { out, verify_data_length };
     ByteBuffer dummy;
 
-    auto digest = m_context.handshake_hash.digest();
+    // Only peek at the transcript hash, as the server's Finished message is checked against the same transcript plus our Finished message.
+    auto digest = m_context.handshake_hash.peek();
     auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
     pseudorandom_function(outbuffer, m_context.master_key, (u8 const*)"client finished", 15, hashbuf, dummy);
 
@@ -220,24 +359,42 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         return (i8)Error::BrokenPacket;
     }
 
-    if (size < buffer.size() - index) {
+    if (size > buffer.size() - index) {
         dbgln_if(TLS_DEBUG, "not enough data after length: {} > {}", size, buffer.size() - index);
         return (i8)Error::NeedMoreData;
     }
 
-    // TODO: Compare Hashes
-    dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
-    m_context.connection_status = ConnectionStatus::Established;
+    // RFC 5246 section 7.4.9: verify_data = PRF(master_secret, finished_label, Hash(handshake_messages))[0..verify_data_length-1];
+    //                         Recipients of Finished messages MUST verify that the contents are correct.
+    // The transcript hash doesn't include this message yet, so it covers exactly the messages the server's Finished is over.
+    // Simplification: Assume that verify_data_length is always 12, like build_handshake_finished() does.
+    constexpr u32 verify_data_length = 12;
+    if (size != verify_data_length) {
+        dbgln("handle_handshake_finished: Unexpected verify_data length {}", size);
+        return (i8)Error::BrokenPacket;
+    }
 
-    if (m_handshake_timeout_timer) {
-        // Disable the handshake timeout timer as handshake has been established.
-        m_handshake_timeout_timer->stop();
-        m_handshake_timeout_timer->remove_from_parent();
-        m_handshake_timeout_timer = nullptr;
+    u8 expected[verify_data_length];
+    auto expected_buffer = Bytes { expected, verify_data_length };
+    ByteBuffer dummy;
+
+    auto digest = m_context.handshake_hash.peek();
+    auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
+    pseudorandom_function(expected_buffer, m_context.master_key, (u8 const*)"server finished", 15, hashbuf, dummy);
+
+    if (!timing_safe_compare(expected, buffer.offset_pointer(index), verify_data_length)) {
+        dbgln("handle_handshake_finished: The server's verify_data doesn't match our handshake");
+        return (i8)Error::NotSafe;
     }
 
-    if (on_connected)
-        on_connected();
+    if (m_context.is_resumed_session) {
+        // RFC 5246 section 7.3: In an abbreviated handshake, the server sends its Finished message first,
+        //                       and the client answers with its own ChangeCipherSpec and Finished messages.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    handshake_did_finish();
 
     return index + size;
 }
@@ -308,6 +465,22 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case HandshakeType::NEW_SESSION_TICKET:
+            if (m_context.handshake_messages[3] >= 1) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[3];
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            // RFC 5077 section 3.3: This message is sent by the server right before its ChangeCipherSpec message,
+            //                       and only if the client included a SessionTicket extension in its ClientHello.
+            if (m_context.is_server || !m_context.options.session_cache || m_context.connection_status != ConnectionStatus::KeyExchange) {
+                payload_res = (i8)Error::UnexpectedMessage;
+            } else {
+                payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            }
+            break;
         case HandshakeType::CERTIFICATE:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -547,7 +720,7 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            handshake_did_finish();
             break;
         }
         payload_size++;
@@ -61,6 +61,12 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // RFC 5246 section 7.4.1.3: The server echoes the session ID we offered if it agrees to resume that session.
+    bool is_resuming = m_context.offered_session.has_value()
+        && session_length != 0
+        && session_length == m_context.session_id_size
+        && memcmp(m_context.session_id, buffer.offset_pointer(res), session_length) == 0;
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -190,12 +196,23 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         } else if (extension_type == ExtensionType::EXTENDED_MASTER_SECRET) {
             m_context.extensions.extended_master_secret = true;
             res += extension_length;
+        } else if (extension_type == ExtensionType::SESSION_TICKET) {
+            // RFC 5077 section 3.2: The server uses an empty SessionTicket extension to indicate to the client that
+            //                       it will send a new session ticket using the NewSessionTicket handshake message.
+            res += extension_length;
         } else {
             dbgln("Encountered unknown extension {} with length {}", enum_to_string(extension_type), extension_length);
             res += extension_length;
         }
     }
 
+    if (is_resuming) {
+        dbgln_if(TLS_DEBUG, "Server agreed to resume the session");
+        auto resume_result = resume_offered_session();
+        if (resume_result < 0)
+            return resume_result;
+    }
+
     return res;
 }
 
@@ -212,6 +229,41 @@ ssize_t TLSv12::handle_server_hello_done(ReadonlyBytes buffer)
     return size + 3;
 }
 
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+
+    // RFC 5077 section 3.3:
+    // struct {
+    //     uint32 ticket_lifetime_hint;
+    //     opaque ticket<0..2^16-1>;
+    // } NewSessionTicket;
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    auto lifetime_hint = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(3)));
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (ticket_length + 6 != size)
+        return (i8)Error::BrokenPacket;
+
+    // An empty ticket means that the server won't give us a new one after all.
+    auto ticket_result = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    if (ticket_result.is_error()) {
+        dbgln("handle_new_session_ticket: Not enough memory");
+        return (i8)Error::OutOfMemory;
+    }
+    m_context.session_ticket = ticket_result.release_value();
+    m_context.session_ticket_lifetime_hint = lifetime_hint;
+
+    return size + 3;
+}
+
 ByteBuffer TLSv12::build_server_key_exchange()
 {
     dbgln("FIXME: build_server_key_exchange");
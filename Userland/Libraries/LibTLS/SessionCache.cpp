@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+NonnullRefPtr<SessionCache> SessionCache::create(size_t capacity)
+{
+    return adopt_ref(*new SessionCache(capacity));
+}
+
+SessionCache::SessionCache(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+Optional<Session> SessionCache::find(ByteString const& host, u16 port)
+{
+    Threading::MutexLocker locker(m_mutex);
+
+    auto index = m_entries.find_first_index_if([&](auto& entry) { return entry.host == host && entry.port == port; });
+    if (!index.has_value())
+        return {};
+
+    auto entry = m_entries.take(*index);
+    if (entry.session.expiry <= UnixDateTime::now())
+        return {};
+
+    auto session = entry.session;
+    m_entries.append(move(entry));
+    return session;
+}
+
+void SessionCache::store(ByteString const& host, u16 port, Session session)
+{
+    Threading::MutexLocker locker(m_mutex);
+
+    m_entries.remove_first_matching([&](auto& entry) { return entry.host == host && entry.port == port; });
+    if (m_capacity == 0)
+        return;
+
+    while (m_entries.size() >= m_capacity)
+        m_entries.take_first();
+    m_entries.append({ host, port, move(session) });
+}
+
+void SessionCache::remove(ByteString const& host, u16 port)
+{
+    Threading::MutexLocker locker(m_mutex);
+    m_entries.remove_first_matching([&](auto& entry) { return entry.host == host && entry.port == port; });
+}
+
+NonnullRefPtr<CertificateChainCache> CertificateChainCache::create(size_t capacity)
+{
+    return adopt_ref(*new CertificateChainCache(capacity));
+}
+
+CertificateChainCache::CertificateChainCache(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+ErrorOr<ByteBuffer> CertificateChainCache::fingerprint(ReadonlySpan<Certificate> chain)
+{
+    // DER encodings are self-delimiting, so hashing the certificates back to back can't make two chains collide.
+    Crypto::Hash::SHA256 hasher;
+    for (auto& certificate : chain)
+        hasher.update(certificate.original_asn1);
+    auto digest = hasher.digest();
+    return ByteBuffer::copy(digest.bytes());
+}
+
+bool CertificateChainCache::contains(ReadonlyBytes fingerprint)
+{
+    Threading::MutexLocker locker(m_mutex);
+
+    auto index = m_entries.find_first_index_if([&](auto& entry) { return entry.fingerprint.bytes() == fingerprint; });
+    if (!index.has_value())
+        return false;
+
+    auto entry = m_entries.take(*index);
+    if (entry.expiry <= UnixDateTime::now())
+        return false;
+
+    m_entries.append(move(entry));
+    return true;
+}
+
+void CertificateChainCache::add(ByteBuffer fingerprint, UnixDateTime expiry)
+{
+    Threading::MutexLocker locker(m_mutex);
+
+    m_entries.remove_first_matching([&](auto& entry) { return entry.fingerprint == fingerprint; });
+    if (m_capacity == 0)
+        return;
+
+    while (m_entries.size() >= m_capacity)
+        m_entries.take_first();
+    m_entries.append({ move(fingerprint), expiry });
+}
+
+}
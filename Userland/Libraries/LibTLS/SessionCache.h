@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/ByteBuffer.h>
+#include <AK/ByteString.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <LibTLS/Certificate.h>
+#include <LibTLS/Extensions.h>
+#include <LibThreading/Mutex.h>
+
+namespace TLS {
+
+// Everything a client needs to resume a session with an abbreviated handshake, see RFC 5246 section 7.3 and RFC 5077.
+struct Session {
+    // At least one of these is set; a session ticket is preferred by the server if it has one.
+    ByteBuffer session_id;
+    ByteBuffer ticket;
+
+    ByteBuffer master_key;
+    CipherSuite cipher { CipherSuite::TLS_NULL_WITH_NULL_NULL };
+    bool extended_master_secret { false };
+    UnixDateTime expiry;
+};
+
+// Remembers the most recent session for a bounded number of servers, so that new connections to one of these servers can
+// skip the key exchange and certificate validation. Servers are told apart by host name and port, as different services
+// on the same host don't share their sessions. A single cache can be shared by connections on different threads.
+class SessionCache : public AtomicRefCounted<SessionCache> {
+public:
+    static constexpr size_t default_capacity = 64;
+
+    // How long to keep sessions around for if the server doesn't tell us for how long its ticket is valid.
+    static constexpr Duration default_session_lifetime = Duration::from_seconds(60 * 60);
+
+    static NonnullRefPtr<SessionCache> create(size_t capacity = default_capacity);
+
+    Optional<Session> find(ByteString const& host, u16 port);
+    void store(ByteString const& host, u16 port, Session);
+    void remove(ByteString const& host, u16 port);
+
+private:
+    explicit SessionCache(size_t capacity);
+
+    struct Entry {
+        ByteString host;
+        u16 port { 0 };
+        Session session;
+    };
+
+    Threading::Mutex m_mutex;
+    // Ordered from least to most recently used.
+    Vector<Entry> m_entries;
+    size_t m_capacity { 0 };
+};
+
+// Remembers certificate chains that were validated up to a trusted root certificate, keyed by a fingerprint of the
+// whole chain, so that their signatures don't have to be checked again until one of the certificates expires.
+class CertificateChainCache : public AtomicRefCounted<CertificateChainCache> {
+public:
+    static constexpr size_t default_capacity = 256;
+
+    static NonnullRefPtr<CertificateChainCache> create(size_t capacity = default_capacity);
+
+    static ErrorOr<ByteBuffer> fingerprint(ReadonlySpan<Certificate> chain);
+
+    bool contains(ReadonlyBytes fingerprint);
+    void add(ByteBuffer fingerprint, UnixDateTime expiry);
+
+private:
+    explicit CertificateChainCache(size_t capacity);
+
+    struct Entry {
+        ByteBuffer fingerprint;
+        UnixDateTime expiry;
+    };
+
+    Threading::Mutex m_mutex;
+    // Ordered from least to most recently used.
+    Vector<Entry> m_entries;
+    size_t m_capacity { 0 };
+};
+
+}
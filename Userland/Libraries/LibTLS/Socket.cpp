@@ -53,7 +53,7 @@ ErrorOr<size_t> TLSv12::write_some(ReadonlyBytes bytes)
 
 template<typename T>
 struct PromiseAwaiter {
-    bool await_ready() const { return promise->is_resolved(); }
+    bool await_ready() const { return promise->is_resolved() || promise->is_rejected(); }
     void await_suspend(std::coroutine_handle<> awaiter)
     {
         // Note: Argument pack as to allow `Promise<void>` which does not pass any arguments to the callback.
@@ -66,10 +66,9 @@ struct PromiseAwaiter {
     }
     ErrorOr<T> await_resume()
     {
-        if constexpr (IsVoid<T>)
-            return {};
-        else
-            return promise->await(); // Already resolved, so this should never yield to the event loop.
+        // Already settled, so this should never yield to the event loop.
+        // NOTE: This has to pass on rejections for Promise<void> as well, or a failed handshake would look like a connection.
+        return promise->await();
     }
 
     NonnullRefPtr<Core::Promise<T>> promise;
@@ -82,6 +81,7 @@ Coroutine<ErrorOr<NonnullOwnPtr<TLSv12>>> TLSv12::async_connect(ByteString const
     CO_TRY(tcp_socket->set_blocking(false));
     auto tls_socket = make<TLSv12>(move(tcp_socket), move(options));
     tls_socket->set_sni(host);
+    tls_socket->m_context.port = port;
     tls_socket->on_connected = [promise] { promise->resolve(); };
     tls_socket->on_tls_error = [&tls_socket = *tls_socket, promise](auto alert) {
         tls_socket.try_disambiguate_error();
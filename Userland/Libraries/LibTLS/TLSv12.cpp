@@ -282,6 +282,19 @@ bool Context::verify_chain(StringView host) const
         return false;
     }
 
+    // A chain we've already validated up to a trusted root doesn't need its signatures checked again.
+    Optional<ByteBuffer> chain_fingerprint;
+    if (options.certificate_chain_cache) {
+        auto fingerprint_or_error = CertificateChainCache::fingerprint(*local_chain);
+        if (!fingerprint_or_error.is_error()) {
+            if (options.certificate_chain_cache->contains(fingerprint_or_error.value())) {
+                dbgln_if(TLS_DEBUG, "verify_chain: Certificate chain was validated before");
+                return true;
+            }
+            chain_fingerprint = fingerprint_or_error.release_value();
+        }
+    }
+
     for (size_t cert_index = 0; cert_index < local_chain->size(); ++cert_index) {
         auto const& cert = local_chain->at(cert_index);
 
@@ -304,6 +317,13 @@ bool Context::verify_chain(StringView host) const
             }
 
             // Root certificate reached, and correctly verified, so we can stop now
+            if (chain_fingerprint.has_value()) {
+                // The chain stays valid until the first of its certificates expires.
+                auto expiry = root_certificate.validity.not_after;
+                for (size_t i = 0; i <= cert_index; ++i)
+                    expiry = min(expiry, local_chain->at(i).validity.not_after);
+                options.certificate_chain_cache->add(chain_fingerprint.release_value(), expiry);
+            }
             return true;
         }
 
@@ -20,6 +20,7 @@
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
 #include <LibTLS/CipherSuite.h>
+#include <LibTLS/SessionCache.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -194,6 +195,8 @@ struct Options {
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] { })
     OPTION_WITH_DEFAULTS(Function<Vector<Certificate>()>, certificate_provider, [] { return Vector<Certificate> {}; })
     OPTION_WITH_DEFAULTS(bool, enable_extended_master_secret, true)
+    OPTION_WITH_DEFAULTS(RefPtr<SessionCache>, session_cache, )
+    OPTION_WITH_DEFAULTS(RefPtr<CertificateChainCache>, certificate_chain_cache, )
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -246,6 +249,13 @@ struct Context {
     u8 local_random[32];
     u8 session_id[32];
     u8 session_id_size { 0 };
+    // The port of the server we connected to, if we know it. Together with the SNI, it is what sessions are cached by.
+    u16 port { 0 };
+    // The session we asked the server to resume, and whether it agreed to do so.
+    Optional<Session> offered_session;
+    bool is_resumed_session { false };
+    ByteBuffer session_ticket;
+    u32 session_ticket_lifetime_hint { 0 };
     CipherSuite cipher;
     bool is_server { false };
     Vector<Certificate> certificates;
@@ -367,6 +377,7 @@ public:
     explicit TLSv12(StreamVariantType, Options);
 
     bool is_established() const { return m_context.connection_status == ConnectionStatus::Established; }
+    bool is_resumed_session() const { return m_context.is_resumed_session; }
 
     void set_sni(StringView sni)
     {
@@ -442,6 +453,7 @@ private:
 
     ssize_t handle_server_hello(ReadonlyBytes, WritePacketStage&);
     ssize_t handle_handshake_finished(ReadonlyBytes, WritePacketStage&);
+    ssize_t handle_new_session_ticket(ReadonlyBytes);
     ssize_t handle_certificate(ReadonlyBytes);
     ssize_t handle_server_key_exchange(ReadonlyBytes);
     ssize_t handle_dhe_rsa_server_key_exchange(ReadonlyBytes);
@@ -528,6 +540,11 @@ private:
 
     bool compute_master_secret_from_pre_master_secret(size_t length);
 
+    void offer_cached_session();
+    ssize_t resume_offered_session();
+    void cache_established_session();
+    void handshake_did_finish();
+
     void try_disambiguate_error() const;
 
     bool m_eof { false };
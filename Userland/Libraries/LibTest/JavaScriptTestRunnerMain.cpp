@@ -8,6 +8,8 @@
 
 #include <LibCore/ArgsParser.h>
 #include <LibFileSystem/FileSystem.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Optimizer.h>
 #include <LibTest/JavaScriptTestRunner.h>
 #include <signal.h>
 #include <stdio.h>
@@ -118,6 +120,8 @@ int main(int argc, char** argv)
     args_parser.add_option(per_file, "Show detailed per-file results as JSON (implies -j)", "per-file");
     args_parser.add_option(g_collect_on_every_allocation, "Collect garbage after every allocation", "collect-often", 'g');
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
+    args_parser.add_option(JS::Bytecode::g_optimization_level, "Optimize the bytecode (0 to 2)", "optimize", 'O', "level");
+    args_parser.add_option(JS::Bytecode::g_jit_enabled, "Compile hot functions and loops to native code", "jit", {});
     args_parser.add_option(test_glob, "Only run tests matching the given glob", "filter", 'f', "glob");
     for (auto& entry : g_extra_args)
         args_parser.add_option(*entry.key, entry.value.get<0>().characters(), entry.value.get<1>().characters(), entry.value.get<2>());
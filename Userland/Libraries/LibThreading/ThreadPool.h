@@ -25,6 +25,8 @@ struct ThreadPoolLooper {
             entry = pool.m_work_queue.with_locked([&](auto& queue) -> Optional<typename Pool::Work> {
                 if (queue.is_empty())
                     return {};
+                // NOTE: The work counts as busy before it leaves the queue, so wait_for_all() can't miss it.
+                pool.m_busy_count++;
                 return queue.dequeue();
             });
             if (entry.has_value())
@@ -36,12 +38,13 @@ struct ThreadPoolLooper {
                 return IterationDecision::Continue;
 
             pool.m_mutex.lock();
-            pool.m_work_available.wait();
+            if (!pool.has_queued_work() && !pool.m_should_exit)
+                pool.m_work_available.wait();
             pool.m_mutex.unlock();
         }
 
-        pool.m_busy_count++;
         pool.m_handler(entry.release_value());
+        pool.work_did_finish();
         return IterationDecision::Continue;
     }
 };
@@ -86,6 +89,7 @@ public:
     void request_exit()
     {
         m_should_exit.store(true, AK::MemoryOrder::memory_order_release);
+        MutexLocker locker(m_mutex);
         m_work_available.broadcast();
     }
 
@@ -99,27 +103,33 @@ public:
         m_work_queue.with_locked([&](auto& queue) {
             queue.enqueue({ move(work) });
         });
+        // NOTE: Idle workers check for work while holding m_mutex, so taking it here makes sure none of them
+        //       can miss this wakeup between that check and going to sleep.
+        MutexLocker locker(m_mutex);
         m_work_available.broadcast();
     }
 
+    // Waits until all submitted work has finished running.
     void wait_for_all()
     {
-        while (true) {
-            if (m_work_queue.with_locked([](auto& queue) { return queue.is_empty(); }))
-                break;
-            m_mutex.lock();
-            m_work_done.wait();
-            m_mutex.unlock();
-        }
-
-        while (m_busy_count.load(AK::MemoryOrder::memory_order_acquire) > 0) {
-            m_mutex.lock();
+        MutexLocker locker(m_mutex);
+        while (has_queued_work() || m_busy_count.load(AK::MemoryOrder::memory_order_acquire) > 0)
             m_work_done.wait();
-            m_mutex.unlock();
-        }
     }
 
 private:
+    bool has_queued_work()
+    {
+        return m_work_queue.with_locked([](auto& queue) { return !queue.is_empty(); });
+    }
+
+    void work_did_finish()
+    {
+        MutexLocker locker(m_mutex);
+        m_busy_count--;
+        m_work_done.broadcast();
+    }
+
     template<typename... Args>
     void initialize_workers(size_t concurrency, Args&&... looper_args)
     {
@@ -127,10 +137,7 @@ private:
             m_workers.append(Thread::construct([this, looper_args...]() -> intptr_t {
                 Looper<ThreadPool> thread_looper { move(looper_args)... };
                 for (; !m_should_exit;) {
-                    auto result = thread_looper.next(*this, true);
-                    m_busy_count--;
-                    m_work_done.signal();
-                    if (result == IterationDecision::Break)
+                    if (thread_looper.next(*this, true) == IterationDecision::Break)
                         break;
                 }
 
@@ -14,14 +14,14 @@
 
 namespace Wasm {
 
-Optional<FunctionAddress> Store::allocate(ModuleInstance& instance, Module const& module, CodeSection::Code const& code, TypeIndex type_index)
+Optional<FunctionAddress> Store::allocate(ModuleInstance& instance, Module const& module, CodeSection::Code const& code, TypeIndex type_index, RefPtr<RegisterFunction const> register_function)
 {
     FunctionAddress address { m_functions.size() };
     if (type_index.value() >= instance.types().size())
         return {};
 
     auto& type = instance.types()[type_index.value()];
-    m_functions.empend(WasmFunction { type, instance, module, code });
+    m_functions.empend(WasmFunction { type, instance, module, code, move(register_function) });
     return address;
 }
 
@@ -225,10 +225,17 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
     Vector<FunctionAddress> module_functions;
     module_functions.ensure_capacity(module.function_section().types().size());
 
+    Vector<RefPtr<RegisterFunction const>> register_functions;
+    if (m_should_lower_to_register_bytecode)
+        register_functions = RegisterFunction::lower_module(module, m_should_compile_to_native_code ? RegisterFunction::CompileToNativeCode::Yes : RegisterFunction::CompileToNativeCode::No);
+
     size_t i = 0;
     for (auto& code : module.code_section().functions()) {
         auto type_index = module.function_section().types()[i];
-        auto address = m_store.allocate(main_module_instance, module, code, type_index);
+        RefPtr<RegisterFunction const> register_function;
+        if (i < register_functions.size())
+            register_function = register_functions[i];
+        auto address = m_store.allocate(main_module_instance, module, code, type_index, move(register_function));
         VERIFY(address.has_value());
         auxiliary_instance.functions().append(*address);
         module_functions.append(*address);
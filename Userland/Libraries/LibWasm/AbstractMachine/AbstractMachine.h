@@ -13,6 +13,7 @@
 #include <AK/Result.h>
 #include <AK/StackInfo.h>
 #include <AK/UFixedBigInt.h>
+#include <LibWasm/AbstractMachine/RegisterBytecode.h>
 #include <LibWasm/Types.h>
 
 // NOTE: Special case for Wasm::Result.
@@ -324,11 +325,12 @@ private:
 
 class WasmFunction {
 public:
-    explicit WasmFunction(FunctionType const& type, ModuleInstance const& instance, Module const& module, CodeSection::Code const& code)
+    explicit WasmFunction(FunctionType const& type, ModuleInstance const& instance, Module const& module, CodeSection::Code const& code, RefPtr<RegisterFunction const> register_function = {})
         : m_type(type)
         , m_module(module.make_weak_ptr())
         , m_module_instance(instance)
         , m_code(code)
+        , m_register_function(move(register_function))
     {
     }
 
@@ -337,11 +339,15 @@ public:
     auto& code() const { return m_code; }
     RefPtr<Module const> module_ref() const { return m_module.strong_ref(); }
 
+    // The function body lowered to register bytecode, if it has a register form.
+    RegisterFunction const* register_function() const { return m_register_function.ptr(); }
+
 private:
     FunctionType m_type;
     WeakPtr<Module const> m_module;
     ModuleInstance const& m_module_instance;
     CodeSection::Code const& m_code;
+    RefPtr<RegisterFunction const> m_register_function;
 };
 
 class HostFunction {
@@ -537,7 +543,7 @@ class Store {
 public:
     Store() = default;
 
-    Optional<FunctionAddress> allocate(ModuleInstance&, Module const&, CodeSection::Code const&, TypeIndex);
+    Optional<FunctionAddress> allocate(ModuleInstance&, Module const&, CodeSection::Code const&, TypeIndex, RefPtr<RegisterFunction const> = {});
     Optional<FunctionAddress> allocate(HostFunction&&);
     Optional<TableAddress> allocate(TableType const&);
     Optional<MemoryAddress> allocate(MemoryType const&);
@@ -583,11 +589,12 @@ private:
 
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, RegisterFunction const* register_function = nullptr)
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
+        , m_register_function(register_function)
     {
     }
 
@@ -598,6 +605,7 @@ public:
     auto arity() const { return m_arity; }
     auto label_index() const { return m_label_index; }
     auto& label_index() { return m_label_index; }
+    auto register_function() const { return m_register_function; }
 
 private:
     ModuleInstance const& m_module;
@@ -605,6 +613,7 @@ private:
     Expression const& m_expression;
     size_t m_arity { 0 };
     size_t m_label_index { 0 };
+    RegisterFunction const* m_register_function { nullptr };
 };
 
 using InstantiationResult = AK::ErrorOr<NonnullOwnPtr<ModuleInstance>, InstantiationError>;
@@ -625,12 +634,21 @@ public:
 
     void enable_instruction_count_limit() { m_should_limit_instruction_count = true; }
 
+    // Keep all functions of modules instantiated from now on running on the stack machine, instead of lowering them
+    // to register bytecode. Useful for comparing the two.
+    void disable_register_bytecode() { m_should_lower_to_register_bytecode = false; }
+
+    // Also compile the register bytecode of modules instantiated from now on to native code, where supported.
+    void enable_jit() { m_should_compile_to_native_code = true; }
+
 private:
     Optional<InstantiationError> allocate_all_initial_phase(Module const&, ModuleInstance&, Vector<ExternValue>&, Vector<Value>& global_values, Vector<FunctionAddress>& own_functions);
     Optional<InstantiationError> allocate_all_final_phase(Module const&, ModuleInstance&, Vector<Vector<Reference>>& elements);
     Store m_store;
     StackInfo m_stack_info;
     bool m_should_limit_instruction_count { false };
+    bool m_should_lower_to_register_bytecode { true };
+    bool m_should_compile_to_native_code { false };
 };
 
 class Linker {
@@ -15,6 +15,7 @@
 #include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
 #include <LibWasm/AbstractMachine/Operators.h>
+#include <LibWasm/JIT/NativeFunction.h>
 #include <LibWasm/Opcode.h>
 #include <LibWasm/Printer/Printer.h>
 
@@ -33,6 +34,9 @@ namespace Wasm {
 void BytecodeInterpreter::interpret(Configuration& configuration)
 {
     m_trap = Empty {};
+    if (auto const* register_function = configuration.frame().register_function(); register_function && m_use_register_bytecode)
+        return interpret_register_function(configuration, *register_function);
+
     auto& instructions = configuration.frame().expression().instructions();
     auto max_ip_value = InstructionPointer { instructions.size() };
     auto& current_ip_value = configuration.ip();
@@ -238,27 +242,61 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
 
     configuration.value_stack().remove(configuration.value_stack().size() - span.size(), span.size());
 
+    auto results = call_function(configuration, address, move(args));
+    if (!results.has_value())
+        return;
+
+    configuration.value_stack().extend(results.release_value());
+}
+
+// Returns the results of the call in order, or nothing if it trapped.
+Optional<Vector<Value>> BytecodeInterpreter::call_function(Configuration& configuration, FunctionAddress address, Vector<Value> arguments)
+{
+    auto instance = configuration.store().get(address);
+
     Result result { Trap { ""sv } };
     if (instance->has<WasmFunction>()) {
         CallFrameHandle handle { *this, configuration };
-        result = configuration.call(*this, address, move(args));
+        result = configuration.call(*this, address, move(arguments));
     } else {
-        result = configuration.call(*this, address, move(args));
+        result = configuration.call(*this, address, move(arguments));
     }
 
     if (result.is_trap()) {
         m_trap = move(result.trap());
-        return;
+        return {};
     }
 
     if (result.is_completion()) {
         m_trap = move(result.completion());
-        return;
+        return {};
     }
 
-    configuration.value_stack().ensure_capacity(configuration.value_stack().size() + result.values().size());
+    Vector<Value> results;
+    results.ensure_capacity(result.values().size());
     for (auto& entry : result.values().in_reverse())
-        configuration.value_stack().unchecked_append(entry);
+        results.unchecked_append(entry);
+    return results;
+}
+
+void BytecodeInterpreter::call_from_registers(Configuration& configuration, FunctionAddress address, Value* registers, RegisterInstruction const& instruction)
+{
+    TRAP_IF_NOT(m_stack_info.size_free() >= Constants::minimum_stack_space_to_keep_free);
+
+    Vector<Value> args;
+    args.ensure_capacity(instruction.a);
+    for (size_t i = 0; i < instruction.a; ++i)
+        args.unchecked_append(registers[instruction.dst + i]);
+
+    auto results = call_function(configuration, address, move(args));
+    if (!results.has_value())
+        return;
+
+    // The callee may have grown the frame stack, so don't trust `registers` anymore.
+    auto* destination = configuration.frame().locals().data() + instruction.dst;
+    VERIFY(results->size() == instruction.b);
+    for (size_t i = 0; i < results->size(); ++i)
+        destination[i] = (*results)[i];
 }
 
 template<typename PopTypeLHS, typename PushType, typename Operator, typename PopTypeRHS, typename... Args>
@@ -343,6 +381,69 @@ void BytecodeInterpreter::pop_and_store(Configuration& configuration, Instructio
     store_to_memory(configuration, memarg, { &value, sizeof(StoreT) }, base);
 }
 
+template<typename PopType, typename PushType, typename Operator>
+ALWAYS_INLINE void BytecodeInterpreter::binary_register_operation(Value* registers, RegisterInstruction const& instruction)
+{
+    auto lhs = registers[instruction.a].to<PopType>();
+    auto rhs = registers[instruction.b].to<PopType>();
+    auto call_result = Operator {}(lhs, rhs);
+    PushType result;
+    if constexpr (IsSpecializationOf<decltype(call_result), AK::ErrorOr>) {
+        if (call_result.is_error()) {
+            trap_if_not(false, call_result.error());
+            return;
+        }
+        result = call_result.release_value();
+    } else {
+        result = call_result;
+    }
+    registers[instruction.dst] = Value(result);
+}
+
+template<typename PopType, typename PushType, typename Operator>
+ALWAYS_INLINE void BytecodeInterpreter::unary_register_operation(Value* registers, RegisterInstruction const& instruction)
+{
+    auto value = registers[instruction.a].to<PopType>();
+    auto call_result = Operator {}(value);
+    PushType result;
+    if constexpr (IsSpecializationOf<decltype(call_result), AK::ErrorOr>) {
+        if (call_result.is_error()) {
+            trap_if_not(false, call_result.error());
+            return;
+        }
+        result = call_result.release_value();
+    } else {
+        result = call_result;
+    }
+    registers[instruction.dst] = Value(result);
+}
+
+template<typename ReadType, typename PushType>
+ALWAYS_INLINE void BytecodeInterpreter::load_into_register(Configuration& configuration, Value* registers, RegisterInstruction const& instruction)
+{
+    auto& address = configuration.frame().module().memories()[instruction.c];
+    auto memory = configuration.store().get(address);
+    auto base = registers[instruction.a].to<i32>();
+    u64 instance_address = static_cast<u64>(bit_cast<u32>(base)) + instruction.immediate;
+    if (instance_address + sizeof(ReadType) > memory->size()) {
+        m_trap = Trap { "Memory access out of bounds" };
+        dbgln("LibWasm: Memory access out of bounds (expected {} to be less than or equal to {})", instance_address + sizeof(ReadType), memory->size());
+        return;
+    }
+    dbgln_if(WASM_TRACE_DEBUG, "load({} : {}) -> register({})", instance_address, sizeof(ReadType), instruction.dst);
+    auto slice = memory->data().bytes().slice(instance_address, sizeof(ReadType));
+    registers[instruction.dst] = Value(static_cast<PushType>(read_value<ReadType>(slice)));
+}
+
+template<typename PopType, typename StoreType>
+ALWAYS_INLINE void BytecodeInterpreter::store_from_register(Configuration& configuration, Value* registers, RegisterInstruction const& instruction)
+{
+    auto value = ConvertToRaw<StoreType> {}(registers[instruction.b].to<PopType>());
+    auto base = registers[instruction.a].to<i32>();
+    Instruction::MemoryArgument memory_argument { 0, static_cast<u32>(instruction.immediate), MemoryIndex { instruction.c } };
+    store_to_memory(configuration, memory_argument, { &value, sizeof(StoreType) }, base);
+}
+
 template<size_t N>
 void BytecodeInterpreter::pop_and_store_lane_n(Configuration& configuration, Instruction const& instruction)
 {
@@ -1654,6 +1755,209 @@ ALWAYS_INLINE void BytecodeInterpreter::interpret_instruction(Configuration& con
     }
 }
 
+static void push_register_results(Configuration& configuration, Value const* registers, RegisterInstruction const& instruction)
+{
+    auto& value_stack = configuration.value_stack();
+    value_stack.ensure_capacity(value_stack.size() + instruction.b);
+    for (size_t i = 0; i < instruction.b; ++i)
+        value_stack.unchecked_append(registers[instruction.a + i]);
+}
+
+void BytecodeInterpreter::interpret_register_function(Configuration& configuration, RegisterFunction const& function)
+{
+    // The locals are the first registers of the register file, the constants go at its end.
+    auto& register_file = configuration.frame().locals();
+    VERIFY(register_file.size() == function.local_count());
+    register_file.resize(function.register_count());
+    for (size_t i = 0; i < function.constants().size(); ++i)
+        register_file[function.constants_base() + i] = Value(function.constants()[i]);
+
+    auto* registers = register_file.data();
+    auto& instructions = function.instructions();
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+
+    if (auto const* native_function = function.native_function(); native_function && m_use_native_code) {
+        JIT::RuntimeContext context {
+            .interpreter = this,
+            .configuration = &configuration,
+            // NOTE: Native code only counts backward branches, so this is a much looser limit than the one below.
+            .remaining_backward_branches = should_limit_instruction_count ? static_cast<i64>(Constants::max_allowed_executed_instructions_per_call) : NumericLimits<i64>::max(),
+        };
+        context.refresh();
+
+        auto exit = native_function->run(context);
+        switch (exit) {
+        case JIT::NativeFunction::trap_exit:
+            VERIFY(did_trap());
+            return;
+        case JIT::NativeFunction::unreachable_exit:
+            m_trap = Trap { "Unreachable" };
+            return;
+        case JIT::NativeFunction::out_of_bounds_exit:
+            m_trap = Trap { "Memory access out of bounds" };
+            return;
+        case JIT::NativeFunction::instruction_limit_exit:
+            m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+            return;
+        default:
+            push_register_results(configuration, context.registers, instructions[exit]);
+            return;
+        }
+    }
+
+    u64 executed_instructions = 0;
+    size_t ip = 0;
+
+    for (;;) {
+        if (should_limit_instruction_count) {
+            if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+                return;
+            }
+        }
+
+        auto& instruction = instructions[ip++];
+        switch (instruction.type) {
+        case RegisterInstruction::Type::Copy:
+            registers[instruction.dst] = registers[instruction.a];
+            continue;
+        case RegisterInstruction::Type::CopyRange:
+            // NOTE: Branches only ever move values down the stack, so copying upwards is fine with overlapping ranges.
+            for (size_t i = 0; i < instruction.b; ++i)
+                registers[instruction.dst + i] = registers[instruction.a + i];
+            continue;
+        case RegisterInstruction::Type::Jump:
+            ip = instruction.immediate;
+            continue;
+        case RegisterInstruction::Type::JumpIfZero:
+            if (registers[instruction.a].to<i32>() == 0)
+                ip = instruction.immediate;
+            continue;
+        case RegisterInstruction::Type::JumpIfNotZero:
+            if (registers[instruction.a].to<i32>() != 0)
+                ip = instruction.immediate;
+            continue;
+        case RegisterInstruction::Type::BranchTable: {
+            auto index = registers[instruction.a].to<u32>();
+            auto& target = function.branch_targets()[instruction.immediate + min(index, instruction.b)];
+            for (size_t i = 0; i < target.count; ++i)
+                registers[target.destination + i] = registers[target.source + i];
+            ip = target.target;
+            continue;
+        }
+        case RegisterInstruction::Type::Return:
+            push_register_results(configuration, registers, instruction);
+            return;
+        case RegisterInstruction::Type::Unreachable:
+            m_trap = Trap { "Unreachable" };
+            return;
+        case RegisterInstruction::Type::Select:
+            registers[instruction.dst] = registers[instruction.c].to<i32>() != 0 ? registers[instruction.a] : registers[instruction.b];
+            continue;
+        case RegisterInstruction::Type::Call:
+        case RegisterInstruction::Type::CallIndirect:
+            execute_register_operation(configuration, registers, instruction);
+            if (did_trap())
+                return;
+            // The callee may have grown the frame stack, so don't trust `registers` anymore.
+            registers = configuration.frame().locals().data();
+            continue;
+        default:
+            execute_register_operation(configuration, registers, instruction);
+            if (did_trap())
+                return;
+            continue;
+        }
+    }
+}
+
+// Executes any instruction that doesn't affect control flow within the function.
+void BytecodeInterpreter::execute_register_operation(Configuration& configuration, Value* registers, RegisterInstruction const& instruction)
+{
+    switch (instruction.type) {
+    case RegisterInstruction::Type::Call: {
+        auto address = configuration.frame().module().functions()[instruction.immediate];
+        dbgln_if(WASM_TRACE_DEBUG, "call({})", address.value());
+        call_from_registers(configuration, address, registers, instruction);
+        return;
+    }
+    case RegisterInstruction::Type::CallIndirect: {
+        auto type_index = static_cast<u32>(instruction.immediate >> 32);
+        auto table_index = static_cast<u32>(instruction.immediate);
+        auto table_address = configuration.frame().module().tables()[table_index];
+        auto table_instance = configuration.store().get(table_address);
+        auto index = registers[instruction.c].to<i32>();
+        TRAP_IF_NOT(index >= 0);
+        TRAP_IF_NOT(static_cast<size_t>(index) < table_instance->elements().size());
+        auto element = table_instance->elements()[index];
+        TRAP_IF_NOT(element.ref().has<Reference::Func>());
+        auto address = element.ref().get<Reference::Func>().address;
+
+        // The stack machine trusts the types to line up; here the callee writes its results straight into our
+        // registers, so make sure it really has the signature we lowered the call for.
+        auto& expected_type = configuration.frame().module().types()[type_index];
+        FunctionType const* type { nullptr };
+        configuration.store().get(address)->visit([&](auto const& function) { type = &function.type(); });
+        if (trap_if_not(type->parameters() == expected_type.parameters() && type->results() == expected_type.results(), "Indirect call type mismatch"sv))
+            return;
+
+        dbgln_if(WASM_TRACE_DEBUG, "call_indirect({} -> {})", index, address.value());
+        call_from_registers(configuration, address, registers, instruction);
+        return;
+    }
+    case RegisterInstruction::Type::GlobalGet: {
+        auto address = configuration.frame().module().globals()[instruction.immediate];
+        registers[instruction.dst] = configuration.store().get(address)->value();
+        return;
+    }
+    case RegisterInstruction::Type::GlobalSet: {
+        auto address = configuration.frame().module().globals()[instruction.immediate];
+        configuration.store().get(address)->set_value(registers[instruction.a]);
+        return;
+    }
+    case RegisterInstruction::Type::MemorySize: {
+        auto address = configuration.frame().module().memories()[instruction.c];
+        auto pages = configuration.store().get(address)->size() / Constants::page_size;
+        registers[instruction.dst] = Value((i32)pages);
+        return;
+    }
+    case RegisterInstruction::Type::MemoryGrow: {
+        auto address = configuration.frame().module().memories()[instruction.c];
+        auto instance = configuration.store().get(address);
+        i32 old_pages = instance->size() / Constants::page_size;
+        auto new_pages = registers[instruction.a].to<i32>();
+        dbgln_if(WASM_TRACE_DEBUG, "memory.grow({}), previously {} pages...", new_pages, old_pages);
+        if (instance->grow(new_pages * Constants::page_size))
+            registers[instruction.dst] = Value((i32)old_pages);
+        else
+            registers[instruction.dst] = Value((i32)-1);
+        return;
+    }
+#define __REGISTER_BINARY_OPERATION(name, PopType, PushType, Operator)                         \
+    case RegisterInstruction::Type::name:                                                      \
+        return binary_register_operation<PopType, PushType, Operator>(registers, instruction);
+        ENUMERATE_WASM_REGISTER_BINARY_OPERATIONS(__REGISTER_BINARY_OPERATION)
+#undef __REGISTER_BINARY_OPERATION
+#define __REGISTER_UNARY_OPERATION(name, PopType, PushType, Operator)                         \
+    case RegisterInstruction::Type::name:                                                     \
+        return unary_register_operation<PopType, PushType, Operator>(registers, instruction);
+        ENUMERATE_WASM_REGISTER_UNARY_OPERATIONS(__REGISTER_UNARY_OPERATION)
+#undef __REGISTER_UNARY_OPERATION
+#define __REGISTER_LOAD(name, ReadType, PushType)                                             \
+    case RegisterInstruction::Type::name:                                                     \
+        return load_into_register<ReadType, PushType>(configuration, registers, instruction);
+        ENUMERATE_WASM_REGISTER_LOADS(__REGISTER_LOAD)
+#undef __REGISTER_LOAD
+#define __REGISTER_STORE(name, PopType, StoreType)                                             \
+    case RegisterInstruction::Type::name:                                                      \
+        return store_from_register<PopType, StoreType>(configuration, registers, instruction);
+        ENUMERATE_WASM_REGISTER_STORES(__REGISTER_STORE)
+#undef __REGISTER_STORE
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
 void DebuggerBytecodeInterpreter::interpret_instruction(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     if (pre_interpret_hook) {
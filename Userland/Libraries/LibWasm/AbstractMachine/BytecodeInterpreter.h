@@ -9,6 +9,7 @@
 #include <AK/StackInfo.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
 #include <LibWasm/AbstractMachine/Interpreter.h>
+#include <LibWasm/AbstractMachine/RegisterBytecode.h>
 
 namespace Wasm {
 
@@ -31,6 +32,9 @@ struct BytecodeInterpreter : public Interpreter {
     }
     virtual void clear_trap() final { m_trap = Empty {}; }
 
+    // Run functions that were compiled to native code on the register bytecode interpreter instead.
+    void disable_native_code() { m_use_native_code = false; }
+
     struct CallFrameHandle {
         explicit CallFrameHandle(BytecodeInterpreter& interpreter, Configuration& configuration)
             : m_configuration_handle(configuration)
@@ -45,7 +49,11 @@ struct BytecodeInterpreter : public Interpreter {
     };
 
 protected:
+    friend class JIT::Compiler;
+
     void interpret_instruction(Configuration&, InstructionPointer&, Instruction const&);
+    void interpret_register_function(Configuration&, RegisterFunction const&);
+    void execute_register_operation(Configuration&, Value* registers, RegisterInstruction const&);
     void branch_to_label(Configuration&, LabelIndex);
     template<typename ReadT, typename PushT>
     void load_and_push(Configuration&, Instruction const&);
@@ -69,6 +77,8 @@ protected:
     VectorType pop_vector(Configuration&);
     void store_to_memory(Configuration&, Instruction::MemoryArgument const&, ReadonlyBytes data, u32 base);
     void call_address(Configuration&, FunctionAddress);
+    Optional<Vector<Value>> call_function(Configuration&, FunctionAddress, Vector<Value> arguments);
+    void call_from_registers(Configuration&, FunctionAddress, Value* registers, RegisterInstruction const&);
 
     template<typename PopTypeLHS, typename PushType, typename Operator, typename PopTypeRHS = PopTypeLHS, typename... Args>
     void binary_numeric_operation(Configuration&, Args&&...);
@@ -76,6 +86,15 @@ protected:
     template<typename PopType, typename PushType, typename Operator, typename... Args>
     void unary_operation(Configuration&, Args&&...);
 
+    template<typename PopType, typename PushType, typename Operator>
+    void binary_register_operation(Value* registers, RegisterInstruction const&);
+    template<typename PopType, typename PushType, typename Operator>
+    void unary_register_operation(Value* registers, RegisterInstruction const&);
+    template<typename ReadType, typename PushType>
+    void load_into_register(Configuration&, Value* registers, RegisterInstruction const&);
+    template<typename PopType, typename StoreType>
+    void store_from_register(Configuration&, Value* registers, RegisterInstruction const&);
+
     template<typename T>
     T read_value(ReadonlyBytes data);
 
@@ -88,12 +107,18 @@ protected:
 
     Variant<Trap, JS::Completion, Empty> m_trap;
     StackInfo const& m_stack_info;
+
+    // Functions that were lowered to register bytecode run on that, unless this is cleared.
+    bool m_use_register_bytecode { true };
+    bool m_use_native_code { true };
 };
 
 struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
     DebuggerBytecodeInterpreter(StackInfo const& stack_info)
         : BytecodeInterpreter(stack_info)
     {
+        // The hooks want to see every instruction of the original function body.
+        m_use_register_bytecode = false;
     }
     virtual ~DebuggerBytecodeInterpreter() override = default;
 
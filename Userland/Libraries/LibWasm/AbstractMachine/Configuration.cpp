@@ -24,8 +24,10 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
     if (!function)
         return Trap {};
     if (auto* wasm_function = function->get_pointer<WasmFunction>()) {
+        auto const* register_function = wasm_function->register_function();
         Vector<Value> locals = move(arguments);
-        locals.ensure_capacity(locals.size() + wasm_function->code().func().locals().size());
+        // NOTE: Register bytecode uses the locals as the start of its register file, so make room for all of it.
+        locals.ensure_capacity(register_function ? register_function->register_count() : locals.size() + wasm_function->code().func().locals().size());
         for (auto& local : wasm_function->code().func().locals()) {
             for (size_t i = 0; i < local.n(); ++i)
                 locals.append(Value());
@@ -36,6 +38,7 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
             move(locals),
             wasm_function->code().func().body(),
             wasm_function->type().results().size(),
+            register_function,
         });
         m_ip = 0;
         return execute(interpreter);
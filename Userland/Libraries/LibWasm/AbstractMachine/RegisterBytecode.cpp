@@ -0,0 +1,625 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Checked.h>
+#include <AK/Debug.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashMap.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/RegisterBytecode.h>
+#include <LibWasm/JIT/Compiler.h>
+#include <LibWasm/JIT/NativeFunction.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+// Operands referring to a constant are tagged with this bit while lowering, since the constants are placed after
+// the value stack slots, and the number of those isn't known until the whole function has been seen.
+static constexpr u32 constant_register_tag = 1u << 31;
+
+struct ConstantTraits : public DefaultTraits<u128> {
+    static unsigned hash(u128 value) { return pair_int_hash(u64_hash(value.low()), u64_hash(value.high())); }
+};
+
+class RegisterBytecodeLowering {
+public:
+    RegisterBytecodeLowering(Module const& module, Vector<FunctionType const*> const& function_types)
+        : m_module(module)
+        , m_function_types(function_types)
+    {
+    }
+
+    RefPtr<RegisterFunction> lower(CodeSection::Code const&, FunctionType const&);
+
+private:
+    using Type = RegisterInstruction::Type;
+
+    struct ControlFrame {
+        enum class Kind {
+            Function,
+            Block,
+            Loop,
+            If,
+        };
+
+        Kind kind;
+        // The height of the value stack below the block's parameters.
+        size_t height { 0 };
+        size_t parameter_count { 0 };
+        size_t result_count { 0 };
+        size_t loop_start { 0 };
+        Vector<size_t> jumps_to_end {};
+        Vector<size_t> branch_targets_to_end {};
+        Optional<size_t> jump_to_else {};
+        bool reachable { true };
+
+        size_t label_arity() const { return kind == Kind::Loop ? parameter_count : result_count; }
+    };
+
+    bool lower_instruction(Instruction const&);
+    void begin_block(ControlFrame::Kind, BlockType const&);
+    void end_block();
+
+    u32 stack_register(size_t height) const { return static_cast<u32>(m_local_count + height); }
+    u32 constant_register(u128 value);
+
+    void push(u32 reg);
+    u32 push_result();
+    u32 pop() { return m_stack.take_last(); }
+
+    void materialize(size_t index);
+    void materialize_all();
+    void materialize_uses_of(u32 reg);
+
+    size_t current_ip() const { return m_function->m_instructions.size(); }
+    size_t emit(RegisterInstruction);
+    size_t emit_producer(RegisterInstruction);
+    void mark_label() { m_last_producer.clear(); }
+
+    u32 pop_condition(bool& inverted);
+    RegisterBranchTarget branch_target(ControlFrame const&) const;
+    void emit_branch(size_t depth);
+    void emit_branch_if(size_t depth);
+    void emit_branch_table(Instruction::TableBranchArgs const&);
+    void set_local(u32 local);
+    void patch_jump(size_t instruction_index, size_t target) { m_function->m_instructions[instruction_index].immediate = target; }
+
+    Module const& m_module;
+    Vector<FunctionType const*> const& m_function_types;
+
+    RefPtr<RegisterFunction> m_function;
+    size_t m_local_count { 0 };
+    size_t m_max_stack_height { 0 };
+    Vector<u32> m_stack;
+    Vector<ControlFrame> m_frames;
+    HashMap<u128, u32, ConstantTraits> m_constant_indices;
+    Optional<size_t> m_last_producer;
+    bool m_reachable { true };
+};
+
+RegisterFunction::~RegisterFunction() = default;
+
+Vector<RefPtr<RegisterFunction const>> RegisterFunction::lower_module(Module const& module, CompileToNativeCode compile_to_native_code)
+{
+    VERIFY(module.validation_status() == Module::ValidationStatus::Valid);
+
+    auto& types = module.type_section().types();
+    Vector<FunctionType const*> function_types;
+    for (auto& import_ : module.import_section().imports()) {
+        import_.description().visit(
+            [&](TypeIndex const& index) { function_types.append(&types[index.value()]); },
+            [&](FunctionType const& type) { function_types.append(&type); },
+            [](auto const&) {});
+    }
+    for (auto& index : module.function_section().types())
+        function_types.append(&types[index.value()]);
+
+    auto imported_function_count = function_types.size() - module.function_section().types().size();
+
+    Vector<RefPtr<RegisterFunction const>> functions;
+    functions.ensure_capacity(module.code_section().functions().size());
+    for (size_t i = 0; i < module.code_section().functions().size(); ++i) {
+        auto& code = module.code_section().functions()[i];
+        RegisterBytecodeLowering lowering { module, function_types };
+        auto function = lowering.lower(code, *function_types[imported_function_count + i]);
+        if (function && compile_to_native_code == CompileToNativeCode::Yes)
+            function->m_native_function = JIT::Compiler::compile(*function);
+        functions.unchecked_append(move(function));
+    }
+    return functions;
+}
+
+RefPtr<RegisterFunction> RegisterBytecodeLowering::lower(CodeSection::Code const& code, FunctionType const& type)
+{
+    m_function = adopt_ref(*new RegisterFunction);
+
+    Checked<size_t> local_count = type.parameters().size();
+    for (auto& locals : code.func().locals())
+        local_count += locals.n();
+    if (local_count.has_overflow() || local_count.value() >= constant_register_tag)
+        return nullptr;
+    m_local_count = local_count.value();
+
+    m_frames.append({ .kind = ControlFrame::Kind::Function, .result_count = type.results().size() });
+
+    for (auto& instruction : code.func().body().instructions()) {
+        if (!lower_instruction(instruction)) {
+            dbgln_if(WASM_TRACE_DEBUG, "No register form for {}, keeping the function on the stack machine", instruction_name(instruction.opcode()));
+            return nullptr;
+        }
+    }
+
+    // The implicit end of the function body.
+    VERIFY(m_frames.size() == 1);
+    if (m_reachable)
+        materialize_all();
+    auto& function_frame = m_frames.last();
+    for (auto jump : function_frame.jumps_to_end)
+        patch_jump(jump, current_ip());
+    for (auto index : function_frame.branch_targets_to_end)
+        m_function->m_branch_targets[index].target = current_ip();
+    emit({ .type = Type::Return, .a = stack_register(0), .b = static_cast<u32>(function_frame.result_count) });
+
+    if (m_local_count + m_max_stack_height + m_constant_indices.size() >= constant_register_tag)
+        return nullptr;
+
+    m_function->m_local_count = m_local_count;
+    m_function->m_stack_slot_count = m_max_stack_height;
+
+    auto constants_base = static_cast<u32>(m_function->constants_base());
+    auto resolve = [&](u32& operand) {
+        if (operand & constant_register_tag)
+            operand = constants_base + (operand & ~constant_register_tag);
+    };
+    for (auto& instruction : m_function->m_instructions) {
+        resolve(instruction.a);
+        resolve(instruction.b);
+        resolve(instruction.c);
+    }
+
+    return move(m_function);
+}
+
+bool RegisterBytecodeLowering::lower_instruction(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    if (!m_reachable) {
+        // Skip over dead code, keeping track of the blocks in it so we know which `end` brings us back.
+        switch (opcode.value()) {
+        case Instructions::block.value():
+        case Instructions::loop.value():
+        case Instructions::if_.value():
+            m_frames.append({ .kind = ControlFrame::Kind::Block, .height = m_stack.size(), .reachable = false });
+            return true;
+        case Instructions::structured_else.value():
+        case Instructions::structured_end.value():
+            break;
+        default:
+            return true;
+        }
+    }
+
+    switch (opcode.value()) {
+    case Instructions::unreachable.value():
+        emit({ .type = Type::Unreachable });
+        m_reachable = false;
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+        begin_block(ControlFrame::Kind::Block, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+        return true;
+    case Instructions::loop.value():
+        begin_block(ControlFrame::Kind::Loop, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+        return true;
+    case Instructions::if_.value():
+        begin_block(ControlFrame::Kind::If, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+        return true;
+    case Instructions::structured_else.value(): {
+        auto& frame = m_frames.last();
+        if (m_reachable) {
+            materialize_all();
+            frame.jumps_to_end.append(emit({ .type = Type::Jump }));
+        }
+        if (frame.jump_to_else.has_value()) {
+            patch_jump(*frame.jump_to_else, current_ip());
+            frame.jump_to_else.clear();
+        }
+        m_stack.shrink(frame.height);
+        for (size_t i = 0; i < frame.parameter_count; ++i)
+            push(stack_register(m_stack.size()));
+        m_reachable = frame.reachable;
+        mark_label();
+        return true;
+    }
+    case Instructions::structured_end.value():
+        end_block();
+        return true;
+    case Instructions::br.value():
+        emit_branch(instruction.arguments().get<LabelIndex>().value());
+        m_reachable = false;
+        return true;
+    case Instructions::br_if.value():
+        emit_branch_if(instruction.arguments().get<LabelIndex>().value());
+        return true;
+    case Instructions::br_table.value():
+        emit_branch_table(instruction.arguments().get<Instruction::TableBranchArgs>());
+        m_reachable = false;
+        return true;
+    case Instructions::return_.value(): {
+        materialize_all();
+        auto result_count = m_frames.first().result_count;
+        emit({ .type = Type::Return, .a = stack_register(m_stack.size() - result_count), .b = static_cast<u32>(result_count) });
+        m_reachable = false;
+        return true;
+    }
+    case Instructions::call.value():
+    case Instructions::call_indirect.value(): {
+        FunctionType const* type;
+        u32 index_register = 0;
+        u64 immediate;
+        if (opcode == Instructions::call) {
+            auto index = instruction.arguments().get<FunctionIndex>();
+            type = m_function_types[index.value()];
+            immediate = index.value();
+        } else {
+            auto& args = instruction.arguments().get<Instruction::IndirectCallArgs>();
+            type = &m_module.type_section().types()[args.type.value()];
+            immediate = (static_cast<u64>(args.type.value()) << 32) | args.table.value();
+            index_register = pop();
+        }
+
+        // The arguments have to be in consecutive registers, the results are written back over them.
+        auto parameter_count = type->parameters().size();
+        auto result_count = type->results().size();
+        for (size_t i = m_stack.size() - parameter_count; i < m_stack.size(); ++i)
+            materialize(i);
+        auto base = stack_register(m_stack.size() - parameter_count);
+        m_stack.shrink(m_stack.size() - parameter_count);
+        for (size_t i = 0; i < result_count; ++i)
+            push_result();
+
+        emit({
+            .type = opcode == Instructions::call ? Type::Call : Type::CallIndirect,
+            .dst = base,
+            .a = static_cast<u32>(parameter_count),
+            .b = static_cast<u32>(result_count),
+            .c = index_register,
+            .immediate = immediate,
+        });
+        return true;
+    }
+    case Instructions::drop.value():
+        pop();
+        return true;
+    case Instructions::select.value():
+    case Instructions::select_typed.value(): {
+        auto condition = pop();
+        auto rhs = pop();
+        auto lhs = pop();
+        emit_producer({ .type = Type::Select, .dst = push_result(), .a = lhs, .b = rhs, .c = condition });
+        return true;
+    }
+    case Instructions::local_get.value():
+        push(instruction.arguments().get<LocalIndex>().value());
+        return true;
+    case Instructions::local_set.value():
+        set_local(instruction.arguments().get<LocalIndex>().value());
+        return true;
+    case Instructions::local_tee.value(): {
+        auto local = instruction.arguments().get<LocalIndex>().value();
+        set_local(local);
+        push(local);
+        return true;
+    }
+    case Instructions::global_get.value():
+        emit_producer({ .type = Type::GlobalGet, .dst = push_result(), .immediate = instruction.arguments().get<GlobalIndex>().value() });
+        return true;
+    case Instructions::global_set.value():
+        emit({ .type = Type::GlobalSet, .a = pop(), .immediate = instruction.arguments().get<GlobalIndex>().value() });
+        return true;
+    case Instructions::memory_size.value(): {
+        auto memory_index = static_cast<u32>(instruction.arguments().get<Instruction::MemoryIndexArgument>().memory_index.value());
+        emit_producer({ .type = Type::MemorySize, .dst = push_result(), .c = memory_index });
+        return true;
+    }
+    case Instructions::memory_grow.value(): {
+        auto memory_index = static_cast<u32>(instruction.arguments().get<Instruction::MemoryIndexArgument>().memory_index.value());
+        auto pages = pop();
+        emit_producer({ .type = Type::MemoryGrow, .dst = push_result(), .a = pages, .c = memory_index });
+        return true;
+    }
+    case Instructions::i32_const.value():
+        push(constant_register(Value(instruction.arguments().get<i32>()).value()));
+        return true;
+    case Instructions::i64_const.value():
+        push(constant_register(Value(instruction.arguments().get<i64>()).value()));
+        return true;
+    case Instructions::f32_const.value():
+        push(constant_register(Value(instruction.arguments().get<float>()).value()));
+        return true;
+    case Instructions::f64_const.value():
+        push(constant_register(Value(instruction.arguments().get<double>()).value()));
+        return true;
+
+#define __LOWER_BINARY_OPERATION(name, ...)                                              \
+    case Instructions::name.value(): {                                                   \
+        auto rhs = pop();                                                                \
+        auto lhs = pop();                                                                \
+        emit_producer({ .type = Type::name, .dst = push_result(), .a = lhs, .b = rhs }); \
+        return true;                                                                     \
+    }
+        ENUMERATE_WASM_REGISTER_BINARY_OPERATIONS(__LOWER_BINARY_OPERATION)
+#undef __LOWER_BINARY_OPERATION
+
+#define __LOWER_UNARY_OPERATION(name, ...)                                         \
+    case Instructions::name.value(): {                                             \
+        auto operand = pop();                                                      \
+        emit_producer({ .type = Type::name, .dst = push_result(), .a = operand }); \
+        return true;                                                               \
+    }
+        ENUMERATE_WASM_REGISTER_UNARY_OPERATIONS(__LOWER_UNARY_OPERATION)
+#undef __LOWER_UNARY_OPERATION
+
+#define __LOWER_LOAD(name, ...)                                                                                                                                                      \
+    case Instructions::name.value(): {                                                                                                                                               \
+        auto& memory_argument = instruction.arguments().get<Instruction::MemoryArgument>();                                                                                          \
+        auto address = pop();                                                                                                                                                        \
+        emit_producer({ .type = Type::name, .dst = push_result(), .a = address, .c = static_cast<u32>(memory_argument.memory_index.value()), .immediate = memory_argument.offset }); \
+        return true;                                                                                                                                                                 \
+    }
+        ENUMERATE_WASM_REGISTER_LOADS(__LOWER_LOAD)
+#undef __LOWER_LOAD
+
+#define __LOWER_STORE(name, ...)                                                                                                                                  \
+    case Instructions::name.value(): {                                                                                                                            \
+        auto& memory_argument = instruction.arguments().get<Instruction::MemoryArgument>();                                                                       \
+        auto value = pop();                                                                                                                                       \
+        auto address = pop();                                                                                                                                     \
+        emit({ .type = Type::name, .a = address, .b = value, .c = static_cast<u32>(memory_argument.memory_index.value()), .immediate = memory_argument.offset }); \
+        return true;                                                                                                                                              \
+    }
+        ENUMERATE_WASM_REGISTER_STORES(__LOWER_STORE)
+#undef __LOWER_STORE
+
+    default:
+        return false;
+    }
+}
+
+void RegisterBytecodeLowering::begin_block(ControlFrame::Kind kind, BlockType const& block_type)
+{
+    size_t parameter_count = 0;
+    size_t result_count = 0;
+    switch (block_type.kind()) {
+    case BlockType::Empty:
+        break;
+    case BlockType::Type:
+        result_count = 1;
+        break;
+    case BlockType::Index: {
+        auto& type = m_module.type_section().types()[block_type.type_index().value()];
+        parameter_count = type.parameters().size();
+        result_count = type.results().size();
+        break;
+    }
+    }
+
+    bool inverted = false;
+    Optional<u32> condition;
+    if (kind == ControlFrame::Kind::If)
+        condition = pop_condition(inverted);
+
+    // Every path into or out of a block has to agree on where the values on the stack live.
+    materialize_all();
+
+    ControlFrame frame {
+        .kind = kind,
+        .height = m_stack.size() - parameter_count,
+        .parameter_count = parameter_count,
+        .result_count = result_count,
+    };
+
+    if (kind == ControlFrame::Kind::Loop) {
+        frame.loop_start = current_ip();
+        mark_label();
+    } else if (kind == ControlFrame::Kind::If) {
+        frame.jump_to_else = emit({ .type = inverted ? Type::JumpIfNotZero : Type::JumpIfZero, .a = *condition });
+    }
+
+    m_frames.append(move(frame));
+}
+
+void RegisterBytecodeLowering::end_block()
+{
+    if (m_reachable)
+        materialize_all();
+
+    auto frame = m_frames.take_last();
+    if (frame.jump_to_else.has_value())
+        patch_jump(*frame.jump_to_else, current_ip());
+    for (auto jump : frame.jumps_to_end)
+        patch_jump(jump, current_ip());
+    for (auto index : frame.branch_targets_to_end)
+        m_function->m_branch_targets[index].target = current_ip();
+
+    m_stack.shrink(frame.height);
+    for (size_t i = 0; i < frame.result_count; ++i)
+        push(stack_register(m_stack.size()));
+    m_reachable = frame.reachable;
+    mark_label();
+}
+
+u32 RegisterBytecodeLowering::constant_register(u128 value)
+{
+    auto index = m_constant_indices.ensure(value, [&] {
+        m_function->m_constants.append(value);
+        return static_cast<u32>(m_function->m_constants.size() - 1);
+    });
+    return index | constant_register_tag;
+}
+
+void RegisterBytecodeLowering::push(u32 reg)
+{
+    m_stack.append(reg);
+    m_max_stack_height = max(m_max_stack_height, m_stack.size());
+}
+
+u32 RegisterBytecodeLowering::push_result()
+{
+    auto reg = stack_register(m_stack.size());
+    push(reg);
+    return reg;
+}
+
+void RegisterBytecodeLowering::materialize(size_t index)
+{
+    auto reg = stack_register(index);
+    if (m_stack[index] == reg)
+        return;
+    emit({ .type = Type::Copy, .dst = reg, .a = m_stack[index] });
+    m_stack[index] = reg;
+}
+
+void RegisterBytecodeLowering::materialize_all()
+{
+    for (size_t i = 0; i < m_stack.size(); ++i)
+        materialize(i);
+}
+
+void RegisterBytecodeLowering::materialize_uses_of(u32 reg)
+{
+    for (size_t i = 0; i < m_stack.size(); ++i) {
+        if (m_stack[i] == reg)
+            materialize(i);
+    }
+}
+
+size_t RegisterBytecodeLowering::emit(RegisterInstruction instruction)
+{
+    m_last_producer.clear();
+    m_function->m_instructions.append(instruction);
+    return m_function->m_instructions.size() - 1;
+}
+
+size_t RegisterBytecodeLowering::emit_producer(RegisterInstruction instruction)
+{
+    auto index = emit(instruction);
+    m_last_producer = index;
+    return index;
+}
+
+// Pops the condition of a conditional branch. If it was computed by an `eqz` right before, that is dropped, and
+// the branch tests its operand with the opposite polarity instead.
+u32 RegisterBytecodeLowering::pop_condition(bool& inverted)
+{
+    auto condition = pop();
+    inverted = false;
+    if (!m_last_producer.has_value() || *m_last_producer != m_function->m_instructions.size() - 1)
+        return condition;
+
+    auto& producer = m_function->m_instructions.last();
+    if (producer.type != Type::i32_eqz || producer.dst != condition || condition != stack_register(m_stack.size()))
+        return condition;
+
+    auto operand = producer.a;
+    m_function->m_instructions.take_last();
+    m_last_producer.clear();
+    inverted = true;
+    return operand;
+}
+
+RegisterBranchTarget RegisterBytecodeLowering::branch_target(ControlFrame const& frame) const
+{
+    auto arity = frame.label_arity();
+    return {
+        .target = static_cast<u32>(frame.kind == ControlFrame::Kind::Loop ? frame.loop_start : 0),
+        .destination = stack_register(frame.height),
+        .source = stack_register(m_stack.size() - arity),
+        .count = static_cast<u32>(arity),
+    };
+}
+
+void RegisterBytecodeLowering::emit_branch(size_t depth)
+{
+    materialize_all();
+
+    auto& frame = m_frames[m_frames.size() - 1 - depth];
+    auto target = branch_target(frame);
+    if (target.count != 0 && target.destination != target.source)
+        emit({ .type = Type::CopyRange, .dst = target.destination, .a = target.source, .b = target.count });
+
+    auto jump = emit({ .type = Type::Jump, .immediate = target.target });
+    if (frame.kind != ControlFrame::Kind::Loop)
+        frame.jumps_to_end.append(jump);
+}
+
+void RegisterBytecodeLowering::emit_branch_if(size_t depth)
+{
+    bool inverted = false;
+    auto condition = pop_condition(inverted);
+    materialize_all();
+
+    auto& frame = m_frames[m_frames.size() - 1 - depth];
+    auto target = branch_target(frame);
+    if (target.count != 0 && target.destination != target.source) {
+        // The values carried by the branch have to be moved first, so skip over that when not taking it.
+        auto skip = emit({ .type = inverted ? Type::JumpIfNotZero : Type::JumpIfZero, .a = condition });
+        emit_branch(depth);
+        patch_jump(skip, current_ip());
+        mark_label();
+        return;
+    }
+
+    auto jump = emit({ .type = inverted ? Type::JumpIfZero : Type::JumpIfNotZero, .a = condition, .immediate = target.target });
+    if (frame.kind != ControlFrame::Kind::Loop)
+        frame.jumps_to_end.append(jump);
+}
+
+void RegisterBytecodeLowering::emit_branch_table(Instruction::TableBranchArgs const& args)
+{
+    auto index = pop();
+    materialize_all();
+
+    auto& branch_targets = m_function->m_branch_targets;
+    auto first_target = branch_targets.size();
+    auto add_target = [&](LabelIndex label) {
+        auto& frame = m_frames[m_frames.size() - 1 - label.value()];
+        if (frame.kind != ControlFrame::Kind::Loop)
+            frame.branch_targets_to_end.append(branch_targets.size());
+        branch_targets.append(branch_target(frame));
+    };
+    for (auto label : args.labels)
+        add_target(label);
+    add_target(args.default_);
+
+    emit({ .type = Type::BranchTable, .a = index, .b = static_cast<u32>(args.labels.size()), .immediate = first_target });
+}
+
+void RegisterBytecodeLowering::set_local(u32 local)
+{
+    auto value = pop();
+    if (value == local)
+        return;
+
+    // If the value was just computed into its stack slot, and nothing else on the stack still needs the old value
+    // of the local, have the instruction that computed it write to the local directly.
+    if (m_last_producer.has_value() && *m_last_producer == m_function->m_instructions.size() - 1 && !m_stack.contains_slow(local)) {
+        auto& producer = m_function->m_instructions.last();
+        if (producer.dst == value && value == stack_register(m_stack.size())) {
+            producer.dst = local;
+            m_last_producer.clear();
+            return;
+        }
+    }
+
+    materialize_uses_of(local);
+    emit({ .type = Type::Copy, .dst = local, .a = value });
+}
+
+}
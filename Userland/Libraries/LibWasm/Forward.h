@@ -9,10 +9,19 @@
 namespace Wasm {
 
 class AbstractMachine;
+class Configuration;
+class RegisterFunction;
 class Validator;
+struct BytecodeInterpreter;
 struct ValidationError;
 struct Interpreter;
 
+namespace JIT {
+class Compiler;
+class NativeFunction;
+struct RuntimeContext;
+}
+
 namespace Wasi {
 struct Implementation;
 }
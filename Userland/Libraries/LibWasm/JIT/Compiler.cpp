@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BitCast.h>
+#include <AK/Debug.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/JIT/Compiler.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifdef JIT_ARCH_SUPPORTED
+
+namespace Wasm::JIT {
+
+using Assembler = ::JIT::Assembler;
+
+// Pinned for the whole lifetime of the native code (all of these are callee-saved).
+static constexpr auto REGISTER_FILE = Assembler::Reg::RBX;
+static constexpr auto CONTEXT = Assembler::Reg::R14;
+static constexpr auto MEMORY_BASE = Assembler::Reg::R15;
+// NOTE: Never used as the base of a memory operand, as that would need a SIB byte or a displacement.
+static constexpr auto MEMORY_SIZE = Assembler::Reg::R13;
+
+static constexpr auto ARG0 = Assembler::Reg::RDI;
+static constexpr auto ARG1 = Assembler::Reg::RSI;
+static constexpr auto RET = Assembler::Reg::RAX;
+
+static constexpr auto GPR0 = Assembler::Reg::RAX;
+// Shift counts have to be in here.
+static constexpr auto GPR1 = Assembler::Reg::RCX;
+// Clobbered by store_result() and the bounds checks.
+static constexpr auto GPR2 = Assembler::Reg::RDX;
+
+static constexpr auto FPR0 = Assembler::Reg::XMM0;
+static constexpr auto FPR1 = Assembler::Reg::XMM1;
+
+// Numeric values live in the low half of a Value, the high half is always zero for them.
+static_assert(sizeof(Value) == 2 * sizeof(u64));
+
+static Assembler::Operand low_half(u32 index)
+{
+    return Assembler::Operand::Mem64BaseAndOffset(REGISTER_FILE, index * sizeof(Value));
+}
+
+static Assembler::Operand high_half(u32 index)
+{
+    return Assembler::Operand::Mem64BaseAndOffset(REGISTER_FILE, index * sizeof(Value) + sizeof(u64));
+}
+
+static Assembler::Operand context_field(size_t offset)
+{
+    return Assembler::Operand::Mem64BaseAndOffset(CONTEXT, offset);
+}
+
+void Compiler::load_i32(Assembler::Reg dst, u32 source, Assembler::Extension extension)
+{
+    m_assembler.mov32(Assembler::Operand::Register(dst), low_half(source), extension);
+}
+
+void Compiler::load_i64(Assembler::Reg dst, u32 source)
+{
+    m_assembler.mov(Assembler::Operand::Register(dst), low_half(source));
+}
+
+void Compiler::store_result(u32 destination, Assembler::Reg value)
+{
+    m_assembler.mov(low_half(destination), Assembler::Operand::Register(value));
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(0));
+    m_assembler.mov(high_half(destination), Assembler::Operand::Register(GPR2));
+}
+
+void Compiler::reload_context()
+{
+    m_assembler.mov(Assembler::Operand::Register(REGISTER_FILE), context_field(offsetof(RuntimeContext, registers)));
+    m_assembler.mov(Assembler::Operand::Register(MEMORY_BASE), context_field(offsetof(RuntimeContext, memory_base)));
+    m_assembler.mov(Assembler::Operand::Register(MEMORY_SIZE), context_field(offsetof(RuntimeContext, memory_size)));
+}
+
+// Loops are the only way to run for a long time without calling out of native code, so the instruction count limit
+// is enforced by counting backward branches.
+void Compiler::count_backward_branch_to(u64 target)
+{
+    if (target > m_current_index)
+        return;
+    m_assembler.sub(context_field(offsetof(RuntimeContext, remaining_backward_branches)), Assembler::Operand::Imm(1));
+    m_assembler.jump_if(Assembler::Condition::SignedLessThan, m_instruction_limit_label);
+}
+
+void Compiler::compile_copy(u32 destination, u32 source)
+{
+    if (destination == source)
+        return;
+    m_assembler.mov(Assembler::Operand::Register(GPR0), low_half(source));
+    m_assembler.mov(Assembler::Operand::Register(GPR1), high_half(source));
+    m_assembler.mov(low_half(destination), Assembler::Operand::Register(GPR0));
+    m_assembler.mov(high_half(destination), Assembler::Operand::Register(GPR1));
+}
+
+void Compiler::compile_jump(RegisterInstruction const& instruction)
+{
+    count_backward_branch_to(instruction.immediate);
+    m_assembler.jump(m_instruction_labels[instruction.immediate]);
+}
+
+void Compiler::compile_conditional_jump(RegisterInstruction const& instruction, Assembler::Condition condition)
+{
+    count_backward_branch_to(instruction.immediate);
+    load_i32(GPR0, instruction.a, Assembler::Extension::ZeroExtend);
+    m_assembler.cmp(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(0));
+    m_assembler.jump_if(condition, m_instruction_labels[instruction.immediate]);
+}
+
+void Compiler::compile_branch(RegisterBranchTarget const& target)
+{
+    count_backward_branch_to(target.target);
+    for (u32 i = 0; i < target.count; ++i)
+        compile_copy(target.destination + i, target.source + i);
+    m_assembler.jump(m_instruction_labels[target.target]);
+}
+
+void Compiler::compile_branch_table(RegisterInstruction const& instruction)
+{
+    auto& targets = m_function.branch_targets();
+
+    // NOTE: Only the branch actually taken clobbers GPR0, so it keeps the index for all of the comparisons.
+    load_i32(GPR0, instruction.a, Assembler::Extension::ZeroExtend);
+    for (u32 i = 0; i < instruction.b; ++i) {
+        Assembler::Label next;
+        m_assembler.jump_if(Assembler::Operand::Register(GPR0), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(i), next);
+        compile_branch(targets[instruction.immediate + i]);
+        next.link(m_assembler);
+    }
+    compile_branch(targets[instruction.immediate + instruction.b]);
+}
+
+void Compiler::compile_select(RegisterInstruction const& instruction)
+{
+    Assembler::Label use_rhs;
+    Assembler::Label done;
+    load_i32(GPR0, instruction.c, Assembler::Extension::ZeroExtend);
+    m_assembler.jump_if(Assembler::Operand::Register(GPR0), Assembler::Condition::EqualTo, Assembler::Operand::Imm(0), use_rhs);
+    compile_copy(instruction.dst, instruction.a);
+    m_assembler.jump(done);
+    use_rhs.link(m_assembler);
+    compile_copy(instruction.dst, instruction.b);
+    done.link(m_assembler);
+}
+
+void Compiler::compile_i32_binary_operation(RegisterInstruction const& instruction)
+{
+    auto lhs = Assembler::Operand::Register(GPR0);
+    auto rhs = Assembler::Operand::Register(GPR1);
+    load_i32(GPR0, instruction.a);
+    load_i32(GPR1, instruction.b);
+
+    // NOTE: The 32-bit shifts only look at the low 5 bits of the count, just like Wasm wants.
+    switch (instruction.type) {
+    case Type::i32_add:
+        m_assembler.add32(lhs, rhs, {});
+        break;
+    case Type::i32_sub:
+        m_assembler.sub32(lhs, rhs, {});
+        break;
+    case Type::i32_mul:
+        m_assembler.mul32(lhs, rhs, {});
+        break;
+    case Type::i32_and:
+        m_assembler.bitwise_and(lhs, rhs);
+        break;
+    case Type::i32_or:
+        m_assembler.bitwise_or(lhs, rhs);
+        break;
+    case Type::i32_xor:
+        m_assembler.bitwise_xor32(lhs, rhs);
+        break;
+    case Type::i32_shl:
+        m_assembler.shift_left32(lhs, {});
+        break;
+    case Type::i32_shrs:
+        m_assembler.arithmetic_right_shift32(lhs, {});
+        break;
+    case Type::i32_shru:
+        m_assembler.shift_right32(lhs, {});
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    m_assembler.sign_extend_32_to_64_bits(GPR0);
+    store_result(instruction.dst, GPR0);
+}
+
+void Compiler::compile_i64_binary_operation(RegisterInstruction const& instruction)
+{
+    auto lhs = Assembler::Operand::Register(GPR0);
+    auto rhs = Assembler::Operand::Register(GPR1);
+    load_i64(GPR0, instruction.a);
+    load_i64(GPR1, instruction.b);
+
+    switch (instruction.type) {
+    case Type::i64_add:
+        m_assembler.add(lhs, rhs);
+        break;
+    case Type::i64_sub:
+        m_assembler.sub(lhs, rhs);
+        break;
+    case Type::i64_mul:
+        m_assembler.mul(lhs, rhs);
+        break;
+    case Type::i64_and:
+        m_assembler.bitwise_and(lhs, rhs);
+        break;
+    case Type::i64_or:
+        m_assembler.bitwise_or(lhs, rhs);
+        break;
+    case Type::i64_xor:
+        m_assembler.bitwise_xor(lhs, rhs);
+        break;
+    case Type::i64_shl:
+        m_assembler.shift_left(lhs, {});
+        break;
+    case Type::i64_shrs:
+        m_assembler.arithmetic_right_shift(lhs, {});
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    store_result(instruction.dst, GPR0);
+}
+
+void Compiler::compile_f64_binary_operation(RegisterInstruction const& instruction)
+{
+    auto lhs = Assembler::Operand::FloatRegister(FPR0);
+    auto rhs = Assembler::Operand::FloatRegister(FPR1);
+    m_assembler.mov(lhs, low_half(instruction.a));
+    m_assembler.mov(rhs, low_half(instruction.b));
+
+    switch (instruction.type) {
+    case Type::f64_add:
+        m_assembler.add(lhs, rhs);
+        break;
+    case Type::f64_sub:
+        m_assembler.sub(lhs, rhs);
+        break;
+    case Type::f64_mul:
+        m_assembler.mul(lhs, rhs);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    m_assembler.mov(Assembler::Operand::Register(GPR0), lhs);
+    store_result(instruction.dst, GPR0);
+}
+
+void Compiler::compile_comparison(RegisterInstruction const& instruction, Assembler::Condition condition, Assembler::Extension extension, bool is_64_bit)
+{
+    // NOTE: Clearing GPR2 clobbers the flags, so it has to happen before the comparison.
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(0));
+    if (is_64_bit) {
+        load_i64(GPR0, instruction.a);
+        load_i64(GPR1, instruction.b);
+    } else {
+        load_i32(GPR0, instruction.a, extension);
+        load_i32(GPR1, instruction.b, extension);
+    }
+    m_assembler.cmp(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR1));
+    m_assembler.set_if(condition, Assembler::Operand::Register(GPR2));
+    store_result(instruction.dst, GPR2);
+}
+
+void Compiler::compile_eqz(RegisterInstruction const& instruction, bool is_64_bit)
+{
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(0));
+    if (is_64_bit)
+        load_i64(GPR0, instruction.a);
+    else
+        load_i32(GPR0, instruction.a, Assembler::Extension::ZeroExtend);
+    m_assembler.cmp(Assembler::Operand::Register(GPR0), Assembler::Operand::Imm(0));
+    m_assembler.set_if(Assembler::Condition::EqualTo, Assembler::Operand::Register(GPR2));
+    store_result(instruction.dst, GPR2);
+}
+
+// Leaves the native address of the access in GPR0, or leaves native code if any of it is out of bounds.
+void Compiler::compute_effective_address(RegisterInstruction const& instruction, size_t access_size)
+{
+    // NOTE: The address is a u32 and the offset fits in one as well, so none of this can overflow.
+    load_i32(GPR0, instruction.a, Assembler::Extension::ZeroExtend);
+    if (instruction.immediate != 0) {
+        m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(instruction.immediate));
+        m_assembler.add(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(GPR2));
+    }
+    m_assembler.mov(Assembler::Operand::Register(GPR2), Assembler::Operand::Register(GPR0));
+    m_assembler.add(Assembler::Operand::Register(GPR2), Assembler::Operand::Imm(access_size));
+    m_assembler.jump_if(Assembler::Operand::Register(GPR2), Assembler::Condition::UnsignedGreaterThan, Assembler::Operand::Register(MEMORY_SIZE), m_out_of_bounds_label);
+    m_assembler.add(Assembler::Operand::Register(GPR0), Assembler::Operand::Register(MEMORY_BASE));
+}
+
+void Compiler::compile_load(RegisterInstruction const& instruction)
+{
+    if (instruction.c != 0)
+        return compile_slow_path(instruction);
+
+    auto value = Assembler::Operand::Register(GPR1);
+    auto address = Assembler::Operand::Mem64BaseAndOffset(GPR0, 0);
+
+    // NOTE: Values of 32-bit types are kept sign-extended to 64 bits, see Value's constructors.
+    switch (instruction.type) {
+    case Type::i32_load:
+    case Type::f32_load:
+        compute_effective_address(instruction, 4);
+        m_assembler.mov32(value, address, Assembler::Extension::SignExtend);
+        break;
+    case Type::i64_load:
+    case Type::f64_load:
+        compute_effective_address(instruction, 8);
+        m_assembler.mov(value, address);
+        break;
+    case Type::i32_load8_s:
+    case Type::i64_load8_s:
+        compute_effective_address(instruction, 1);
+        m_assembler.mov8(value, address, Assembler::Extension::SignExtend);
+        m_assembler.sign_extend_32_to_64_bits(GPR1);
+        break;
+    case Type::i32_load8_u:
+    case Type::i64_load8_u:
+        compute_effective_address(instruction, 1);
+        m_assembler.mov8(value, address, Assembler::Extension::ZeroExtend);
+        break;
+    case Type::i32_load16_s:
+    case Type::i64_load16_s:
+        compute_effective_address(instruction, 2);
+        m_assembler.mov16(value, address, Assembler::Extension::SignExtend);
+        m_assembler.sign_extend_32_to_64_bits(GPR1);
+        break;
+    case Type::i32_load16_u:
+    case Type::i64_load16_u:
+        compute_effective_address(instruction, 2);
+        m_assembler.mov16(value, address, Assembler::Extension::ZeroExtend);
+        break;
+    case Type::i64_load32_s:
+        compute_effective_address(instruction, 4);
+        m_assembler.mov32(value, address, Assembler::Extension::SignExtend);
+        break;
+    case Type::i64_load32_u:
+        compute_effective_address(instruction, 4);
+        m_assembler.mov32(value, address, Assembler::Extension::ZeroExtend);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    store_result(instruction.dst, GPR1);
+}
+
+void Compiler::compile_store(RegisterInstruction const& instruction)
+{
+    if (instruction.c != 0)
+        return compile_slow_path(instruction);
+
+    auto value = Assembler::Operand::Register(GPR1);
+    auto address = Assembler::Operand::Mem64BaseAndOffset(GPR0, 0);
+    load_i64(GPR1, instruction.b);
+
+    switch (instruction.type) {
+    case Type::i32_store:
+    case Type::f32_store:
+    case Type::i64_store32:
+        compute_effective_address(instruction, 4);
+        m_assembler.mov32(address, value);
+        break;
+    case Type::i64_store:
+    case Type::f64_store:
+        compute_effective_address(instruction, 8);
+        m_assembler.mov(address, value);
+        break;
+    case Type::i32_store8:
+    case Type::i64_store8:
+        compute_effective_address(instruction, 1);
+        m_assembler.mov8(address, value);
+        break;
+    case Type::i32_store16:
+    case Type::i64_store16:
+        compute_effective_address(instruction, 2);
+        m_assembler.mov16(address, value);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+u64 Compiler::cxx_execute(RuntimeContext& context, RegisterInstruction const& instruction)
+{
+    auto& interpreter = *context.interpreter;
+    interpreter.execute_register_operation(*context.configuration, context.registers, instruction);
+    if (interpreter.did_trap())
+        return 1;
+    context.refresh();
+    return 0;
+}
+
+void Compiler::compile_slow_path(RegisterInstruction const& instruction)
+{
+    m_assembler.mov(Assembler::Operand::Register(ARG0), Assembler::Operand::Register(CONTEXT));
+    m_assembler.mov(Assembler::Operand::Register(ARG1), Assembler::Operand::Imm(bit_cast<u64>(&instruction)));
+    m_assembler.native_call(bit_cast<u64>(&cxx_execute));
+    m_assembler.jump_if(Assembler::Operand::Register(RET), Assembler::Condition::NotEqualTo, Assembler::Operand::Imm(0), m_trap_label);
+    reload_context();
+}
+
+void Compiler::compile_instruction(RegisterInstruction const& instruction)
+{
+    using Condition = Assembler::Condition;
+    constexpr auto sign_extend = Assembler::Extension::SignExtend;
+    constexpr auto zero_extend = Assembler::Extension::ZeroExtend;
+
+    switch (instruction.type) {
+    case Type::Copy:
+        return compile_copy(instruction.dst, instruction.a);
+    case Type::CopyRange:
+        for (u32 i = 0; i < instruction.b; ++i)
+            compile_copy(instruction.dst + i, instruction.a + i);
+        return;
+    case Type::Jump:
+        return compile_jump(instruction);
+    case Type::JumpIfZero:
+        return compile_conditional_jump(instruction, Condition::EqualTo);
+    case Type::JumpIfNotZero:
+        return compile_conditional_jump(instruction, Condition::NotEqualTo);
+    case Type::BranchTable:
+        return compile_branch_table(instruction);
+    case Type::Return:
+        m_assembler.mov(Assembler::Operand::Register(RET), Assembler::Operand::Imm(m_current_index));
+        m_assembler.jump(m_exit_label);
+        return;
+    case Type::Unreachable:
+        m_assembler.mov(Assembler::Operand::Register(RET), Assembler::Operand::Imm(NativeFunction::unreachable_exit));
+        m_assembler.jump(m_exit_label);
+        return;
+    case Type::Select:
+        return compile_select(instruction);
+
+    case Type::i32_add:
+    case Type::i32_sub:
+    case Type::i32_mul:
+    case Type::i32_and:
+    case Type::i32_or:
+    case Type::i32_xor:
+    case Type::i32_shl:
+    case Type::i32_shrs:
+    case Type::i32_shru:
+        return compile_i32_binary_operation(instruction);
+    case Type::i64_add:
+    case Type::i64_sub:
+    case Type::i64_mul:
+    case Type::i64_and:
+    case Type::i64_or:
+    case Type::i64_xor:
+    case Type::i64_shl:
+    case Type::i64_shrs:
+        return compile_i64_binary_operation(instruction);
+    case Type::f64_add:
+    case Type::f64_sub:
+    case Type::f64_mul:
+        return compile_f64_binary_operation(instruction);
+
+    case Type::i32_eqz:
+        return compile_eqz(instruction, false);
+    case Type::i64_eqz:
+        return compile_eqz(instruction, true);
+    case Type::i32_eq:
+        return compile_comparison(instruction, Condition::EqualTo, zero_extend, false);
+    case Type::i32_ne:
+        return compile_comparison(instruction, Condition::NotEqualTo, zero_extend, false);
+    case Type::i32_lts:
+        return compile_comparison(instruction, Condition::SignedLessThan, sign_extend, false);
+    case Type::i32_ltu:
+        return compile_comparison(instruction, Condition::UnsignedLessThan, zero_extend, false);
+    case Type::i32_gts:
+        return compile_comparison(instruction, Condition::SignedGreaterThan, sign_extend, false);
+    case Type::i32_gtu:
+        return compile_comparison(instruction, Condition::UnsignedGreaterThan, zero_extend, false);
+    case Type::i32_les:
+        return compile_comparison(instruction, Condition::SignedLessThanOrEqualTo, sign_extend, false);
+    case Type::i32_leu:
+        return compile_comparison(instruction, Condition::UnsignedLessThanOrEqualTo, zero_extend, false);
+    case Type::i32_ges:
+        return compile_comparison(instruction, Condition::SignedGreaterThanOrEqualTo, sign_extend, false);
+    case Type::i32_geu:
+        return compile_comparison(instruction, Condition::UnsignedGreaterThanOrEqualTo, zero_extend, false);
+    case Type::i64_eq:
+        return compile_comparison(instruction, Condition::EqualTo, zero_extend, true);
+    case Type::i64_ne:
+        return compile_comparison(instruction, Condition::NotEqualTo, zero_extend, true);
+    case Type::i64_lts:
+        return compile_comparison(instruction, Condition::SignedLessThan, sign_extend, true);
+    case Type::i64_ltu:
+        return compile_comparison(instruction, Condition::UnsignedLessThan, zero_extend, true);
+    case Type::i64_gts:
+        return compile_comparison(instruction, Condition::SignedGreaterThan, sign_extend, true);
+    case Type::i64_gtu:
+        return compile_comparison(instruction, Condition::UnsignedGreaterThan, zero_extend, true);
+    case Type::i64_les:
+        return compile_comparison(instruction, Condition::SignedLessThanOrEqualTo, sign_extend, true);
+    case Type::i64_leu:
+        return compile_comparison(instruction, Condition::UnsignedLessThanOrEqualTo, zero_extend, true);
+    case Type::i64_ges:
+        return compile_comparison(instruction, Condition::SignedGreaterThanOrEqualTo, sign_extend, true);
+    case Type::i64_geu:
+        return compile_comparison(instruction, Condition::UnsignedGreaterThanOrEqualTo, zero_extend, true);
+
+#define __COMPILE_LOAD(name, ...) case Type::name:
+        ENUMERATE_WASM_REGISTER_LOADS(__COMPILE_LOAD)
+#undef __COMPILE_LOAD
+        return compile_load(instruction);
+#define __COMPILE_STORE(name, ...) case Type::name:
+        ENUMERATE_WASM_REGISTER_STORES(__COMPILE_STORE)
+#undef __COMPILE_STORE
+        return compile_store(instruction);
+
+    default:
+        return compile_slow_path(instruction);
+    }
+}
+
+OwnPtr<NativeFunction> Compiler::compile(RegisterFunction const& function)
+{
+    // All registers have to be reachable with a 32-bit displacement.
+    if (function.register_count() * sizeof(Value) > NumericLimits<i32>::max())
+        return nullptr;
+
+    Compiler compiler { function };
+    auto& assembler = compiler.m_assembler;
+
+    // The native code is entered with a pointer to the RuntimeContext (see NativeFunction::run()), and keeps the
+    // state it needs the most in callee-saved registers.
+    assembler.enter();
+    assembler.mov(Assembler::Operand::Register(CONTEXT), Assembler::Operand::Register(ARG0));
+    compiler.reload_context();
+
+    auto& instructions = function.instructions();
+    compiler.m_instruction_labels.resize(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        compiler.m_current_index = i;
+        compiler.m_instruction_labels[i].link(assembler);
+        compiler.compile_instruction(instructions[i]);
+    }
+
+    // Every function ends in a Return, so falling off the end of it would be a bug.
+    assembler.verify_not_reached();
+
+    auto emit_exit_with = [&](Assembler::Label& label, u64 exit_code) {
+        label.link(assembler);
+        assembler.mov(Assembler::Operand::Register(RET), Assembler::Operand::Imm(exit_code));
+        assembler.jump(compiler.m_exit_label);
+    };
+    emit_exit_with(compiler.m_trap_label, NativeFunction::trap_exit);
+    emit_exit_with(compiler.m_out_of_bounds_label, NativeFunction::out_of_bounds_exit);
+    emit_exit_with(compiler.m_instruction_limit_label, NativeFunction::instruction_limit_exit);
+
+    compiler.m_exit_label.link(assembler);
+    assembler.exit();
+
+    auto& output = compiler.m_output;
+    auto* executable_memory = mmap(nullptr, output.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (executable_memory == MAP_FAILED) {
+        dbgln("LibWasm: JIT: Failed to allocate executable memory: {}", strerror(errno));
+        return nullptr;
+    }
+
+    memcpy(executable_memory, output.data(), output.size());
+    if (mprotect(executable_memory, output.size(), PROT_READ | PROT_EXEC) < 0) {
+        dbgln("LibWasm: JIT: Failed to make executable memory executable: {}", strerror(errno));
+        munmap(executable_memory, output.size());
+        return nullptr;
+    }
+
+    dbgln_if(JIT_DEBUG, "LibWasm: JIT: Compiled {} register instructions to {} bytes of native code", instructions.size(), output.size());
+    return make<NativeFunction>(executable_memory, output.size());
+}
+
+}
+
+#else
+
+namespace Wasm::JIT {
+
+OwnPtr<NativeFunction> Compiler::compile(RegisterFunction const&)
+{
+    return nullptr;
+}
+
+}
+
+#endif
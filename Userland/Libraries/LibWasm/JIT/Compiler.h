@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJIT/Assembler.h>
+#include <LibWasm/AbstractMachine/RegisterBytecode.h>
+#include <LibWasm/JIT/NativeFunction.h>
+
+namespace Wasm::JIT {
+
+// Translates the register bytecode of a function into machine code, one instruction at a time. Control flow, integer
+// arithmetic, comparisons, f64 add/sub/mul and accesses to memory 0 are emitted inline. Everything else calls back into
+// BytecodeInterpreter::execute_register_operation(), so the native code works on the same register file as the
+// interpreter would.
+class Compiler {
+public:
+    // Returns nullptr if the current architecture isn't supported, or if we failed to allocate executable memory.
+    static OwnPtr<NativeFunction> compile(RegisterFunction const&);
+
+private:
+#ifdef JIT_ARCH_SUPPORTED
+    using Assembler = ::JIT::Assembler;
+    using Type = RegisterInstruction::Type;
+
+    explicit Compiler(RegisterFunction const& function)
+        : m_function(function)
+    {
+    }
+
+    void compile_instruction(RegisterInstruction const&);
+
+    void compile_copy(u32 destination, u32 source);
+    void compile_jump(RegisterInstruction const&);
+    void compile_conditional_jump(RegisterInstruction const&, Assembler::Condition);
+    void compile_branch_table(RegisterInstruction const&);
+    void compile_branch(RegisterBranchTarget const&);
+    void compile_select(RegisterInstruction const&);
+    void compile_i32_binary_operation(RegisterInstruction const&);
+    void compile_i64_binary_operation(RegisterInstruction const&);
+    void compile_f64_binary_operation(RegisterInstruction const&);
+    void compile_comparison(RegisterInstruction const&, Assembler::Condition, Assembler::Extension, bool is_64_bit);
+    void compile_eqz(RegisterInstruction const&, bool is_64_bit);
+    void compile_load(RegisterInstruction const&);
+    void compile_store(RegisterInstruction const&);
+    void compile_slow_path(RegisterInstruction const&);
+
+    void count_backward_branch_to(u64 target);
+    void compute_effective_address(RegisterInstruction const&, size_t access_size);
+    void load_i32(Assembler::Reg, u32 source, Assembler::Extension = Assembler::Extension::SignExtend);
+    void load_i64(Assembler::Reg, u32 source);
+    void store_result(u32 destination, Assembler::Reg);
+    void reload_context();
+
+    // Executes an instruction that has no inline fast path. Returns 0, or 1 if it trapped.
+    static u64 cxx_execute(RuntimeContext&, RegisterInstruction const&);
+
+    RegisterFunction const& m_function;
+    Vector<u8> m_output;
+    Assembler m_assembler { m_output };
+    Vector<Assembler::Label> m_instruction_labels;
+    Assembler::Label m_exit_label;
+    Assembler::Label m_trap_label;
+    Assembler::Label m_out_of_bounds_label;
+    Assembler::Label m_instruction_limit_label;
+    size_t m_current_index { 0 };
+#endif
+};
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibJIT/GDB.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/JIT/NativeFunction.h>
+#include <sys/mman.h>
+
+namespace Wasm::JIT {
+
+void RuntimeContext::refresh()
+{
+    registers = configuration->frame().locals().data();
+
+    auto& memories = configuration->frame().module().memories();
+    if (memories.is_empty()) {
+        memory_base = nullptr;
+        memory_size = 0;
+        return;
+    }
+    auto* memory = configuration->store().get(memories.first());
+    memory_base = memory->data().data();
+    memory_size = memory->size();
+}
+
+NativeFunction::NativeFunction(void* code, size_t size)
+    : m_code(code)
+    , m_size(size)
+{
+    if constexpr (JIT_DEBUG) {
+        m_gdb_object = ::JIT::GDB::build_gdb_image(code_bytes(), "LibWasm JIT"sv, "NativeFunction"sv);
+        if (m_gdb_object.has_value())
+            ::JIT::GDB::register_into_gdb(m_gdb_object->span());
+    }
+}
+
+NativeFunction::~NativeFunction()
+{
+    if (m_gdb_object.has_value())
+        ::JIT::GDB::unregister_from_gdb(m_gdb_object->span());
+    munmap(m_code, m_size);
+}
+
+u64 NativeFunction::run(RuntimeContext& context) const
+{
+    // NOTE: This matches the prologue emitted by JIT::Compiler.
+    using EntryPoint = u64 (*)(RuntimeContext*);
+    auto entry_point = reinterpret_cast<EntryPoint>(m_code);
+    return entry_point(&context);
+}
+
+}
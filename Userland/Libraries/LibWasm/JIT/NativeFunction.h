@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/FixedArray.h>
+#include <AK/Noncopyable.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <LibWasm/Forward.h>
+
+namespace Wasm {
+
+class Value;
+
+}
+
+namespace Wasm::JIT {
+
+// The state native code runs with. It is handed to the code in a register, and read and written through that.
+struct RuntimeContext {
+    BytecodeInterpreter* interpreter { nullptr };
+    Configuration* configuration { nullptr };
+    Value* registers { nullptr };
+    // Memory 0 of the module, the only one accessed inline.
+    u8* memory_base { nullptr };
+    u64 memory_size { 0 };
+    i64 remaining_backward_branches { 0 };
+
+    // Reloads everything that may have changed by running arbitrary code (e.g. calls and memory.grow).
+    void refresh();
+};
+
+class NativeFunction {
+    AK_MAKE_NONCOPYABLE(NativeFunction);
+    AK_MAKE_NONMOVABLE(NativeFunction);
+
+public:
+    // Besides these, run() returns the index of the Return instruction the function ended with.
+    static constexpr u64 trap_exit = NumericLimits<u64>::max();
+    static constexpr u64 unreachable_exit = trap_exit - 1;
+    static constexpr u64 out_of_bounds_exit = trap_exit - 2;
+    static constexpr u64 instruction_limit_exit = trap_exit - 3;
+
+    NativeFunction(void* code, size_t size);
+    ~NativeFunction();
+
+    // Runs the function on the register file in `context`, from its first instruction until it returns or traps.
+    // If it trapped in a slow path, the interpreter already holds the trap.
+    [[nodiscard]] u64 run(RuntimeContext&) const;
+
+    ReadonlyBytes code_bytes() const { return { static_cast<u8 const*>(m_code), m_size }; }
+
+private:
+    void* m_code { nullptr };
+    size_t m_size { 0 };
+    Optional<FixedArray<u8>> m_gdb_object;
+};
+
+}
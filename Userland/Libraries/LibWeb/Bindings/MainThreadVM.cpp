@@ -10,6 +10,7 @@
 #include <LibJS/AST.h>
 #include <LibJS/Heap/DeferGC.h>
 #include <LibJS/Module.h>
+#include <LibJS/ParsedProgramCache.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/Environment.h>
 #include <LibJS/Runtime/FinalizationRegistry.h>
@@ -90,6 +91,10 @@ ErrorOr<void> initialize_main_thread_vm(HTML::EventLoop::Type type)
     //       This avoids doing an exhaustive garbage collection on process exit.
     s_main_thread_vm->ref();
 
+    // NOTE: Pages tend to load the same scripts over and over again, both across reloads and across navigations
+    //       within a site, so we keep the parsed programs of recently loaded scripts around.
+    s_main_thread_vm->parsed_program_cache().set_source_size_budget(8 * MiB);
+
     auto& custom_data = verify_cast<WebEngineCustomData>(*s_main_thread_vm->custom_data());
     custom_data.event_loop = s_main_thread_vm->heap().allocate_without_realm<HTML::EventLoop>(type);
 
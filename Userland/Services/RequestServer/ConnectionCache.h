@@ -175,6 +175,10 @@ extern Threading::RWLockProtected<HashMap<ConnectionKey, NonnullOwnPtr<Vector<No
 extern Threading::RWLockProtected<HashMap<ConnectionKey, NonnullOwnPtr<Vector<NonnullOwnPtr<Connection<TLS::TLSv12>>>>>> g_tls_connection_cache;
 extern Threading::RWLockProtected<HashMap<ByteString, InferredServerProperties>> g_inferred_server_properties;
 
+// Shared by all TLS connections so that reconnecting to a host can resume its previous session.
+extern NonnullRefPtr<TLS::SessionCache> g_tls_session_cache;
+extern NonnullRefPtr<TLS::CertificateChainCache> g_tls_certificate_chain_cache;
+
 void request_did_finish(URL::URL const&, Core::Socket const*);
 void dump_jobs();
 
@@ -215,6 +219,8 @@ Coroutine<ErrorOr<void>> recreate_socket_if_needed(T& connection, URL::URL const
                     return connection.job_data->provide_client_certificates();
                 return {};
             });
+            options.set_session_cache(g_tls_session_cache.ptr());
+            options.set_certificate_chain_cache(g_tls_certificate_chain_cache.ptr());
             CO_TRY(set_socket(CO_TRY(co_await (connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))))));
         } else {
             CO_TRY(set_socket(CO_TRY(co_await (connection.proxy.template tunnel<SocketType, SocketStorageType>(url)))));
@@ -267,7 +273,16 @@ Coroutine<void> async_get_or_create_connection(auto& cache, URL::URL url, auto j
             socket_for_url->is_being_started = false;
         };
 
-        auto connection_result = co_await proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        TLS::Options tls_options;
+        tls_options.set_session_cache(g_tls_session_cache.ptr());
+        tls_options.set_certificate_chain_cache(g_tls_certificate_chain_cache.ptr());
+        auto tunnel = [&] {
+            if constexpr (IsSame<TLS::TLSv12, typename ConnectionType::SocketType>)
+                return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url, move(tls_options));
+            else
+                return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        };
+        auto connection_result = co_await tunnel();
         if (connection_result.is_error()) {
             dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
             Core::deferred_invoke([job] {
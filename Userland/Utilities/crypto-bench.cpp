@@ -18,6 +18,8 @@
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Curves/SECPxxxr1.h>
+#include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/Forward.h>
 #include <LibCrypto/Hash/BLAKE2b.h>
 #include <LibCrypto/Hash/MD5.h>
@@ -46,8 +48,13 @@
     E(aes_128_gcm, cipher, Cipher::AESCipher::GCMMode, 128)          \
     E(aes_256_cbc, cipher, Cipher::AESCipher::CBCMode, 256)          \
     E(aes_256_ctr, cipher, Cipher::AESCipher::CTRMode, 256)          \
+    E(aes_256_gcm, cipher, Cipher::AESCipher::GCMMode, 256)          \
     E(chacha20_128, cipher, Cipher::ChaCha20, 128, 96)               \
-    E(chacha20_256, cipher, Cipher::ChaCha20, 256, 96)
+    E(chacha20_256, cipher, Cipher::ChaCha20, 256, 96)               \
+    E(chacha20_poly1305, aead, AEAD::ChaCha20Poly1305)               \
+    E(x25519, handshake, Curves::X25519)                             \
+    E(secp256r1, handshake, Curves::SECP256r1)                       \
+    E(secp384r1, handshake, Curves::SECP384r1)
 
 struct Timings {
     u64 total_us { 0 };
@@ -57,6 +64,13 @@ struct Timings {
     size_t unit_bytes { 0 };
 };
 static HashMap<StringView, HashMap<size_t, Timings>> g_all_timings;
+
+struct OperationTimings {
+    ByteString name;
+    Timings timings;
+};
+static Vector<OperationTimings> g_all_operation_timings;
+
 static auto g_time_slice_per_size = Duration::from_seconds(3);
 
 constexpr size_t sizes_in_bytes[] = { 16, 1 * KiB, 16 * KiB, 256 * KiB, 1 * MiB, 16 * MiB };
@@ -89,6 +103,24 @@ static void run_benchmark_with_all_sizes(StringView name, Function<void(ByteBuff
     }
 }
 
+static void run_operation_benchmark(StringView name, StringView operation, Function<void()> func)
+{
+    Timings timing_result;
+    warn("Running benchmark for {} {} for ~{}ms...", name, operation, g_time_slice_per_size.to_milliseconds());
+    auto total_timer = Core::ElapsedTimer::start_new(Core::TimerType::Precise);
+    for (; total_timer.elapsed_time() < g_time_slice_per_size;) {
+        auto timer = Core::ElapsedTimer::start_new(Core::TimerType::Precise);
+        func();
+        auto elapsed = timer.elapsed_time();
+        timing_result.max_us = max(timing_result.max_us, elapsed.to_microseconds());
+        timing_result.min_us = min(timing_result.min_us, elapsed.to_microseconds());
+        timing_result.total_us += elapsed.to_microseconds();
+        timing_result.count++;
+    }
+    g_all_operation_timings.append({ ByteString::formatted("{} {}", name, operation), timing_result });
+    warnln("{}ms, {} ops, {}us/op", total_timer.elapsed_milliseconds(), timing_result.count, timing_result.total_us / timing_result.count);
+}
+
 template<typename Algorithm>
 static ErrorOr<void> run_hash_benchmark(StringView name)
 {
@@ -169,6 +201,71 @@ static ErrorOr<void> run_cipher_benchmark(StringView name, size_t key_bits, Opti
     return {};
 }
 
+template<typename Algorithm>
+static ErrorOr<void> run_aead_benchmark(StringView name)
+{
+    auto key = TRY(ByteBuffer::create_uninitialized(32));
+    fill_with_random(key);
+
+    auto nonce = TRY(ByteBuffer::create_uninitialized(12));
+    fill_with_random(nonce);
+
+    auto aad = TRY(ByteBuffer::create_uninitialized(13));
+    fill_with_random(aad);
+
+    run_benchmark_with_all_sizes(name, [&](auto& buffer) {
+        Algorithm aead(key.bytes(), nonce.bytes());
+        auto result = aead.encrypt(aad.bytes(), buffer.bytes());
+        AK::taint_for_optimizer(result);
+    });
+    return {};
+}
+
+// Times the public key operations one side of a TLS handshake performs: generating an ephemeral key pair,
+// deriving the shared secret from the peer's public key, and (for ECDSA curves) verifying the server's signature.
+template<typename Algorithm>
+static ErrorOr<void> run_handshake_benchmark(StringView name)
+{
+    Algorithm curve;
+    auto private_key = TRY(curve.generate_private_key());
+    auto peer_public_key = TRY(curve.generate_public_key(TRY(curve.generate_private_key())));
+
+    run_operation_benchmark(name, "keygen"sv, [&] {
+        auto key = MUST(curve.generate_private_key());
+        auto public_key = MUST(curve.generate_public_key(key));
+        AK::taint_for_optimizer(public_key);
+    });
+
+    run_operation_benchmark(name, "ecdh"sv, [&] {
+        auto shared_point = MUST(curve.compute_coordinate(private_key, peer_public_key));
+        AK::taint_for_optimizer(shared_point);
+    });
+
+    if constexpr (requires { curve.verify(ReadonlyBytes {}, ReadonlyBytes {}, ReadonlyBytes {}); }) {
+        auto scalar_size = private_key.size();
+        auto hash = TRY(ByteBuffer::create_uninitialized(scalar_size));
+        fill_with_random(hash);
+
+        // A random signature takes exactly as long to check as a valid one, it just fails the final comparison.
+        auto signature = TRY(ByteBuffer::create_uninitialized(6 + 2 * scalar_size));
+        fill_with_random(signature);
+        signature[0] = 0x30;
+        signature[1] = 4 + 2 * scalar_size;
+        for (size_t offset : { 2uz, 4 + scalar_size }) {
+            signature[offset] = 0x02;
+            signature[offset + 1] = scalar_size;
+            // Keep the integers positive and full length
+            signature[offset + 2] = (signature[offset + 2] & 0x7f) | 0x40;
+        }
+
+        run_operation_benchmark(name, "verify"sv, [&] {
+            auto result = MUST(curve.verify(hash, peer_public_key, signature));
+            AK::taint_for_optimizer(result);
+        });
+    }
+    return {};
+}
+
 static ErrorOr<void> benchmark(StringView algorithm)
 {
 #define BENCH(name, type, algo, ...)                                                       \
@@ -203,6 +300,20 @@ static void print_benchmark_results()
                 human_readable_quantity(timing.unit_bytes * timing.count / timing.total_us * 1'000'000));
         }
     }
+
+    if (g_all_operation_timings.is_empty())
+        return;
+
+    outln();
+    outln("{:<20} {:<10} {:<10} {:<10} {:<10}", "Operation", "Min us/op", "Max us/op", "Avg us/op", "Ops/s");
+    for (auto& [name, timing] : g_all_operation_timings) {
+        outln("{:<20} {:<10} {:<10} {:<10} {:<10}",
+            name,
+            timing.min_us,
+            timing.max_us,
+            timing.total_us / timing.count,
+            timing.count * 1'000'000 / timing.total_us);
+    }
 }
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
@@ -20,11 +20,13 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool keep_input_files { false };
     bool write_to_stdout { false };
     bool decompress { false };
+    Optional<size_t> thread_count;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
     args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(thread_count, "Compress using this many threads", "processes", 'p', "N");
     args_parser.add_positional_argument(filenames, "Files", "FILES", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -46,6 +48,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (write_to_stdout)
         keep_input_files = true;
 
+    if (thread_count == 0u) {
+        warnln("gzip: the number of threads must be at least 1");
+        return 1;
+    }
+
     for (auto const& input_filename : filenames) {
         OwnPtr<Stream> output_stream;
 
@@ -71,19 +78,27 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         // Buffer reads, which yields a significant performance improvement.
         NonnullOwnPtr<Stream> input_stream = TRY(Core::InputBufferedFile::create(move(input_file), 1 * MiB));
 
+        OwnPtr<Compress::ParallelGzipCompressor> parallel_compressor;
+
         if (decompress) {
             input_stream = TRY(try_make<Compress::GzipDecompressor>(move(input_stream)));
+        } else if (thread_count.has_value()) {
+            parallel_compressor = TRY(Compress::ParallelGzipCompressor::create(output_stream.release_nonnull(), thread_count.value()));
         } else {
             output_stream = TRY(try_make<Compress::GzipCompressor>(output_stream.release_nonnull()));
         }
 
+        Stream& destination = parallel_compressor ? static_cast<Stream&>(*parallel_compressor) : *output_stream;
         auto buffer = TRY(ByteBuffer::create_uninitialized(1 * MiB));
 
         while (!input_stream->is_eof()) {
             auto span = TRY(input_stream->read_some(buffer));
-            TRY(output_stream->write_until_depleted(span));
+            TRY(destination.write_until_depleted(span));
         }
 
+        if (parallel_compressor)
+            TRY(parallel_compressor->finish());
+
         if (!keep_input_files)
             TRY(Core::System::unlink(input_filename));
     }
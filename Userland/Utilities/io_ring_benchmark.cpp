@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/ByteString.h>
+#include <AK/ScopeGuard.h>
+#include <AK/Types.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/IORing.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+enum class Mode {
+    Read,
+    Write,
+};
+
+struct Result {
+    u64 operations {};
+    u64 bytes {};
+    i64 milliseconds {};
+
+    u64 operations_per_second() const { return milliseconds ? operations * 1000 / milliseconds : operations; }
+    u64 bytes_per_second() const { return milliseconds ? bytes * 1000 / milliseconds : bytes; }
+};
+
+static ErrorOr<Result> benchmark_syscalls(int fd, Mode mode, size_t file_size, ByteBuffer& buffer, Duration time_per_benchmark)
+{
+    Result result;
+    size_t offset = 0;
+
+    auto timer = Core::ElapsedTimer::start_new();
+    while (timer.elapsed_time() < time_per_benchmark) {
+        ssize_t nbytes = mode == Mode::Read
+            ? pread(fd, buffer.data(), buffer.size(), offset)
+            : pwrite(fd, buffer.data(), buffer.size(), offset);
+        if (nbytes < 0)
+            return Error::from_syscall(mode == Mode::Read ? "pread"sv : "pwrite"sv, -errno);
+        result.bytes += nbytes;
+        ++result.operations;
+
+        offset += buffer.size();
+        if (offset + buffer.size() > file_size)
+            offset = 0;
+    }
+    result.milliseconds = timer.elapsed_milliseconds();
+    return result;
+}
+
+static ErrorOr<Result> benchmark_io_ring(int fd, Mode mode, size_t file_size, size_t block_size, u32 queue_depth, Duration time_per_benchmark)
+{
+    auto ring = TRY(Core::IORing::create(queue_depth));
+    auto buffers = TRY(ByteBuffer::create_zeroed(block_size * queue_depth));
+
+    Result result;
+    u64 offset = 0;
+    u32 in_flight = 0;
+    Optional<Error> error;
+
+    auto queue_operation = [&](u32 slot) -> ErrorOr<void> {
+        auto buffer = buffers.bytes().slice(slot * block_size, block_size);
+        if (mode == Mode::Read)
+            TRY(ring->queue_read(fd, buffer, offset, slot));
+        else
+            TRY(ring->queue_write(fd, buffer, offset, slot));
+        ++in_flight;
+
+        offset += block_size;
+        if (offset + block_size > file_size)
+            offset = 0;
+        return {};
+    };
+
+    for (u32 slot = 0; slot < queue_depth; ++slot)
+        TRY(queue_operation(slot));
+
+    auto timer = Core::ElapsedTimer::start_new();
+    while (in_flight > 0) {
+        TRY(ring->submit(1));
+
+        bool should_stop = timer.elapsed_time() >= time_per_benchmark;
+        ring->for_each_completion([&](IORingCompletion const& completion) {
+            --in_flight;
+            if (completion.result < 0) {
+                error = Error::from_errno(-completion.result);
+                return;
+            }
+            result.bytes += completion.result;
+            ++result.operations;
+            if (!should_stop && !error.has_value()) {
+                if (auto queue_result = queue_operation(completion.user_data); queue_result.is_error())
+                    error = queue_result.release_error();
+            }
+        });
+    }
+    result.milliseconds = timer.elapsed_milliseconds();
+
+    if (error.has_value())
+        return error.release_value();
+    return result;
+}
+
+static void print_result(StringView name, Result const& result)
+{
+    outln("{:>16}: ops={} time={}ms ops_per_second={} bps={}", name, result.operations, result.milliseconds, result.operations_per_second(), result.bytes_per_second());
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    ByteString directory = ".";
+    i64 time_per_benchmark_sec = 5;
+    size_t file_size = 4 * MiB;
+    size_t block_size = 4096;
+    u32 queue_depth = 64;
+    bool allow_cache = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Compare batched I/O ring operations with one read() or write() syscall per operation.");
+    args_parser.add_option(allow_cache, "Allow using disk cache", "cache", 'c');
+    args_parser.add_option(directory, "Path to a directory where we can store the benchmark temp file", "directory", 'd', "directory");
+    args_parser.add_option(time_per_benchmark_sec, "Time elapsed per benchmark (seconds)", "time-per-benchmark", 't', "time-per-benchmark");
+    args_parser.add_option(file_size, "File size", "file-size", 'f', "file-size");
+    args_parser.add_option(block_size, "Size of each operation", "block-size", 'b', "block-size");
+    args_parser.add_option(queue_depth, "Number of operations in flight on the I/O ring", "queue-depth", 'q', "queue-depth");
+    args_parser.parse(arguments);
+
+    if (block_size == 0 || block_size > file_size) {
+        warnln("The block size must be between 1 and the file size");
+        return 1;
+    }
+    if (queue_depth == 0 || queue_depth > IO_RING_MAX_ENTRIES) {
+        warnln("The queue depth must be between 1 and {}", IO_RING_MAX_ENTRIES);
+        return 1;
+    }
+
+    Duration const time_per_benchmark = Duration::from_seconds(time_per_benchmark_sec);
+
+    auto filename = ByteString::formatted("{}/io_ring_benchmark.tmp", directory);
+    int flags = O_CREAT | O_TRUNC | O_RDWR;
+    if (!allow_cache)
+        flags |= O_DIRECT;
+    int fd = TRY(Core::System::open(filename, flags, 0644));
+    ScopeGuard fd_cleanup = [&] {
+        if (auto result = Core::System::close(fd); result.is_error())
+            warnln("{}", result.release_error());
+        if (auto result = Core::System::unlink(filename); result.is_error())
+            warnln("{}", result.release_error());
+    };
+
+    auto buffer = TRY(ByteBuffer::create_zeroed(block_size));
+    for (size_t offset = 0; offset + block_size <= file_size; offset += block_size) {
+        if (pwrite(fd, buffer.data(), buffer.size(), offset) < 0)
+            return Error::from_syscall("pwrite"sv, -errno);
+    }
+    TRY(Core::System::fsync(fd));
+
+    outln("Running: file_size={} block_size={} queue_depth={}", file_size, block_size, queue_depth);
+    for (auto mode : { Mode::Write, Mode::Read }) {
+        auto mode_name = mode == Mode::Read ? "read"sv : "write"sv;
+        print_result(ByteString::formatted("{} syscalls", mode_name), TRY(benchmark_syscalls(fd, mode, file_size, buffer, time_per_benchmark)));
+        print_result(ByteString::formatted("{} I/O ring", mode_name), TRY(benchmark_io_ring(fd, mode, file_size, block_size, queue_depth, time_per_benchmark)));
+    }
+
+    return 0;
+}
@@ -16,6 +16,7 @@
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Optimizer.h>
 #include <LibJS/Console.h>
 #include <LibJS/Contrib/Test262/GlobalObject.h>
 #include <LibJS/Parser.h>
@@ -58,6 +59,7 @@ private:
     JS_DECLARE_NATIVE_FUNCTION(load_json);
     JS_DECLARE_NATIVE_FUNCTION(last_value_getter);
     JS_DECLARE_NATIVE_FUNCTION(print);
+    JS_DECLARE_NATIVE_FUNCTION(dump_inline_cache_stats);
 };
 
 class ScriptObject final : public JS::GlobalObject {
@@ -332,6 +334,7 @@ void ReplObject::initialize(JS::Realm& realm)
     define_native_function(realm, "loadINI", load_ini, 1, attr);
     define_native_function(realm, "loadJSON", load_json, 1, attr);
     define_native_function(realm, "print", print, 1, attr);
+    define_native_function(realm, "dumpInlineCacheStats", dump_inline_cache_stats, 0, attr);
 
     define_native_accessor(
         realm,
@@ -377,6 +380,7 @@ JS_DEFINE_NATIVE_FUNCTION(ReplObject::exit_interpreter)
 JS_DEFINE_NATIVE_FUNCTION(ReplObject::repl_help)
 {
     warnln("REPL commands:");
+    warnln("    dumpInlineCacheStats(): print the hit and miss counts of every property access site.");
     warnln("    exit(code): exit the REPL with specified code. Defaults to 0.");
     warnln("    help(): display this menu");
     warnln("    loadINI(file): load the given file as INI.");
@@ -407,6 +411,14 @@ JS_DEFINE_NATIVE_FUNCTION(ReplObject::print)
     return JS::js_undefined();
 }
 
+JS_DEFINE_NATIVE_FUNCTION(ReplObject::dump_inline_cache_stats)
+{
+    vm.heap().for_each_live_cell_of_type<JS::Bytecode::Executable>([](auto& executable) {
+        executable.dump_property_lookup_cache_statistics();
+    });
+    return JS::js_undefined();
+}
+
 void ScriptObject::initialize(JS::Realm& realm)
 {
     Base::initialize(realm);
@@ -448,10 +460,24 @@ static ErrorOr<void> repl(JS::Realm& realm)
 
         g_repl_statements.append(piece);
         TRY(parse_and_run(realm, piece, "REPL"sv));
+
+        // NOTE: Waiting for the next piece of input is a good time to destroy any cells left behind by the GC.
+        g_vm->heap().finish_sweeping();
     }
     return {};
 }
 
+static void print_gc_pause_report(JS::Heap const& heap)
+{
+    auto print_statistics = [](StringView name, JS::Heap::CollectionStatistics const& statistics) {
+        warnln("{} collections: {}, total pause {} us, longest pause {} us", name, statistics.collection_count,
+            statistics.total_pause_time.to_microseconds(), statistics.longest_pause_time.to_microseconds());
+    };
+    print_statistics("Young generation"sv, heap.young_generation_collection_statistics());
+    print_statistics("Full"sv, heap.full_collection_statistics());
+    warnln("Longest sweep slice: {} us", heap.longest_sweep_slice().to_microseconds());
+}
+
 class ReplConsoleClient final : public JS::ConsoleClient {
     JS_CELL(ReplConsoleClient, JS::ConsoleClient);
 
@@ -535,9 +561,12 @@ private:
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction map_fixed"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction map_fixed prot_exec"));
 
     bool gc_on_every_allocation = false;
+    bool generational_gc = false;
+    bool incremental_sweep = false;
+    bool report_gc_pauses = false;
     bool disable_syntax_highlight = false;
     bool disable_debug_printing = false;
     bool use_test262_global = false;
@@ -548,11 +577,17 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.set_general_help("This is a JavaScript interpreter.");
     args_parser.add_option(s_dump_ast, "Dump the AST", "dump-ast", 'A');
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
+    args_parser.add_option(JS::Bytecode::g_optimization_level, "Optimize the bytecode (0 to 2, default 0)", "optimize", 'O', "level");
+    args_parser.add_option(JS::Bytecode::g_dump_optimization_statistics, "Print instruction counts before and after bytecode optimization", "dump-optimization-stats", {});
+    args_parser.add_option(JS::Bytecode::g_jit_enabled, "Compile hot functions and loops to native code", "jit", {});
     args_parser.add_option(s_as_module, "Treat as module", "as-module", 'm');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
     args_parser.add_option(s_disable_source_location_hints, "Disable source location hints", "disable-source-location-hints", 'h');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(generational_gc, "Only collect the young generation on allocation-triggered GCs", "generational-gc", {});
+    args_parser.add_option(incremental_sweep, "Destroy dead cells lazily instead of during GC pauses", "incremental-sweep", {});
+    args_parser.add_option(report_gc_pauses, "Print GC pause and sweep slice times on exit", "report-gc-pauses", {});
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
     args_parser.add_option(disable_debug_printing, "Disable debug output", "disable-debug-output", {});
     args_parser.add_option(evaluate_script, "Evaluate argument as a script", "evaluate", 'c', "script");
@@ -600,6 +635,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         ReplConsoleClient console_client(console_object.console());
         console_object.console().set_client(console_client);
         g_vm->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        g_vm->heap().set_generational_collection_enabled(generational_gc);
+        g_vm->heap().set_incremental_sweeping_enabled(incremental_sweep);
 
         auto& global_environment = realm.global_environment();
 
@@ -829,6 +866,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         ReplConsoleClient console_client(console_object.console());
         console_object.console().set_client(console_client);
         g_vm->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        g_vm->heap().set_generational_collection_enabled(generational_gc);
+        g_vm->heap().set_incremental_sweeping_enabled(incremental_sweep);
 
         StringBuilder builder;
         StringView source_name;
@@ -865,5 +904,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return 1;
     }
 
+    if (report_gc_pauses)
+        print_gc_pause_report(g_vm->heap());
+
     return s_exit_code;
 }
@@ -10,6 +10,7 @@
 #include <AK/MemoryStream.h>
 #include <AK/StackInfo.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibFileSystem/FileSystem.h>
@@ -523,6 +524,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool export_all_imports = false;
     bool shell_mode = false;
     bool wasi = false;
+    bool jit = false;
+    size_t benchmark_runs = 0;
     ByteString exported_function_to_execute;
     Vector<ParsedValue> values_to_push;
     Vector<ByteString> modules_to_link_in;
@@ -538,6 +541,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     parser.add_option(export_all_imports, "Export noop functions corresponding to imports", "export-noop");
     parser.add_option(shell_mode, "Launch a REPL in the module's context (implies -i)", "shell", 's');
     parser.add_option(wasi, "Enable WASI", "wasi", 'w');
+    parser.add_option(jit, "Compile functions to native code when instantiating modules", "jit");
+    parser.add_option(benchmark_runs, "Run the exported function (or all exported functions) this many times on both the interpreter and the JIT, and compare them (implies -i and --jit)", "benchmark", 0, "runs");
     parser.add_option(Core::ArgsParser::Option {
         .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
         .help_string = "Directory mappings to expose via WASI",
@@ -602,6 +607,15 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (!exported_function_to_execute.is_empty())
         attempt_instantiate = true;
 
+    if (benchmark_runs > 0) {
+        if (debug) {
+            warnln("Cannot benchmark in the debugger");
+            return 1;
+        }
+        attempt_instantiate = true;
+        jit = true;
+    }
+
     auto parse_result = parse(filename);
     if (parse_result.is_null())
         return 1;
@@ -616,6 +630,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     if (attempt_instantiate) {
         Wasm::AbstractMachine machine;
+        if (jit)
+            machine.enable_jit();
         Optional<Wasm::Wasi::Implementation> wasi_impl;
 
         if (wasi) {
@@ -793,6 +809,70 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return 0;
         }
 
+        if (benchmark_runs > 0) {
+            auto run_tier = [&](Wasm::BytecodeInterpreter& interpreter, Wasm::FunctionAddress address, Vector<Wasm::Value> const& arguments, Optional<Wasm::Result>& result) {
+                auto timer = Core::ElapsedTimer::start_new(Core::TimerType::Precise);
+                for (size_t i = 0; i < benchmark_runs; ++i)
+                    result = machine.invoke(interpreter, address, arguments);
+                return timer.elapsed_time();
+            };
+            auto results_match = [](Wasm::Result const& a, Wasm::Result const& b) {
+                if (a.is_trap() || b.is_trap())
+                    return a.is_trap() && b.is_trap() && a.trap().reason == b.trap().reason;
+                if (a.is_completion() || b.is_completion())
+                    return false;
+                if (a.values().size() != b.values().size())
+                    return false;
+                for (size_t i = 0; i < a.values().size(); ++i) {
+                    if (a.values()[i].value() != b.values()[i].value())
+                        return false;
+                }
+                return true;
+            };
+
+            Wasm::BytecodeInterpreter interpreter(g_stack_info);
+            interpreter.disable_native_code();
+            Wasm::BytecodeInterpreter native_code(g_stack_info);
+
+            size_t mismatches = 0;
+            for (auto& entry : module_instance->exports()) {
+                if (!exported_function_to_execute.is_empty() && entry.name() != exported_function_to_execute)
+                    continue;
+                auto address = entry.value().get_pointer<Wasm::FunctionAddress>();
+                if (!address)
+                    continue;
+                auto* function = machine.store().get(*address);
+                if (!function || !function->has<Wasm::WasmFunction>())
+                    continue;
+
+                // NOTE: Arguments given with --arg only make sense for the one function given with -e.
+                Vector<Wasm::Value> arguments;
+                auto parameters_to_push = values_to_push;
+                for (auto& param : function->get<Wasm::WasmFunction>().type().parameters()) {
+                    if (!parameters_to_push.is_empty() && param == parameters_to_push.last().type)
+                        arguments.append(parameters_to_push.take_last().value);
+                    else
+                        arguments.append(Wasm::Value());
+                }
+
+                Optional<Wasm::Result> interpreter_result;
+                Optional<Wasm::Result> native_code_result;
+                auto interpreter_time = run_tier(interpreter, *address, arguments, interpreter_result);
+                auto native_code_time = run_tier(native_code, *address, arguments, native_code_result);
+
+                auto interpreter_us = interpreter_time.to_microseconds();
+                auto native_code_us = native_code_time.to_microseconds();
+                outln("{}: interpreter {}us, jit {}us, speedup {:.2}x",
+                    entry.name(), interpreter_us, native_code_us,
+                    static_cast<double>(interpreter_us) / static_cast<double>(max<i64>(native_code_us, 1)));
+                if (!results_match(*interpreter_result, *native_code_result)) {
+                    warnln("{}: results of the interpreter and the jit differ", entry.name());
+                    ++mismatches;
+                }
+            }
+            return mismatches == 0 ? 0 : 1;
+        }
+
         if (!exported_function_to_execute.is_empty()) {
             Optional<Wasm::FunctionAddress> run_address;
             Vector<Wasm::Value> values;
@@ -832,7 +912,10 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 outln();
             }
 
-            auto result = machine.invoke(g_interpreter, run_address.value(), move(values)).assert_wasm_result();
+            // NOTE: Only the plain interpreter runs the register bytecode and native code, the debugger needs to see every instruction.
+            auto result = debug
+                ? machine.invoke(g_interpreter, run_address.value(), move(values)).assert_wasm_result()
+                : machine.invoke(run_address.value(), move(values)).assert_wasm_result();
 
             if (debug)
                 launch_repl();